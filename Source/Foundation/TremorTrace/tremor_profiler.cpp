@@ -17,6 +17,7 @@ Profiler& Profiler::instance() {
 void Profiler::beginFrame() {
     std::lock_guard<std::mutex> lock(mutex_);
     activeFrameRecords_.clear();
+    activeFrameCounters_.clear();
     frameStart_ = std::chrono::steady_clock::now();
     frameActive_ = true;
 }
@@ -71,11 +72,19 @@ void Profiler::endFrame() {
         return a.lastMs > b.lastMs;
     });
 
-    if (records.size() > kMaxDisplayRecords) {
-        records.resize(kMaxDisplayRecords);
-    }
+    frameRecords_ = std::move(records);
+    snapshot_.topRecords.assign(
+        frameRecords_.begin(),
+        frameRecords_.begin() + static_cast<std::ptrdiff_t>(std::min(frameRecords_.size(), kMaxDisplayRecords))
+    );
 
-    snapshot_.topRecords = std::move(records);
+    snapshot_.counters.clear();
+    for (const auto& [name, value] : activeFrameCounters_) {
+        snapshot_.counters.push_back(ProfileCounterRecord{name, value});
+    }
+    std::sort(snapshot_.counters.begin(), snapshot_.counters.end(), [](const ProfileCounterRecord& a, const ProfileCounterRecord& b) {
+        return a.name < b.name;
+    });
     frameActive_ = false;
 }
 
@@ -90,11 +99,25 @@ void Profiler::addSample(std::string_view name, double milliseconds) {
     record.callCount += 1;
 }
 
+void Profiler::setCounter(std::string_view name, double value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!frameActive_) {
+        return;
+    }
+
+    activeFrameCounters_[std::string(name)] = value;
+}
+
 ProfileFrameSnapshot Profiler::snapshot() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return snapshot_;
 }
 
+std::vector<ProfileDisplayRecord> Profiler::frameRecords() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frameRecords_;
+}
+
 ScopedCpuZone::ScopedCpuZone(std::string_view name)
     : name_(name),
       start_(std::chrono::steady_clock::now()) {}
@@ -18,11 +18,17 @@ struct ProfileDisplayRecord {
     uint32_t callCount = 0;
 };
 
+struct ProfileCounterRecord {
+    std::string name;
+    double value = 0.0;
+};
+
 struct ProfileFrameSnapshot {
     double frameMs = 0.0;
     double avgFrameMs = 0.0;
     double maxFrameMs = 0.0;
     std::vector<ProfileDisplayRecord> topRecords;
+    std::vector<ProfileCounterRecord> counters;
 };
 
 class Profiler {
@@ -32,8 +38,12 @@ public:
     void beginFrame();
     void endFrame();
     void addSample(std::string_view name, double milliseconds);
+    // Per-frame value such as an object count; the last value set in a frame wins
+    void setCounter(std::string_view name, double value);
 
     ProfileFrameSnapshot snapshot() const;
+    // Every zone of the last finished frame, slowest first; the snapshot keeps only the top few
+    std::vector<ProfileDisplayRecord> frameRecords() const;
 
 private:
     struct ActiveRecord {
@@ -52,7 +62,9 @@ private:
     mutable std::mutex mutex_;
     std::unordered_map<std::string, ActiveRecord> activeFrameRecords_;
     std::unordered_map<std::string, HistoryRecord> historyRecords_;
+    std::unordered_map<std::string, double> activeFrameCounters_;
     ProfileFrameSnapshot snapshot_;
+    std::vector<ProfileDisplayRecord> frameRecords_;
     std::chrono::steady_clock::time_point frameStart_{};
     bool frameActive_ = false;
     bool frameStatsInitialized_ = false;
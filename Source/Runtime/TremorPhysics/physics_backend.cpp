@@ -3,16 +3,51 @@
 #include "Source/Runtime/TremorPhysics/physx_physics_world.h"
 #include "jolt_physics_world.h"
 
+#include "logger.h"
+
+#include <algorithm>
+#include <cmath>
 #include <exception>
+#include <functional>
 #include <string>
 #include <utility>
 
 namespace tremor::physics {
 
+bool PhysicsQueryFilter::acceptsLayer(const PhysicsLayerConfig& config, PhysicsObjectLayer layer) const {
+    if (layer >= 64 || (layerMask & (uint64_t{1} << layer)) == 0) {
+        return false;
+    }
+    if (!asLayer) {
+        return true;
+    }
+    return *asLayer < config.objectCollisions.size() &&
+        layer < config.objectCollisions[*asLayer].size() &&
+        config.objectCollisions[*asLayer][layer];
+}
+
+size_t PhysicsShapeKeyHash::operator()(const PhysicsShapeKey& key) const {
+    size_t hash = std::hash<uint8_t>{}(static_cast<uint8_t>(key.type));
+    for (const float value : {key.dimensions.x, key.dimensions.y, key.dimensions.z}) {
+        hash = hash * 31 + std::hash<float>{}(value);
+    }
+    return hash;
+}
+
+size_t PhysicsBodyPoolKeyHash::operator()(const PhysicsBodyPoolKey& key) const {
+    return PhysicsShapeKeyHash{}(key.shape) * 31 + std::hash<PhysicsObjectLayer>{}(key.layer);
+}
+
 PhysicsWorldBackend::PhysicsWorldBackend(PhysicsSettings settings)
     : settings_(std::move(settings)) {
 }
 
+void PhysicsWorldBackend::reserveDynamicCapsules(float, float, PhysicsObjectLayer, size_t) {
+}
+
+void PhysicsWorldBackend::reserveKinematicBoxes(const glm::vec3&, PhysicsObjectLayer, size_t) {
+}
+
 std::optional<PhysicsObjectLayer> PhysicsWorldBackend::findLayer(std::string_view nameOrNumber) const {
     const std::string value(nameOrNumber);
     for (PhysicsObjectLayer index = 0; index < settings_.layers.layers.size(); ++index) {
@@ -32,18 +67,281 @@ std::optional<PhysicsObjectLayer> PhysicsWorldBackend::findLayer(std::string_vie
     return std::nullopt;
 }
 
+void PhysicsWorldBackend::setContactBatchCallback(ContactBatchCallback callback) {
+    contactBatchCallback_ = std::move(callback);
+}
+
 void PhysicsWorldBackend::setContactCallback(ContactCallback callback) {
     contactCallback_ = std::move(callback);
 }
 
 void PhysicsWorldBackend::clearContactCallback() {
     contactCallback_ = nullptr;
+    contactBatchCallback_ = nullptr;
+}
+
+void PhysicsWorldBackend::setContactLayerPairEnabled(PhysicsObjectLayer left, PhysicsObjectLayer right, bool enabled) {
+    contactStream_.setLayerPairEnabled(left, right, enabled);
 }
 
-void PhysicsWorldBackend::emitContactEvent(const PhysicsContactEvent& event) const {
+void PhysicsWorldBackend::emitContactEvent(const PhysicsContactEvent& event) {
+    contactStream_.push(event);
+}
+
+void PhysicsWorldBackend::dispatchContactEvents() {
+    contactStream_.mergeStep();
+    const std::span<const PhysicsContactEvent> events = contactStream_.batch();
+    if (events.empty()) {
+        return;
+    }
+    if (contactBatchCallback_) {
+        contactBatchCallback_(events);
+    }
     if (contactCallback_) {
-        contactCallback_(event);
+        for (const PhysicsContactEvent& event : events) {
+            contactCallback_(event);
+        }
+    }
+    contactStream_.clearBatch();
+}
+
+uint32_t PhysicsWorldBackend::advance(float frameDeltaTime) {
+    if (!(frameDeltaTime > 0.0f) || !std::isfinite(frameDeltaTime)) {
+        return 0;
+    }
+
+    if (!isFixedStep()) {
+        update(frameDeltaTime);
+        dispatchContactEvents();
+        return 1;
+    }
+
+    const float stepDuration = fixedStepDuration();
+    stepAccumulator_ += frameDeltaTime;
+
+    uint32_t stepCount = static_cast<uint32_t>(stepAccumulator_ / stepDuration);
+    const uint32_t maxSteps = std::max(1u, settings_.maxSubsteps);
+    if (stepCount > maxSteps) {
+        // A frame spike: simulate what the budget allows and let the rest go
+        // rather than spiral into ever longer frames
+        const float dropped = static_cast<float>(stepCount - maxSteps) * stepDuration;
+        droppedStepTime_ += dropped;
+        stepAccumulator_ -= dropped;
+        stepCount = maxSteps;
+        Logger::get().debug("Physics dropped {:.1f} ms after a {:.1f} ms frame", dropped * 1000.0f, frameDeltaTime * 1000.0f);
+    }
+
+    for (uint32_t step = 0; step < stepCount; ++step) {
+        // Only the state before the final step is needed for interpolation
+        if (step + 1 == stepCount) {
+            if (stepCount == 1) {
+                previousPositions_ = currentPositions_;
+            } else {
+                readBodyPositions(interpolatedBodies_, previousPositions_);
+            }
+        }
+        update(stepDuration);
+        // Merge per step so duplicates are only collapsed within the step that produced them
+        contactStream_.mergeStep();
+        stepAccumulator_ -= stepDuration;
+    }
+    dispatchContactEvents();
+    if (stepCount > 0) {
+        readBodyPositions(interpolatedBodies_, currentPositions_);
+    }
+
+    stepAccumulator_ = std::max(0.0f, stepAccumulator_);
+    interpolationAlpha_ = std::clamp(stepAccumulator_ / stepDuration, 0.0f, 1.0f);
+    return stepCount;
+}
+
+void PhysicsWorldBackend::setFixedStep(float stepRate, uint32_t maxSubsteps) {
+    settings_.fixedStepRate = std::isfinite(stepRate) ? std::max(0.0f, stepRate) : 0.0f;
+    settings_.maxSubsteps = std::max(1u, maxSubsteps);
+    stepAccumulator_ = 0.0f;
+    interpolationAlpha_ = 1.0f;
+    readBodyPositions(interpolatedBodies_, currentPositions_);
+    previousPositions_ = currentPositions_;
+}
+
+void PhysicsWorldBackend::setStepAccumulator(float seconds) {
+    const float stepDuration = fixedStepDuration();
+    if (stepDuration <= 0.0f) {
+        return;
+    }
+    stepAccumulator_ = std::isfinite(seconds) ? std::clamp(seconds, 0.0f, stepDuration) : 0.0f;
+    interpolationAlpha_ = stepAccumulator_ / stepDuration;
+}
+
+void PhysicsWorldBackend::setBodyInterpolated(PhysicsBodyHandle bodyId, bool interpolated) {
+    if (bodyId.IsInvalid()) {
+        return;
+    }
+    if (!interpolated) {
+        forgetInterpolatedBody(bodyId);
+        return;
+    }
+
+    const glm::vec3 position = getBodyPosition(bodyId);
+    const auto [found, inserted] = interpolatedBodyIndex_.try_emplace(bodyId.raw(), interpolatedBodies_.size());
+    if (inserted) {
+        interpolatedBodies_.push_back(bodyId);
+        previousPositions_.push_back(position);
+        currentPositions_.push_back(position);
+        return;
+    }
+    previousPositions_[found->second] = position;
+    currentPositions_[found->second] = position;
+}
+
+glm::vec3 PhysicsWorldBackend::getInterpolatedBodyPosition(PhysicsBodyHandle bodyId) const {
+    // Variable steps always end on the simulated state
+    const auto found = isFixedStep() ? interpolatedBodyIndex_.find(bodyId.raw()) : interpolatedBodyIndex_.end();
+    if (found == interpolatedBodyIndex_.end()) {
+        return getBodyPosition(bodyId);
+    }
+    return glm::mix(previousPositions_[found->second], currentPositions_[found->second], interpolationAlpha_);
+}
+
+void PhysicsWorldBackend::snapInterpolatedBody(PhysicsBodyHandle bodyId, const glm::vec3& position) {
+    const auto found = interpolatedBodyIndex_.find(bodyId.raw());
+    if (found != interpolatedBodyIndex_.end()) {
+        previousPositions_[found->second] = position;
+        currentPositions_[found->second] = position;
+    }
+}
+
+void PhysicsWorldBackend::forgetInterpolatedBody(PhysicsBodyHandle bodyId) {
+    const auto found = interpolatedBodyIndex_.find(bodyId.raw());
+    if (found == interpolatedBodyIndex_.end()) {
+        return;
+    }
+
+    // Swap-remove to keep the arrays dense
+    const size_t index = found->second;
+    const size_t last = interpolatedBodies_.size() - 1;
+    if (index != last) {
+        interpolatedBodies_[index] = interpolatedBodies_[last];
+        previousPositions_[index] = previousPositions_[last];
+        currentPositions_[index] = currentPositions_[last];
+        interpolatedBodyIndex_[interpolatedBodies_[index].raw()] = index;
+    }
+    interpolatedBodies_.pop_back();
+    previousPositions_.pop_back();
+    currentPositions_.pop_back();
+    interpolatedBodyIndex_.erase(found);
+}
+
+void PhysicsWorldBackend::clearInterpolatedBodies() {
+    interpolatedBodies_.clear();
+    previousPositions_.clear();
+    currentPositions_.clear();
+    interpolatedBodyIndex_.clear();
+    stepAccumulator_ = 0.0f;
+    interpolationAlpha_ = 1.0f;
+}
+
+void PhysicsWorldBackend::readBodyPositions(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<glm::vec3> positions
+) const {
+    const size_t count = std::min(bodyIds.size(), positions.size());
+    for (size_t index = 0; index < count; ++index) {
+        positions[index] = getBodyPosition(bodyIds[index]);
+    }
+}
+
+void PhysicsWorldBackend::readBodyVelocities(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<glm::vec3> velocities
+) const {
+    const size_t count = std::min(bodyIds.size(), velocities.size());
+    for (size_t index = 0; index < count; ++index) {
+        velocities[index] = getBodyVelocity(bodyIds[index]);
+    }
+}
+
+void PhysicsWorldBackend::readBodySleeping(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<uint8_t> sleeping
+) const {
+    const size_t count = std::min(bodyIds.size(), sleeping.size());
+    for (size_t index = 0; index < count; ++index) {
+        sleeping[index] = isBodySleeping(bodyIds[index]) ? 1 : 0;
+    }
+}
+
+void PhysicsWorldBackend::setBodyPositions(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<const glm::vec3> positions
+) {
+    const size_t count = std::min(bodyIds.size(), positions.size());
+    for (size_t index = 0; index < count; ++index) {
+        setBodyPosition(bodyIds[index], positions[index]);
+    }
+}
+
+void PhysicsWorldBackend::setBodyVelocities(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<const glm::vec3> velocities
+) {
+    const size_t count = std::min(bodyIds.size(), velocities.size());
+    for (size_t index = 0; index < count; ++index) {
+        setBodyVelocity(bodyIds[index], velocities[index]);
+    }
+}
+
+void PhysicsWorldBackend::wakeBodies(std::span<const PhysicsBodyHandle> bodyIds) {
+    for (const PhysicsBodyHandle bodyId : bodyIds) {
+        wakeBody(bodyId);
+    }
+}
+
+void PhysicsWorldBackend::sleepBodies(std::span<const PhysicsBodyHandle> bodyIds) {
+    for (const PhysicsBodyHandle bodyId : bodyIds) {
+        sleepBody(bodyId);
+    }
+}
+
+void PhysicsWorldBackend::raycastBatch(
+    std::span<const PhysicsRaycastRequest> rays,
+    std::span<PhysicsQueryHit> hits,
+    const PhysicsQueryFilter& filter
+) const {
+    const size_t count = std::min(rays.size(), hits.size());
+    for (size_t index = 0; index < count; ++index) {
+        const PhysicsRaycastRequest& ray = rays[index];
+        hits[index] = raycast(ray.origin, ray.direction, ray.maxDistance, filter).value_or(PhysicsQueryHit{});
+    }
+}
+
+void PhysicsWorldBackend::sweepBatch(
+    std::span<const PhysicsSweepRequest> sweeps,
+    std::span<PhysicsQueryHit> hits,
+    const PhysicsQueryFilter& filter
+) const {
+    const size_t count = std::min(sweeps.size(), hits.size());
+    for (size_t index = 0; index < count; ++index) {
+        const PhysicsSweepRequest& request = sweeps[index];
+        hits[index] = sweep(request.shape, request.origin, request.direction, request.maxDistance, filter)
+            .value_or(PhysicsQueryHit{});
+    }
+}
+
+size_t PhysicsWorldBackend::overlapBatch(
+    std::span<const PhysicsOverlapRequest> overlaps,
+    std::span<PhysicsBodyHandle> bodies,
+    std::span<PhysicsOverlapRange> ranges,
+    const PhysicsQueryFilter& filter
+) const {
+    const size_t count = std::min(overlaps.size(), ranges.size());
+    size_t written = 0;
+    for (size_t index = 0; index < count; ++index) {
+        const size_t found = overlap(overlaps[index].shape, overlaps[index].position, bodies.subspan(written), filter);
+        ranges[index] = {static_cast<uint32_t>(written), static_cast<uint32_t>(found)};
+        written += found;
     }
+    return written;
 }
 
 std::unique_ptr<PhysicsWorldBackend> createPhysicsWorldBackend(
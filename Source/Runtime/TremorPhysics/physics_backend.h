@@ -1,13 +1,18 @@
 #pragma once
 
+#include "Source/Runtime/TremorPhysics/physics_contact_stream.h"
 #include "Source/Runtime/TremorPhysics/physics_core.h"
 
 #include <glm/glm.hpp>
 
 #include <functional>
+#include <initializer_list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace tremor::physics {
 
@@ -20,6 +25,10 @@ struct PhysicsSettings {
     uint32_t maxPhysicsBarriers = 8;
     uint32_t collisionSteps = 1;
     uint32_t tempAllocatorBytes = 32 * 1024 * 1024;
+    // Fixed-step mode for advance(): steps per second, 0 steps once with the frame delta
+    float fixedStepRate = 0.0f;
+    // Most fixed steps advance() runs per frame; time beyond that is dropped
+    uint32_t maxSubsteps = 4;
     glm::vec3 gravity{0.0f, 9.81f, 0.0f};
     PhysicsLayerConfig layers = PhysicsLayerConfig::makeDefault();
 };
@@ -29,21 +38,135 @@ enum class PhysicsBackendKind {
     PhysX
 };
 
-enum class PhysicsContactPhase : uint8_t {
-    Added,
-    Persisted,
-    Removed
+enum class PhysicsQueryShapeType : uint8_t {
+    Sphere,
+    Capsule,
+    Box
 };
 
-struct PhysicsContactEvent {
-    PhysicsBodyHandle leftBody{};
-    PhysicsBodyHandle rightBody{};
-    PhysicsContactPhase phase = PhysicsContactPhase::Added;
+// Shape for sweeps and overlaps; capsules stand along Y like the bodies createDynamicCapsule makes
+struct PhysicsQueryShape {
+    PhysicsQueryShapeType type = PhysicsQueryShapeType::Sphere;
+    float radius = 0.5f;
+    float halfHeight = 0.0f;             // Capsule: half the length of the cylinder part
+    glm::vec3 halfExtents{0.5f};         // Box
+
+    static PhysicsQueryShape sphere(float radius) {
+        return {PhysicsQueryShapeType::Sphere, radius};
+    }
+    static PhysicsQueryShape capsule(float radius, float height) {
+        return {PhysicsQueryShapeType::Capsule, radius, height * 0.5f};
+    }
+    static PhysicsQueryShape box(const glm::vec3& halfExtents) {
+        return {PhysicsQueryShapeType::Box, 0.0f, 0.0f, halfExtents};
+    }
+};
+
+// Which bodies a query may hit. A query acting as a layer hits what that layer
+// collides with in PhysicsLayerConfig; the mask then narrows it to explicit layers.
+struct PhysicsQueryFilter {
+    std::optional<PhysicsObjectLayer> asLayer;
+    uint64_t layerMask = ~uint64_t{0};
+    PhysicsBodyHandle ignoreBody{};
+
+    static PhysicsQueryFilter collidingWith(PhysicsObjectLayer layer) {
+        PhysicsQueryFilter filter;
+        filter.asLayer = layer;
+        return filter;
+    }
+    static PhysicsQueryFilter onlyLayers(std::initializer_list<PhysicsObjectLayer> layers) {
+        PhysicsQueryFilter filter;
+        filter.layerMask = 0;
+        for (const PhysicsObjectLayer layer : layers) {
+            filter.layerMask |= layer < 64 ? uint64_t{1} << layer : 0;
+        }
+        return filter;
+    }
+
+    [[nodiscard]] bool acceptsLayer(const PhysicsLayerConfig& config, PhysicsObjectLayer layer) const;
+    [[nodiscard]] bool accepts(const PhysicsLayerConfig& config, PhysicsObjectLayer layer, PhysicsBodyHandle body) const {
+        return body != ignoreBody && acceptsLayer(config, layer);
+    }
+};
+
+// Closest hit of a ray or sweep; distance is along the normalized direction
+struct PhysicsQueryHit {
+    PhysicsBodyHandle body{};
+    glm::vec3 position{0.0f};
+    glm::vec3 normal{0.0f};
+    float distance = 0.0f;
+
+    [[nodiscard]] explicit operator bool() const { return !body.IsInvalid(); }
+};
+
+struct PhysicsRaycastRequest {
+    glm::vec3 origin{0.0f};
+    glm::vec3 direction{0.0f, -1.0f, 0.0f};
+    float maxDistance = 0.0f;
+};
+
+struct PhysicsSweepRequest {
+    PhysicsQueryShape shape;
+    glm::vec3 origin{0.0f};
+    glm::vec3 direction{0.0f, -1.0f, 0.0f};
+    float maxDistance = 0.0f;
+};
+
+struct PhysicsOverlapRequest {
+    PhysicsQueryShape shape;
+    glm::vec3 position{0.0f};
+};
+
+// Where one overlap of a batch wrote its bodies in the shared output buffer
+struct PhysicsOverlapRange {
+    uint32_t offset = 0;
+    uint32_t count = 0;
+};
+
+// Shape dimensions as a cache key: capsules are (radius, height, 0), boxes their half extents.
+// Only bodies built from identical dimensions share a shape or a pool.
+struct PhysicsShapeKey {
+    PhysicsQueryShapeType type = PhysicsQueryShapeType::Capsule;
+    glm::vec3 dimensions{0.0f};
+
+    static PhysicsShapeKey capsule(float radius, float height) {
+        return {PhysicsQueryShapeType::Capsule, glm::vec3(radius, height, 0.0f)};
+    }
+    static PhysicsShapeKey box(const glm::vec3& halfExtents) {
+        return {PhysicsQueryShapeType::Box, halfExtents};
+    }
+
+    bool operator==(const PhysicsShapeKey&) const = default;
+};
+
+// Pooled bodies are interchangeable when shape and layer match; capsules are
+// always dynamic and boxes kinematic, so the shape also fixes the motion type
+struct PhysicsBodyPoolKey {
+    PhysicsShapeKey shape;
+    PhysicsObjectLayer layer = DefaultPhysicsLayers::Dynamic;
+
+    bool operator==(const PhysicsBodyPoolKey&) const = default;
+};
+
+struct PhysicsShapeKeyHash {
+    size_t operator()(const PhysicsShapeKey& key) const;
+};
+
+struct PhysicsBodyPoolKeyHash {
+    size_t operator()(const PhysicsBodyPoolKey& key) const;
+};
+
+struct PhysicsBodyPoolStats {
+    size_t pooledBodies = 0;     // Parked and ready for reuse
+    size_t cachedShapes = 0;
+    uint64_t createdBodies = 0;  // Create calls that had to build a new body
+    uint64_t reusedBodies = 0;   // Create calls served from a pool
 };
 
 class PhysicsWorldBackend {
 public:
     using ContactCallback = std::function<void(const PhysicsContactEvent&)>;
+    using ContactBatchCallback = std::function<void(std::span<const PhysicsContactEvent>)>;
 
     explicit PhysicsWorldBackend(PhysicsSettings settings = {});
     virtual ~PhysicsWorldBackend() = default;
@@ -60,6 +183,38 @@ public:
     virtual void update(float deltaTime) = 0;
     void Update(float deltaTime) { update(deltaTime); }
 
+    // Advance by one frame. With a fixed step rate the frame time is accumulated
+    // and simulated in whole steps of 1 / fixedStepRate, at most maxSubsteps per
+    // call; otherwise this is a single update(frameDeltaTime). Returns the number
+    // of steps simulated.
+    uint32_t advance(float frameDeltaTime);
+    uint32_t Advance(float frameDeltaTime) { return advance(frameDeltaTime); }
+
+    // Hand the contacts merged since the last dispatch to the callbacks. advance()
+    // does this itself; callers stepping with update() directly call it afterwards.
+    void dispatchContactEvents();
+
+    void setFixedStep(float stepRate, uint32_t maxSubsteps);
+    [[nodiscard]] bool isFixedStep() const { return settings_.fixedStepRate > 0.0f; }
+    [[nodiscard]] float fixedStepDuration() const { return isFixedStep() ? 1.0f / settings_.fixedStepRate : 0.0f; }
+
+    // Fraction of a fixed step left in the accumulator after the last advance()
+    [[nodiscard]] float interpolationAlpha() const { return interpolationAlpha_; }
+
+    // Simulation time carried over to the next advance(); saved and restored with world snapshots
+    [[nodiscard]] float stepAccumulator() const { return stepAccumulator_; }
+    void setStepAccumulator(float seconds);
+
+    // Simulation time dropped by the maxSubsteps clamp since the last reset
+    [[nodiscard]] float droppedStepTime() const { return droppedStepTime_; }
+    void resetDroppedStepTime() { droppedStepTime_ = 0.0f; }
+
+    // Interpolated bodies remember their position before the last fixed step so
+    // rendering can blend between the last two simulated states by interpolationAlpha().
+    void setBodyInterpolated(PhysicsBodyHandle bodyId, bool interpolated);
+    glm::vec3 getInterpolatedBodyPosition(PhysicsBodyHandle bodyId) const;
+    glm::vec3 GetInterpolatedBodyPosition(PhysicsBodyHandle bodyId) const { return getInterpolatedBodyPosition(bodyId); }
+
     virtual PhysicsBodyHandle createDynamicCapsule(
         const glm::vec3& position,
         float radius,
@@ -134,16 +289,145 @@ public:
     virtual void removeBody(PhysicsBodyHandle bodyId) = 0;
     void RemoveBody(PhysicsBodyHandle bodyId) { removeBody(bodyId); }
 
+    // Body pooling. releaseBody() takes a dynamic capsule or kinematic box out of
+    // the simulation and parks it instead of destroying it; the next create call
+    // with the same dimensions and layer takes it back, reset to the new position
+    // with zero velocity. Parked bodies are invisible to simulation and queries and
+    // their handles must not be used until they are handed out again. Other bodies,
+    // and backends without pools, are removed as by removeBody().
+    virtual void releaseBody(PhysicsBodyHandle bodyId) { removeBody(bodyId); }
+    void ReleaseBody(PhysicsBodyHandle bodyId) { releaseBody(bodyId); }
+
+    // Pre-create parked bodies so the first spawns don't pay for body creation
+    virtual void reserveDynamicCapsules(float radius, float height, PhysicsObjectLayer layer, size_t count);
+    virtual void reserveKinematicBoxes(const glm::vec3& halfExtents, PhysicsObjectLayer layer, size_t count);
+
+    // Destroy every parked body; cached shapes stay alive with the world
+    virtual void clearBodyPools() {}
+    [[nodiscard]] virtual PhysicsBodyPoolStats bodyPoolStats() const { return {}; }
+
+    // Batched body access: one call per batch instead of one per body, and
+    // backends lock the whole batch once. Values are matched to bodyIds by
+    // index; only the common length of the spans is used. Invalid or removed
+    // bodies read as zero / awake and are skipped by writes.
+    virtual void readBodyPositions(std::span<const PhysicsBodyHandle> bodyIds, std::span<glm::vec3> positions) const;
+    virtual void readBodyVelocities(std::span<const PhysicsBodyHandle> bodyIds, std::span<glm::vec3> velocities) const;
+    virtual void readBodySleeping(std::span<const PhysicsBodyHandle> bodyIds, std::span<uint8_t> sleeping) const;
+    virtual void setBodyPositions(std::span<const PhysicsBodyHandle> bodyIds, std::span<const glm::vec3> positions);
+    virtual void setBodyVelocities(std::span<const PhysicsBodyHandle> bodyIds, std::span<const glm::vec3> velocities);
+    virtual void wakeBodies(std::span<const PhysicsBodyHandle> bodyIds);
+    virtual void sleepBodies(std::span<const PhysicsBodyHandle> bodyIds);
+
+    // Scene queries. They see the state after the last step and never wake
+    // bodies. Directions need not be normalized; a zero direction misses.
+    virtual std::optional<PhysicsQueryHit> raycast(
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        const PhysicsQueryFilter& filter = {}
+    ) const = 0;
+    std::optional<PhysicsQueryHit> Raycast(
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        const PhysicsQueryFilter& filter = {}
+    ) const {
+        return raycast(origin, direction, maxDistance, filter);
+    }
+
+    // First body the shape touches moving from origin; bodies it starts inside hit at distance 0
+    virtual std::optional<PhysicsQueryHit> sweep(
+        const PhysicsQueryShape& shape,
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        const PhysicsQueryFilter& filter = {}
+    ) const = 0;
+    std::optional<PhysicsQueryHit> Sweep(
+        const PhysicsQueryShape& shape,
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        const PhysicsQueryFilter& filter = {}
+    ) const {
+        return sweep(shape, origin, direction, maxDistance, filter);
+    }
+
+    // Writes each body the shape overlaps once, in no particular order, and
+    // returns how many were written; stops early when the buffer is full.
+    virtual size_t overlap(
+        const PhysicsQueryShape& shape,
+        const glm::vec3& position,
+        std::span<PhysicsBodyHandle> bodies,
+        const PhysicsQueryFilter& filter = {}
+    ) const = 0;
+    size_t Overlap(
+        const PhysicsQueryShape& shape,
+        const glm::vec3& position,
+        std::span<PhysicsBodyHandle> bodies,
+        const PhysicsQueryFilter& filter = {}
+    ) const {
+        return overlap(shape, position, bodies, filter);
+    }
+
+    // Batched queries share one filter. Rays and sweeps write one hit per
+    // request, with an invalid body on a miss. Overlaps append to one body
+    // buffer and record where each request's bodies went; returns the total.
+    virtual void raycastBatch(
+        std::span<const PhysicsRaycastRequest> rays,
+        std::span<PhysicsQueryHit> hits,
+        const PhysicsQueryFilter& filter = {}
+    ) const;
+    virtual void sweepBatch(
+        std::span<const PhysicsSweepRequest> sweeps,
+        std::span<PhysicsQueryHit> hits,
+        const PhysicsQueryFilter& filter = {}
+    ) const;
+    virtual size_t overlapBatch(
+        std::span<const PhysicsOverlapRequest> overlaps,
+        std::span<PhysicsBodyHandle> bodies,
+        std::span<PhysicsOverlapRange> ranges,
+        const PhysicsQueryFilter& filter = {}
+    ) const;
+
     virtual std::optional<PhysicsObjectLayer> findLayer(std::string_view nameOrNumber) const;
+
+    // Contacts reach gameplay once per advance(), merged and de-duplicated per step.
+    // The batch callback sees the whole span; the per-event callback is called for
+    // each event after it.
+    void setContactBatchCallback(ContactBatchCallback callback);
     void setContactCallback(ContactCallback callback);
     void clearContactCallback();
-    void emitContactEvent(const PhysicsContactEvent& event) const;
+    // Drop contacts between these layers before they are buffered
+    void setContactLayerPairEnabled(PhysicsObjectLayer left, PhysicsObjectLayer right, bool enabled);
+    [[nodiscard]] PhysicsContactStream::Stats contactStats() const { return contactStream_.stats(); }
+
+    // Safe from the backend's worker threads while a step is running
+    void emitContactEvent(const PhysicsContactEvent& event);
 
     [[nodiscard]] const PhysicsSettings& settings() const { return settings_; }
 
 protected:
+    // Backends call these when a body is teleported or destroyed
+    void snapInterpolatedBody(PhysicsBodyHandle bodyId, const glm::vec3& position);
+    void forgetInterpolatedBody(PhysicsBodyHandle bodyId);
+    void clearInterpolatedBodies();
+
     PhysicsSettings settings_;
     ContactCallback contactCallback_;
+    ContactBatchCallback contactBatchCallback_;
+    PhysicsContactStream contactStream_;
+
+private:
+    float stepAccumulator_ = 0.0f;
+    float interpolationAlpha_ = 1.0f;
+    float droppedStepTime_ = 0.0f;
+
+    // Interpolated bodies as parallel arrays so each step refreshes them with one batched read
+    std::vector<PhysicsBodyHandle> interpolatedBodies_;
+    std::vector<glm::vec3> previousPositions_;
+    std::vector<glm::vec3> currentPositions_;
+    std::unordered_map<uint64_t, size_t> interpolatedBodyIndex_;
 };
 
 std::unique_ptr<PhysicsWorldBackend> createPhysicsWorldBackend(
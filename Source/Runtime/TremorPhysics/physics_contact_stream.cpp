@@ -0,0 +1,129 @@
+#include "Source/Runtime/TremorPhysics/physics_contact_stream.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+namespace tremor::physics {
+
+namespace {
+
+// Never reused, so a thread's cached buffer for a destroyed stream can't match a new one
+std::atomic<uint64_t> nextStreamId{1};
+
+auto eventKey(const PhysicsContactEvent& event) {
+    return std::tuple(event.leftBody.raw(), event.rightBody.raw(), event.phase);
+}
+
+} // namespace
+
+PhysicsContactStream::PhysicsContactStream()
+    : streamId_(nextStreamId.fetch_add(1, std::memory_order_relaxed)) {
+}
+
+PhysicsContactStream::ThreadBuffer* PhysicsContactStream::threadBuffer() {
+    // Buffers claimed by this thread, by stream; a thread rarely feeds more than one stream
+    thread_local std::vector<std::pair<uint64_t, ThreadBuffer*>> claimed;
+    for (const auto& [streamId, buffer] : claimed) {
+        if (streamId == streamId_) {
+            return buffer;
+        }
+    }
+
+    const size_t index = claimedBuffers_.fetch_add(1, std::memory_order_relaxed);
+    ThreadBuffer* buffer = index < kMaxThreadBuffers ? &threadBuffers_[index] : nullptr;
+    claimed.emplace_back(streamId_, buffer);
+    return buffer;
+}
+
+void PhysicsContactStream::push(const PhysicsContactEvent& event) {
+    const bool enabled = isLayerPairEnabled(event.leftLayer, event.rightLayer);
+    if (ThreadBuffer* buffer = threadBuffer()) {
+        ++buffer->pushed;
+        if (enabled) {
+            buffer->events.push_back(event);
+        } else {
+            ++buffer->filtered;
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(overflowMutex_);
+    ++overflow_.pushed;
+    if (enabled) {
+        overflow_.events.push_back(event);
+    } else {
+        ++overflow_.filtered;
+    }
+}
+
+void PhysicsContactStream::mergeStep() {
+    // Workers have finished the step, so every buffer is ours to read
+    step_.clear();
+    const size_t claimedCount = std::min(claimedBuffers_.load(std::memory_order_acquire), kMaxThreadBuffers);
+    for (size_t index = 0; index < claimedCount; ++index) {
+        std::vector<PhysicsContactEvent>& events = threadBuffers_[index].events;
+        step_.insert(step_.end(), events.begin(), events.end());
+        events.clear();
+    }
+    step_.insert(step_.end(), overflow_.events.begin(), overflow_.events.end());
+    overflow_.events.clear();
+    if (step_.empty()) {
+        return;
+    }
+
+    // Order within a step depends on worker scheduling anyway; sorting makes it deterministic
+    for (PhysicsContactEvent& event : step_) {
+        if (event.rightBody.raw() < event.leftBody.raw()) {
+            std::swap(event.leftBody, event.rightBody);
+            std::swap(event.leftLayer, event.rightLayer);
+        }
+    }
+    std::sort(step_.begin(), step_.end(), [](const PhysicsContactEvent& left, const PhysicsContactEvent& right) {
+        return eventKey(left) < eventKey(right);
+    });
+    const auto uniqueEnd = std::unique(step_.begin(), step_.end(), [](const PhysicsContactEvent& left, const PhysicsContactEvent& right) {
+        return eventKey(left) == eventKey(right);
+    });
+    duplicates_ += static_cast<uint64_t>(step_.end() - uniqueEnd);
+    step_.erase(uniqueEnd, step_.end());
+
+    batch_.insert(batch_.end(), step_.begin(), step_.end());
+    delivered_ += step_.size();
+}
+
+void PhysicsContactStream::setLayerPairEnabled(PhysicsObjectLayer left, PhysicsObjectLayer right, bool enabled) {
+    if (left >= kMaxFilteredLayers || right >= kMaxFilteredLayers) {
+        return;
+    }
+    if (enabled) {
+        disabledPairs_[left] &= ~(uint64_t{1} << right);
+        disabledPairs_[right] &= ~(uint64_t{1} << left);
+    } else {
+        disabledPairs_[left] |= uint64_t{1} << right;
+        disabledPairs_[right] |= uint64_t{1} << left;
+    }
+}
+
+bool PhysicsContactStream::isLayerPairEnabled(PhysicsObjectLayer left, PhysicsObjectLayer right) const {
+    if (left >= kMaxFilteredLayers || right >= kMaxFilteredLayers) {
+        return true;
+    }
+    return (disabledPairs_[left] & (uint64_t{1} << right)) == 0;
+}
+
+PhysicsContactStream::Stats PhysicsContactStream::stats() const {
+    Stats stats;
+    const size_t claimedCount = std::min(claimedBuffers_.load(std::memory_order_acquire), kMaxThreadBuffers);
+    for (size_t index = 0; index < claimedCount; ++index) {
+        stats.pushed += threadBuffers_[index].pushed;
+        stats.filtered += threadBuffers_[index].filtered;
+    }
+    stats.pushed += overflow_.pushed;
+    stats.filtered += overflow_.filtered;
+    stats.duplicates = duplicates_;
+    stats.delivered = delivered_;
+    return stats;
+}
+
+} // namespace tremor::physics
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Source/Runtime/TremorPhysics/physics_core.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace tremor::physics {
+
+enum class PhysicsContactPhase : uint8_t {
+    Added,
+    Persisted,
+    Removed
+};
+
+struct PhysicsContactEvent {
+    static constexpr PhysicsObjectLayer UnknownLayer = std::numeric_limits<PhysicsObjectLayer>::max();
+
+    PhysicsBodyHandle leftBody{};
+    PhysicsBodyHandle rightBody{};
+    PhysicsContactPhase phase = PhysicsContactPhase::Added;
+    // Unknown when the backend can no longer see the body, e.g. removal after destruction
+    PhysicsObjectLayer leftLayer = UnknownLayer;
+    PhysicsObjectLayer rightLayer = UnknownLayer;
+};
+
+// Contact events from physics worker threads, collected without locks. Each
+// producing thread appends to a buffer of its own; once a step has finished the
+// owner merges the buffers, drops duplicate events and keeps the result until
+// the batch is taken. Layer pairs can be filtered out before anything is buffered.
+class PhysicsContactStream {
+public:
+    struct Stats {
+        uint64_t pushed = 0;
+        uint64_t filtered = 0;    // Dropped by the layer pair filter
+        uint64_t duplicates = 0;  // Same pair and phase more than once in a step
+        uint64_t delivered = 0;
+    };
+
+    PhysicsContactStream();
+
+    PhysicsContactStream(const PhysicsContactStream&) = delete;
+    PhysicsContactStream& operator=(const PhysicsContactStream&) = delete;
+
+    // Any thread, during a step
+    void push(const PhysicsContactEvent& event);
+
+    // Owner thread, between steps: move this step's events into the pending batch.
+    // Duplicates within the step are dropped and each pair is ordered by handle.
+    void mergeStep();
+
+    // Owner thread: the batch merged since the last clearBatch(), in step order
+    [[nodiscard]] std::span<const PhysicsContactEvent> batch() const { return batch_; }
+    void clearBatch() { batch_.clear(); }
+
+    // Owner thread, between steps. Events on a disabled pair are never buffered;
+    // an event whose layer is unknown always passes.
+    void setLayerPairEnabled(PhysicsObjectLayer left, PhysicsObjectLayer right, bool enabled);
+    [[nodiscard]] bool isLayerPairEnabled(PhysicsObjectLayer left, PhysicsObjectLayer right) const;
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    static constexpr size_t kMaxThreadBuffers = 64;
+    static constexpr PhysicsObjectLayer kMaxFilteredLayers = 64;
+
+    // One producing thread each; padded so neighbours don't share a cache line
+    struct alignas(64) ThreadBuffer {
+        std::vector<PhysicsContactEvent> events;
+        uint64_t pushed = 0;
+        uint64_t filtered = 0;
+    };
+
+    ThreadBuffer* threadBuffer();
+
+    uint64_t streamId_;
+    std::array<ThreadBuffer, kMaxThreadBuffers> threadBuffers_;
+    std::atomic<size_t> claimedBuffers_{0};
+    // Threads beyond kMaxThreadBuffers share this one
+    std::mutex overflowMutex_;
+    ThreadBuffer overflow_;
+
+    // Bit r of disabledPairs_[l] set: events between layers l and r are dropped
+    std::array<uint64_t, kMaxFilteredLayers> disabledPairs_{};
+
+    std::vector<PhysicsContactEvent> step_;
+    std::vector<PhysicsContactEvent> batch_;
+    uint64_t duplicates_ = 0;
+    uint64_t delivered_ = 0;
+};
+
+} // namespace tremor::physics
@@ -177,15 +177,77 @@ physx::PxFilterFlags TremorPhysicsFilterShader(
     return physx::PxFilterFlag::eDEFAULT;
 }
 
-void applyFilterData(physx::PxRigidActor& actor, PhysicsObjectLayer layer) {
-    const physx::PxFilterData filterData(static_cast<physx::PxU32>(layer), 0, 0, 0);
-    physx::PxShape* shapes[8] = {};
-    const physx::PxU32 shapeCount = actor.getShapes(shapes, std::size(shapes));
-    for (physx::PxU32 index = 0; index < shapeCount; ++index) {
-        if (shapes[index] != nullptr) {
-            shapes[index]->setSimulationFilterData(filterData);
-            shapes[index]->setQueryFilterData(filterData);
+// Keeps shapes on the layers a PhysicsQueryFilter accepts; word0 of the query filter data is the layer
+class QueryFilterCallback final : public physx::PxQueryFilterCallback {
+public:
+    QueryFilterCallback(
+        const PhysicsLayerConfig& config,
+        const PhysicsQueryFilter& filter,
+        const physx::PxRigidActor* ignoredActor,
+        physx::PxQueryHitType::Enum acceptedHit
+    ) : config_(config), filter_(filter), ignoredActor_(ignoredActor), acceptedHit_(acceptedHit) {
+    }
+
+    physx::PxQueryHitType::Enum preFilter(
+        const physx::PxFilterData&,
+        const physx::PxShape* shape,
+        const physx::PxRigidActor* actor,
+        physx::PxHitFlags&
+    ) override {
+        if (shape == nullptr || actor == ignoredActor_) {
+            return physx::PxQueryHitType::eNONE;
         }
+        const PhysicsObjectLayer layer = shape->getQueryFilterData().word0;
+        return filter_.acceptsLayer(config_, layer) ? acceptedHit_ : physx::PxQueryHitType::eNONE;
+    }
+
+    physx::PxQueryHitType::Enum postFilter(
+        const physx::PxFilterData&,
+        const physx::PxQueryHit&,
+        const physx::PxShape*,
+        const physx::PxRigidActor*
+    ) override {
+        return acceptedHit_;
+    }
+
+private:
+    const PhysicsLayerConfig& config_;
+    const PhysicsQueryFilter& filter_;
+    const physx::PxRigidActor* ignoredActor_;
+    physx::PxQueryHitType::Enum acceptedHit_;
+};
+
+physx::PxQueryFilterData makeQueryFilterData(bool touchesOnly) {
+    physx::PxQueryFlags flags = physx::PxQueryFlag::eSTATIC | physx::PxQueryFlag::eDYNAMIC | physx::PxQueryFlag::ePREFILTER;
+    if (touchesOnly) {
+        flags |= physx::PxQueryFlag::eNO_BLOCK;
+    }
+    return physx::PxQueryFilterData(flags);
+}
+
+// Capsules get the same Y-up pose as capsule bodies
+template <typename Fn>
+bool withQueryGeometry(const PhysicsQueryShape& shape, const glm::vec3& position, Fn&& fn) {
+    switch (shape.type) {
+        case PhysicsQueryShapeType::Box:
+            if (!(std::min({shape.halfExtents.x, shape.halfExtents.y, shape.halfExtents.z}) > 0.0f)) {
+                return false;
+            }
+            fn(physx::PxBoxGeometry(toPxVec3(shape.halfExtents)), makeWorldTransform(position));
+            return true;
+        case PhysicsQueryShapeType::Capsule:
+            if (shape.halfHeight > 0.0f && shape.radius > 0.0f) {
+                fn(physx::PxCapsuleGeometry(shape.radius, shape.halfHeight), makeCapsuleTransform(position));
+                return true;
+            }
+            [[fallthrough]];
+        case PhysicsQueryShapeType::Sphere:
+        default:
+            if (!(shape.radius > 0.0f)) {
+                return false;
+            }
+            fn(physx::PxSphereGeometry(shape.radius), makeWorldTransform(position));
+            return true;
     }
 }
 
@@ -216,14 +278,26 @@ struct PhysXPhysicsWorld::Impl {
 
             for (physx::PxU32 index = 0; index < nbPairs; ++index) {
                 const physx::PxContactPair& pair = pairs[index];
+                // word0 of the simulation filter data is the layer; removed shapes can't be read
+                const auto layerOf = [&pair](physx::PxU32 shapeIndex, physx::PxContactPairFlag::Enum removedFlag) {
+                    return pair.flags.isSet(removedFlag) || pair.shapes[shapeIndex] == nullptr
+                        ? PhysicsContactEvent::UnknownLayer
+                        : static_cast<PhysicsObjectLayer>(pair.shapes[shapeIndex]->getSimulationFilterData().word0);
+                };
+                PhysicsContactEvent event{leftFound->second, rightFound->second};
+                event.leftLayer = layerOf(0, physx::PxContactPairFlag::eREMOVED_SHAPE_0);
+                event.rightLayer = layerOf(1, physx::PxContactPairFlag::eREMOVED_SHAPE_1);
                 if (pair.events.isSet(physx::PxPairFlag::eNOTIFY_TOUCH_FOUND)) {
-                    owner.world.emitContactEvent({leftFound->second, rightFound->second, PhysicsContactPhase::Added});
+                    event.phase = PhysicsContactPhase::Added;
+                    owner.world.emitContactEvent(event);
                 }
                 if (pair.events.isSet(physx::PxPairFlag::eNOTIFY_TOUCH_PERSISTS)) {
-                    owner.world.emitContactEvent({leftFound->second, rightFound->second, PhysicsContactPhase::Persisted});
+                    event.phase = PhysicsContactPhase::Persisted;
+                    owner.world.emitContactEvent(event);
                 }
                 if (pair.events.isSet(physx::PxPairFlag::eNOTIFY_TOUCH_LOST)) {
-                    owner.world.emitContactEvent({leftFound->second, rightFound->second, PhysicsContactPhase::Removed});
+                    event.phase = PhysicsContactPhase::Removed;
+                    owner.world.emitContactEvent(event);
                 }
             }
         }
@@ -246,6 +320,14 @@ struct PhysXPhysicsWorld::Impl {
     std::unordered_map<uint64_t, physx::PxRigidActor*> actors;
     std::unordered_map<const physx::PxActor*, PhysicsBodyHandle> actorHandles;
     std::unordered_map<uint64_t, float> defaultSleepThresholds;
+    // Shared shapes; filter data lives on the shape, so the layer is part of the key
+    std::unordered_map<PhysicsBodyPoolKey, physx::PxShape*, PhysicsBodyPoolKeyHash> shapeCache;
+    std::unordered_map<PhysicsBodyPoolKey, std::vector<uint64_t>, PhysicsBodyPoolKeyHash> bodyPools;
+    // Kind of every live capsule and kinematic box actor, parked or not, by handle
+    std::unordered_map<uint64_t, PhysicsBodyPoolKey> poolableBodies;
+    size_t pooledBodyCount = 0;
+    uint64_t createdBodies = 0;
+    uint64_t reusedBodies = 0;
     std::vector<physx::PxU32> filterShaderData;
     SimulationEvents simulationEvents;
     PhysXPhysicsWorld& world;
@@ -274,6 +356,105 @@ struct PhysXPhysicsWorld::Impl {
         const auto found = actors.find(handle.raw());
         return found != actors.end() ? found->second : nullptr;
     }
+
+    physx::PxShape* cachedShape(const PhysicsBodyPoolKey& key) {
+        const auto [found, inserted] = shapeCache.try_emplace(key, nullptr);
+        if (!inserted) {
+            return found->second;
+        }
+
+        const glm::vec3& dimensions = key.shape.dimensions;
+        physx::PxShape* shape = key.shape.type == PhysicsQueryShapeType::Capsule
+            ? physics->createShape(physx::PxCapsuleGeometry(dimensions.x, dimensions.y * 0.5f), *defaultMaterial, false)
+            : physics->createShape(physx::PxBoxGeometry(toPxVec3(dimensions)), *defaultMaterial, false);
+        if (shape == nullptr) {
+            shapeCache.erase(found);
+            return nullptr;
+        }
+
+        const physx::PxFilterData filterData(static_cast<physx::PxU32>(key.layer), 0, 0, 0);
+        shape->setSimulationFilterData(filterData);
+        shape->setQueryFilterData(filterData);
+        found->second = shape;
+        return shape;
+    }
+
+    // Creates and registers an actor of a poolable kind without adding it to the scene
+    PhysicsBodyHandle createPoolableActor(const PhysicsBodyPoolKey& key, const glm::vec3& position) {
+        const bool capsule = key.shape.type == PhysicsQueryShapeType::Capsule;
+        physx::PxShape* shape = cachedShape(key);
+        physx::PxRigidDynamic* actor = shape != nullptr
+            ? physx::PxCreateDynamic(*physics, capsule ? makeCapsuleTransform(position) : makeWorldTransform(position), *shape, 1.0f)
+            : nullptr;
+        if (actor == nullptr) {
+            Logger::get().error(capsule ? "PhysX failed to create dynamic capsule body" : "PhysX failed to create kinematic box body");
+            return {};
+        }
+
+        if (!capsule) {
+            actor->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, true);
+        }
+        const PhysicsBodyHandle handle = registerActor(actor);
+        poolableBodies.emplace(handle.raw(), key);
+        return handle;
+    }
+
+    // Takes a parked actor of this kind if there is one, otherwise creates one, and adds it
+    PhysicsBodyHandle acquireBody(const PhysicsBodyPoolKey& key, const glm::vec3& position) {
+        const bool capsule = key.shape.type == PhysicsQueryShapeType::Capsule;
+        PhysicsBodyHandle handle;
+        const auto pool = bodyPools.find(key);
+        if (pool != bodyPools.end() && !pool->second.empty()) {
+            handle = PhysicsBodyHandle(pool->second.back());
+            pool->second.pop_back();
+            --pooledBodyCount;
+            ++reusedBodies;
+        } else {
+            handle = createPoolableActor(key, position);
+            if (handle.IsInvalid()) {
+                return {};
+            }
+            ++createdBodies;
+        }
+
+        // Reset what the previous user may have left behind
+        physx::PxRigidDynamic* actor = findActor(handle)->is<physx::PxRigidDynamic>();
+        actor->setGlobalPose(capsule ? makeCapsuleTransform(position) : makeWorldTransform(position));
+        if (capsule) {
+            actor->setLinearVelocity(physx::PxVec3(0.0f));
+            actor->setAngularVelocity(physx::PxVec3(0.0f));
+        }
+        if (const auto threshold = defaultSleepThresholds.find(handle.raw()); threshold != defaultSleepThresholds.end()) {
+            actor->setSleepThreshold(threshold->second);
+        }
+        scene->addActor(*actor);
+        return handle;
+    }
+
+    void forgetActor(uint64_t handle, physx::PxRigidActor* actor) {
+        actorHandles.erase(actor);
+        defaultSleepThresholds.erase(handle);
+        poolableBodies.erase(handle);
+        actors.erase(handle);
+    }
+
+    PhysicsBodyHandle findHandle(const physx::PxActor* actor) const {
+        const auto found = actorHandles.find(actor);
+        return found != actorHandles.end() ? found->second : PhysicsBodyHandle{};
+    }
+
+    std::optional<PhysicsQueryHit> makeHit(const physx::PxLocationHit& locationHit) const {
+        const PhysicsBodyHandle body = findHandle(locationHit.actor);
+        if (body.IsInvalid()) {
+            return std::nullopt;
+        }
+        PhysicsQueryHit hit;
+        hit.body = body;
+        hit.position = fromPxVec3(locationHit.position);
+        hit.normal = fromPxVec3(locationHit.normal);
+        hit.distance = locationHit.distance;
+        return hit;
+    }
 };
 
 #else
@@ -372,6 +553,7 @@ bool PhysXPhysicsWorld::initialize() {
 }
 
 void PhysXPhysicsWorld::shutdown() {
+    clearInterpolatedBodies();
 #if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
     if (!impl_) {
         return;
@@ -380,14 +562,25 @@ void PhysXPhysicsWorld::shutdown() {
     if (impl_->scene != nullptr) {
         for (auto& [_, actor] : impl_->actors) {
             if (actor != nullptr) {
-                impl_->scene->removeActor(*actor, false);
+                // Parked pool actors are not in the scene
+                if (actor->getScene() != nullptr) {
+                    impl_->scene->removeActor(*actor, false);
+                }
                 actor->release();
             }
         }
         impl_->actors.clear();
         impl_->actorHandles.clear();
+        impl_->bodyPools.clear();
+        impl_->poolableBodies.clear();
+        impl_->pooledBodyCount = 0;
     }
 
+    for (auto& [_, shape] : impl_->shapeCache) {
+        shape->release();
+    }
+    impl_->shapeCache.clear();
+
     if (impl_->defaultMaterial != nullptr) {
         impl_->defaultMaterial->release();
         impl_->defaultMaterial = nullptr;
@@ -458,21 +651,7 @@ PhysicsBodyHandle PhysXPhysicsWorld::createDynamicCapsule(
         return {};
     }
 
-    physx::PxRigidDynamic* actor = physx::PxCreateDynamic(
-        *impl_->physics,
-        makeCapsuleTransform(position),
-        physx::PxCapsuleGeometry(radius, height * 0.5f),
-        *impl_->defaultMaterial,
-        1.0f
-    );
-    if (actor == nullptr) {
-        Logger::get().error("PhysX failed to create dynamic capsule body");
-        return {};
-    }
-
-    applyFilterData(*actor, layer);
-    impl_->scene->addActor(*actor);
-    return impl_->registerActor(actor);
+    return impl_->acquireBody({PhysicsShapeKey::capsule(radius, height), layer}, position);
 #else
     (void)position;
     (void)radius;
@@ -493,22 +672,7 @@ PhysicsBodyHandle PhysXPhysicsWorld::createKinematicBox(
         return {};
     }
 
-    physx::PxRigidDynamic* actor = physx::PxCreateDynamic(
-        *impl_->physics,
-        makeWorldTransform(position),
-        physx::PxBoxGeometry(halfExtents.x, halfExtents.y, halfExtents.z),
-        *impl_->defaultMaterial,
-        1.0f
-    );
-    if (actor == nullptr) {
-        Logger::get().error("PhysX failed to create kinematic box body");
-        return {};
-    }
-
-    actor->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, true);
-    applyFilterData(*actor, layer);
-    impl_->scene->addActor(*actor);
-    return impl_->registerActor(actor);
+    return impl_->acquireBody({PhysicsShapeKey::box(halfExtents), layer}, position);
 #else
     (void)position;
     (void)halfExtents;
@@ -528,18 +692,15 @@ PhysicsBodyHandle PhysXPhysicsWorld::createStaticBox(
         return {};
     }
 
-    physx::PxRigidStatic* actor = physx::PxCreateStatic(
-        *impl_->physics,
-        makeWorldTransform(position),
-        physx::PxBoxGeometry(halfExtents.x, halfExtents.y, halfExtents.z),
-        *impl_->defaultMaterial
-    );
+    physx::PxShape* shape = impl_->cachedShape({PhysicsShapeKey::box(halfExtents), layer});
+    physx::PxRigidStatic* actor = shape != nullptr
+        ? physx::PxCreateStatic(*impl_->physics, makeWorldTransform(position), *shape)
+        : nullptr;
     if (actor == nullptr) {
         Logger::get().error("PhysX failed to create static box body");
         return {};
     }
 
-    applyFilterData(*actor, layer);
     impl_->scene->addActor(*actor);
     return impl_->registerActor(actor);
 #else
@@ -585,10 +746,12 @@ void PhysXPhysicsWorld::setBodyPosition(PhysicsBodyHandle bodyId, const glm::vec
         }
         dynamicActor->setGlobalPose(transform, true);
         dynamicActor->wakeUp();
+        snapInterpolatedBody(bodyId, position);
         return;
     }
 
     actor->setGlobalPose(transform, true);
+    snapInterpolatedBody(bodyId, position);
 #else
     (void)bodyId;
     (void)position;
@@ -755,16 +918,345 @@ void PhysXPhysicsWorld::removeBody(PhysicsBodyHandle bodyId) {
         return;
     }
 
-    if (impl_->scene != nullptr && found->second != nullptr) {
-        impl_->actorHandles.erase(found->second);
-        impl_->scene->removeActor(*found->second, false);
-        found->second->release();
+    physx::PxRigidActor* actor = found->second;
+    if (actor != nullptr && actor->getScene() != nullptr) {
+        impl_->scene->removeActor(*actor, false);
+    } else if (const auto poolable = impl_->poolableBodies.find(bodyId.raw()); poolable != impl_->poolableBodies.end()) {
+        // Parked; take it out of its pool before releasing it
+        std::vector<uint64_t>& pool = impl_->bodyPools[poolable->second];
+        const auto parked = std::find(pool.begin(), pool.end(), bodyId.raw());
+        if (parked != pool.end()) {
+            pool.erase(parked);
+            --impl_->pooledBodyCount;
+        }
+    }
+    impl_->forgetActor(bodyId.raw(), actor);
+    if (actor != nullptr) {
+        actor->release();
     }
-    impl_->defaultSleepThresholds.erase(found->first);
-    impl_->actors.erase(found);
+    forgetInterpolatedBody(bodyId);
 #else
     (void)bodyId;
 #endif
 }
 
+void PhysXPhysicsWorld::releaseBody(PhysicsBodyHandle bodyId) {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (!impl_) {
+        return;
+    }
+
+    const auto poolable = impl_->poolableBodies.find(bodyId.raw());
+    physx::PxRigidActor* actor = impl_->findActor(bodyId);
+    if (poolable == impl_->poolableBodies.end() || actor == nullptr) {
+        removeBody(bodyId);
+        return;
+    }
+    if (actor->getScene() == nullptr) {
+        return;
+    }
+
+    impl_->scene->removeActor(*actor, false);
+    forgetInterpolatedBody(bodyId);
+    impl_->bodyPools[poolable->second].push_back(bodyId.raw());
+    ++impl_->pooledBodyCount;
+#else
+    removeBody(bodyId);
+#endif
+}
+
+void PhysXPhysicsWorld::reserveDynamicCapsules(float radius, float height, PhysicsObjectLayer layer, size_t count) {
+    reserveBodies({PhysicsShapeKey::capsule(radius, height), layer}, count);
+}
+
+void PhysXPhysicsWorld::reserveKinematicBoxes(const glm::vec3& halfExtents, PhysicsObjectLayer layer, size_t count) {
+    reserveBodies({PhysicsShapeKey::box(halfExtents), layer}, count);
+}
+
+void PhysXPhysicsWorld::reserveBodies(const PhysicsBodyPoolKey& key, size_t count) {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (!impl_ || impl_->physics == nullptr || impl_->defaultMaterial == nullptr) {
+        return;
+    }
+
+    std::vector<uint64_t>& pool = impl_->bodyPools[key];
+    while (pool.size() < count) {
+        const PhysicsBodyHandle handle = impl_->createPoolableActor(key, glm::vec3(0.0f));
+        if (handle.IsInvalid()) {
+            return;
+        }
+        pool.push_back(handle.raw());
+        ++impl_->pooledBodyCount;
+    }
+#else
+    (void)key;
+    (void)count;
+#endif
+}
+
+void PhysXPhysicsWorld::clearBodyPools() {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (!impl_) {
+        return;
+    }
+
+    for (auto& [_, pool] : impl_->bodyPools) {
+        for (uint64_t handle : pool) {
+            physx::PxRigidActor* actor = impl_->findActor(PhysicsBodyHandle(handle));
+            impl_->forgetActor(handle, actor);
+            if (actor != nullptr) {
+                actor->release();
+            }
+        }
+    }
+    impl_->bodyPools.clear();
+    impl_->pooledBodyCount = 0;
+#endif
+}
+
+PhysicsBodyPoolStats PhysXPhysicsWorld::bodyPoolStats() const {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (impl_) {
+        return {impl_->pooledBodyCount, impl_->shapeCache.size(), impl_->createdBodies, impl_->reusedBodies};
+    }
+#endif
+    return {};
+}
+
+void PhysXPhysicsWorld::readBodyPositions(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<glm::vec3> positions
+) const {
+    const size_t count = std::min(bodyIds.size(), positions.size());
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (impl_) {
+        for (size_t index = 0; index < count; ++index) {
+            physx::PxRigidActor* actor = impl_->findActor(bodyIds[index]);
+            positions[index] = actor != nullptr ? fromPxVec3(actor->getGlobalPose().p) : glm::vec3(0.0f);
+        }
+        return;
+    }
+#endif
+    std::fill_n(positions.begin(), count, glm::vec3(0.0f));
+}
+
+void PhysXPhysicsWorld::readBodyVelocities(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<glm::vec3> velocities
+) const {
+    const size_t count = std::min(bodyIds.size(), velocities.size());
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (impl_) {
+        for (size_t index = 0; index < count; ++index) {
+            physx::PxRigidActor* actor = impl_->findActor(bodyIds[index]);
+            physx::PxRigidBody* body = actor != nullptr ? actor->is<physx::PxRigidBody>() : nullptr;
+            velocities[index] = body != nullptr ? fromPxVec3(body->getLinearVelocity()) : glm::vec3(0.0f);
+        }
+        return;
+    }
+#endif
+    std::fill_n(velocities.begin(), count, glm::vec3(0.0f));
+}
+
+void PhysXPhysicsWorld::readBodySleeping(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<uint8_t> sleeping
+) const {
+    const size_t count = std::min(bodyIds.size(), sleeping.size());
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (impl_) {
+        for (size_t index = 0; index < count; ++index) {
+            physx::PxRigidActor* actor = impl_->findActor(bodyIds[index]);
+            physx::PxRigidDynamic* dynamicActor = actor != nullptr ? actor->is<physx::PxRigidDynamic>() : nullptr;
+            sleeping[index] = dynamicActor != nullptr && dynamicActor->isSleeping() ? 1 : 0;
+        }
+        return;
+    }
+#endif
+    std::fill_n(sleeping.begin(), count, uint8_t{0});
+}
+
+void PhysXPhysicsWorld::setBodyPositions(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<const glm::vec3> positions
+) {
+    // Kinematic targets and pose writes differ per actor type; the final class makes these direct calls
+    const size_t count = std::min(bodyIds.size(), positions.size());
+    for (size_t index = 0; index < count; ++index) {
+        PhysXPhysicsWorld::setBodyPosition(bodyIds[index], positions[index]);
+    }
+}
+
+void PhysXPhysicsWorld::setBodyVelocities(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<const glm::vec3> velocities
+) {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (!impl_) {
+        return;
+    }
+
+    const size_t count = std::min(bodyIds.size(), velocities.size());
+    for (size_t index = 0; index < count; ++index) {
+        if (physx::PxRigidActor* actor = impl_->findActor(bodyIds[index])) {
+            if (physx::PxRigidDynamic* dynamicActor = actor->is<physx::PxRigidDynamic>()) {
+                dynamicActor->setLinearVelocity(toPxVec3(velocities[index]), true);
+            }
+        }
+    }
+#else
+    (void)bodyIds;
+    (void)velocities;
+    logUnavailable("setBodyVelocities");
+#endif
+}
+
+void PhysXPhysicsWorld::wakeBodies(std::span<const PhysicsBodyHandle> bodyIds) {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (!impl_) {
+        return;
+    }
+
+    for (const PhysicsBodyHandle bodyId : bodyIds) {
+        if (physx::PxRigidActor* actor = impl_->findActor(bodyId)) {
+            if (physx::PxRigidDynamic* dynamicActor = actor->is<physx::PxRigidDynamic>()) {
+                dynamicActor->wakeUp();
+            }
+        }
+    }
+#else
+    (void)bodyIds;
+    logUnavailable("wakeBodies");
+#endif
+}
+
+void PhysXPhysicsWorld::sleepBodies(std::span<const PhysicsBodyHandle> bodyIds) {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (!impl_) {
+        return;
+    }
+
+    for (const PhysicsBodyHandle bodyId : bodyIds) {
+        if (physx::PxRigidActor* actor = impl_->findActor(bodyId)) {
+            if (physx::PxRigidDynamic* dynamicActor = actor->is<physx::PxRigidDynamic>()) {
+                dynamicActor->putToSleep();
+            }
+        }
+    }
+#else
+    (void)bodyIds;
+    logUnavailable("sleepBodies");
+#endif
+}
+
+std::optional<PhysicsQueryHit> PhysXPhysicsWorld::raycast(
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    float maxDistance,
+    const PhysicsQueryFilter& filter
+) const {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    const float length = glm::length(direction);
+    if (!impl_ || impl_->scene == nullptr || !(length > 0.0f) || !(maxDistance > 0.0f)) {
+        return std::nullopt;
+    }
+
+    QueryFilterCallback callback(settings_.layers, filter, impl_->findActor(filter.ignoreBody), physx::PxQueryHitType::eBLOCK);
+    physx::PxRaycastBuffer buffer;
+    const bool hit = impl_->scene->raycast(
+        toPxVec3(origin),
+        toPxVec3(direction / length),
+        maxDistance,
+        buffer,
+        physx::PxHitFlag::ePOSITION | physx::PxHitFlag::eNORMAL,
+        makeQueryFilterData(false),
+        &callback
+    );
+    return hit && buffer.hasBlock ? impl_->makeHit(buffer.block) : std::nullopt;
+#else
+    (void)origin;
+    (void)direction;
+    (void)maxDistance;
+    (void)filter;
+    return std::nullopt;
+#endif
+}
+
+std::optional<PhysicsQueryHit> PhysXPhysicsWorld::sweep(
+    const PhysicsQueryShape& shape,
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    float maxDistance,
+    const PhysicsQueryFilter& filter
+) const {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    const float length = glm::length(direction);
+    if (!impl_ || impl_->scene == nullptr || !(length > 0.0f) || !(maxDistance > 0.0f)) {
+        return std::nullopt;
+    }
+
+    QueryFilterCallback callback(settings_.layers, filter, impl_->findActor(filter.ignoreBody), physx::PxQueryHitType::eBLOCK);
+    physx::PxSweepBuffer buffer;
+    bool hit = false;
+    withQueryGeometry(shape, origin, [&](const physx::PxGeometry& geometry, const physx::PxTransform& pose) {
+        hit = impl_->scene->sweep(
+            geometry,
+            pose,
+            toPxVec3(direction / length),
+            maxDistance,
+            buffer,
+            physx::PxHitFlag::ePOSITION | physx::PxHitFlag::eNORMAL,
+            makeQueryFilterData(false),
+            &callback
+        );
+    });
+    return hit && buffer.hasBlock ? impl_->makeHit(buffer.block) : std::nullopt;
+#else
+    (void)shape;
+    (void)origin;
+    (void)direction;
+    (void)maxDistance;
+    (void)filter;
+    return std::nullopt;
+#endif
+}
+
+size_t PhysXPhysicsWorld::overlap(
+    const PhysicsQueryShape& shape,
+    const glm::vec3& position,
+    std::span<PhysicsBodyHandle> bodies,
+    const PhysicsQueryFilter& filter
+) const {
+#if defined(TREMOR_HAS_PHYSX_SDK) && __has_include(<PxConfig.h>) && __has_include(<PxPhysicsAPI.h>)
+    if (!impl_ || impl_->scene == nullptr || bodies.empty()) {
+        return 0;
+    }
+
+    // Every actor has one shape, so one touch per body is enough
+    thread_local std::vector<physx::PxOverlapHit> touches;
+    touches.resize(bodies.size());
+    physx::PxOverlapBuffer buffer(touches.data(), static_cast<physx::PxU32>(touches.size()));
+    QueryFilterCallback callback(settings_.layers, filter, impl_->findActor(filter.ignoreBody), physx::PxQueryHitType::eTOUCH);
+    withQueryGeometry(shape, position, [&](const physx::PxGeometry& geometry, const physx::PxTransform& pose) {
+        impl_->scene->overlap(geometry, pose, buffer, makeQueryFilterData(true), &callback);
+    });
+
+    size_t count = 0;
+    for (physx::PxU32 index = 0; index < buffer.getNbTouches(); ++index) {
+        const PhysicsBodyHandle body = impl_->findHandle(buffer.getTouch(index).actor);
+        const auto written = bodies.first(count);
+        if (!body.IsInvalid() && std::find(written.begin(), written.end(), body) == written.end()) {
+            bodies[count++] = body;
+        }
+    }
+    return count;
+#else
+    (void)shape;
+    (void)position;
+    (void)bodies;
+    (void)filter;
+    return 0;
+#endif
+}
+
 } // namespace tremor::physics
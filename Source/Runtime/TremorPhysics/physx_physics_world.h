@@ -46,7 +46,43 @@ public:
     void setBodySleepingAllowed(PhysicsBodyHandle bodyId, bool allowed) override;
     void removeBody(PhysicsBodyHandle bodyId) override;
 
+    void releaseBody(PhysicsBodyHandle bodyId) override;
+    void reserveDynamicCapsules(float radius, float height, PhysicsObjectLayer layer, size_t count) override;
+    void reserveKinematicBoxes(const glm::vec3& halfExtents, PhysicsObjectLayer layer, size_t count) override;
+    void clearBodyPools() override;
+    PhysicsBodyPoolStats bodyPoolStats() const override;
+
+    void readBodyPositions(std::span<const PhysicsBodyHandle> bodyIds, std::span<glm::vec3> positions) const override;
+    void readBodyVelocities(std::span<const PhysicsBodyHandle> bodyIds, std::span<glm::vec3> velocities) const override;
+    void readBodySleeping(std::span<const PhysicsBodyHandle> bodyIds, std::span<uint8_t> sleeping) const override;
+    void setBodyPositions(std::span<const PhysicsBodyHandle> bodyIds, std::span<const glm::vec3> positions) override;
+    void setBodyVelocities(std::span<const PhysicsBodyHandle> bodyIds, std::span<const glm::vec3> velocities) override;
+    void wakeBodies(std::span<const PhysicsBodyHandle> bodyIds) override;
+    void sleepBodies(std::span<const PhysicsBodyHandle> bodyIds) override;
+
+    std::optional<PhysicsQueryHit> raycast(
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+    std::optional<PhysicsQueryHit> sweep(
+        const PhysicsQueryShape& shape,
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+    size_t overlap(
+        const PhysicsQueryShape& shape,
+        const glm::vec3& position,
+        std::span<PhysicsBodyHandle> bodies,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+
 private:
+    void reserveBodies(const PhysicsBodyPoolKey& key, size_t count);
+
     struct Impl;
     std::unique_ptr<Impl> impl_;
 };
@@ -154,16 +154,26 @@ namespace tremor::gfx {
             snapshot.maxFrameMs
         ));
 
+        // Counters share the last line
+        const size_t timingLines = snapshot.counters.empty() ? kProfilerVisibleLines : kProfilerVisibleLines - 1;
         for (const auto& record : snapshot.topRecords) {
+            if (lines.size() >= timingLines) {
+                break;
+            }
             lines.push_back(std::format(
                 "{:<18} {:>5.2f} ms  avg {:>5.2f}",
                 record.name.substr(0, 18),
                 record.lastMs,
                 record.avgMs
             ));
-            if (lines.size() >= kProfilerVisibleLines) {
-                break;
+        }
+
+        if (!snapshot.counters.empty()) {
+            std::string counters;
+            for (const auto& counter : snapshot.counters) {
+                counters += std::format("{}{} {:.0f}", counters.empty() ? "" : "  ", counter.name, counter.value);
             }
+            lines.push_back(std::move(counters));
         }
 
         if (backend.vkSwapchain) {
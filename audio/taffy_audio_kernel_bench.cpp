@@ -0,0 +1,235 @@
+// Micro-benchmark for the Taffy audio block kernels.
+//
+// Reports samples/sec per node type for the vectorized kernels next to the
+// per-sample scalar loops they replaced, so regressions show up as a ratio.
+//
+// Usage: TremorAudioKernelBench [block frames] [iterations]
+
+#include "taffy_audio_kernels.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using namespace tremor::audio;
+
+    constexpr float kSampleRate = 48000.0f;
+    constexpr float kTwoPi = 6.28318530717958647692f;
+
+    // Keeps results observable so the optimizer cannot drop the work
+    volatile float g_sink = 0.0f;
+
+    struct BenchResult {
+        double kernelRate = 0.0;
+        double referenceRate = 0.0;
+    };
+
+    template <typename Fn>
+    double samplesPerSecond(uint32_t frames, uint32_t iterations, Fn&& fn) {
+        fn();  // Warm caches
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(frames) * iterations / std::max(elapsed.count(), 1e-9);
+    }
+
+    void report(const std::string& name, const BenchResult& result) {
+        std::cout << "  " << std::left << std::setw(22) << name << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1) << result.kernelRate / 1e6 << " Msmp/s"
+                  << std::setw(10) << result.referenceRate / 1e6 << " Msmp/s"
+                  << std::setw(8) << std::setprecision(2) << result.kernelRate / result.referenceRate << "x"
+                  << std::endl;
+    }
+
+    // Scalar reference: the per-sample oscillator loop with the waveform switch inside
+    void referenceOscillator(uint32_t waveform, float& phase, float increment, float* out, uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            switch (waveform) {
+                case 0: out[i] = std::sin(phase); break;
+                case 1: out[i] = phase < 3.14159265f ? 1.0f : -1.0f; break;
+                case 2: out[i] = 2.0f * (phase / kTwoPi) - 1.0f; break;
+                default:
+                    out[i] = phase < 3.14159265f ? -1.0f + 2.0f * (phase / 3.14159265f)
+                                                 : 3.0f - 2.0f * (phase / 3.14159265f);
+                    break;
+            }
+            phase += increment;
+            if (phase >= kTwoPi) {
+                phase -= kTwoPi;
+            }
+        }
+    }
+
+    // Scalar reference: per-sample modulated biquad that recomputes coefficients with std::sin/std::cos
+    void referenceModulatedFilter(float cutoff, const float* mod, const float* in, float* out, uint32_t count,
+                                  kernels::BiquadState& s) {
+        for (uint32_t i = 0; i < count; ++i) {
+            float c = std::max(20.0f, std::min(20000.0f, cutoff + mod[i]));
+            kernels::BiquadCoefficients k = kernels::biquadCoefficients(kernels::BiquadShape::Lowpass, c, 0.707f, kSampleRate);
+            float y = k.b0 * in[i] + k.b1 * s.x1 + k.b2 * s.x2 - k.a1 * s.y1 - k.a2 * s.y2;
+            s.x2 = s.x1;
+            s.x1 = in[i];
+            s.y2 = s.y1;
+            s.y1 = y;
+            out[i] = y;
+        }
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 512;
+    uint32_t iterations = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 20000;
+    frames = std::max(frames, 1u);
+    iterations = std::max(iterations, 1u);
+
+    std::vector<float> phases(frames), increments(frames), out(frames);
+    std::vector<float> inputA(frames), inputB(frames), modulation(frames);
+    for (uint32_t i = 0; i < frames; ++i) {
+        inputA[i] = std::sin(static_cast<float>(i) * 0.05f);
+        inputB[i] = 0.5f + 0.5f * std::cos(static_cast<float>(i) * 0.01f);
+        modulation[i] = 800.0f * std::sin(static_cast<float>(i) * 0.002f);
+    }
+
+    std::cout << "🎛️ Taffy audio kernel benchmark (" << kernels::instructionSet() << ", "
+              << frames << " frames x " << iterations << " blocks)" << std::endl;
+    std::cout << "  " << std::left << std::setw(22) << "node" << std::right
+              << std::setw(17) << "kernel" << std::setw(17) << "scalar" << std::setw(9) << "speedup" << std::endl;
+
+    const float increment = 440.0f / kSampleRate;
+    const char* waveformNames[] = {"oscillator/sine", "oscillator/square", "oscillator/saw", "oscillator/triangle"};
+    for (uint32_t waveform = 0; waveform < 4; ++waveform) {
+        BenchResult result;
+        float phase = 0.0f;
+        result.kernelRate = samplesPerSecond(frames, iterations, [&] {
+            kernels::phaseRamp(phase, increment, phases.data(), frames);
+            switch (waveform) {
+                case 0: kernels::sine(phases.data(), out.data(), frames); break;
+                case 1: kernels::square(phases.data(), nullptr, increment, out.data(), frames); break;
+                case 2: kernels::saw(phases.data(), nullptr, increment, out.data(), frames); break;
+                default: kernels::triangle(phases.data(), out.data(), frames); break;
+            }
+            g_sink = out[frames - 1];
+        });
+        float radians = 0.0f;
+        result.referenceRate = samplesPerSecond(frames, iterations, [&] {
+            referenceOscillator(waveform, radians, increment * kTwoPi, out.data(), frames);
+            g_sink = out[frames - 1];
+        });
+        report(waveformNames[waveform], result);
+    }
+
+    {
+        BenchResult result;
+        float phase = 0.0f;
+        result.kernelRate = samplesPerSecond(frames, iterations, [&] {
+            kernels::phaseRampModulated(phase, increment, modulation.data(), 1.0f / kSampleRate,
+                                        phases.data(), increments.data(), frames);
+            kernels::saw(phases.data(), increments.data(), increment, out.data(), frames);
+            g_sink = out[frames - 1];
+        });
+        float radians = 0.0f;
+        result.referenceRate = samplesPerSecond(frames, iterations, [&] {
+            for (uint32_t i = 0; i < frames; ++i) {
+                out[i] = 2.0f * (radians / kTwoPi) - 1.0f;
+                radians += kTwoPi * (440.0f + modulation[i]) / kSampleRate;
+                radians -= kTwoPi * std::floor(radians / kTwoPi);
+            }
+            g_sink = out[frames - 1];
+        });
+        report("oscillator/saw+fm", result);
+    }
+
+    {
+        BenchResult result;
+        result.kernelRate = samplesPerSecond(frames, iterations, [&] {
+            kernels::multiplyScaled(inputA.data(), inputB.data(), 0.8f, out.data(), frames);
+            g_sink = out[frames - 1];
+        });
+        result.referenceRate = samplesPerSecond(frames, iterations, [&] {
+            for (uint32_t i = 0; i < frames; ++i) {
+                out[i] = inputA[i] * 0.8f * inputB[i];
+            }
+            g_sink = out[frames - 1];
+        });
+        report("amplifier", result);
+    }
+
+    {
+        BenchResult result;
+        const float* sources[] = {inputA.data(), inputB.data(), modulation.data(), inputA.data()};
+        result.kernelRate = samplesPerSecond(frames, iterations, [&] {
+            // Master gain is folded into the per-input gain
+            kernels::scale(sources[0], 0.25f * 0.9f, out.data(), frames);
+            for (uint32_t s = 1; s < 4; ++s) {
+                kernels::accumulate(sources[s], 0.25f * 0.9f, out.data(), frames);
+            }
+            g_sink = out[frames - 1];
+        });
+        result.referenceRate = samplesPerSecond(frames, iterations, [&] {
+            for (uint32_t i = 0; i < frames; ++i) {
+                out[i] = 0.0f;
+            }
+            for (uint32_t s = 0; s < 4; ++s) {
+                for (uint32_t i = 0; i < frames; ++i) {
+                    out[i] += sources[s][i] * 0.25f;
+                }
+            }
+            for (uint32_t i = 0; i < frames; ++i) {
+                out[i] *= 0.9f;
+            }
+            g_sink = out[frames - 1];
+        });
+        report("mixer/4 inputs", result);
+    }
+
+    {
+        BenchResult result;
+        kernels::BiquadState state;
+        kernels::BiquadCoefficients coefficients =
+            kernels::biquadCoefficients(kernels::BiquadShape::Lowpass, 1000.0f, 0.707f, kSampleRate);
+        result.kernelRate = samplesPerSecond(frames, iterations, [&] {
+            kernels::biquad(coefficients, state, inputA.data(), out.data(), frames);
+            g_sink = out[frames - 1];
+        });
+        kernels::BiquadState referenceState;
+        result.referenceRate = samplesPerSecond(frames, iterations, [&] {
+            for (uint32_t i = 0; i < frames; ++i) {
+                float y = coefficients.b0 * inputA[i] + coefficients.b1 * referenceState.x1 + coefficients.b2 * referenceState.x2
+                        - coefficients.a1 * referenceState.y1 - coefficients.a2 * referenceState.y2;
+                referenceState.x2 = referenceState.x1;
+                referenceState.x1 = inputA[i];
+                referenceState.y2 = referenceState.y1;
+                referenceState.y1 = y;
+                out[i] = y;
+            }
+            g_sink = out[frames - 1];
+        });
+        report("filter/lowpass", result);
+    }
+
+    {
+        BenchResult result;
+        kernels::BiquadState state;
+        result.kernelRate = samplesPerSecond(frames, iterations, [&] {
+            kernels::biquadModulated(kernels::BiquadShape::Lowpass, 1000.0f, modulation.data(), 0.707f, kSampleRate,
+                                     state, inputA.data(), out.data(), frames);
+            g_sink = out[frames - 1];
+        });
+        kernels::BiquadState referenceState;
+        result.referenceRate = samplesPerSecond(frames, iterations, [&] {
+            referenceModulatedFilter(1000.0f, modulation.data(), inputA.data(), out.data(), frames, referenceState);
+            g_sink = out[frames - 1];
+        });
+        report("filter/lowpass+mod", result);
+    }
+
+    return 0;
+}
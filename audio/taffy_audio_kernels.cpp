@@ -0,0 +1,425 @@
+#include "taffy_audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TREMOR_AUDIO_KERNELS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TREMOR_AUDIO_KERNELS_SSE2 1
+#endif
+
+namespace tremor::audio::kernels {
+
+    namespace {
+
+        constexpr float kTwoPi = 6.28318530717958647692f;
+
+        // Taylor coefficients for sin(x) on [-pi/2, pi/2], max error ~4e-6
+        constexpr float kSin3 = -1.0f / 6.0f;
+        constexpr float kSin5 = 1.0f / 120.0f;
+        constexpr float kSin7 = -1.0f / 5040.0f;
+        constexpr float kSin9 = 1.0f / 362880.0f;
+
+        // Coefficient batch size for modulated biquads
+        constexpr uint32_t kBiquadBatch = 64;
+
+        // One lane; also used for the tail of every vector loop
+        struct ScalarOps {
+            using V = float;
+            using M = bool;
+            static constexpr uint32_t width = 1;
+
+            static V load(const float* p) { return *p; }
+            static void store(float* p, V v) { *p = v; }
+            static V set1(float x) { return x; }
+            static V ramp(float start, float) { return start; }
+            static V add(V a, V b) { return a + b; }
+            static V sub(V a, V b) { return a - b; }
+            static V mul(V a, V b) { return a * b; }
+            static V div(V a, V b) { return a / b; }
+            static V madd(V a, V b, V c) { return a * b + c; }
+            static V min(V a, V b) { return std::min(a, b); }
+            static V max(V a, V b) { return std::max(a, b); }
+            static V abs(V a) { return std::fabs(a); }
+            static V floor(V a) { return std::floor(a); }
+            static M less(V a, V b) { return a < b; }
+            static M greater(V a, V b) { return a > b; }
+            static V select(M m, V a, V b) { return m ? a : b; }
+        };
+
+#if defined(TREMOR_AUDIO_KERNELS_AVX2)
+        struct WideOps {
+            using V = __m256;
+            using M = __m256;
+            static constexpr uint32_t width = 8;
+
+            static V load(const float* p) { return _mm256_loadu_ps(p); }
+            static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+            static V set1(float x) { return _mm256_set1_ps(x); }
+            static V ramp(float start, float step) {
+                return _mm256_fmadd_ps(_mm256_set1_ps(step), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps(start));
+            }
+            static V add(V a, V b) { return _mm256_add_ps(a, b); }
+            static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+            static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+            static V div(V a, V b) { return _mm256_div_ps(a, b); }
+            static V madd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+            static V min(V a, V b) { return _mm256_min_ps(a, b); }
+            static V max(V a, V b) { return _mm256_max_ps(a, b); }
+            static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+            static V floor(V a) { return _mm256_floor_ps(a); }
+            static M less(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+            static M greater(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+            static V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+        };
+#elif defined(TREMOR_AUDIO_KERNELS_SSE2)
+        struct WideOps {
+            using V = __m128;
+            using M = __m128;
+            static constexpr uint32_t width = 4;
+
+            static V load(const float* p) { return _mm_loadu_ps(p); }
+            static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+            static V set1(float x) { return _mm_set1_ps(x); }
+            static V ramp(float start, float step) {
+                return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0, 1, 2, 3)), _mm_set1_ps(start));
+            }
+            static V add(V a, V b) { return _mm_add_ps(a, b); }
+            static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+            static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+            static V div(V a, V b) { return _mm_div_ps(a, b); }
+            static V madd(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+            static V min(V a, V b) { return _mm_min_ps(a, b); }
+            static V max(V a, V b) { return _mm_max_ps(a, b); }
+            static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+            static V floor(V a) {
+                // SSE2 has no round instruction; truncate and fix up negative values
+                V truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+                return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+            }
+            static M less(V a, V b) { return _mm_cmplt_ps(a, b); }
+            static M greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+            static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        };
+#else
+        using WideOps = ScalarOps;
+#endif
+
+        // Run fn<Ops>(index) over a block: full vectors first, then scalar tail
+        template <typename Fn>
+        inline void forEachLane(uint32_t count, Fn&& fn) {
+            uint32_t i = 0;
+            for (; i + WideOps::width <= count; i += WideOps::width) {
+                fn.template operator()<WideOps>(i);
+            }
+            for (; i < count; ++i) {
+                fn.template operator()<ScalarOps>(i);
+            }
+        }
+
+        template <typename Ops>
+        inline typename Ops::V fract(typename Ops::V x) {
+            return Ops::sub(x, Ops::floor(x));
+        }
+
+        // sin(2*pi*t) for t in cycles
+        template <typename Ops>
+        inline typename Ops::V sinCycles(typename Ops::V t) {
+            using V = typename Ops::V;
+            // Reduce to [-0.5, 0.5), then fold into [-0.25, 0.25] using sin(pi - x) == sin(x)
+            V r = Ops::sub(t, Ops::floor(Ops::add(t, Ops::set1(0.5f))));
+            r = Ops::select(Ops::greater(r, Ops::set1(0.25f)), Ops::sub(Ops::set1(0.5f), r), r);
+            r = Ops::select(Ops::less(r, Ops::set1(-0.25f)), Ops::sub(Ops::set1(-0.5f), r), r);
+
+            V x = Ops::mul(r, Ops::set1(kTwoPi));
+            V x2 = Ops::mul(x, x);
+            V p = Ops::madd(x2, Ops::set1(kSin9), Ops::set1(kSin7));
+            p = Ops::madd(x2, p, Ops::set1(kSin5));
+            p = Ops::madd(x2, p, Ops::set1(kSin3));
+            p = Ops::madd(x2, p, Ops::set1(1.0f));
+            return Ops::mul(x, p);
+        }
+
+        // PolyBLEP residual for a unit step at t == 0, dt in (0, 0.5]
+        template <typename Ops>
+        inline typename Ops::V polyBlep(typename Ops::V t, typename Ops::V dt, typename Ops::V invDt) {
+            using V = typename Ops::V;
+            V one = Ops::set1(1.0f);
+            V zero = Ops::set1(0.0f);
+
+            // Just after the discontinuity: 2x - x^2 - 1
+            V x = Ops::mul(t, invDt);
+            V rising = Ops::sub(Ops::sub(Ops::add(x, x), Ops::mul(x, x)), one);
+
+            // Just before it: x^2 + 2x + 1
+            V y = Ops::mul(Ops::sub(t, one), invDt);
+            V falling = Ops::add(Ops::madd(y, y, Ops::add(y, y)), one);
+
+            V result = Ops::select(Ops::greater(t, Ops::sub(one, dt)), falling, zero);
+            return Ops::select(Ops::less(t, dt), rising, result);
+        }
+
+        template <typename Ops>
+        inline typename Ops::V blepIncrement(const float* increments, float increment, uint32_t i) {
+            using V = typename Ops::V;
+            V dt = increments ? Ops::load(increments + i) : Ops::set1(increment);
+            return Ops::min(Ops::max(Ops::abs(dt), Ops::set1(1e-6f)), Ops::set1(0.5f));
+        }
+
+        template <typename Ops>
+        inline void biquadCoefficientBatch(BiquadShape shape, typename Ops::V cutoff, float resonance, float sampleRate,
+                                           float* b0, float* b1, float* b2, float* a1, float* a2) {
+            using V = typename Ops::V;
+            V one = Ops::set1(1.0f);
+            V w = Ops::div(cutoff, Ops::set1(sampleRate));
+            V sinOmega = sinCycles<Ops>(w);
+            V cosOmega = sinCycles<Ops>(Ops::add(w, Ops::set1(0.25f)));
+            V alpha = Ops::div(sinOmega, Ops::set1(2.0f * resonance));
+            V invA0 = Ops::div(one, Ops::add(one, alpha));
+            V a1v = Ops::mul(Ops::mul(Ops::set1(-2.0f), cosOmega), invA0);
+            V a2v = Ops::mul(Ops::sub(one, alpha), invA0);
+
+            V b0v, b1v, b2v;
+            switch (shape) {
+                case BiquadShape::Lowpass:
+                    b1v = Ops::mul(Ops::sub(one, cosOmega), invA0);
+                    b0v = Ops::mul(b1v, Ops::set1(0.5f));
+                    b2v = b0v;
+                    break;
+
+                case BiquadShape::Highpass:
+                    b0v = Ops::mul(Ops::mul(Ops::add(one, cosOmega), Ops::set1(0.5f)), invA0);
+                    b1v = Ops::mul(b0v, Ops::set1(-2.0f));
+                    b2v = b0v;
+                    break;
+
+                case BiquadShape::Bandpass:
+                    b0v = Ops::mul(Ops::mul(sinOmega, Ops::set1(0.5f)), invA0);
+                    b1v = Ops::set1(0.0f);
+                    b2v = Ops::sub(Ops::set1(0.0f), b0v);
+                    break;
+
+                default:
+                    b0v = one;
+                    b1v = Ops::set1(0.0f);
+                    b2v = b1v;
+                    a1v = b1v;
+                    a2v = b1v;
+                    break;
+            }
+
+            Ops::store(b0, b0v);
+            Ops::store(b1, b1v);
+            Ops::store(b2, b2v);
+            Ops::store(a1, a1v);
+            Ops::store(a2, a2v);
+        }
+
+    } // namespace
+
+    const char* instructionSet() {
+#if defined(TREMOR_AUDIO_KERNELS_AVX2)
+        return "AVX2";
+#elif defined(TREMOR_AUDIO_KERNELS_SSE2)
+        return "SSE2";
+#else
+        return "Scalar";
+#endif
+    }
+
+    void phaseRamp(float& phase, float increment, float* phases, uint32_t count) {
+        // Lanes are offset from a base phase that is wrapped once per vector,
+        // so rounding error does not grow with the block size
+        float base = phase;
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            Ops::store(phases + i, fract<Ops>(Ops::ramp(base, increment)));
+            base += increment * static_cast<float>(Ops::width);
+            if (base >= 1.0f || base < 0.0f) {
+                base -= std::floor(base);
+            }
+        });
+        phase = base;
+    }
+
+    void phaseRampModulated(float& phase, float baseIncrement, const float* modulation, float modulationScale,
+                            float* phases, float* increments, uint32_t count) {
+        // The phase recurrence is serial, so only the increments vectorize
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            Ops::store(increments + i, Ops::madd(Ops::load(modulation + i), Ops::set1(modulationScale), Ops::set1(baseIncrement)));
+        });
+
+        float current = phase;
+        for (uint32_t i = 0; i < count; ++i) {
+            phases[i] = current;
+            current += increments[i];
+            // Modulation can push the frequency negative or past Nyquist
+            if (current >= 1.0f || current < 0.0f) {
+                current -= std::floor(current);
+            }
+        }
+        phase = current;
+    }
+
+    void sine(const float* phases, float* out, uint32_t count) {
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            Ops::store(out + i, sinCycles<Ops>(Ops::load(phases + i)));
+        });
+    }
+
+    void triangle(const float* phases, float* out, uint32_t count) {
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            using V = typename Ops::V;
+            V t = Ops::load(phases + i);
+            V four = Ops::set1(4.0f);
+            V up = Ops::madd(t, four, Ops::set1(-1.0f));
+            V down = Ops::sub(Ops::set1(3.0f), Ops::mul(t, four));
+            Ops::store(out + i, Ops::select(Ops::less(t, Ops::set1(0.5f)), up, down));
+        });
+    }
+
+    void saw(const float* phases, const float* increments, float increment, float* out, uint32_t count) {
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            using V = typename Ops::V;
+            V t = Ops::load(phases + i);
+            V dt = blepIncrement<Ops>(increments, increment, i);
+            V invDt = Ops::div(Ops::set1(1.0f), dt);
+            V naive = Ops::madd(t, Ops::set1(2.0f), Ops::set1(-1.0f));
+            Ops::store(out + i, Ops::sub(naive, polyBlep<Ops>(t, dt, invDt)));
+        });
+    }
+
+    void square(const float* phases, const float* increments, float increment, float* out, uint32_t count) {
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            using V = typename Ops::V;
+            V t = Ops::load(phases + i);
+            V dt = blepIncrement<Ops>(increments, increment, i);
+            V invDt = Ops::div(Ops::set1(1.0f), dt);
+            V naive = Ops::select(Ops::less(t, Ops::set1(0.5f)), Ops::set1(1.0f), Ops::set1(-1.0f));
+            V halfShifted = fract<Ops>(Ops::add(t, Ops::set1(0.5f)));
+            V blep = Ops::sub(polyBlep<Ops>(t, dt, invDt), polyBlep<Ops>(halfShifted, dt, invDt));
+            Ops::store(out + i, Ops::add(naive, blep));
+        });
+    }
+
+    void scale(const float* in, float gain, float* out, uint32_t count) {
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            Ops::store(out + i, Ops::mul(Ops::load(in + i), Ops::set1(gain)));
+        });
+    }
+
+    void multiplyScaled(const float* a, const float* b, float gain, float* out, uint32_t count) {
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            Ops::store(out + i, Ops::mul(Ops::mul(Ops::load(a + i), Ops::load(b + i)), Ops::set1(gain)));
+        });
+    }
+
+    void accumulate(const float* in, float gain, float* out, uint32_t count) {
+        forEachLane(count, [&]<typename Ops>(uint32_t i) {
+            Ops::store(out + i, Ops::madd(Ops::load(in + i), Ops::set1(gain), Ops::load(out + i)));
+        });
+    }
+
+    BiquadCoefficients biquadCoefficients(BiquadShape shape, float cutoff, float resonance, float sampleRate) {
+        float omega = kTwoPi * cutoff / sampleRate;
+        float sinOmega = std::sin(omega);
+        float cosOmega = std::cos(omega);
+        float alpha = sinOmega / (2.0f * resonance);
+
+        float a0 = 1.0f + alpha;
+        BiquadCoefficients c;
+        c.a1 = -2.0f * cosOmega;
+        c.a2 = 1.0f - alpha;
+
+        switch (shape) {
+            case BiquadShape::Lowpass:
+                c.b0 = (1.0f - cosOmega) / 2.0f;
+                c.b1 = 1.0f - cosOmega;
+                c.b2 = (1.0f - cosOmega) / 2.0f;
+                break;
+
+            case BiquadShape::Highpass:
+                c.b0 = (1.0f + cosOmega) / 2.0f;
+                c.b1 = -(1.0f + cosOmega);
+                c.b2 = (1.0f + cosOmega) / 2.0f;
+                break;
+
+            case BiquadShape::Bandpass:
+                c.b0 = sinOmega / 2.0f;
+                c.b1 = 0.0f;
+                c.b2 = -sinOmega / 2.0f;
+                break;
+
+            default:
+                return BiquadCoefficients{};
+        }
+
+        c.b0 /= a0;
+        c.b1 /= a0;
+        c.b2 /= a0;
+        c.a1 /= a0;
+        c.a2 /= a0;
+        return c;
+    }
+
+    void biquad(const BiquadCoefficients& coefficients, BiquadState& state,
+                const float* in, float* out, uint32_t count) {
+        // The recurrence is serial; keep everything in registers for the block
+        const float b0 = coefficients.b0, b1 = coefficients.b1, b2 = coefficients.b2;
+        const float a1 = coefficients.a1, a2 = coefficients.a2;
+        float x1 = state.x1, x2 = state.x2, y1 = state.y1, y2 = state.y2;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            float x = in ? in[i] : 0.0f;
+            float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            out[i] = y;
+        }
+
+        state = {x1, x2, y1, y2};
+    }
+
+    void biquadModulated(BiquadShape shape, float cutoff, const float* cutoffModulation, float resonance,
+                         float sampleRate, BiquadState& state, const float* in, float* out, uint32_t count) {
+        alignas(32) float b0[kBiquadBatch];
+        alignas(32) float b1[kBiquadBatch];
+        alignas(32) float b2[kBiquadBatch];
+        alignas(32) float a1[kBiquadBatch];
+        alignas(32) float a2[kBiquadBatch];
+
+        float x1 = state.x1, x2 = state.x2, y1 = state.y1, y2 = state.y2;
+
+        for (uint32_t begin = 0; begin < count; begin += kBiquadBatch) {
+            uint32_t batch = std::min(kBiquadBatch, count - begin);
+            const float* modulation = cutoffModulation + begin;
+
+            // Per-sample coefficients for the whole batch
+            forEachLane(batch, [&]<typename Ops>(uint32_t i) {
+                using V = typename Ops::V;
+                V mod = Ops::load(modulation + i);
+                V base = Ops::set1(cutoff);
+                V clamped = Ops::min(Ops::max(Ops::add(base, mod), Ops::set1(20.0f)), Ops::set1(20000.0f));
+                V target = Ops::select(Ops::greater(Ops::abs(mod), Ops::set1(0.0f)), clamped, base);
+                biquadCoefficientBatch<Ops>(shape, target, resonance, sampleRate,
+                                            b0 + i, b1 + i, b2 + i, a1 + i, a2 + i);
+            });
+
+            for (uint32_t i = 0; i < batch; ++i) {
+                float x = in ? in[begin + i] : 0.0f;
+                float y = b0[i] * x + b1[i] * x1 + b2[i] * x2 - a1[i] * y1 - a2[i] * y2;
+                x2 = x1;
+                x1 = x;
+                y2 = y1;
+                y1 = y;
+                out[begin + i] = y;
+            }
+        }
+
+        state = {x1, x2, y1, y2};
+    }
+
+} // namespace tremor::audio::kernels
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tremor::audio::kernels {
+
+    /**
+     * Block DSP kernels used by the Taffy audio graph
+     *
+     * Each kernel processes a whole block of samples. The implementation is
+     * picked at compile time: AVX2/FMA when the kernels translation unit is
+     * built with AVX2 enabled (TREMOR_AUDIO_AVX2), SSE2 on any other x86
+     * target, and a portable scalar fallback everywhere else.
+     *
+     * Oscillator phases are normalized to cycles in [0, 1).
+     */
+
+    enum class BiquadShape : uint32_t {
+        Lowpass = 0,
+        Highpass = 1,
+        Bandpass = 2,
+        Passthrough = 3
+    };
+
+    // Normalized biquad coefficients (a0 == 1)
+    struct BiquadCoefficients {
+        float b0 = 1.0f;
+        float b1 = 0.0f;
+        float b2 = 0.0f;
+        float a1 = 0.0f;
+        float a2 = 0.0f;
+    };
+
+    // Direct form I delay line
+    struct BiquadState {
+        float x1 = 0.0f;
+        float x2 = 0.0f;
+        float y1 = 0.0f;
+        float y2 = 0.0f;
+    };
+
+    /**
+     * Name of the instruction set the kernels were compiled for
+     */
+    const char* instructionSet();
+
+    /**
+     * Write a constant-rate phase ramp and advance the phase past it
+     * @param phase Phase in cycles, updated to the phase after the block
+     * @param increment Phase increment per sample in cycles
+     * @param phases Output phases in [0, 1)
+     */
+    void phaseRamp(float& phase, float increment, float* phases, uint32_t count);
+
+    /**
+     * Write a frequency-modulated phase ramp and advance the phase past it
+     * @param phase Phase in cycles, updated to the phase after the block
+     * @param baseIncrement Phase increment per sample without modulation
+     * @param modulation Per-sample modulation added to the frequency
+     * @param modulationScale Converts modulation units to cycles per sample
+     * @param phases Output phases in [0, 1)
+     * @param increments Output per-sample increments, used by the band-limited waveforms
+     */
+    void phaseRampModulated(float& phase, float baseIncrement, const float* modulation, float modulationScale,
+                            float* phases, float* increments, uint32_t count);
+
+    /**
+     * Waveform shapers; read phases in cycles and write samples in [-1, 1]
+     * Saw and square are band-limited with PolyBLEP and need the phase
+     * increment: pass per-sample increments, or nullptr to use the constant one.
+     */
+    void sine(const float* phases, float* out, uint32_t count);
+    void triangle(const float* phases, float* out, uint32_t count);
+    void saw(const float* phases, const float* increments, float increment, float* out, uint32_t count);
+    void square(const float* phases, const float* increments, float increment, float* out, uint32_t count);
+
+    /**
+     * Gain kernels
+     * scale:          out = in * gain
+     * multiplyScaled: out = a * b * gain
+     * accumulate:     out += in * gain
+     */
+    void scale(const float* in, float gain, float* out, uint32_t count);
+    void multiplyScaled(const float* a, const float* b, float gain, float* out, uint32_t count);
+    void accumulate(const float* in, float gain, float* out, uint32_t count);
+
+    /**
+     * RBJ cookbook biquad coefficients
+     * @param cutoff Cutoff frequency in Hz
+     * @param resonance Filter Q
+     */
+    BiquadCoefficients biquadCoefficients(BiquadShape shape, float cutoff, float resonance, float sampleRate);
+
+    /**
+     * Run a biquad with fixed coefficients over a block
+     * @param in Input samples, or nullptr for silence
+     */
+    void biquad(const BiquadCoefficients& coefficients, BiquadState& state,
+                const float* in, float* out, uint32_t count);
+
+    /**
+     * Run a biquad whose cutoff is modulated per sample
+     * Samples with non-zero modulation use cutoff + modulation clamped to
+     * 20 Hz - 20 kHz; coefficients are computed in vector batches.
+     * @param in Input samples, or nullptr for silence
+     */
+    void biquadModulated(BiquadShape shape, float cutoff, const float* cutoffModulation, float resonance,
+                         float sampleRate, BiquadState& state, const float* in, float* out, uint32_t count);
+
+} // namespace tremor::audio::kernels
@@ -1,4 +1,5 @@
 #include "taffy_audio_processor.h"
+#include "taffy_audio_kernels.h"
 #include <iostream>
 #include <cstring>
 #include <random>
@@ -23,18 +24,13 @@ namespace tremor::audio {
 #endif
 
     TaffyAudioProcessor::TaffyAudioProcessor(uint32_t sample_rate)
-        : sample_rate_(sample_rate), current_time_(0.0f), sample_count_(0) {
-        // Start background loader thread
-        loaderThread_ = std::make_unique<std::thread>(&TaffyAudioProcessor::backgroundLoader, this);
+        : sample_rate_(sample_rate) {
+        // Background chunk reads go through the shared StreamingIOService
     }
 
     TaffyAudioProcessor::~TaffyAudioProcessor() {
-        // Stop loader thread
-        shouldStopLoader_ = true;
-        loaderCV_.notify_all();
-        if (loaderThread_ && loaderThread_->joinable()) {
-            loaderThread_->join();
-        }
+        // Drop our queued reads and wait out any that are running
+        StreamingIOService::instance().cancelOwner(this);
         
         // Clean up streaming file handles
         {
@@ -50,7 +46,7 @@ namespace tremor::audio {
 
     bool TaffyAudioProcessor::loadAudioChunk(const std::vector<uint8_t>& audioData) {
         // Lock the graph mutex for the entire loading process
-        std::lock_guard<std::mutex> lock(graphMutex_);
+        std::lock_guard<std::shared_mutex> lock(graphMutex_);
         
         if (audioData.size() < sizeof(Taffy::AudioChunk)) {
             std::cerr << "❌ Audio chunk data too small!" << std::endl;
@@ -58,14 +54,8 @@ namespace tremor::audio {
         }
         
 
-        // Stop background loader during load to prevent race conditions
-        {
-            std::lock_guard<std::mutex> lock(loaderMutex_);
-            // Clear the load queue
-            while (!loadQueue_.empty()) {
-                loadQueue_.pop();
-            }
-        }
+        // Stop background loads during load to prevent race conditions
+        StreamingIOService::instance().cancelOwner(this);
         
         // Close any open file streams and clear streaming data
         {
@@ -83,8 +73,10 @@ namespace tremor::audio {
         // Clear existing data
         try {
             nodes_.clear();
+            nodeSlots_.clear();
+            plan_.clear();
             connections_.clear();
-            parameters_.clear();
+            parameterIndex_.clear();
             parameterList_.clear();
             samples_.clear();
         } catch (const std::exception& e) {
@@ -92,21 +84,22 @@ namespace tremor::audio {
             return false;
         }
         
-        // Reset time when loading new audio chunk
-        current_time_ = 0.0f;
-        sample_count_ = 0;
+        // Voices built for the previous graph reset themselves on their next block
+        ++graphGeneration_;
         
         // Clear existing data structures to prevent memory corruption
         std::cout << "🧹 Clearing audio processor data. Current nodes: " << nodes_.size() << std::endl;
         // List current nodes before clearing
         if (!nodes_.empty()) {
-            for (const auto& [id, node] : nodes_) {
-                std::cout << "   Clearing node " << id << " type=" << static_cast<int>(node.node.type) << std::endl;
+            for (const auto& node : nodes_) {
+                std::cout << "   Clearing node " << node.id << " type=" << static_cast<int>(node.type) << std::endl;
             }
         }
         nodes_.clear();
+        nodeSlots_.clear();
+        plan_.clear();
         connections_.clear();
-        parameters_.clear();
+        parameterIndex_.clear();
         samples_.clear();
         std::cout << "   Nodes after clear: " << nodes_.size() << std::endl;
         
@@ -182,30 +175,15 @@ namespace tremor::audio {
                 return false;
             }
 
-            // Create NodeState directly in map to avoid copy
-            NodeState& state = nodes_[node.id];
-            state.node = node;
-            std::cout << "   ✅ Added node " << node.id << " to processor" << std::endl;
-            
-            try {
-                state.outputBuffer.resize(1024, 0.0f);  // Pre-allocate buffer with zeros
-            } catch (const std::exception& e) {
-                std::cerr << "❌ Failed to allocate output buffer for node " << node.id << ": " << e.what() << std::endl;
-                return false;
+            // Assign the node a slot; a repeated ID reuses its existing slot
+            auto [slotIt, inserted] = nodeSlots_.try_emplace(node.id, static_cast<uint32_t>(nodes_.size()));
+            if (inserted) {
+                nodes_.emplace_back();
             }
+            nodes_[slotIt->second] = node;
+            std::cout << "   ✅ Added node " << node.id << " to processor" << std::endl;
 
-            const char* nodeTypeName = "Unknown";
-            switch (node.type) {
-                case Taffy::AudioChunk::NodeType::Oscillator: nodeTypeName = "Oscillator"; break;
-                case Taffy::AudioChunk::NodeType::Amplifier: nodeTypeName = "Amplifier"; break;
-                case Taffy::AudioChunk::NodeType::Parameter: nodeTypeName = "Parameter"; break;
-                case Taffy::AudioChunk::NodeType::Mixer: nodeTypeName = "Mixer"; break;
-                case Taffy::AudioChunk::NodeType::Envelope: nodeTypeName = "Envelope"; break;
-                case Taffy::AudioChunk::NodeType::Filter: nodeTypeName = "Filter"; break;
-                case Taffy::AudioChunk::NodeType::Distortion: nodeTypeName = "Distortion"; break;
-                case Taffy::AudioChunk::NodeType::Sampler: nodeTypeName = "Sampler"; break;
-                case Taffy::AudioChunk::NodeType::StreamingSampler: nodeTypeName = "StreamingSampler"; break;
-            }
+            const char* nodeTypeName = TaffyAudioProcessor::nodeTypeName(node.type);
 
             std::cout << "   Node " << node.id << ": type=" << static_cast<uint32_t>(node.type) 
                       << " (" << nodeTypeName << ")"
@@ -232,11 +210,11 @@ namespace tremor::audio {
                       << "] (strength=" << conn.strength << ")" << std::endl;
                       
             // Special debug for parameter -> sampler connections
-            auto srcIt = nodes_.find(conn.source_node);
-            auto destIt = nodes_.find(conn.dest_node);
-            if (srcIt != nodes_.end() && destIt != nodes_.end()) {
-                if (srcIt->second.node.type == Taffy::AudioChunk::NodeType::Parameter &&
-                    destIt->second.node.type == Taffy::AudioChunk::NodeType::StreamingSampler) {
+            auto srcIt = nodeSlots_.find(conn.source_node);
+            auto destIt = nodeSlots_.find(conn.dest_node);
+            if (srcIt != nodeSlots_.end() && destIt != nodeSlots_.end()) {
+                if (nodes_[srcIt->second].type == Taffy::AudioChunk::NodeType::Parameter &&
+                    nodes_[destIt->second].type == Taffy::AudioChunk::NodeType::StreamingSampler) {
                     std::cout << "   🔗 IMPORTANT: Parameter -> StreamingSampler connection created!" << std::endl;
                     std::cout << "      This should trigger the sampler when parameter outputs > 0.5" << std::endl;
                 }
@@ -249,20 +227,15 @@ namespace tremor::audio {
             std::memcpy(&param, ptr, sizeof(param));
             ptr += sizeof(param);
 
-            ParameterInfo info;
-            info.param = param;
-            info.currentValue = param.default_value;
+            // Store in list (preserves order and duplicates); voices hold the current values
+            parameterList_.push_back(param);
             
-            // Store in list (preserves order and duplicates)
-            parameterList_.push_back(info);
-            
-            // Also store by hash for global parameters (last one wins)
-            parameters_[param.name_hash] = info;
+            // Also index by hash for global parameters (first one wins, matching setParameter)
+            parameterIndex_.try_emplace(param.name_hash, static_cast<uint32_t>(parameterList_.size() - 1));
             
             // Debug parameter loading
             if (param.name_hash == Taffy::fnv1a_hash("pitch")) {
-                std::cout << "   📎 Loaded pitch parameter: default=" << param.default_value 
-                          << ", current=" << info.currentValue << std::endl;
+                std::cout << "   📎 Loaded pitch parameter: default=" << param.default_value << std::endl;
             }
 
             std::cout << "   Parameter " << i << ": hash=0x" << std::hex << param.name_hash << std::dec
@@ -474,6 +447,12 @@ namespace tremor::audio {
             */
         }
 
+        compileExecutionPlan();
+        resetVoice(voice_);
+
+        // Size the render scratch for a typical block up front
+        ensureBlockCapacity(scratch_, 1024);
+
         std::cout << "✅ Audio chunk loaded successfully!" << std::endl;
         std::cout << "   Total streaming audios loaded: " << streamingAudios_.size() << std::endl;
         return true;
@@ -495,648 +474,748 @@ namespace tremor::audio {
         return loadAudioChunk(metadataOnly);
     }
 
+    void TaffyAudioProcessor::compileExecutionPlan() {
+        // Called with graphMutex_ held whenever the graph is (re)loaded
+        plan_.clear();
+
+        const uint32_t nodeCount = static_cast<uint32_t>(nodes_.size());
+        if (nodeCount == 0) {
+            return;
+        }
+
+        // Incoming connections per destination slot, keeping file order within each input
+        std::vector<std::vector<PlanInput>> incoming(nodeCount);
+        std::vector<bool> hasOutgoing(nodeCount, false);
+        for (const auto& conn : connections_) {
+            auto srcIt = nodeSlots_.find(conn.sourceNode);
+            auto destIt = nodeSlots_.find(conn.destNode);
+            if (srcIt == nodeSlots_.end() || destIt == nodeSlots_.end()) {
+                std::cerr << "⚠️ Dropping connection " << conn.sourceNode << " -> " << conn.destNode
+                          << ": unknown node" << std::endl;
+                continue;
+            }
+            if (conn.destInput >= kMaxNodeInputs) {
+                std::cerr << "⚠️ Dropping connection " << conn.sourceNode << " -> " << conn.destNode
+                          << ": input " << conn.destInput << " out of range" << std::endl;
+                continue;
+            }
+            incoming[destIt->second].push_back({srcIt->second, conn.sourceOutput, conn.destInput, conn.strength});
+            hasOutgoing[srcIt->second] = true;
+        }
+        for (auto& inputs : incoming) {
+            std::stable_sort(inputs.begin(), inputs.end(),
+                [](const PlanInput& a, const PlanInput& b) { return a.destInput < b.destInput; });
+        }
+
+        // Depth-first topological sort; a back edge (cycle) is broken by reading the
+        // previous block's output of the node already on the stack
+        enum class Visit : uint8_t { None, Active, Done };
+        std::vector<Visit> visit(nodeCount, Visit::None);
+        std::vector<bool> isFeedback(nodeCount, false);
+        std::vector<uint32_t> order;
+        order.reserve(nodeCount);
+        std::vector<std::pair<uint32_t, size_t>> stack;
+        for (uint32_t root = 0; root < nodeCount; ++root) {
+            if (visit[root] != Visit::None) continue;
+            stack.push_back({root, 0});
+            visit[root] = Visit::Active;
+            while (!stack.empty()) {
+                auto& [slot, next] = stack.back();
+                if (next < incoming[slot].size()) {
+                    uint32_t source = incoming[slot][next++].sourceSlot;
+                    if (visit[source] == Visit::None) {
+                        visit[source] = Visit::Active;
+                        stack.push_back({source, 0});
+                    } else if (visit[source] == Visit::Active) {
+                        isFeedback[source] = true;
+                    }
+                    continue;
+                }
+                visit[slot] = Visit::Done;
+                order.push_back(slot);
+                stack.pop_back();
+            }
+        }
+
+        // Parameter names each processor understands
+        static const std::array<std::pair<NodeParam, uint64_t>, static_cast<size_t>(NodeParam::Count)> paramNames = {{
+            {NodeParam::Frequency, Taffy::fnv1a_hash("frequency")},
+            {NodeParam::Waveform, Taffy::fnv1a_hash("waveform")},
+            {NodeParam::Amplitude, Taffy::fnv1a_hash("amplitude")},
+            {NodeParam::MasterGain, Taffy::fnv1a_hash("master_gain")},
+            {NodeParam::Attack, Taffy::fnv1a_hash("attack")},
+            {NodeParam::Decay, Taffy::fnv1a_hash("decay")},
+            {NodeParam::Sustain, Taffy::fnv1a_hash("sustain")},
+            {NodeParam::Release, Taffy::fnv1a_hash("release")},
+            {NodeParam::Cutoff, Taffy::fnv1a_hash("cutoff")},
+            {NodeParam::Resonance, Taffy::fnv1a_hash("resonance")},
+            {NodeParam::Type, Taffy::fnv1a_hash("type")},
+            {NodeParam::Drive, Taffy::fnv1a_hash("drive")},
+            {NodeParam::Mix, Taffy::fnv1a_hash("mix")},
+            {NodeParam::SampleIndex, Taffy::fnv1a_hash("sample_index")},
+            {NodeParam::Pitch, Taffy::fnv1a_hash("pitch")},
+            {NodeParam::StartPosition, Taffy::fnv1a_hash("start_position")},
+            {NodeParam::Loop, Taffy::fnv1a_hash("loop")},
+        }};
+
+        auto findGlobalParam = [this](uint64_t hash) {
+            for (uint32_t i = 0; i < parameterList_.size(); ++i) {
+                if (parameterList_[i].name_hash == hash) return i;
+            }
+            return kInvalidIndex;
+        };
+
+        plan_.steps.reserve(order.size());
+        for (uint32_t slot : order) {
+            const auto& node = nodes_[slot];
+
+            PlanStep step;
+            step.nodeSlot = slot;
+            step.params.fill(kInvalidIndex);
+            step.inputBegin = static_cast<uint32_t>(plan_.inputs.size());
+            step.inputCount = static_cast<uint32_t>(incoming[slot].size());
+            plan_.inputs.insert(plan_.inputs.end(), incoming[slot].begin(), incoming[slot].end());
+
+            // One port per input number so processors can fetch an input without scanning
+            uint32_t portCount = std::min(node.input_count, kMaxNodeInputs);
+            for (const PlanInput& input : incoming[slot]) {
+                portCount = std::max(portCount, input.destInput + 1);
+            }
+            step.portBegin = static_cast<uint32_t>(plan_.ports.size());
+            step.portCount = portCount;
+            uint32_t cursor = step.inputBegin;
+            const uint32_t inputEnd = step.inputBegin + step.inputCount;
+            for (uint32_t port = 0; port < portCount; ++port) {
+                PlanPort planPort;
+                planPort.inputBegin = cursor;
+                while (cursor < inputEnd && plan_.inputs[cursor].destInput == port) {
+                    ++cursor;
+                }
+                planPort.inputCount = cursor - planPort.inputBegin;
+                plan_.ports.push_back(planPort);
+            }
+            plan_.maxPortCount = std::max(plan_.maxPortCount, portCount);
+
+            // Later parameters in the node's range override earlier ones with the same name
+            uint32_t paramEnd = std::min<uint64_t>(uint64_t(node.param_offset) + node.param_count, parameterList_.size());
+            for (uint32_t paramIdx = node.param_offset; paramIdx < paramEnd; ++paramIdx) {
+                uint64_t hash = parameterList_[paramIdx].name_hash;
+                for (const auto& [param, nameHash] : paramNames) {
+                    if (hash == nameHash) {
+                        step.params[static_cast<size_t>(param)] = paramIdx;
+                    }
+                }
+            }
+
+            // Streaming samplers fall back to global parameters
+            if (node.type == Taffy::AudioChunk::NodeType::StreamingSampler) {
+                for (NodeParam param : {NodeParam::Pitch, NodeParam::StartPosition}) {
+                    auto& index = step.params[static_cast<size_t>(param)];
+                    if (index == kInvalidIndex) {
+                        index = findGlobalParam(paramNames[static_cast<size_t>(param)].second);
+                    }
+                }
+            }
+
+            if (node.type == Taffy::AudioChunk::NodeType::Mixer) {
+                step.gainBegin = static_cast<uint32_t>(plan_.gainParams.size());
+                for (uint32_t input = 0; input < node.input_count; ++input) {
+                    std::string gainParamName = "gain_" + std::to_string(input);
+                    uint64_t gainHash = Taffy::fnv1a_hash(gainParamName.c_str());
+                    uint32_t gainIndex = kInvalidIndex;
+                    for (uint32_t paramIdx = node.param_offset; paramIdx < paramEnd; ++paramIdx) {
+                        if (parameterList_[paramIdx].name_hash == gainHash) {
+                            gainIndex = paramIdx;
+                        }
+                    }
+                    plan_.gainParams.push_back(gainIndex);
+                }
+            }
+
+            plan_.steps.push_back(step);
+        }
+
+        // The output is the first amplifier (in load order) that feeds nothing else
+        for (uint32_t slot = 0; slot < nodeCount; ++slot) {
+            if (nodes_[slot].type == Taffy::AudioChunk::NodeType::Amplifier && !hasOutgoing[slot]) {
+                plan_.outputSlot = slot;
+                break;
+            }
+        }
+        if (plan_.outputSlot == kInvalidIndex) {
+            auto defaultIt = nodeSlots_.find(1);  // Default for simple assets
+            if (defaultIt != nodeSlots_.end()) {
+                plan_.outputSlot = defaultIt->second;
+            }
+        }
+
+        plan_.timeParam = findGlobalParam(Taffy::fnv1a_hash("time"));
+
+        // Every streaming sampler gets its own play cursor in each voice
+        for (auto& step : plan_.steps) {
+            if (nodes_[step.nodeSlot].type == Taffy::AudioChunk::NodeType::StreamingSampler) {
+                step.streamCursor = plan_.streamCursorCount++;
+            }
+        }
+        updateStreamSharing();
+
+        for (uint32_t slot = 0; slot < nodeCount; ++slot) {
+            if (isFeedback[slot]) {
+                plan_.feedbackSlots.push_back(slot);
+            }
+        }
+
+        std::cout << "🗺️ Compiled execution plan: " << plan_.steps.size() << " steps, "
+                  << plan_.inputs.size() << " inputs, output node "
+                  << (plan_.outputSlot != kInvalidIndex ? static_cast<int64_t>(nodes_[plan_.outputSlot].id) : -1)
+                  << std::endl;
+    }
+
     void TaffyAudioProcessor::processAudio(float* outputBuffer, uint32_t frameCount, uint32_t channelCount) {
         // Try to lock the graph mutex during processing
         // If we can't get the lock, skip this frame to avoid blocking the audio thread
-        std::unique_lock<std::mutex> lock(graphMutex_, std::try_to_lock);
+        std::unique_lock<std::shared_mutex> lock(graphMutex_, std::try_to_lock);
         if (!lock.owns_lock()) {
             // Can't get lock, clear output and return to avoid blocking
             std::memset(outputBuffer, 0, frameCount * channelCount * sizeof(float));
             return;
         }
         
-        static int processCallCount = 0;
-        static bool hasStreamingAudio = false;
-        if (!streamingAudios_.empty() && !hasStreamingAudio) {
-            hasStreamingAudio = true;
-            processCallCount = 0;
+        static std::atomic<int> processCallCount{0};
+        static std::atomic<bool> hasStreamingAudio{false};
+        if (!streamingAudios_.empty() && !hasStreamingAudio.load(std::memory_order_relaxed)) {
+            hasStreamingAudio.store(true, std::memory_order_relaxed);
+            processCallCount.store(0, std::memory_order_relaxed);
         }
-        if (processCallCount < 5 && hasStreamingAudio) {
+        if (processCallCount.load(std::memory_order_relaxed) < 5 && hasStreamingAudio.load(std::memory_order_relaxed)) {
             std::cout << "🎵 processAudio called! frameCount=" << frameCount 
                       << ", nodes=" << nodes_.size() 
                       << ", streaming=" << streamingAudios_.size() << std::endl;
-            processCallCount++;
+            processCallCount.fetch_add(1, std::memory_order_relaxed);
         }
         
         // Clear output buffer
         std::memset(outputBuffer, 0, frameCount * channelCount * sizeof(float));
 
         // Debug: Check output buffer before processing
-        static int preProcessDebug = 0;
-        if (preProcessDebug < 3) {
+        static std::atomic<int> preProcessDebug{0};
+        if (preProcessDebug.load(std::memory_order_relaxed) < 3) {
             // std::cout << "🔍 processAudio: frameCount=" << frameCount << ", channelCount=" << channelCount << std::endl;
             std::cout << "   Output buffer cleared, processing " << nodes_.size() << " nodes" << std::endl;
-            preProcessDebug++;
+            preProcessDebug.fetch_add(1, std::memory_order_relaxed);
         }
 
-        // Process all nodes in dependency order using a simple topological sort
-        // Build a list of nodes sorted by dependencies
-        std::vector<uint32_t> nodeOrder;
-        std::unordered_set<uint32_t> processed;
-        std::function<void(uint32_t)> processNodeDependencies = [&](uint32_t nodeId) {
-            if (processed.count(nodeId)) return;
-            
-            // First process all dependencies (nodes that feed into this one)
-            for (const auto& conn : connections_) {
-                if (conn.destNode == nodeId && processed.count(conn.sourceNode) == 0) {
-                    processNodeDependencies(conn.sourceNode);
-                }
-            }
-            
-            // Then add this node
-            nodeOrder.push_back(nodeId);
-            processed.insert(nodeId);
-        };
-        
-        // Process all nodes
-        // Make a snapshot of current node IDs to avoid race conditions
-        std::vector<uint32_t> currentNodeIds;
-        for (const auto& [nodeId, nodeState] : nodes_) {
-            currentNodeIds.push_back(nodeId);
-        }
-        
-        for (uint32_t nodeId : currentNodeIds) {
-            if (nodes_.count(nodeId)) {
-                processNodeDependencies(nodeId);
+        if (plan_.outputSlot == kInvalidIndex) {
+            static std::atomic<bool> missingOutputWarned{false};
+            if (!missingOutputWarned.load(std::memory_order_relaxed) && !nodes_.empty()) {
+                std::cout << "❌ No output node in execution plan!" << std::endl;
+                missingOutputWarned.store(true, std::memory_order_relaxed);
             }
+            return;
         }
-        
-        // Now process nodes in the correct order
-        static int nodeProcessDebug = 0;
-        if (nodeProcessDebug < 5) {
-            std::cout << "📊 Processing " << nodeOrder.size() << " nodes in order" << std::endl;
-            for (uint32_t nodeId : nodeOrder) {
-                auto it = nodes_.find(nodeId);
-                if (it != nodes_.end()) {
-                    std::cout << "   Node " << nodeId << " type: " << static_cast<int>(it->second.node.type) << std::endl;
+
+        // Render in segments split at queued parameter events so each change
+        // lands on its exact sample
+        parameterEvents_.collect();
+        float maxAmp = 0.0f;
+        uint32_t segmentStart = 0;
+        while (segmentStart < frameCount) {
+            ParameterEvent event;
+            while (parameterEvents_.popDue(segmentStart, event)) {
+                applyVoiceParameter(voice_, event.parameterHash, event.value);
+            }
+            uint32_t segmentEnd = parameterEvents_.nextOffset(frameCount);
+            uint32_t segmentFrames = segmentEnd - segmentStart;
+
+            renderVoice(voice_, scratch_, segmentFrames);
+            const float* output = scratch_.output(plan_.outputSlot);
+
+            // Copy output to the audio buffer
+            for (uint32_t i = 0; i < segmentFrames; ++i) {
+                float sample = output[i];
+                maxAmp = std::max(maxAmp, std::abs(sample));
+
+                // Write to all channels
+                for (uint32_t ch = 0; ch < channelCount; ++ch) {
+                    outputBuffer[(segmentStart + i) * channelCount + ch] = sample;
                 }
             }
-            nodeProcessDebug++;
+            segmentStart = segmentEnd;
         }
-        for (uint32_t nodeId : nodeOrder) {
-            auto it = nodes_.find(nodeId);
-            if (it != nodes_.end()) {
-                processNode(it->second, frameCount);
-            }
+        parameterEvents_.endBlock(frameCount);
+
+        static std::atomic<int> nodeProcessDebug{0};
+        if (nodeProcessDebug.load(std::memory_order_relaxed) < 5) {
+            std::cout << "📊 Processed " << plan_.steps.size() << " nodes in plan order" << std::endl;
+            nodeProcessDebug.fetch_add(1, std::memory_order_relaxed);
         }
 
-        // Find the final output node (typically the last amplifier)
-        // Look for an amplifier with no outgoing connections
-        uint32_t outputNodeId = 1; // Default for simple assets
-        
-        // Debug: List all nodes and their types
-        static int debugCount = 0;
-        if (debugCount < 3) {
-            std::cout << "🔍 Looking for output node among " << nodes_.size() << " nodes:" << std::endl;
-            for (const auto& [nodeId, nodeState] : nodes_) {
-                const char* nodeTypeName = "Unknown";
-                switch (nodeState.node.type) {
-                    case Taffy::AudioChunk::NodeType::Oscillator: nodeTypeName = "Oscillator"; break;
-                    case Taffy::AudioChunk::NodeType::Amplifier: nodeTypeName = "Amplifier"; break;
-                    case Taffy::AudioChunk::NodeType::Parameter: nodeTypeName = "Parameter"; break;
-                    case Taffy::AudioChunk::NodeType::Mixer: nodeTypeName = "Mixer"; break;
-                    case Taffy::AudioChunk::NodeType::Envelope: nodeTypeName = "Envelope"; break;
-                    case Taffy::AudioChunk::NodeType::Filter: nodeTypeName = "Filter"; break;
-                    case Taffy::AudioChunk::NodeType::Distortion: nodeTypeName = "Distortion"; break;
-                    case Taffy::AudioChunk::NodeType::Sampler: nodeTypeName = "Sampler"; break;
-                    case Taffy::AudioChunk::NodeType::StreamingSampler: nodeTypeName = "StreamingSampler"; break;
-                }
-                std::cout << "   Node " << nodeId << ": type=" << static_cast<int>(nodeState.node.type) 
-                          << " (" << nodeTypeName << ")" << std::endl;
-            }
-            debugCount++;
+        // Debug: Check if amplifier has any output
+        static std::atomic<int> ampDebugCount{0};
+        if (ampDebugCount.load(std::memory_order_relaxed) < 5 && maxAmp > 0.0f) {
+            std::cout << "🔊 Amplifier output: max amplitude = " << maxAmp << std::endl;
+            ampDebugCount.fetch_add(1, std::memory_order_relaxed);
         }
-        
-        // Find the output node - it's typically an amplifier with no outgoing connections
-        for (const auto& [nodeId, nodeState] : nodes_) {
-            if (nodeState.node.type == Taffy::AudioChunk::NodeType::Amplifier) {
-                bool hasOutgoingConnections = false;
-                for (const auto& conn : connections_) {
-                    if (conn.sourceNode == nodeId) {
-                        hasOutgoingConnections = true;
-                        break;
-                    }
-                }
-                if (!hasOutgoingConnections) {
-                    outputNodeId = nodeId;
-                    if (debugCount <= 3) {
-                        //std::cout << "   ✅ Found output amplifier: Node " << nodeId << std::endl;
-                    }
-                    break;
-                }
-            }
+    }
+
+    void TaffyAudioProcessor::processVoice(VoiceState& voice, RenderScratch& scratch, float* outputBuffer, uint32_t frameCount) {
+        // Same policy as processAudio, but shared so voices can render concurrently
+        std::shared_lock<std::shared_mutex> lock(graphMutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            std::memset(outputBuffer, 0, frameCount * sizeof(float));
+            return;
         }
-        
-        auto outputIt = nodes_.find(outputNodeId);
-        if (outputIt != nodes_.end()) {
-            // Debug: Check if amplifier has any output
-            static int ampDebugCount = 0;
-            if (ampDebugCount < 5) {
-                float maxAmp = 0.0f;
-                for (uint32_t i = 0; i < frameCount; ++i) {
-                    maxAmp = std::max(maxAmp, std::abs(outputIt->second.outputBuffer[i]));
-                }
-                if (maxAmp > 0.0f) {
-                    std::cout << "🔊 Amplifier output: max amplitude = " << maxAmp << std::endl;
-                    ampDebugCount++;
-                }
-            }
-            
-            // Copy output to the audio buffer
-            static int copyDebug = 0;
-            float maxCopied = 0.0f;
-            
-            for (uint32_t i = 0; i < frameCount; ++i) {
-                float sample = outputIt->second.outputBuffer[i];
-                maxCopied = std::max(maxCopied, std::abs(sample));
-                
-                // Write to all channels
-                for (uint32_t ch = 0; ch < channelCount; ++ch) {
-                    outputBuffer[i * channelCount + ch] = sample;
-                }
-            }
-            
-            if (copyDebug < 5 && maxCopied > 0.0f) {
-                // std::cout << "📻 Copied " << frameCount << " frames to output buffer, max amplitude: " << maxCopied << std::endl;
-                // Also check what's actually in the output buffer
-                float maxInOutput = 0.0f;
-                for (uint32_t i = 0; i < frameCount * channelCount; ++i) {
-                    maxInOutput = std::max(maxInOutput, std::abs(outputBuffer[i]));
-                }
-                std::cout << "   Max amplitude in final output buffer: " << maxInOutput << std::endl;
-                copyDebug++;
-            }
-        } else {
-            std::cout << "❌ Output node " << outputNodeId << " not found!" << std::endl;
+        processVoiceLocked(voice, scratch, outputBuffer, frameCount);
+    }
+
+    std::shared_lock<std::shared_mutex> TaffyAudioProcessor::tryLockGraph() const {
+        return std::shared_lock<std::shared_mutex>(graphMutex_, std::try_to_lock);
+    }
+
+    void TaffyAudioProcessor::processVoiceLocked(VoiceState& voice, RenderScratch& scratch, float* outputBuffer, uint32_t frameCount) {
+        // Called with graphMutex_ held
+        if (plan_.outputSlot == kInvalidIndex) {
+            std::memset(outputBuffer, 0, frameCount * sizeof(float));
+            return;
+        }
+
+        renderVoice(voice, scratch, frameCount);
+        std::memcpy(outputBuffer, scratch.output(plan_.outputSlot), frameCount * sizeof(float));
+    }
+
+    bool TaffyAudioProcessor::hasSharedStreamState() const {
+        std::shared_lock<std::shared_mutex> lock(graphMutex_);
+        return plan_.sharesStreamState;
+    }
+
+    void TaffyAudioProcessor::updateStreamSharing() {
+        // Called with graphMutex_ held. Samplers always play stream 0; see processStreamingSampler
+        std::lock_guard<std::mutex> lock(streamingAudiosMutex_);
+        bool mapped = !streamingAudios_.empty() && streamingAudios_[0].mapped.file != nullptr;
+        plan_.sharesStreamState = plan_.streamCursorCount > 0 && !streamingAudios_.empty() && !mapped;
+    }
+
+    void TaffyAudioProcessor::renderVoice(VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        // Called with graphMutex_ held
+        if (voice.graphGeneration != graphGeneration_) {
+            resetVoice(voice);
+        }
+        ensureBlockCapacity(scratch, frameCount);
+
+        // Restore this voice's previous block for nodes that are read before they run
+        const size_t feedbackSize = plan_.feedbackSlots.size() * static_cast<size_t>(scratch.frames);
+        if (voice.feedback.size() < feedbackSize) {
+            voice.feedback.resize(feedbackSize, 0.0f);
+        }
+        for (size_t f = 0; f < plan_.feedbackSlots.size(); ++f) {
+            std::memcpy(scratch.output(plan_.feedbackSlots[f]), voice.feedback.data() + f * scratch.frames,
+                        frameCount * sizeof(float));
+        }
+
+        // Run the precompiled plan; dependency order was resolved at load time
+        for (const PlanStep& step : plan_.steps) {
+            processNode(step, voice, scratch, frameCount);
+        }
+
+        for (size_t f = 0; f < plan_.feedbackSlots.size(); ++f) {
+            std::memcpy(voice.feedback.data() + f * scratch.frames, scratch.output(plan_.feedbackSlots[f]),
+                        frameCount * sizeof(float));
         }
 
         // Update time
-        current_time_ += static_cast<float>(frameCount) / static_cast<float>(sample_rate_);
-        sample_count_ += frameCount;
+        voice.currentTime += static_cast<float>(frameCount) / static_cast<float>(sample_rate_);
+        voice.sampleCount += frameCount;
 
         // Update time parameter if it exists
-        auto timeHash = Taffy::fnv1a_hash("time");
-        auto timeIt = parameters_.find(timeHash);
-        if (timeIt != parameters_.end()) {
-            timeIt->second.currentValue = current_time_;
+        if (plan_.timeParam != kInvalidIndex) {
+            voice.parameters[plan_.timeParam] = voice.currentTime;
         }
     }
 
-    void TaffyAudioProcessor::setParameter(uint64_t parameterHash, float value) {
-        // Try to lock the mutex to prevent race conditions with audio processing
-        // If we can't get the lock, skip this update to avoid blocking
-        std::unique_lock<std::mutex> lock(graphMutex_, std::try_to_lock);
-        if (!lock.owns_lock()) {
-            // Can't get lock, skip this parameter update
-            if (parameterHash == Taffy::fnv1a_hash("gate")) {
-                std::cout << "⚡ Gate parameter SET skipped (mutex busy)" << std::endl;
-            }
+    TaffyAudioProcessor::VoiceState TaffyAudioProcessor::createVoice() const {
+        std::shared_lock<std::shared_mutex> lock(graphMutex_);
+        VoiceState voice;
+        resetVoice(voice);
+        return voice;
+    }
+
+    void TaffyAudioProcessor::resetVoice(VoiceState& voice) const {
+        // Called with graphMutex_ held; keeps the vectors' capacity
+        voice.nodes.assign(nodes_.size(), NodeState{});
+        voice.parameters.resize(parameterList_.size());
+        for (size_t i = 0; i < parameterList_.size(); ++i) {
+            voice.parameters[i] = parameterList_[i].default_value;
+        }
+        voice.feedback.assign(plan_.feedbackSlots.size() * static_cast<size_t>(scratch_.frames), 0.0f);
+        voice.streamCursors.resize(plan_.streamCursorCount);
+        for (auto& cursor : voice.streamCursors) {
+            cursor.reset();
+        }
+        voice.currentTime = 0.0f;
+        voice.sampleCount = 0;
+        voice.graphGeneration = graphGeneration_;
+    }
+
+    void TaffyAudioProcessor::setParameter(uint64_t parameterHash, float value, uint32_t sampleOffset) {
+        // Never touches the graph; the audio thread applies the event at block start
+        if (!parameterEvents_.push({parameterHash, value, sampleOffset})) {
+            std::cout << "⚠️ Parameter queue full, dropping update 0x" << std::hex << parameterHash << std::dec << std::endl;
+        }
+    }
+
+    void TaffyAudioProcessor::setVoiceParameter(VoiceState& voice, uint64_t parameterHash, float value) const {
+        std::shared_lock<std::shared_mutex> lock(graphMutex_);
+        applyVoiceParameter(voice, parameterHash, value);
+    }
+
+    void TaffyAudioProcessor::setVoiceParameterLocked(VoiceState& voice, uint64_t parameterHash, float value) const {
+        applyVoiceParameter(voice, parameterHash, value);
+    }
+
+    void TaffyAudioProcessor::applyVoiceParameter(VoiceState& voice, uint64_t parameterHash, float value) const {
+        // Called with graphMutex_ held
+        auto it = parameterIndex_.find(parameterHash);
+        if (it == parameterIndex_.end() || voice.graphGeneration != graphGeneration_) {
             return;
         }
         
-        auto it = parameters_.find(parameterHash);
-        if (it != parameters_.end()) {
-            // Clamp to valid range
-            value = std::max(it->second.param.min_value, 
-                            std::min(it->second.param.max_value, value));
-            it->second.currentValue = value;
-            
-            // Also update the parameterList_ (which is used by processParameter)
-            for (auto& param : parameterList_) {
-                if (param.param.name_hash == parameterHash) {
-                    param.currentValue = value;
-                    break;
-                }
-            }
-            
-            // Debug gate parameter changes
-            if (parameterHash == Taffy::fnv1a_hash("gate")) {
-                std::cout << "⚡ Gate parameter SET to: " << value << std::endl;
+        // Clamp to valid range
+        const auto& param = parameterList_[it->second];
+        voice.parameters[it->second] = std::max(param.min_value, std::min(param.max_value, value));
+    }
+
+    const char* TaffyAudioProcessor::nodeTypeName(Taffy::AudioChunk::NodeType type) {
+        switch (type) {
+            case Taffy::AudioChunk::NodeType::Oscillator: return "Oscillator";
+            case Taffy::AudioChunk::NodeType::Amplifier: return "Amplifier";
+            case Taffy::AudioChunk::NodeType::Parameter: return "Parameter";
+            case Taffy::AudioChunk::NodeType::Mixer: return "Mixer";
+            case Taffy::AudioChunk::NodeType::Envelope: return "Envelope";
+            case Taffy::AudioChunk::NodeType::Filter: return "Filter";
+            case Taffy::AudioChunk::NodeType::Distortion: return "Distortion";
+            case Taffy::AudioChunk::NodeType::Sampler: return "Sampler";
+            case Taffy::AudioChunk::NodeType::StreamingSampler: return "StreamingSampler";
+            default: return "Unknown";
+        }
+    }
+
+    void TaffyAudioProcessor::setNodeProfiling(bool enabled) {
+        nodeProfiling_.store(enabled, std::memory_order_relaxed);
+    }
+
+    void TaffyAudioProcessor::resetNodeTypeCosts() {
+        for (size_t i = 0; i < kProfiledNodeTypes; ++i) {
+            nodeTypeNanos_[i].store(0, std::memory_order_relaxed);
+            nodeTypeCalls_[i].store(0, std::memory_order_relaxed);
+            nodeTypeFrames_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<TaffyAudioProcessor::NodeTypeCost> TaffyAudioProcessor::nodeTypeCosts() const {
+        std::vector<NodeTypeCost> costs;
+        for (size_t i = 0; i < kProfiledNodeTypes; ++i) {
+            uint64_t calls = nodeTypeCalls_[i].load(std::memory_order_relaxed);
+            if (calls == 0) {
+                continue;
             }
+            NodeTypeCost cost;
+            cost.type = static_cast<Taffy::AudioChunk::NodeType>(i);
+            cost.calls = calls;
+            cost.frames = nodeTypeFrames_[i].load(std::memory_order_relaxed);
+            cost.seconds = static_cast<double>(nodeTypeNanos_[i].load(std::memory_order_relaxed)) * 1e-9;
+            costs.push_back(cost);
         }
+        return costs;
     }
 
-    void TaffyAudioProcessor::processNode(NodeState& node, uint32_t frameCount) {               
-        // Ensure output buffer is properly sized
-        if (node.outputBuffer.size() < frameCount) {
-            node.outputBuffer.resize(frameCount);
+    void TaffyAudioProcessor::processNode(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        if (!nodeProfiling_.load(std::memory_order_relaxed)) {
+            runNode(step, voice, scratch, frameCount);
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        runNode(step, voice, scratch, frameCount);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        size_t type = static_cast<size_t>(nodes_[step.nodeSlot].type);
+        if (type < kProfiledNodeTypes) {
+            nodeTypeNanos_[type].fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+            nodeTypeCalls_[type].fetch_add(1, std::memory_order_relaxed);
+            nodeTypeFrames_[type].fetch_add(frameCount, std::memory_order_relaxed);
         }
+    }
+
+    void TaffyAudioProcessor::runNode(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        const Taffy::AudioChunk::Node& nodeInfo = nodes_[step.nodeSlot];
         
-        static bool samplerLogged = false;
+        static std::atomic<bool> samplerLogged{false};
         
         // Debug: log which node we're processing
-        static int nodeProcessDebug = 0;
-        if (nodeProcessDebug < 20) {
-            std::cout << "🔧 Processing node " << node.node.id 
-                      << " type=" << static_cast<int>(node.node.type) << std::endl;
-            nodeProcessDebug++;
+        static std::atomic<int> nodeProcessDebug{0};
+        if (nodeProcessDebug.load(std::memory_order_relaxed) < 20) {
+            std::cout << "🔧 Processing node " << nodeInfo.id 
+                      << " type=" << static_cast<int>(nodeInfo.type) << std::endl;
+            nodeProcessDebug.fetch_add(1, std::memory_order_relaxed);
         }
-        static bool streamingDebugPrinted = false;
+        static std::atomic<bool> streamingDebugPrinted{false};
 
-        switch (node.node.type) {
+        switch (nodeInfo.type) {
             case Taffy::AudioChunk::NodeType::Oscillator:
-                processOscillator(node, frameCount);
+                processOscillator(step, voice, scratch, frameCount);
                 break;
             case Taffy::AudioChunk::NodeType::Amplifier:
-                processAmplifier(node, frameCount);
+                processAmplifier(step, voice, scratch, frameCount);
                 break;
             case Taffy::AudioChunk::NodeType::Parameter:
-                processParameter(node, frameCount);
+                processParameter(step, voice, scratch, frameCount);
                 break;
             case Taffy::AudioChunk::NodeType::Mixer:
-                processMixer(node, frameCount);
+                processMixer(step, voice, scratch, frameCount);
                 break;
             case Taffy::AudioChunk::NodeType::Envelope:
-                processEnvelope(node, frameCount);
+                processEnvelope(step, voice, scratch, frameCount);
                 break;
             case Taffy::AudioChunk::NodeType::Filter:
-                processFilter(node, frameCount);
+                processFilter(step, voice, scratch, frameCount);
                 break;
             case Taffy::AudioChunk::NodeType::Distortion:
-                processDistortion(node, frameCount);
+                processDistortion(step, voice, scratch, frameCount);
                 break;
             case Taffy::AudioChunk::NodeType::Sampler:
-                if (!samplerLogged) {
+                if (!samplerLogged.load(std::memory_order_relaxed)) {
                     std::cout << "🎵 SAMPLER NODE FOUND AND PROCESSING!" << std::endl;
-                    samplerLogged = true;
+                    samplerLogged.store(true, std::memory_order_relaxed);
                 }
-                processSampler(node, frameCount);
+                processSampler(step, voice, scratch, frameCount);
                 break;
             case Taffy::AudioChunk::NodeType::StreamingSampler:
-                if (!streamingDebugPrinted) {
+                if (!streamingDebugPrinted.load(std::memory_order_relaxed)) {
                     std::cout << "🎵 STREAMING SAMPLER NODE FOUND AND PROCESSING!" << std::endl;
-                    std::cout << "   Node ID: " << node.node.id << std::endl;
-                    std::cout << "   Input count: " << node.node.input_count << std::endl;
-                    std::cout << "   Output count: " << node.node.output_count << std::endl;
-                    streamingDebugPrinted = true;
+                    std::cout << "   Node ID: " << nodeInfo.id << std::endl;
+                    std::cout << "   Input count: " << nodeInfo.input_count << std::endl;
+                    std::cout << "   Output count: " << nodeInfo.output_count << std::endl;
+                    streamingDebugPrinted.store(true, std::memory_order_relaxed);
                 }
-                processStreamingSampler(node, frameCount);
+                processStreamingSampler(step, voice, scratch, frameCount);
                 break;
             default:
 
                 // Clear output for unsupported nodes
-                std::memset(node.outputBuffer.data(), 0, frameCount * sizeof(float));
+                std::memset(scratch.output(step.nodeSlot), 0, frameCount * sizeof(float));
                 break;
         }
     }
 
-    float TaffyAudioProcessor::getNodeInput(uint32_t nodeId, uint32_t inputIndex) {
-        // Find connection to this input
-        for (const auto& conn : connections_) {
-            if (conn.destNode == nodeId && conn.destInput == inputIndex && conn.strength > 0.0f) {
-                auto srcIt = nodes_.find(conn.sourceNode);
-                if (srcIt != nodes_.end() && conn.sourceOutput == 0) {
-                    // Return the last value from the source node's output
-                    if (!srcIt->second.outputBuffer.empty()) {
-                        return srcIt->second.outputBuffer[0] * conn.strength;
-                    }
-                }
-            }
+    void TaffyAudioProcessor::ensureBlockCapacity(RenderScratch& scratch, uint32_t frameCount) const {
+        // Only reallocates when a block is larger than any seen before or the graph changed
+        const uint32_t nodeCount = static_cast<uint32_t>(nodes_.size());
+        if (frameCount <= scratch.frames && scratch.nodeCount == nodeCount && scratch.portCount == plan_.maxPortCount) {
+            return;
         }
-        return 0.0f;
+        scratch.frames = std::max(frameCount, scratch.frames);
+        scratch.nodeCount = nodeCount;
+        scratch.portCount = plan_.maxPortCount;
+        scratch.nodeOutputs.assign(static_cast<size_t>(nodeCount) * scratch.frames, 0.0f);
+        scratch.inputs.assign(static_cast<size_t>(plan_.maxPortCount) * scratch.frames, 0.0f);
+        scratch.phases.assign(scratch.frames, 0.0f);
+        scratch.increments.assign(scratch.frames, 0.0f);
     }
 
-    float TaffyAudioProcessor::getParameterValue(uint64_t paramHash) {
-        auto it = parameters_.find(paramHash);
-        if (it != parameters_.end()) {
-            return it->second.currentValue;
+    const float* TaffyAudioProcessor::getNodeInput(RenderScratch& scratch, const PlanStep& step, uint32_t inputIndex, uint32_t frameCount) const {
+        // Per-sample signal arriving at one input, or nullptr if nothing is connected
+        if (inputIndex >= step.portCount) {
+            return nullptr;
         }
-        return 0.0f;
-    }
-    
-    float TaffyAudioProcessor::getNodeParameterValue(const NodeState& node, uint64_t paramHash) {
-        // Look for parameter in node's parameter range
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    if (parameterList_[paramIdx].param.name_hash == paramHash) {
-                        return parameterList_[paramIdx].currentValue;
-                    }
-                }
-            }
+        const PlanPort& port = plan_.ports[step.portBegin + inputIndex];
+        if (port.inputCount == 0) {
+            return nullptr;
         }
-        // Fall back to global parameter
-        return getParameterValue(paramHash);
-    }
 
-    void TaffyAudioProcessor::processOscillator(NodeState& node, uint32_t frameCount) {
-        // Get parameters for this specific node from the parameter list
-        float frequency = 440.0f;  // Default
-        float waveformValue = 0.0f;  // Default to sine
-        
-        // Get parameters based on node's param_offset
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    const auto& param = parameterList_[paramIdx];
-                    
-                    if (param.param.name_hash == Taffy::fnv1a_hash("frequency")) {
-                        frequency = param.currentValue;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("waveform")) {
-                        waveformValue = param.currentValue;
-                    }
-                }
-            }
+        const PlanInput* inputs = plan_.inputs.data() + port.inputBegin;
+        if (port.inputCount == 1 && inputs[0].strength == 1.0f) {
+            // Single unity connection: read the source buffer in place
+            return scratch.output(inputs[0].sourceSlot);
+        }
+
+        // Sum all connections into this port's scratch buffer
+        float* sum = scratch.inputs.data() + static_cast<size_t>(inputIndex) * scratch.frames;
+        kernels::scale(scratch.output(inputs[0].sourceSlot), inputs[0].strength, sum, frameCount);
+        for (uint32_t c = 1; c < port.inputCount; ++c) {
+            kernels::accumulate(scratch.output(inputs[c].sourceSlot), inputs[c].strength, sum, frameCount);
         }
+        return sum;
+    }
+
+    void TaffyAudioProcessor::processOscillator(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        NodeState& node = voice.nodes[step.nodeSlot];
+        float* output = scratch.output(step.nodeSlot);
+        // Get parameters for this specific node (resolved in the execution plan)
+        float frequency = planParameter(voice, step, NodeParam::Frequency, 440.0f);
+        float waveformValue = planParameter(voice, step, NodeParam::Waveform, 0.0f);  // Default to sine
         
         Waveform waveform = static_cast<Waveform>(static_cast<uint32_t>(waveformValue));
 
-        // Check for frequency modulation input
-        float freqMod = getNodeInput(node.node.id, 0);
-        frequency += freqMod;
+        // Frequency modulation input (input 0), applied per sample
+        const float* freqMod = getNodeInput(scratch, step, 0, frameCount);
 
-        // Generate waveform based on type
-        float phaseIncrement = 2.0f * M_PI * frequency / static_cast<float>(sample_rate_);
+        // Phase increments in cycles per sample
+        const float cyclesPerHz = 1.0f / static_cast<float>(sample_rate_);
+        float phaseIncrement = cyclesPerHz * frequency;
+        
+        if (waveform == Waveform::Noise) {
+            // Static random generator for noise
+            // Per thread, since voices may render concurrently
+            thread_local std::mt19937 rng(std::chrono::steady_clock::now().time_since_epoch().count());
+            thread_local std::uniform_real_distribution<float> noiseDist(-1.0f, 1.0f);
+            for (uint32_t i = 0; i < frameCount; ++i) {
+                output[i] = noiseDist(rng);
+            }
+            return;
+        }
         
-        // Static random generator for noise
-        static std::mt19937 rng(std::chrono::steady_clock::now().time_since_epoch().count());
-        static std::uniform_real_distribution<float> noiseDist(-1.0f, 1.0f);
+        // Build the phase ramp for the block, then shape it
+        float* phases = scratch.phases.data();
+        const float* increments = nullptr;
+        if (freqMod) {
+            kernels::phaseRampModulated(node.phase, phaseIncrement, freqMod, cyclesPerHz,
+                                        phases, scratch.increments.data(), frameCount);
+            increments = scratch.increments.data();
+        } else {
+            kernels::phaseRamp(node.phase, phaseIncrement, phases, frameCount);
+        }
         
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            switch (waveform) {
-                case Waveform::Sine:
-                    node.outputBuffer[i] = std::sin(node.phase);
-                    break;
-                    
-                case Waveform::Square:
-                    node.outputBuffer[i] = (node.phase < M_PI) ? 1.0f : -1.0f;
-                    break;
-                    
-                case Waveform::Saw:
-                    // Sawtooth: ramps from -1 to 1 over the period
-                    node.outputBuffer[i] = 2.0f * (node.phase / (2.0f * M_PI)) - 1.0f;
-                    break;
-                    
-                case Waveform::Triangle:
-                    // Triangle: ramps up then down
-                    if (node.phase < M_PI) {
-                        node.outputBuffer[i] = -1.0f + 2.0f * (node.phase / M_PI);
-                    } else {
-                        node.outputBuffer[i] = 3.0f - 2.0f * (node.phase / M_PI);
-                    }
-                    break;
-                    
-                case Waveform::Noise:
-                    // White noise
-                    node.outputBuffer[i] = noiseDist(rng);
-                    break;
-                    
-                default:
-                    // Default to sine
-                    node.outputBuffer[i] = std::sin(node.phase);
-                    break;
-            }
-            
-            node.phase += phaseIncrement;
-            
-            // Wrap phase
-            if (node.phase > 2.0f * M_PI) {
-                node.phase -= 2.0f * M_PI;
-            }
+        switch (waveform) {
+            case Waveform::Square:
+                kernels::square(phases, increments, phaseIncrement, output, frameCount);
+                break;
+                
+            case Waveform::Saw:
+                // Sawtooth: ramps from -1 to 1 over the period
+                kernels::saw(phases, increments, phaseIncrement, output, frameCount);
+                break;
+                
+            case Waveform::Triangle:
+                // Triangle: ramps up then down
+                kernels::triangle(phases, output, frameCount);
+                break;
+                
+            case Waveform::Sine:
+            default:
+                kernels::sine(phases, output, frameCount);
+                break;
         }
     }
 
-    void TaffyAudioProcessor::processAmplifier(NodeState& node, uint32_t frameCount) {
+    void TaffyAudioProcessor::processAmplifier(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        float* output = scratch.output(step.nodeSlot);
         // Get amplitude from parameter
-        float amplitude = 1.0f; // Default
-        
-        // Get parameter based on node's param_offset
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    const auto& param = parameterList_[paramIdx];
-                    if (param.param.name_hash == Taffy::fnv1a_hash("amplitude")) {
-                        amplitude = param.currentValue;
-                    }
-                }
-            }
-        }
-        
-        // Debug
-        static int ampProcessDebug = 0;
-        if (ampProcessDebug < 3) {
-            //std::cout << "🎚️ Amplifier " << node.node.id << " processing: amplitude=" << amplitude << std::endl;
-            //std::cout << "   Parameters at offset " << node.node.param_offset << ":" << std::endl;
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    const auto& param = parameterList_[paramIdx];
-                    //std::cout << "     Param " << paramIdx << ": value=" << param.currentValue 
-                    //          << " (hash=0x" << std::hex << param.param.name_hash << std::dec << ")" << std::endl;
-                }
-            }
-            ampProcessDebug++;
-        }
+        float amplitude = planParameter(voice, step, NodeParam::Amplitude, 1.0f);
 
-        // Process each sample
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            // Get audio input (input 0)
-            float audioInput = 0.0f;
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 0) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        // Bounds check before accessing outputBuffer
-                        if (i < srcIt->second.outputBuffer.size()) {
-                            audioInput += srcIt->second.outputBuffer[i] * conn.strength;
-                        }
-                    }
-                }
-            }
-            
-            // Get modulation input (input 1) if available
-            float modulation = 1.0f;
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 1) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        // Bounds check before accessing outputBuffer
-                        if (i < srcIt->second.outputBuffer.size()) {
-                            modulation = srcIt->second.outputBuffer[i] * conn.strength;
-                            break; // Only use first modulation input
-                        }
-                    }
-                }
-            }
-            
-            // Apply amplification with modulation
-            node.outputBuffer[i] = audioInput * amplitude * modulation;
+        // Audio input (input 0) and per-sample gain modulation (input 1) if available
+        const float* audioInput = getNodeInput(scratch, step, 0, frameCount);
+        const float* modulation = getNodeInput(scratch, step, 1, frameCount);
+
+        if (!audioInput) {
+            std::memset(output, 0, frameCount * sizeof(float));
+            return;
         }
-        
-        // Debug: Check if amplifier received any input
-        if (ampProcessDebug <= 3) {
-            float maxInput = 0.0f;
-            for (uint32_t i = 0; i < frameCount; ++i) {
-                // Check input again for max
-                float audioInput = 0.0f;
-                for (const auto& conn : connections_) {
-                    if (conn.destNode == node.node.id && conn.destInput == 0) {
-                        auto srcIt = nodes_.find(conn.sourceNode);
-                        if (srcIt != nodes_.end() && i < srcIt->second.outputBuffer.size()) {
-                            audioInput += srcIt->second.outputBuffer[i] * conn.strength;
-                        }
-                    }
-                }
-                maxInput = std::max(maxInput, std::abs(audioInput));
-            }
-            //std::cout << "   Max input to amplifier: " << maxInput << std::endl;
-            //std::cout << "   Max output from amplifier: " << std::max(maxInput * amplitude, 0.0f) << std::endl;
+
+        // Apply amplification with modulation
+        if (modulation) {
+            kernels::multiplyScaled(audioInput, modulation, amplitude, output, frameCount);
+        } else {
+            kernels::scale(audioInput, amplitude, output, frameCount);
         }
     }
 
-    void TaffyAudioProcessor::processParameter(NodeState& node, uint32_t frameCount) {
+    void TaffyAudioProcessor::processParameter(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        const Taffy::AudioChunk::Node& nodeInfo = nodes_[step.nodeSlot];
+        float* output = scratch.output(step.nodeSlot);
         // Parameters output their current value
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
+        if (nodeInfo.param_count > 0 && nodeInfo.param_offset < parameterList_.size()) {
             // Get the parameter value
             float value = 0.0f;
             uint64_t paramHash = 0;
             
-            if (node.node.param_offset < parameterList_.size()) {
-                const auto& param = parameterList_[node.node.param_offset];
-                value = param.currentValue;
-                paramHash = param.param.name_hash;
+            if (nodeInfo.param_offset < parameterList_.size()) {
+                value = voice.parameters[nodeInfo.param_offset];
+                paramHash = parameterList_[nodeInfo.param_offset].name_hash;
             }
             
             // Special handling for gate parameter - use parameter value directly
             if (paramHash == Taffy::fnv1a_hash("gate")) {
                 // Output the actual parameter value
-                static int gateDebugCount = 0;
-                if (gateDebugCount < 10) {
-                    //std::cout << "⚡ Gate parameter node " << node.node.id << " outputting: " << value << std::endl;
+                static std::atomic<int> gateDebugCount{0};
+                if (gateDebugCount.load(std::memory_order_relaxed) < 10) {
+                    //std::cout << "⚡ Gate parameter node " << nodeInfo.id << " outputting: " << value << std::endl;
                     //std::cout << "   Output buffer size: " << node.outputBuffer.size() << ", frameCount: " << frameCount << std::endl;
                     
                     // Find what's connected to this parameter node
-                    //std::cout << "   Connections FROM this node:" << std::endl;
-                    for (const auto& conn : connections_) {
-                        if (conn.sourceNode == node.node.id) {
-                            //std::cout << "     -> Node " << conn.destNode << " input " << conn.destInput 
-                            //         << " (strength=" << conn.strength << ")" << std::endl;
-                        }
-                    }
-                    gateDebugCount++;
+                    gateDebugCount.fetch_add(1, std::memory_order_relaxed);
                 }
                 for (uint32_t i = 0; i < frameCount; ++i) {
-                    node.outputBuffer[i] = value;
+                    output[i] = value;
                 }
                 
                 // Verify what we wrote
-                if (gateDebugCount <= 10 && value != 0.0f) {
-                    //std::cout << "   Verified output[0] = " << node.outputBuffer[0] 
-                    //         << ", output[" << (frameCount-1) << "] = " << node.outputBuffer[frameCount-1] << std::endl;
+                if (gateDebugCount.load(std::memory_order_relaxed) <= 10 && value != 0.0f) {
+                    //std::cout << "   Verified output[0] = " << output[0] 
+                    //         << ", output[" << (frameCount-1) << "] = " << output[frameCount-1] << std::endl;
                 }
             } else {
                 // Normal parameter - constant value
-                std::fill(node.outputBuffer.begin(), node.outputBuffer.begin() + frameCount, value);
+                std::fill(output, output + frameCount, value);
             }
         }
     }
 
-    void TaffyAudioProcessor::processMixer(NodeState& node, uint32_t frameCount) {
+    void TaffyAudioProcessor::processMixer(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        const Taffy::AudioChunk::Node& nodeInfo = nodes_[step.nodeSlot];
+        float* output = scratch.output(step.nodeSlot);
         // Mixer combines multiple inputs with individual gain controls
         // The mixer can have any number of inputs (typically 2-8)
         
         // Clear output buffer first
-        std::memset(node.outputBuffer.data(), 0, frameCount * sizeof(float));
-        
-        // Get gain parameters for this mixer from parameter list
-        std::vector<float> inputGains(node.node.input_count, 1.0f); // Default to unity
-        float masterGain = 1.0f;
-        
-        // Get parameters based on node's param_offset
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    const auto& param = parameterList_[paramIdx];
-                    
-                    // Check for gain_0, gain_1, etc.
-                    for (uint32_t input = 0; input < node.node.input_count; ++input) {
-                        std::string gainParamName = "gain_" + std::to_string(input);
-                        if (param.param.name_hash == Taffy::fnv1a_hash(gainParamName.c_str())) {
-                            inputGains[input] = param.currentValue;
-                        }
-                    }
-                    
-                    // Check for master gain
-                    if (param.param.name_hash == Taffy::fnv1a_hash("master_gain")) {
-                        masterGain = param.currentValue;
-                    }
-                }
-            }
-        }
+        std::memset(output, 0, frameCount * sizeof(float));
         
-        // Process each frame
-        for (uint32_t frame = 0; frame < frameCount; ++frame) {
-            float mixedSample = 0.0f;
-            
-            // Sum all inputs with their gains
-            for (uint32_t input = 0; input < node.node.input_count; ++input) {
-                // Find and sum input connections
-                for (const auto& conn : connections_) {
-                    if (conn.destNode == node.node.id && conn.destInput == input) {
-                        auto srcIt = nodes_.find(conn.sourceNode);
-                        if (srcIt != nodes_.end()) {
-                            // Use pre-calculated input gain
-                            mixedSample += srcIt->second.outputBuffer[frame] * conn.strength * inputGains[input];
-                        }
-                    }
-                }
-            }
-            
-            // Apply master gain and store result
-            node.outputBuffer[frame] = mixedSample * masterGain;
+        // Get gain parameters for this mixer (resolved per input in the execution plan)
+        float masterGain = planParameter(voice, step, NodeParam::MasterGain, 1.0f);
+        const uint32_t* gainParams = plan_.gainParams.data() + step.gainBegin;
+        
+        // Sum all connected inputs with their gains, master gain folded in
+        uint32_t inputCount = std::min(step.portCount, nodeInfo.input_count);
+        for (uint32_t inputIndex = 0; inputIndex < inputCount; ++inputIndex) {
+            const float* source = getNodeInput(scratch, step, inputIndex, frameCount);
+            if (!source) continue;
+            uint32_t gainIndex = gainParams[inputIndex];
+            float gain = gainIndex != kInvalidIndex ? voice.parameters[gainIndex] : 1.0f;
+            kernels::accumulate(source, gain * masterGain, output, frameCount);
         }
     }
 
-    void TaffyAudioProcessor::processEnvelope(NodeState& node, uint32_t frameCount) {
+    void TaffyAudioProcessor::processEnvelope(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        NodeState& node = voice.nodes[step.nodeSlot];
+        float* output = scratch.output(step.nodeSlot);
         // ADSR Envelope generator
         // Parameters: attack, decay, sustain, release
         // Input 0: Gate signal (0 or 1)
         
-        // Get ADSR parameters from parameter list
-        float attack = 0.01f;   // Default 10ms
-        float decay = 0.1f;     // Default 100ms
-        float sustain = 0.7f;   // Default 70%
-        float release = 0.2f;   // Default 200ms
-        
-        // Get parameters based on node's param_offset
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    const auto& param = parameterList_[paramIdx];
-                    
-                    if (param.param.name_hash == Taffy::fnv1a_hash("attack")) {
-                        attack = param.currentValue;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("decay")) {
-                        decay = param.currentValue;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("sustain")) {
-                        sustain = param.currentValue;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("release")) {
-                        release = param.currentValue;
-                    }
-                }
-            }
-        }
+        // Get ADSR parameters (resolved in the execution plan)
+        float attack = planParameter(voice, step, NodeParam::Attack, 0.01f);    // Default 10ms
+        float decay = planParameter(voice, step, NodeParam::Decay, 0.1f);       // Default 100ms
+        float sustain = planParameter(voice, step, NodeParam::Sustain, 0.7f);   // Default 70%
+        float release = planParameter(voice, step, NodeParam::Release, 0.2f);   // Default 200ms
+        
+        // Gate input (input 0)
+        const float* gateInput = getNodeInput(scratch, step, 0, frameCount);
         
         // Process each sample
         float sampleTime = 1.0f / static_cast<float>(sample_rate_);
         
         for (uint32_t i = 0; i < frameCount; ++i) {
             // Get gate input (input 0)
-            float gate = 0.0f;
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 0) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        gate = srcIt->second.outputBuffer[i] * conn.strength;
-                        break;
-                    }
-                }
-            }
+            float gate = gateInput ? gateInput[i] : 0.0f;
             
             // Detect gate edges
             bool gateOn = gate > 0.5f;
@@ -1205,19 +1284,19 @@ namespace tremor::audio {
                         node.envLevel = releaseStart * (1.0f - releaseProgress);
                         
                         // Debug output for first few samples of release
-                        static int releaseDebugCount = 0;
-                        if (releaseDebugCount < 5) {
+                        static std::atomic<int> releaseDebugCount{0};
+                        if (releaseDebugCount.load(std::memory_order_relaxed) < 5) {
                             //std::cout << "Release: start=" << releaseStart 
                             //         << " progress=" << releaseProgress 
                             //         << " level=" << node.envLevel << std::endl;
-                            releaseDebugCount++;
+                            releaseDebugCount.fetch_add(1, std::memory_order_relaxed);
                         }
                         
                         if (releaseProgress >= 1.0f) {
                             node.envLevel = 0.0f;
                             node.envPhase = EnvelopePhase::Off;
                             node.envTime = 0.0f;
-                            releaseDebugCount = 0; // Reset debug counter
+                            releaseDebugCount.store(0, std::memory_order_relaxed); // Reset debug counter
                         }
                     } else {
                         // Instant release
@@ -1233,252 +1312,91 @@ namespace tremor::audio {
                     break;
             }
             
-            // Update time in current phase
-            if (node.envPhase != EnvelopePhase::Off) {
-                node.envTime += sampleTime;
-            }
-            
-            // Output the envelope level
-            node.outputBuffer[i] = node.envLevel;
-            
-            // Only update lastValue when NOT in release phase
-            // (we need to preserve the release start level)
-            if (node.envPhase != EnvelopePhase::Release) {
-                node.lastValue = node.envLevel;
-            }
-        }
-    }
-
-    void TaffyAudioProcessor::processFilter(NodeState& node, uint32_t frameCount) {
-        // Biquad filter implementation supporting lowpass, highpass, and bandpass
-        // Parameters: cutoff, resonance, type
-        // Input 0: Audio signal
-        // Input 1: Cutoff modulation (optional)
-        
-        // Get filter parameters from parameter list
-        float cutoff = 1000.0f;     // Default 1kHz
-        float resonance = 0.707f;   // Default Q (no resonance peak)
-        float filterType = 0.0f;    // Default to lowpass
-        
-        // Get parameters based on node's param_offset
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    const auto& param = parameterList_[paramIdx];
-                    
-                    if (param.param.name_hash == Taffy::fnv1a_hash("cutoff")) {
-                        cutoff = param.currentValue;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("resonance")) {
-                        resonance = param.currentValue;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("type")) {
-                        filterType = param.currentValue;
-                    }
-                }
-            }
-        }
-        
-        FilterType type = static_cast<FilterType>(static_cast<uint32_t>(filterType));
-        
-        // Calculate filter coefficients (Robert Bristow-Johnson's cookbook formulas)
-        float omega = 2.0f * M_PI * cutoff / static_cast<float>(sample_rate_);
-        float sin_omega = std::sin(omega);
-        float cos_omega = std::cos(omega);
-        float alpha = sin_omega / (2.0f * resonance);
-        
-        float a0, a1, a2, b0, b1, b2;
-        
-        switch (type) {
-            case FilterType::Lowpass:
-                b0 = (1.0f - cos_omega) / 2.0f;
-                b1 = 1.0f - cos_omega;
-                b2 = (1.0f - cos_omega) / 2.0f;
-                a0 = 1.0f + alpha;
-                a1 = -2.0f * cos_omega;
-                a2 = 1.0f - alpha;
-                break;
-                
-            case FilterType::Highpass:
-                b0 = (1.0f + cos_omega) / 2.0f;
-                b1 = -(1.0f + cos_omega);
-                b2 = (1.0f + cos_omega) / 2.0f;
-                a0 = 1.0f + alpha;
-                a1 = -2.0f * cos_omega;
-                a2 = 1.0f - alpha;
-                break;
-                
-            case FilterType::Bandpass:
-                b0 = sin_omega / 2.0f;  // Or alpha for constant peak gain
-                b1 = 0.0f;
-                b2 = -sin_omega / 2.0f; // Or -alpha
-                a0 = 1.0f + alpha;
-                a1 = -2.0f * cos_omega;
-                a2 = 1.0f - alpha;
-                break;
-                
-            default:
-                // Passthrough (no filtering)
-                b0 = 1.0f;
-                b1 = 0.0f;
-                b2 = 0.0f;
-                a0 = 1.0f;
-                a1 = 0.0f;
-                a2 = 0.0f;
-                break;
-        }
-        
-        // Normalize coefficients
-        b0 /= a0;
-        b1 /= a0;
-        b2 /= a0;
-        a1 /= a0;
-        a2 /= a0;
-        
-        // Process each sample using the biquad difference equation
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            // Get audio input (input 0)
-            float input = 0.0f;
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 0) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        input += srcIt->second.outputBuffer[i] * conn.strength;
-                    }
-                }
-            }
-            
-            // Get cutoff modulation (input 1) if available
-            float cutoffMod = 0.0f;
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 1) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        cutoffMod = srcIt->second.outputBuffer[i] * conn.strength;
-                        break;
-                    }
-                }
-            }
-            
-            // Apply cutoff modulation if present
-            if (cutoffMod != 0.0f) {
-                // Recalculate coefficients with modulated cutoff
-                float modCutoff = cutoff + cutoffMod;
-                modCutoff = std::max(20.0f, std::min(20000.0f, modCutoff)); // Clamp to audio range
-                
-                float modOmega = 2.0f * M_PI * modCutoff / static_cast<float>(sample_rate_);
-                float modSinOmega = std::sin(modOmega);
-                float modCosOmega = std::cos(modOmega);
-                float modAlpha = modSinOmega / (2.0f * resonance);
-                
-                // Recalculate coefficients based on filter type
-                switch (type) {
-                    case FilterType::Lowpass:
-                        b0 = (1.0f - modCosOmega) / 2.0f;
-                        b1 = 1.0f - modCosOmega;
-                        b2 = (1.0f - modCosOmega) / 2.0f;
-                        a0 = 1.0f + modAlpha;
-                        a1 = -2.0f * modCosOmega;
-                        a2 = 1.0f - modAlpha;
-                        break;
-                        
-                    case FilterType::Highpass:
-                        b0 = (1.0f + modCosOmega) / 2.0f;
-                        b1 = -(1.0f + modCosOmega);
-                        b2 = (1.0f + modCosOmega) / 2.0f;
-                        a0 = 1.0f + modAlpha;
-                        a1 = -2.0f * modCosOmega;
-                        a2 = 1.0f - modAlpha;
-                        break;
-                        
-                    case FilterType::Bandpass:
-                        b0 = modSinOmega / 2.0f;
-                        b1 = 0.0f;
-                        b2 = -modSinOmega / 2.0f;
-                        a0 = 1.0f + modAlpha;
-                        a1 = -2.0f * modCosOmega;
-                        a2 = 1.0f - modAlpha;
-                        break;
-                }
-                
-                // Re-normalize
-                b0 /= a0;
-                b1 /= a0;
-                b2 /= a0;
-                a1 /= a0;
-                a2 /= a0;
+            // Update time in current phase
+            if (node.envPhase != EnvelopePhase::Off) {
+                node.envTime += sampleTime;
             }
             
-            // Apply biquad filter equation: y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
-            float output = b0 * input + b1 * node.x1 + b2 * node.x2 - a1 * node.y1 - a2 * node.y2;
-            
-            // Update delay elements
-            node.x2 = node.x1;     // x[n-2] = x[n-1]
-            node.x1 = input;       // x[n-1] = x[n]
-            node.y2 = node.y1;     // y[n-2] = y[n-1]
-            node.y1 = output;      // y[n-1] = y[n]
+            // Output the envelope level
+            output[i] = node.envLevel;
             
-            // Store output
-            node.outputBuffer[i] = output;
+            // Only update lastValue when NOT in release phase
+            // (we need to preserve the release start level)
+            if (node.envPhase != EnvelopePhase::Release) {
+                node.lastValue = node.envLevel;
+            }
+        }
+    }
+
+    void TaffyAudioProcessor::processFilter(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        NodeState& node = voice.nodes[step.nodeSlot];
+        float* output = scratch.output(step.nodeSlot);
+        // Biquad filter implementation supporting lowpass, highpass, and bandpass
+        // Parameters: cutoff, resonance, type
+        // Input 0: Audio signal
+        // Input 1: Cutoff modulation (optional)
+        
+        // Get filter parameters (resolved in the execution plan)
+        float cutoff = planParameter(voice, step, NodeParam::Cutoff, 1000.0f);        // Default 1kHz
+        float resonance = planParameter(voice, step, NodeParam::Resonance, 0.707f);   // Default Q (no resonance peak)
+        float filterType = planParameter(voice, step, NodeParam::Type, 0.0f);         // Default to lowpass
+        
+        FilterType type = static_cast<FilterType>(static_cast<uint32_t>(filterType));
+        kernels::BiquadShape shape = type <= FilterType::Bandpass
+            ? static_cast<kernels::BiquadShape>(type)
+            : kernels::BiquadShape::Passthrough;
+        
+        // Audio input (input 0) and cutoff modulation (input 1) if available
+        const float* audioInput = getNodeInput(scratch, step, 0, frameCount);
+        const float* cutoffMod = getNodeInput(scratch, step, 1, frameCount);
+        
+        kernels::BiquadState state{node.x1, node.x2, node.y1, node.y2};
+        if (cutoffMod) {
+            // Coefficients follow the modulated cutoff sample by sample
+            kernels::biquadModulated(shape, cutoff, cutoffMod, resonance, static_cast<float>(sample_rate_),
+                                     state, audioInput, output, frameCount);
+        } else {
+            // Calculate filter coefficients once for the block (Robert Bristow-Johnson's cookbook formulas)
+            kernels::BiquadCoefficients coefficients =
+                kernels::biquadCoefficients(shape, cutoff, resonance, static_cast<float>(sample_rate_));
+            kernels::biquad(coefficients, state, audioInput, output, frameCount);
         }
+        
+        node.x1 = state.x1;
+        node.x2 = state.x2;
+        node.y1 = state.y1;
+        node.y2 = state.y2;
     }
 
-    void TaffyAudioProcessor::processDistortion(NodeState& node, uint32_t frameCount) {
+    void TaffyAudioProcessor::processDistortion(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        NodeState& node = voice.nodes[step.nodeSlot];
+        float* output = scratch.output(step.nodeSlot);
         // Distortion effects processor
         // Parameters: drive, mix, type
         // Input 0: Audio signal
         
-        // Get distortion parameters from parameter list
-        float drive = 1.0f;      // Default unity gain
-        float mix = 1.0f;        // Default 100% wet
-        float distType = 0.0f;   // Default to hard clip
-        
-        // Get parameters based on node's param_offset
-        //std::cout << "🎸 Checking distortion node params: offset=" << node.node.param_offset 
-        //          << ", count=" << node.node.param_count << std::endl;
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    const auto& param = parameterList_[paramIdx];
-                    
-                    if (param.param.name_hash == Taffy::fnv1a_hash("drive")) {
-                        drive = param.currentValue;
-                        std::cout << "   Found drive param: " << drive << std::endl;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("mix")) {
-                        mix = param.currentValue;
-                        std::cout << "   Found mix param: " << mix << std::endl;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("type")) {
-                        distType = param.currentValue;
-                        std::cout << "   Found type param: " << distType << std::endl;
-                    }
-                }
-            }
-        }
+        // Get distortion parameters (resolved in the execution plan)
+        float drive = planParameter(voice, step, NodeParam::Drive, 1.0f);      // Default unity gain
+        float mix = planParameter(voice, step, NodeParam::Mix, 1.0f);          // Default 100% wet
+        float distType = planParameter(voice, step, NodeParam::Type, 0.0f);    // Default to hard clip
+        const float* audioInput = getNodeInput(scratch, step, 0, frameCount);
         
         DistortionType type = static_cast<DistortionType>(static_cast<uint32_t>(distType));
         
         // Debug log parameters
-        static bool debugPrinted = false;
-        if (!debugPrinted) {
+        static std::atomic<bool> debugPrinted{false};
+        if (!debugPrinted.load(std::memory_order_relaxed)) {
             std::cout << "🎸 Distortion parameters:" << std::endl;
             std::cout << "   Drive: " << drive << std::endl;
             std::cout << "   Mix: " << mix << std::endl;
             std::cout << "   Type: " << static_cast<uint32_t>(type) << std::endl;
-            debugPrinted = true;
+            debugPrinted.store(true, std::memory_order_relaxed);
         }
         
         // Process each sample
         for (uint32_t i = 0; i < frameCount; ++i) {
             // Get audio input (input 0)
-            float input = 0.0f;
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 0) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        input += srcIt->second.outputBuffer[i] * conn.strength;
-                    }
-                }
-            }
+            float input = audioInput ? audioInput[i] : 0.0f;
             
             // Store dry signal for mixing
             float dry = input;
@@ -1487,11 +1405,11 @@ namespace tremor::audio {
             float driven = input * drive;
             
             // Debug first few samples
-            static int sampleCount = 0;
-            if (sampleCount < 5) {
+            static std::atomic<int> sampleCount{0};
+            if (sampleCount.load(std::memory_order_relaxed) < 5) {
                 //std::cout << "Distortion sample " << sampleCount << ": input=" << input 
                 //         << ", driven=" << driven << ", drive=" << drive << std::endl;
-                sampleCount++;
+                sampleCount.fetch_add(1, std::memory_order_relaxed);
             }
             
             // Apply distortion based on type
@@ -1536,7 +1454,9 @@ namespace tremor::audio {
                     // 1-bit ZX Spectrum beeper emulation
                     // Pure on/off with hysteresis to prevent buzzing at zero crossings
                     {
-                        static float hysteresis = 0.0f;
+                        // Beeper state lives in the voice: lastValue holds the
+                        // hysteresis level and phase the buzz phase
+                        float& hysteresis = node.lastValue;
                         const float threshold = 0.1f; // Hysteresis threshold
                         
                         if (driven > threshold) {
@@ -1552,7 +1472,7 @@ namespace tremor::audio {
                         
                         // Add characteristic "beeper buzz" by slightly varying the output
                         // This simulates the mechanical response of the tiny speaker
-                        static float buzzPhase = 0.0f;
+                        float& buzzPhase = node.phase;
                         buzzPhase += 0.1f;
                         if (buzzPhase > 2.0f * M_PI) buzzPhase -= 2.0f * M_PI;
                         
@@ -1567,62 +1487,39 @@ namespace tremor::audio {
             }
             
             // Mix dry and wet signals
-            node.outputBuffer[i] = dry * (1.0f - mix) + wet * mix;
+            output[i] = dry * (1.0f - mix) + wet * mix;
         }
     }
 
-    void TaffyAudioProcessor::processSampler(NodeState& node, uint32_t frameCount) {
-        // Get parameters
-        uint32_t sampleIndex = 0;      // Which sample to play
-        float pitch = 1.0f;            // Pitch/speed multiplier
-        float startPos = 0.0f;         // Start position (0-1)
-        bool loop = false;             // Whether to loop
-        
-        static bool debugPrinted = false;
-        static int sampleDebugFrame = 0;
-        
-        // Get parameters based on node's param_offset
-        if (node.node.param_count > 0 && node.node.param_offset < parameterList_.size()) {
-            if (!debugPrinted) {
-                //std::cout << "🎛️ Sampler parameters: offset=" << node.node.param_offset 
-                //          << ", count=" << node.node.param_count << std::endl;
-            }
-            for (uint32_t i = 0; i < node.node.param_count; ++i) {
-                uint32_t paramIdx = node.node.param_offset + i;
-                if (paramIdx < parameterList_.size()) {
-                    const auto& param = parameterList_[paramIdx];
-                    
-                    if (!debugPrinted) {
-                    //   std::cout << "   Param[" << i << "]: hash=0x" << std::hex << param.param.name_hash 
-                    //              << std::dec << ", value=" << param.currentValue << std::endl;
-                    }
-                    
-                    if (param.param.name_hash == Taffy::fnv1a_hash("sample_index")) {
-                        sampleIndex = static_cast<uint32_t>(param.currentValue);
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("pitch")) {
-                        pitch = param.currentValue;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("start_position")) {
-                        startPos = param.currentValue;
-                    } else if (param.param.name_hash == Taffy::fnv1a_hash("loop")) {
-                        loop = param.currentValue > 0.5f;
-                    }
-                }
-            }
-        }
+    void TaffyAudioProcessor::processSampler(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        NodeState& node = voice.nodes[step.nodeSlot];
+        float* output = scratch.output(step.nodeSlot);
+        // Get parameters (resolved in the execution plan)
+        uint32_t sampleIndex = static_cast<uint32_t>(planParameter(voice, step, NodeParam::SampleIndex, 0.0f));  // Which sample to play
+        float pitch = planParameter(voice, step, NodeParam::Pitch, 1.0f);              // Pitch/speed multiplier
+        float startPos = planParameter(voice, step, NodeParam::StartPosition, 0.0f);   // Start position (0-1)
+        bool loop = planParameter(voice, step, NodeParam::Loop, 0.0f) > 0.5f;          // Whether to loop
+        
+        static std::atomic<bool> debugPrinted{false};
+        static std::atomic<int> sampleDebugFrame{0};
+        
+        // Trigger (input 0) and pitch modulation (input 1) if available
+        const float* triggerInput = getNodeInput(scratch, step, 0, frameCount);
+        const float* pitchInput = getNodeInput(scratch, step, 1, frameCount);
         
         // Validate sample index
         if (sampleIndex >= samples_.size()) {
-            if (!debugPrinted) {
+            if (!debugPrinted.load(std::memory_order_relaxed)) {
                 std::cout << "❌ Sampler: No samples loaded! samples_.size()=" << samples_.size() << std::endl;
-                debugPrinted = true;
+                debugPrinted.store(true, std::memory_order_relaxed);
             }
-            std::memset(node.outputBuffer.data(), 0, frameCount * sizeof(float));
+            std::memset(output, 0, frameCount * sizeof(float));
             return;
         }
         
         const SampleData& sample = samples_[sampleIndex];
         
-        if (!debugPrinted) {
+        if (!debugPrinted.load(std::memory_order_relaxed)) {
             /*std::cout << "🎵 Sampler: Processing sample " << sampleIndex << ", " 
                       << sample.data.size() << " samples, " 
                       << sample.channelCount << " channels" << std::endl;
@@ -1641,7 +1538,7 @@ namespace tremor::audio {
                 }
                 std::cout << std::endl;
             }*/
-            debugPrinted = true;
+            debugPrinted.store(true, std::memory_order_relaxed);
         }
         
         // Process each frame
@@ -1650,16 +1547,7 @@ namespace tremor::audio {
             // (removed the re-reading code that was overwriting with wrong value)
             
             // Get trigger input (input 0) - triggers playback on rising edge
-            float trigger = 0.0f;
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 0) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        trigger = srcIt->second.outputBuffer[i] * conn.strength;
-                        break;
-                    }
-                }
-            }
+            float trigger = triggerInput ? triggerInput[i] : 0.0f;
             
             // Detect rising edge for trigger OR keep playing if already playing
             if (trigger > 0.5f && node.lastTrigger <= 0.5f) {
@@ -1692,24 +1580,14 @@ namespace tremor::audio {
             node.lastTrigger = trigger;
             
             // Get pitch modulation input (input 1) if available
-            float pitchMod = 0.0f;
-            bool hasPitchMod = false;
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 1) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        pitchMod = srcIt->second.outputBuffer[i] * conn.strength;
-                        hasPitchMod = true;
-                        break;
-                    }
-                }
-            }
+            bool hasPitchMod = pitchInput != nullptr;
+            float pitchMod = hasPitchMod ? pitchInput[i] : 0.0f;
             
             // Apply pitch modulation (additive if connected, otherwise just use base pitch)
             float finalPitch = hasPitchMod ? (pitch + pitchMod) : pitch;
             
             // Debug pitch values
-            if (!debugPrinted) {
+            if (!debugPrinted.load(std::memory_order_relaxed)) {
                 std::cout << "   Pitch calculation: pitch=" << pitch << ", pitchMod=" << pitchMod 
                           << ", finalPitch=" << finalPitch << std::endl;
             }
@@ -1721,8 +1599,8 @@ namespace tremor::audio {
                 float playbackRate = finalPitch * sampleRateRatio;
                 
                 // Debug first time
-                static bool rateDebug = false;
-                if (!rateDebug || playbackRate == 0) {
+                static std::atomic<bool> rateDebug{false};
+                if (!rateDebug.load(std::memory_order_relaxed) || playbackRate == 0) {
                     std::cout << "📊 Sample playback calculation:" << std::endl;
                     std::cout << "   sample.sampleRate = " << sample.sampleRate << std::endl;
                     std::cout << "   sample_rate_ = " << sample_rate_ << std::endl;
@@ -1736,7 +1614,7 @@ namespace tremor::audio {
                         std::cout << "   ❌ ERROR: playbackRate is 0! Sample won't advance!" << std::endl;
                         std::cout << "   header_.sample_rate = " << header_.sample_rate << std::endl;
                     }
-                    rateDebug = true;
+                    rateDebug.store(true, std::memory_order_relaxed);
                 }
                 
                 // Get current sample position
@@ -1744,23 +1622,23 @@ namespace tremor::audio {
                 float fract = node.samplePosition - samplePos;
                 
                 // Debug: First few samples
-                static int sampleOutputDebug = 0;
-                if (sampleOutputDebug < 5 && node.isPlaying) {
-                    std::cout << "🎧 Sample output[" << sampleOutputDebug << "]: samplePos=" << samplePos 
+                static std::atomic<int> sampleOutputDebug{0};
+                if (sampleOutputDebug.load(std::memory_order_relaxed) < 5 && node.isPlaying) {
+                    std::cout << "🎧 Sample output[" << sampleOutputDebug.load(std::memory_order_relaxed) << "]: samplePos=" << samplePos 
                               << ", fract=" << fract << ", data.size()=" << sample.data.size() 
                               << ", channels=" << sample.channelCount << std::endl;
-                    sampleOutputDebug++;
+                    sampleOutputDebug.fetch_add(1, std::memory_order_relaxed);
                 }
                 
                 // Linear interpolation for smoother playback
-                float output = 0.0f;
+                float value = 0.0f;
                 if (sample.channelCount == 1) {
                     // Mono
                     if (samplePos < sample.data.size() - 1) {
-                        output = sample.data[samplePos] * (1.0f - fract) + 
+                        value = sample.data[samplePos] * (1.0f - fract) + 
                                 sample.data[samplePos + 1] * fract;
                     } else if (samplePos < sample.data.size()) {
-                        output = sample.data[samplePos];
+                        value = sample.data[samplePos];
                     }
                 } else {
                     // Stereo - mix to mono for now
@@ -1771,35 +1649,35 @@ namespace tremor::audio {
                                     sample.data[pos2] * fract;
                         float right = sample.data[pos1 + 1] * (1.0f - fract) + 
                                      sample.data[pos2 + 1] * fract;
-                        output = (left + right) * 0.5f;
+                        value = (left + right) * 0.5f;
                     }
                 }
                 
-                node.outputBuffer[i] = output;
+                output[i] = value;
                 
                 // Debug output for first few samples
-                if (sampleDebugFrame < 10 && output != 0.0f) {
+                if (sampleDebugFrame.load(std::memory_order_relaxed) < 10 && value != 0.0f) {
                     //std::cout << "Sample playback[" << i << "]: pos=" << node.samplePosition 
-                    //          << ", output=" << output << ", playbackRate=" << playbackRate << std::endl;
+                    //          << ", output=" << value << ", playbackRate=" << playbackRate << std::endl;
                 }
                 
                 // Debug: Check for pitch drift every 2 seconds
-                static float lastDebugTime = 0.0f;
-                static float lastPlaybackRate = -1.0f;
-                float currentTime = current_time_ + (i * 1.0f / static_cast<float>(sample_rate_));
-                if (currentTime - lastDebugTime > 2.0f && node.isPlaying) {
-                    if (lastPlaybackRate >= 0.0f && std::abs(playbackRate - lastPlaybackRate) > 0.0001f) {
+                static std::atomic<float> lastDebugTime{0.0f};
+                static std::atomic<float> lastPlaybackRate{-1.0f};
+                float currentTime = voice.currentTime + (i * 1.0f / static_cast<float>(sample_rate_));
+                if (currentTime - lastDebugTime.load(std::memory_order_relaxed) > 2.0f && node.isPlaying) {
+                    if (lastPlaybackRate.load(std::memory_order_relaxed) >= 0.0f && std::abs(playbackRate - lastPlaybackRate.load(std::memory_order_relaxed)) > 0.0001f) {
                         std::cout << "⚠️ PITCH DRIFT DETECTED at " << currentTime << "s: " 
-                                  << "playbackRate changed from " << lastPlaybackRate 
-                                  << " to " << playbackRate << " (delta=" << (playbackRate - lastPlaybackRate) << ")" << std::endl;
+                                  << "playbackRate changed from " << lastPlaybackRate.load(std::memory_order_relaxed) 
+                                  << " to " << playbackRate << " (delta=" << (playbackRate - lastPlaybackRate.load(std::memory_order_relaxed)) << ")" << std::endl;
                         std::cout << "   pitch=" << pitch << ", finalPitch=" << finalPitch 
                                   << ", sampleRateRatio=" << sampleRateRatio << std::endl;
                     } else {
                         std::cout << "🎵 Pitch check at " << currentTime << "s: pitch=" << pitch 
                                   << ", finalPitch=" << finalPitch << ", playbackRate=" << playbackRate << std::endl;
                     }
-                    lastPlaybackRate = playbackRate;
-                    lastDebugTime = currentTime;
+                    lastPlaybackRate.store(playbackRate, std::memory_order_relaxed);
+                    lastDebugTime.store(currentTime, std::memory_order_relaxed);
                 }
                 
                 // Advance position
@@ -1809,14 +1687,14 @@ namespace tremor::audio {
                 uint32_t maxSamples = sample.data.size() / sample.channelCount;
                 
                 // Debug: Log position info for first few frames
-                static int posDebug = 0;
-                if (posDebug < 10) {
-                    std::cout << "📍 Position debug[" << posDebug << "]: samplePos=" << node.samplePosition 
+                static std::atomic<int> posDebug{0};
+                if (posDebug.load(std::memory_order_relaxed) < 10) {
+                    std::cout << "📍 Position debug[" << posDebug.load(std::memory_order_relaxed) << "]: samplePos=" << node.samplePosition 
                               << ", maxSamples=" << maxSamples 
                               << ", playbackRate=" << playbackRate
                               << ", data.size()=" << sample.data.size()
                               << ", channels=" << sample.channelCount << std::endl;
-                    posDebug++;
+                    posDebug.fetch_add(1, std::memory_order_relaxed);
                 }
                 
                 if (loop && sample.hasLoop) {
@@ -1829,56 +1707,62 @@ namespace tremor::audio {
                 } else if (node.samplePosition >= maxSamples) {
                     // End of sample
                     node.isPlaying = false;
-                    node.outputBuffer[i] = 0.0f;
+                    output[i] = 0.0f;
                     if (node.samplePosition == maxSamples) { // Only print once
                         std::cout << "🛑 Sample playback ended at position " << node.samplePosition 
                                   << " (max=" << maxSamples << ")" << std::endl;
                     }
                 }
             } else {
-                node.outputBuffer[i] = 0.0f;
+                output[i] = 0.0f;
             }
         }
         
         // Increment debug frame counter
-        if (node.isPlaying && sampleDebugFrame < 10) {
-            sampleDebugFrame++;
+        if (node.isPlaying && sampleDebugFrame.load(std::memory_order_relaxed) < 10) {
+            sampleDebugFrame.fetch_add(1, std::memory_order_relaxed);
         }
     }
     
-    void TaffyAudioProcessor::processStreamingSampler(NodeState& node, uint32_t frameCount) {
-        static bool debugPrinted = false;
-        static int callCount = 0;
+    void TaffyAudioProcessor::processStreamingSampler(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount) {
+        NodeState& node = voice.nodes[step.nodeSlot];
+        const Taffy::AudioChunk::Node& nodeInfo = nodes_[step.nodeSlot];
+        float* output = scratch.output(step.nodeSlot);
+
+        // Memory-mapped streams keep all playback state in the voice. The
+        // mapping only changes under the exclusive graph lock, so no stream lock is needed.
+        if (!streamingAudios_.empty() && streamingAudios_[0].mapped.file) {
+            processMappedStreamingSampler(step, voice, scratch, frameCount, streamingAudios_[0].mapped);
+            return;
+        }
+
+        static std::atomic<bool> debugPrinted{false};
+        static std::atomic<int> callCount{0};
         
-        if (callCount++ < 10) {
+        if (callCount.fetch_add(1, std::memory_order_relaxed) < 10) {
             std::cout << "🎵 processStreamingSampler called! frameCount=" << frameCount 
-                      << ", node.id=" << node.node.id 
+                      << ", node.id=" << nodeInfo.id 
                       << ", streamingAudios_.size()=" << streamingAudios_.size() << std::endl;
         }
         
-        if (callCount < 5) {
+        if (callCount.load(std::memory_order_relaxed) < 5) {
             std::cout << "🎵 processStreamingSampler called! frameCount=" << frameCount 
-                      << ", node.id=" << node.node.id << std::endl;
-            callCount++;
-        }
-        
-        // Defensive: ensure output buffer is properly sized
-        if (node.outputBuffer.size() < frameCount) {
-            node.outputBuffer.resize(frameCount);
+                      << ", node.id=" << nodeInfo.id << std::endl;
+            callCount.fetch_add(1, std::memory_order_relaxed);
         }
         
         // Get parameters
         // For streaming samplers, the stream index is typically 0 (first streaming audio)
         // In the future, this could be stored in the node structure
         uint32_t streamIndex = 0; // Default to first streaming audio
-        float pitch = getNodeParameterValue(node, Taffy::fnv1a_hash("pitch"));
-        float startPos = getNodeParameterValue(node, Taffy::fnv1a_hash("start_position"));
+        float pitch = planParameter(voice, step, NodeParam::Pitch, 0.0f);
+        float startPos = planParameter(voice, step, NodeParam::StartPosition, 0.0f);
         
-        if (!debugPrinted) {
+        if (!debugPrinted.load(std::memory_order_relaxed)) {
             std::cout << "🎵 StreamingSampler: streamIndex=" << streamIndex 
                       << ", pitch=" << pitch << ", startPos=" << startPos << std::endl;
             std::cout << "   Available streams: " << streamingAudios_.size() << std::endl;
-            debugPrinted = true;
+            debugPrinted.store(true, std::memory_order_relaxed);
         }
         
         if (pitch == 0.0f) pitch = 1.0f; // Default pitch
@@ -1888,25 +1772,17 @@ namespace tremor::audio {
         {
             std::lock_guard<std::mutex> lock(streamingAudiosMutex_);
             if (streamIndex >= streamingAudios_.size()) {
-                if (!debugPrinted) {
+                if (!debugPrinted.load(std::memory_order_relaxed)) {
                     std::cout << "❌ No streaming audio at index " << streamIndex << std::endl;
                 }
-                // Ensure buffer is sized before memset
-                if (node.outputBuffer.size() < frameCount) {
-                    node.outputBuffer.resize(frameCount);
-                }
-                std::memset(node.outputBuffer.data(), 0, frameCount * sizeof(float));
+                std::memset(output, 0, frameCount * sizeof(float));
                 return;
             }
             streamPtr = &streamingAudios_[streamIndex];
         }
         
         if (!streamPtr) {
-            // Ensure buffer is sized before memset
-            if (node.outputBuffer.size() < frameCount) {
-                node.outputBuffer.resize(frameCount);
-            }
-            std::memset(node.outputBuffer.data(), 0, frameCount * sizeof(float));
+            std::memset(output, 0, frameCount * sizeof(float));
             return;
         }
         
@@ -1914,8 +1790,8 @@ namespace tremor::audio {
         
         // Check if we have either embedded data, file path, or TAF loader
         if (stream.filePath.empty() && stream.embeddedData == nullptr && !stream.tafLoader) {
-            static bool noDataWarned = false;
-            if (!noDataWarned) {
+            static std::atomic<bool> noDataWarned{false};
+            if (!noDataWarned.load(std::memory_order_relaxed)) {
                 std::cerr << "⚠️ StreamingSampler: No data source for stream!" << std::endl;
                 std::cerr << "   filePath: '" << stream.filePath << "'" << std::endl;
                 std::cerr << "   embeddedData: " << (stream.embeddedData ? "YES" : "NO") << std::endl;
@@ -1923,14 +1799,14 @@ namespace tremor::audio {
                 std::cerr << "   totalChunks: " << stream.totalChunks << std::endl;
                 std::cerr << "   dataOffset: " << stream.dataOffset << std::endl;
                 std::cerr << "   totalSamples: " << stream.totalSamples << std::endl;
-                noDataWarned = true;
+                noDataWarned.store(true, std::memory_order_relaxed);
             }
-            std::memset(node.outputBuffer.data(), 0, frameCount * sizeof(float));
+            std::memset(output, 0, frameCount * sizeof(float));
             return;
         }
         
         // Debug - we got past the data source check
-        if (callCount < 5) {
+        if (callCount.load(std::memory_order_relaxed) < 5) {
             std::cout << "✅ Got past data source check for stream" << std::endl;
         }
         
@@ -1942,7 +1818,7 @@ namespace tremor::audio {
             if (!stream.fileStream->is_open()) {
                 std::cerr << "❌ Failed to open streaming audio file: " << stream.filePath << std::endl;
                 std::cerr << "   Does file exist? " << std::filesystem::exists(stream.filePath) << std::endl;
-                std::memset(node.outputBuffer.data(), 0, frameCount * sizeof(float));
+                std::memset(output, 0, frameCount * sizeof(float));
                 return;
             }
             std::cout << "✅ File opened successfully!" << std::endl;
@@ -1987,24 +1863,24 @@ namespace tremor::audio {
         }
         
         // Debug streaming state at start
-        static int streamDebugCount = 0;
-        if (streamDebugCount < 5) {
-            std::cout << "🎙️ Processing StreamingSampler node " << node.node.id 
+        static std::atomic<int> streamDebugCount{0};
+        if (streamDebugCount.load(std::memory_order_relaxed) < 5) {
+            std::cout << "🎙️ Processing StreamingSampler node " << nodeInfo.id 
                       << ", frameCount=" << frameCount 
                       << ", streamIndex=" << streamIndex << std::endl;
-            std::cout << "   Node has " << node.node.input_count << " inputs" << std::endl;
+            std::cout << "   Node has " << nodeInfo.input_count << " inputs" << std::endl;
             std::cout << "   Looking for connections to this node..." << std::endl;
             for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id) {
+                if (conn.destNode == nodeInfo.id) {
                     std::cout << "   Found connection: " << conn.sourceNode << " -> " << conn.destNode 
                               << " (input " << conn.destInput << ")" << std::endl;
                 }
             }
-            streamDebugCount++;
+            streamDebugCount.fetch_add(1, std::memory_order_relaxed);
         }
         
         // Handle initial preload if needed
-        if (callCount < 5) {
+        if (callCount.load(std::memory_order_relaxed) < 5) {
             std::cout << "📋 Preload check: needsPreload=" << (stream.needsPreload ? "true" : "false") 
                       << ", tafLoader=" << (stream.tafLoader ? "YES" : "NO")
                       << ", totalChunks=" << stream.totalChunks << std::endl;
@@ -2023,73 +1899,49 @@ namespace tremor::audio {
         }
         
         // Debug connections for this node
-        static bool connDebugPrinted = false;
-        if (!connDebugPrinted) {
-            std::cout << "🔗 StreamingSampler node " << node.node.id << " connections:" << std::endl;
+        static std::atomic<bool> connDebugPrinted{false};
+        if (!connDebugPrinted.load(std::memory_order_relaxed)) {
+            std::cout << "🔗 StreamingSampler node " << nodeInfo.id << " connections:" << std::endl;
             for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id) {
+                if (conn.destNode == nodeInfo.id) {
                     std::cout << "   Input " << conn.destInput << " <- Node " << conn.sourceNode 
                               << " output " << conn.sourceOutput << std::endl;
                 }
             }
-            connDebugPrinted = true;
+            connDebugPrinted.store(true, std::memory_order_relaxed);
         }
         
         // Debug frame processing
-        if (callCount < 5) {
+        if (callCount.load(std::memory_order_relaxed) < 5) {
             std::cout << "📊 About to process " << frameCount << " frames for StreamingSampler" << std::endl;
         }
         
+        // Trigger input (input 0)
+        const float* triggerInput = getNodeInput(scratch, step, 0, frameCount);
+        
         // Process each frame
         for (uint32_t i = 0; i < frameCount; ++i) {
             // Get trigger input
             float trigger = 0.0f;
             
             // Debug first frame
-            static bool firstFrameDebug = false;
-            if (i == 0 && !firstFrameDebug) {
-                std::cout << "🔍 Checking trigger for StreamingSampler node " << node.node.id << std::endl;
+            static std::atomic<bool> firstFrameDebug{false};
+            if (i == 0 && !firstFrameDebug.load(std::memory_order_relaxed)) {
+                std::cout << "🔍 Checking trigger for StreamingSampler node " << nodeInfo.id << std::endl;
                 std::cout << "   Total connections: " << connections_.size() << std::endl;
-                firstFrameDebug = true;
+                firstFrameDebug.store(true, std::memory_order_relaxed);
             }
             
-            for (const auto& conn : connections_) {
-                if (conn.destNode == node.node.id && conn.destInput == 0) {
-                    auto srcIt = nodes_.find(conn.sourceNode);
-                    if (srcIt != nodes_.end()) {
-                        // Bounds check before accessing source buffer
-                        if (i < srcIt->second.outputBuffer.size()) {
-                            trigger = srcIt->second.outputBuffer[i] * conn.strength;
-                            
-                            // Debug trigger values
-                            static int triggerDebugCount = 0;
-                            if (triggerDebugCount < 20 && i == 0) {
-                                std::cout << "🎯 StreamingSampler node " << node.node.id 
-                                         << " reading trigger from node " << conn.sourceNode 
-                                         << ": buffer[" << i << "] = " << srcIt->second.outputBuffer[i]
-                                         << " * strength " << conn.strength 
-                                         << " = trigger " << trigger 
-                                         << " (lastTrigger: " << node.lastTrigger << ")" << std::endl;
-                                
-                                // Check source node type
-                                const char* srcTypeName = "Unknown";
-                                switch (srcIt->second.node.type) {
-                                    case Taffy::AudioChunk::NodeType::Parameter: srcTypeName = "Parameter"; break;
-                                    case Taffy::AudioChunk::NodeType::Oscillator: srcTypeName = "Oscillator"; break;
-                                    case Taffy::AudioChunk::NodeType::Envelope: srcTypeName = "Envelope"; break;
-                                    default: break;
-                                }
-                                std::cout << "     Source node type: " << srcTypeName << std::endl;
-                                triggerDebugCount++;
-                            }
-                        } else {
-                            std::cerr << "❌ Source buffer too small in StreamingSampler trigger: index=" << i 
-                                      << ", size=" << srcIt->second.outputBuffer.size() << std::endl;
-                        }
-                        break;
-                    } else {
-                        std::cerr << "❌ Source node " << conn.sourceNode << " not found!" << std::endl;
-                    }
+            if (triggerInput) {
+                trigger = triggerInput[i];
+                
+                // Debug trigger values
+                static std::atomic<int> triggerDebugCount{0};
+                if (triggerDebugCount.load(std::memory_order_relaxed) < 20 && i == 0) {
+                    std::cout << "🎯 StreamingSampler node " << nodeInfo.id 
+                             << " trigger = " << trigger 
+                             << " (lastTrigger: " << node.lastTrigger << ")" << std::endl;
+                    triggerDebugCount.fetch_add(1, std::memory_order_relaxed);
                 }
             }
             
@@ -2128,6 +1980,7 @@ namespace tremor::audio {
                 if (needsSyncLoad) {
                     // Need to load synchronously (causes hitch)
                     std::cout << "⚠️  Loading chunk " << stream.currentChunk << " synchronously (may cause hitch)" << std::endl;
+                    StreamingIOService::instance().reportUnderrun();
                     auto syncStart = std::chrono::high_resolution_clock::now();
                     preloadStreamingChunk(stream, stream.currentChunk);
                     auto syncEnd = std::chrono::high_resolution_clock::now();
@@ -2168,16 +2021,16 @@ namespace tremor::audio {
             // Generate output
             if (node.isPlaying) {
                 // Debug playing state
-                static int playingDebugCount = 0;
-                if (playingDebugCount < 10) {
+                static std::atomic<int> playingDebugCount{0};
+                if (playingDebugCount.load(std::memory_order_relaxed) < 10) {
                     std::cout << "🎵 StreamingSampler is PLAYING! frame=" << i 
                               << ", chunkBuffer.size()=" << stream.chunkBuffer.size()
                               << ", bufferPosition=" << stream.bufferPosition << std::endl;
-                    playingDebugCount++;
+                    playingDebugCount.fetch_add(1, std::memory_order_relaxed);
                 }
                 
                 // Time the sample generation
-                static int timingCount = 0;
+                static std::atomic<int> timingCount{0};
                 auto sampleStart = std::chrono::high_resolution_clock::now();
                 
                 // Apply sample rate conversion for pitch
@@ -2196,13 +2049,13 @@ namespace tremor::audio {
                     std::lock_guard<std::mutex> lock(stream.bufferMutex);
                     
                     // Debug buffer state
-                    static int bufferDebugCount = 0;
-                    if (bufferDebugCount < 10) {
+                    static std::atomic<int> bufferDebugCount{0};
+                    if (bufferDebugCount.load(std::memory_order_relaxed) < 10) {
                         std::cout << "📊 Buffer state: size=" << stream.chunkBuffer.size() 
                                   << ", pos=" << pos << ", channels=" << stream.channelCount
                                   << ", currentChunk=" << stream.currentChunk 
                                   << ", totalChunks=" << stream.totalChunks << std::endl;
-                        bufferDebugCount++;
+                        bufferDebugCount.fetch_add(1, std::memory_order_relaxed);
                     }
                     
                     // Bounds check
@@ -2224,33 +2077,20 @@ namespace tremor::audio {
                             sample = s1 * (1.0f - frac) + s2 * frac;
                         }
                     } else {
-                        if (bufferDebugCount <= 10) {
+                        if (bufferDebugCount.load(std::memory_order_relaxed) <= 10) {
                             std::cout << "⚠️ Buffer empty or invalid!" << std::endl;
                         }
                     }
                 }
                 
-                // Bounds check before writing to output buffer
-                if (i >= node.outputBuffer.size()) {
-                    std::cerr << "❌ StreamingSampler output buffer overrun! index=" << i 
-                              << ", buffer size=" << node.outputBuffer.size() 
-                              << ", frameCount=" << frameCount << std::endl;
-                    // Resize the buffer to prevent crash
-                    node.outputBuffer.resize(frameCount, 0.0f);
-                }
-                
-                if (i < node.outputBuffer.size()) {
-                    node.outputBuffer[i] = sample;
-                } else {
-                    std::cerr << "❌ Still can't write to output buffer after resize!" << std::endl;
-                    break;
-                }
+                // Render scratch always covers the whole block
+                output[i] = sample;
                 
                 // Debug output
-                static int outputDebugCounter = 0;
-                if (outputDebugCounter < 100 && sample != 0.0f) {
+                static std::atomic<int> outputDebugCounter{0};
+                if (outputDebugCounter.load(std::memory_order_relaxed) < 100 && sample != 0.0f) {
                     std::cout << "🔊 StreamingSampler output[" << i << "] = " << sample << std::endl;
-                    outputDebugCounter++;
+                    outputDebugCounter.fetch_add(1, std::memory_order_relaxed);
                 }
                 
                 // Advance position
@@ -2261,24 +2101,24 @@ namespace tremor::audio {
                 stream.bufferPosition = absoluteSamplePos - chunkStartSample;
                 
                 // Debug buffer position advancement
-                static int posDebugCount = 0;
-                if (posDebugCount < 20 && i < 5) {
+                static std::atomic<int> posDebugCount{0};
+                if (posDebugCount.load(std::memory_order_relaxed) < 20 && i < 5) {
                     std::cout << "📍 Frame " << i << ": samplePos=" << node.samplePosition 
                               << ", absPos=" << absoluteSamplePos 
                               << ", chunk=" << stream.currentChunk 
                               << ", bufferPos=" << stream.bufferPosition 
                               << ", playbackRate=" << playbackRate << std::endl;
-                    posDebugCount++;
+                    posDebugCount.fetch_add(1, std::memory_order_relaxed);
                 }
                 
                 // Debug chunk boundaries
-                static uint32_t lastChunk = 0;
+                static std::atomic<uint32_t> lastChunk{0};
                 uint32_t currentSampleChunk = static_cast<uint32_t>(node.samplePosition / stream.chunkSize);
-                if (currentSampleChunk != lastChunk && i < 100) {
+                if (currentSampleChunk != lastChunk.load(std::memory_order_relaxed) && i < 100) {
                     std::cout << "📍 Sample position " << node.samplePosition 
                               << " -> chunk " << currentSampleChunk 
                               << " (buffer pos: " << stream.bufferPosition << ")" << std::endl;
-                    lastChunk = currentSampleChunk;
+                    lastChunk.store(currentSampleChunk, std::memory_order_relaxed);
                 }
                 
                 // Check if we need to load next chunk
@@ -2307,6 +2147,7 @@ namespace tremor::audio {
                     if (!useAsync) {
                         // Need to load synchronously (causes hitch)
                         std::cout << "⚠️  Loading chunk " << stream.currentChunk << " synchronously (HITCH!)" << std::endl;
+                        StreamingIOService::instance().reportUnderrun();
                         auto syncStart = std::chrono::high_resolution_clock::now();
                         preloadStreamingChunk(stream, stream.currentChunk);
                         auto syncEnd = std::chrono::high_resolution_clock::now();
@@ -2337,14 +2178,138 @@ namespace tremor::audio {
                 }
             } else {
                 // Not playing, output silence
-                static int notPlayingDebugCount = 0;
-                if (notPlayingDebugCount < 5) {
+                static std::atomic<int> notPlayingDebugCount{0};
+                if (notPlayingDebugCount.load(std::memory_order_relaxed) < 5) {
                     std::cout << "🔇 StreamingSampler NOT playing, outputting silence for frame " << i << std::endl;
-                    notPlayingDebugCount++;
+                    notPlayingDebugCount.fetch_add(1, std::memory_order_relaxed);
+                }
+                output[i] = 0.0f;
+            }
+        }
+    }
+
+    void TaffyAudioProcessor::processMappedStreamingSampler(const PlanStep& step, VoiceState& voice, RenderScratch& scratch,
+                                                            uint32_t frameCount, const MappedAudioSource& source) {
+        NodeState& node = voice.nodes[step.nodeSlot];
+        MappedStreamCursor& cursor = voice.streamCursors[step.streamCursor];
+        float* output = scratch.output(step.nodeSlot);
+
+        float pitch = planParameter(voice, step, NodeParam::Pitch, 0.0f);
+        float startPos = planParameter(voice, step, NodeParam::StartPosition, 0.0f);
+        if (pitch == 0.0f) pitch = 1.0f; // Default pitch
+
+        // Apply sample rate conversion for pitch
+        double playbackRate = static_cast<double>(pitch) * sample_rate_ / source.sampleRate;
+
+        // Trigger input (input 0)
+        const float* triggerInput = getNodeInput(scratch, step, 0, frameCount);
+
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            float trigger = triggerInput ? triggerInput[i] : 0.0f;
+
+            // Restart playback on a rising trigger
+            if (trigger > 0.5f && node.lastTrigger <= 0.5f) {
+                node.isPlaying = true;
+                cursor.seek(source, static_cast<double>(startPos) * source.frameCount);
+            }
+            node.lastTrigger = trigger;
+
+            if (!node.isPlaying) {
+                output[i] = 0.0f;
+                continue;
+            }
+
+            output[i] = cursor.sample(source);
+            cursor.advance(playbackRate);
+
+            // Stop if we've reached the end
+            if (cursor.position() >= static_cast<double>(source.frameCount)) {
+                node.isPlaying = false;
+            }
+        }
+
+        node.samplePosition = static_cast<float>(cursor.position());
+    }
+
+    bool TaffyAudioProcessor::setStreamingTafFile(const std::string& tafPath) {
+        std::shared_ptr<MappedFile> file = MappedFile::open(tafPath);
+        if (!file) {
+            return false;
+        }
+
+        // Walk the chunk directory for AUDI chunks; the first one holds the graph
+        Taffy::AssetHeader assetHeader;
+        if (file->size() < sizeof(assetHeader)) {
+            std::cerr << "❌ Not a TAF file: " << tafPath << std::endl;
+            return false;
+        }
+        std::memcpy(&assetHeader, file->data(), sizeof(assetHeader));
+        size_t directoryEnd = sizeof(assetHeader) + static_cast<size_t>(assetHeader.chunk_count) * sizeof(Taffy::ChunkDirectoryEntry);
+        if (std::memcmp(assetHeader.magic, "TAF!", 4) != 0 || directoryEnd > file->size()) {
+            std::cerr << "❌ Invalid TAF header or chunk directory: " << tafPath << std::endl;
+            return false;
+        }
+
+        std::vector<Taffy::ChunkDirectoryEntry> audioChunks;
+        for (uint32_t i = 0; i < assetHeader.chunk_count; ++i) {
+            Taffy::ChunkDirectoryEntry entry;
+            std::memcpy(&entry, file->data() + sizeof(assetHeader) + i * sizeof(entry), sizeof(entry));
+            if (entry.type == Taffy::ChunkType::AUDI && entry.offset + entry.size <= file->size()) {
+                audioChunks.push_back(entry);
+            }
+        }
+        if (audioChunks.empty()) {
+            std::cerr << "❌ No audio chunks in " << tafPath << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::shared_mutex> lock(graphMutex_);
+        size_t mappedCount = 0;
+        {
+            std::lock_guard<std::mutex> vecLock(streamingAudiosMutex_);
+            for (auto& stream : streamingAudios_) {
+                MappedAudioSource source;
+                source.file = file;
+                source.frameCount = stream.totalSamples;
+                source.sampleRate = stream.sampleRate;
+                source.channelCount = stream.channelCount;
+                source.bitDepth = stream.bitDepth;
+                source.format = stream.format;
+
+                if (stream.totalChunks > 0 && stream.dataOffset == 0) {
+                    // Chunked TAF: audio chunk N follows the metadata chunk
+                    for (size_t c = 1; c < audioChunks.size() && c <= stream.totalChunks; ++c) {
+                        source.segmentOffsets.push_back(audioChunks[c].offset);
+                    }
+                    source.framesPerSegment = stream.chunkSize;
+                } else {
+                    // Embedded: PCM follows the graph inside the metadata chunk
+                    source.segmentOffsets.push_back(audioChunks[0].offset + stream.dataOffset);
+                    source.framesPerSegment = stream.totalSamples;
+                }
+
+                if (!source.valid()) {
+                    std::cerr << "⚠️ Stream layout doesn't fit " << tafPath << ", keeping buffered streaming" << std::endl;
+                    continue;
                 }
-                node.outputBuffer[i] = 0.0f;
+
+                // The mapping replaces the decoded chunks and the embedded copy
+                std::lock_guard<std::mutex> streamLock(stream.bufferMutex);
+                stream.mapped = std::move(source);
+                stream.embeddedDataCopy = {};
+                stream.embeddedData = nullptr;
+                stream.embeddedDataSize = 0;
+                stream.chunkBuffer = {};
+                stream.nextChunkBuffer = {};
+                stream.nextChunkReady = false;
+                stream.needsPreload = false;
+                ++mappedCount;
             }
         }
+        updateStreamSharing();
+
+        std::cout << "🗺️ Memory-mapped " << mappedCount << " streaming audios from " << tafPath << std::endl;
+        return mappedCount > 0;
     }
 
     void TaffyAudioProcessor::preloadStreamingChunk(StreamingAudioInfo& stream, uint32_t chunkIndex) {
@@ -2660,262 +2625,229 @@ namespace tremor::audio {
     }
 
     void TaffyAudioProcessor::clearLoadQueueForStream(StreamingAudioInfo* stream) {
-        std::lock_guard<std::mutex> lock(loaderMutex_);
+        // A submitted read can't be recalled, so it is orphaned instead: it sees the
+        // new generation, keeps its chunk to itself and only then lowers
+        // isLoadingNext, so the stream never has two reads in flight. Bumping
+        // under bufferMutex orders this against a read publishing its chunk.
+        std::lock_guard<std::mutex> lock(stream->bufferMutex);
+        stream->loadGeneration.fetch_add(1, std::memory_order_relaxed);
+        stream->nextChunkReady = false;
+    }
+
+    void TaffyAudioProcessor::readStreamingChunk(void* owner, void* key, uint32_t chunkIndex, uint32_t generation) {
+        static_cast<TaffyAudioProcessor*>(owner)->loadStreamingChunkInBackground(static_cast<StreamingAudioInfo*>(key),
+                                                                                 chunkIndex, generation);
+    }
+
+    void TaffyAudioProcessor::loadStreamingChunkInBackground(StreamingAudioInfo* stream, uint32_t chunkIndex, uint32_t generation) {
+        // Runs on a StreamingIOService thread
+        // Validate stream pointer and state
+        if (!stream) {
+            std::cout << "❌ Background loader: null stream pointer" << std::endl;
+            return;
+        }
+        
+        // For TAF chunks, we don't need a file path
+        if (stream->filePath.empty() && !stream->tafLoader) {
+            std::cout << "❌ Background loader: no file path and no TAF loader" << std::endl;
+            stream->isLoadingNext = false;
+            return;
+        }
+        
+        std::cout << "✅ Background loader: stream validation passed" << std::endl;
         
-        // Create a new queue without requests for this stream
-        std::queue<LoadRequest> newQueue;
-        while (!loadQueue_.empty()) {
-            LoadRequest req = loadQueue_.front();
-            loadQueue_.pop();
-            if (req.stream != stream) {
-                newQueue.push(req);
+        // Double-check the stream is still valid (not deallocated)
+        bool streamValid = false;
+        {
+            std::lock_guard<std::mutex> lock(streamingAudiosMutex_);
+            for (auto& s : streamingAudios_) {
+                if (&s == stream) {
+                    streamValid = true;
+                    break;
+                }
             }
         }
-        loadQueue_ = std::move(newQueue);
         
-        // Mark stream as not loading
-        stream->isLoadingNext = false;
+        if (!streamValid) {
+            std::cout << "⚠️ Stream pointer no longer valid, skipping load" << std::endl;
+            return;
+        } else {
+            std::cout << "✅ Stream found in streamingAudios_" << std::endl;
+        }
         
-        std::cout << "🧹 Cleared load queue for stream, remaining requests: " << loadQueue_.size() << std::endl;
-    }
-
-    void TaffyAudioProcessor::backgroundLoader() {
-        std::cout << "🚀 Background loader thread started" << std::endl;
+        // Orphaned by clearLoadQueueForStream before it started; skip the I/O
+        if (stream->loadGeneration.load(std::memory_order_relaxed) != generation) {
+            stream->isLoadingNext = false;
+            return;
+        }
         
-        while (!shouldStopLoader_) {
-            LoadRequest request;
-            
-            {
-                std::unique_lock<std::mutex> lock(loaderMutex_);
-                //std::cout << "🔄 Background loader waiting, queue size: " << loadQueue_.size() << std::endl;
+        // isLoadingNext was raised by preloadStreamingChunkAsync when the read was submitted
+        std::cout << "🔄 Background loading chunk " << chunkIndex << std::endl;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        
+        // Check if this is a chunked TAF first
+        if (stream->tafLoader && stream->totalChunks > 0) {
+            std::cout << "📀 Using TAF loader for chunk " << chunkIndex << std::endl;
+                // Load from chunked TAF
+                if (chunkIndex >= stream->totalChunks) {
+                    std::cerr << "❌ Background: Chunk index " << chunkIndex 
+                              << " exceeds total chunks " << stream->totalChunks << std::endl;
+                    stream->isLoadingNext = false;
+                    return;
+                }
                 
-                // Wait with timeout to prevent indefinite blocking
-                auto status = loaderCV_.wait_for(lock, std::chrono::seconds(5),
-                    [this] { return !loadQueue_.empty() || shouldStopLoader_; });
+                auto chunkData = stream->tafLoader->loadAudioChunk(chunkIndex);
+                if (chunkData.empty()) {
+                    std::cerr << "❌ Background: Failed to load chunk " << chunkIndex << std::endl;
+                    stream->isLoadingNext = false;
+                    return;
+                }
                 
-                if (shouldStopLoader_) break;
+                // Convert and store in next buffer
+                uint64_t bytesPerSample = stream->channelCount * (stream->bitDepth / 8);
+                uint32_t actualSamples = chunkData.size() / bytesPerSample;
+                size_t requiredSize = actualSamples * stream->channelCount;
                 
-                if (!status) {
-                    // Timeout occurred - this is normal when no loads are pending
-                    continue;
+                std::vector<float> tempBuffer;
+                try {
+                    tempBuffer.resize(requiredSize);
+                } catch (const std::exception& e) {
+                    std::cerr << "❌ Background: Failed to allocate buffer: " << e.what() << std::endl;
+                    stream->isLoadingNext = false;
+                    return;
                 }
                 
-                if (loadQueue_.empty()) {
-                    std::cout << "⚠️ Background loader woke up but queue is empty" << std::endl;
-                    continue;
+                // Convert data
+                const uint8_t* dataPtr = chunkData.data();
+                if (stream->format == 1) { // Float
+                    std::memcpy(tempBuffer.data(), dataPtr, requiredSize * sizeof(float));
+                } else if (stream->bitDepth == 16) { // 16-bit PCM
+                    const int16_t* pcmData = reinterpret_cast<const int16_t*>(dataPtr);
+                    for (size_t i = 0; i < requiredSize; ++i) {
+                        tempBuffer[i] = pcmData[i] / 32768.0f;
+                    }
+                } else if (stream->bitDepth == 24) { // 24-bit PCM
+                    for (size_t i = 0; i < requiredSize; ++i) {
+                        const uint8_t* sample = dataPtr + (i * 3);
+                        int32_t value = (sample[0] << 8) | (sample[1] << 16) | (sample[2] << 24);
+                        tempBuffer[i] = value / 2147483648.0f;
+                    }
+                } else if (stream->bitDepth == 32) { // 32-bit PCM
+                    const int32_t* pcmData = reinterpret_cast<const int32_t*>(dataPtr);
+                    for (size_t i = 0; i < requiredSize; ++i) {
+                        tempBuffer[i] = pcmData[i] / 2147483648.0f;
+                    }
                 }
                 
-                request = loadQueue_.front();
-                loadQueue_.pop();
-                std::cout << "📦 Background loader got request for chunk " << request.chunkIndex 
-                          << ", remaining in queue: " << loadQueue_.size() << std::endl;
-            }
-            
-            // Validate stream pointer and state
-            if (!request.stream) {
-                std::cout << "❌ Background loader: null stream pointer" << std::endl;
-                continue;
-            }
-            
-            // For TAF chunks, we don't need a file path
-            if (request.stream->filePath.empty() && !request.stream->tafLoader) {
-                std::cout << "❌ Background loader: no file path and no TAF loader" << std::endl;
-                continue;
-            }
-            
-            std::cout << "✅ Background loader: stream validation passed" << std::endl;
-            
-            // Double-check the stream is still valid (not deallocated)
-            bool streamValid = false;
-            {
-                std::lock_guard<std::mutex> lock(streamingAudiosMutex_);
-                for (auto& s : streamingAudios_) {
-                    if (&s == request.stream) {
-                        streamValid = true;
-                        break;
+                // Store in next chunk buffer, unless the read was orphaned meanwhile
+                {
+                    std::lock_guard<std::mutex> lock(stream->bufferMutex);
+                    if (stream->loadGeneration.load(std::memory_order_relaxed) == generation) {
+                        stream->nextChunkBuffer = std::move(tempBuffer);
+                        stream->nextChunkReady = true;
+                        stream->nextChunkIndex = chunkIndex;
                     }
                 }
+                
+                auto endTime = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+                std::cout << "✅ Background: Loaded chunk " << chunkIndex 
+                          << " from TAF in " << duration << "ms" << std::endl;
+                stream->isLoadingNext = false;
+                return;
             }
             
-            if (!streamValid) {
-                std::cout << "⚠️ Stream pointer no longer valid, skipping load" << std::endl;
-                continue;
-            } else {
-                std::cout << "✅ Stream found in streamingAudios_" << std::endl;
-            }
-            
-            // Load the chunk
-            bool wasAlreadyLoading = request.stream->isLoadingNext.exchange(true);
-            if (wasAlreadyLoading) {
-                std::cout << "⚠️ Chunk " << request.chunkIndex << " already being loaded, skipping" << std::endl;
-                continue;
-            }
-            
-            std::cout << "🔄 Background loading chunk " << request.chunkIndex << std::endl;
-            auto startTime = std::chrono::high_resolution_clock::now();
-            
-            // Check if this is a chunked TAF first
-            if (request.stream->tafLoader && request.stream->totalChunks > 0) {
-                std::cout << "📀 Using TAF loader for chunk " << request.chunkIndex << std::endl;
-                    // Load from chunked TAF
-                    if (request.chunkIndex >= request.stream->totalChunks) {
-                        std::cerr << "❌ Background: Chunk index " << request.chunkIndex 
-                                  << " exceeds total chunks " << request.stream->totalChunks << std::endl;
-                        request.stream->isLoadingNext = false;
-                        continue;
-                    }
-                    
-                    auto chunkData = request.stream->tafLoader->loadAudioChunk(request.chunkIndex);
-                    if (chunkData.empty()) {
-                        std::cerr << "❌ Background: Failed to load chunk " << request.chunkIndex << std::endl;
-                        request.stream->isLoadingNext = false;
-                        continue;
-                    }
-                    
-                    // Convert and store in next buffer
-                    uint64_t bytesPerSample = request.stream->channelCount * (request.stream->bitDepth / 8);
-                    uint32_t actualSamples = chunkData.size() / bytesPerSample;
-                    size_t requiredSize = actualSamples * request.stream->channelCount;
-                    
-                    std::vector<float> tempBuffer;
-                    try {
-                        tempBuffer.resize(requiredSize);
-                    } catch (const std::exception& e) {
-                        std::cerr << "❌ Background: Failed to allocate buffer: " << e.what() << std::endl;
-                        request.stream->isLoadingNext = false;
-                        continue;
-                    }
-                    
-                    // Convert data
-                    const uint8_t* dataPtr = chunkData.data();
-                    if (request.stream->format == 1) { // Float
-                        std::memcpy(tempBuffer.data(), dataPtr, requiredSize * sizeof(float));
-                    } else if (request.stream->bitDepth == 16) { // 16-bit PCM
-                        const int16_t* pcmData = reinterpret_cast<const int16_t*>(dataPtr);
-                        for (size_t i = 0; i < requiredSize; ++i) {
-                            tempBuffer[i] = pcmData[i] / 32768.0f;
-                        }
-                    } else if (request.stream->bitDepth == 24) { // 24-bit PCM
-                        for (size_t i = 0; i < requiredSize; ++i) {
-                            const uint8_t* sample = dataPtr + (i * 3);
-                            int32_t value = (sample[0] << 8) | (sample[1] << 16) | (sample[2] << 24);
-                            tempBuffer[i] = value / 2147483648.0f;
-                        }
-                    } else if (request.stream->bitDepth == 32) { // 32-bit PCM
-                        const int32_t* pcmData = reinterpret_cast<const int32_t*>(dataPtr);
-                        for (size_t i = 0; i < requiredSize; ++i) {
-                            tempBuffer[i] = pcmData[i] / 2147483648.0f;
-                        }
-                    }
-                    
-                    // Store in next chunk buffer
-                    {
-                        std::lock_guard<std::mutex> lock(request.stream->bufferMutex);
-                        request.stream->nextChunkBuffer = std::move(tempBuffer);
-                        request.stream->nextChunkReady = true;
-                        request.stream->nextChunkIndex = request.chunkIndex;
-                    }
-                    
-                    auto endTime = std::chrono::high_resolution_clock::now();
-                    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-                    std::cout << "✅ Background: Loaded chunk " << request.chunkIndex 
-                              << " from TAF in " << duration << "ms" << std::endl;
-                    request.stream->isLoadingNext = false;
-                    continue;
+            // Otherwise use file-based streaming
+            if (!stream->fileStream || !stream->fileStream->is_open()) {
+                stream->fileStream = std::make_unique<std::ifstream>(stream->filePath, std::ios::binary);
+                if (!stream->fileStream->is_open()) {
+                    std::cerr << "❌ Failed to open file in background loader" << std::endl;
+                    stream->isLoadingNext = false;
+                    return;
                 }
                 
-                // Otherwise use file-based streaming
-                if (!request.stream->fileStream || !request.stream->fileStream->is_open()) {
-                    request.stream->fileStream = std::make_unique<std::ifstream>(request.stream->filePath, std::ios::binary);
-                    if (!request.stream->fileStream->is_open()) {
-                        std::cerr << "❌ Failed to open file in background loader" << std::endl;
-                        request.stream->isLoadingNext = false;
-                        continue;
-                    }
-                    
-                    // If this is a WAV file, we need to find the data chunk offset
-                    if (request.stream->filePath.find(".wav") != std::string::npos) {
-                        // Read WAV header to find data chunk
-                        char buffer[4];
-                        request.stream->fileStream->read(buffer, 4);
-                        if (std::strncmp(buffer, "RIFF", 4) == 0) {
-                            request.stream->fileStream->seekg(12); // Skip RIFF header
-                            
-                            // Search for data chunk
-                            while (!request.stream->fileStream->eof()) {
-                                request.stream->fileStream->read(buffer, 4);
-                                if (std::strncmp(buffer, "data", 4) == 0) {
-                                    uint32_t dataSize;
-                                    request.stream->fileStream->read(reinterpret_cast<char*>(&dataSize), 4);
-                                    request.stream->dataOffset = request.stream->fileStream->tellg();
-                                    std::cout << "📍 Background loader: Found WAV data chunk at offset: " << request.stream->dataOffset << std::endl;
-                                    break;
-                                } else {
-                                    // Skip this chunk
-                                    uint32_t chunkSize;
-                                    request.stream->fileStream->read(reinterpret_cast<char*>(&chunkSize), 4);
-                                    request.stream->fileStream->seekg(chunkSize, std::ios::cur);
-                                }
+                // If this is a WAV file, we need to find the data chunk offset
+                if (stream->filePath.find(".wav") != std::string::npos) {
+                    // Read WAV header to find data chunk
+                    char buffer[4];
+                    stream->fileStream->read(buffer, 4);
+                    if (std::strncmp(buffer, "RIFF", 4) == 0) {
+                        stream->fileStream->seekg(12); // Skip RIFF header
+                        
+                        // Search for data chunk
+                        while (!stream->fileStream->eof()) {
+                            stream->fileStream->read(buffer, 4);
+                            if (std::strncmp(buffer, "data", 4) == 0) {
+                                uint32_t dataSize;
+                                stream->fileStream->read(reinterpret_cast<char*>(&dataSize), 4);
+                                stream->dataOffset = stream->fileStream->tellg();
+                                std::cout << "📍 Background loader: Found WAV data chunk at offset: " << stream->dataOffset << std::endl;
+                                break;
+                            } else {
+                                // Skip this chunk
+                                uint32_t chunkSize;
+                                stream->fileStream->read(reinterpret_cast<char*>(&chunkSize), 4);
+                                stream->fileStream->seekg(chunkSize, std::ios::cur);
                             }
                         }
                     }
                 }
-                
-                // Calculate chunk offset
-                uint64_t chunkOffset = request.stream->dataOffset + 
-                    (request.chunkIndex * request.stream->chunkSize * request.stream->channelCount * (request.stream->bitDepth / 8));
-                request.stream->fileStream->seekg(chunkOffset);
-                
-                // Validate parameters before allocating
-                if (request.stream->chunkSize == 0 || request.stream->channelCount == 0 || 
-                    request.stream->chunkSize > 1000000) {
-                    std::cerr << "❌ Invalid chunk parameters in background loader: chunkSize=" 
-                              << request.stream->chunkSize << ", channelCount=" 
-                              << request.stream->channelCount << std::endl;
-                    request.stream->isLoadingNext = false;
-                    continue;
-                }
-                
-                // Allocate temporary buffer
-                std::vector<float> tempBuffer;
-                try {
-                    tempBuffer.resize(request.stream->chunkSize * request.stream->channelCount);
-                } catch (const std::exception& e) {
-                    std::cerr << "❌ Failed to allocate buffer in background loader: " << e.what() << std::endl;
-                    request.stream->isLoadingNext = false;
-                    continue;
-                }
-                
-                // Read chunk data
-                if (request.stream->format == 1) { // Float format
-                    request.stream->fileStream->read(reinterpret_cast<char*>(tempBuffer.data()), 
-                                          request.stream->chunkSize * request.stream->channelCount * sizeof(float));
-                } else { // PCM format
-                    if (request.stream->bitDepth == 16) {
-                        std::vector<int16_t> pcmBuffer(request.stream->chunkSize * request.stream->channelCount);
-                        request.stream->fileStream->read(reinterpret_cast<char*>(pcmBuffer.data()), 
-                                              pcmBuffer.size() * sizeof(int16_t));
-                        // Convert to float - ensure buffer sizes match
-                        size_t sampleCount = std::min(pcmBuffer.size(), tempBuffer.size());
-                        for (size_t j = 0; j < sampleCount; ++j) {
-                            tempBuffer[j] = pcmBuffer[j] / 32768.0f;
-                        }
+            }
+            
+            // Calculate chunk offset
+            uint64_t chunkOffset = stream->dataOffset + 
+                (chunkIndex * stream->chunkSize * stream->channelCount * (stream->bitDepth / 8));
+            stream->fileStream->seekg(chunkOffset);
+            
+            // Validate parameters before allocating
+            if (stream->chunkSize == 0 || stream->channelCount == 0 || 
+                stream->chunkSize > 1000000) {
+                std::cerr << "❌ Invalid chunk parameters in background loader: chunkSize=" 
+                          << stream->chunkSize << ", channelCount=" 
+                          << stream->channelCount << std::endl;
+                stream->isLoadingNext = false;
+                return;
+            }
+            
+            // Allocate temporary buffer
+            std::vector<float> tempBuffer;
+            try {
+                tempBuffer.resize(stream->chunkSize * stream->channelCount);
+            } catch (const std::exception& e) {
+                std::cerr << "❌ Failed to allocate buffer in background loader: " << e.what() << std::endl;
+                stream->isLoadingNext = false;
+                return;
+            }
+            
+            // Read chunk data
+            if (stream->format == 1) { // Float format
+                stream->fileStream->read(reinterpret_cast<char*>(tempBuffer.data()), 
+                                      stream->chunkSize * stream->channelCount * sizeof(float));
+            } else { // PCM format
+                if (stream->bitDepth == 16) {
+                    std::vector<int16_t> pcmBuffer(stream->chunkSize * stream->channelCount);
+                    stream->fileStream->read(reinterpret_cast<char*>(pcmBuffer.data()), 
+                                          pcmBuffer.size() * sizeof(int16_t));
+                    // Convert to float - ensure buffer sizes match
+                    size_t sampleCount = std::min(pcmBuffer.size(), tempBuffer.size());
+                    for (size_t j = 0; j < sampleCount; ++j) {
+                        tempBuffer[j] = pcmBuffer[j] / 32768.0f;
                     }
                 }
-                
-                // Swap buffers under lock
-                {
-                    std::lock_guard<std::mutex> lock(request.stream->bufferMutex);
-                    request.stream->nextChunkBuffer = std::move(tempBuffer);
-                    request.stream->nextChunkReady = true;
-                    request.stream->nextChunkIndex = request.chunkIndex;
+            }
+            
+            // Swap buffers under lock, unless the read was orphaned meanwhile
+            {
+                std::lock_guard<std::mutex> lock(stream->bufferMutex);
+                if (stream->loadGeneration.load(std::memory_order_relaxed) == generation) {
+                    stream->nextChunkBuffer = std::move(tempBuffer);
+                    stream->nextChunkReady = true;
+                    stream->nextChunkIndex = chunkIndex;
                 }
-                
-                std::cout << "✅ Chunk " << request.chunkIndex << " loaded in background" << std::endl;
-                request.stream->isLoadingNext = false;
-        }
-        
-        std::cout << "🛑 Background loader thread stopped" << std::endl;
+            }
+            
+            std::cout << "✅ Chunk " << chunkIndex << " loaded in background" << std::endl;
+            stream->isLoadingNext = false;
     }
     
     void TaffyAudioProcessor::preloadStreamingChunkAsync(StreamingAudioInfo& stream, uint32_t chunkIndex) {
@@ -2936,27 +2868,24 @@ namespace tremor::audio {
             return;
         }
         
-        {
-            std::lock_guard<std::mutex> lock(loaderMutex_);
-            
-            // Clear any pending loads for this stream to avoid stale requests
-            std::queue<LoadRequest> newQueue;
-            while (!loadQueue_.empty()) {
-                LoadRequest req = loadQueue_.front();
-                loadQueue_.pop();
-                if (req.stream != &stream) {
-                    newQueue.push(req);
-                }
-            }
-            loadQueue_ = std::move(newQueue);
-            
-            // Add new request
-            loadQueue_.push({&stream, chunkIndex});
-            std::cout << "📮 Enqueued chunk " << chunkIndex << " for async loading, queue size: " 
-                      << loadQueue_.size() << std::endl;
+        // Deadline: when playback reaches the chunk, i.e. when the current buffer runs dry
+        uint64_t playFrame = static_cast<uint64_t>(stream.currentChunk) * stream.chunkSize + stream.bufferPosition;
+        uint64_t neededFrame = static_cast<uint64_t>(chunkIndex) * stream.chunkSize;
+        double secondsUntilNeeded = neededFrame > playFrame ? static_cast<double>(neededFrame - playFrame) / stream.sampleRate : 0.0;
+        
+        // isLoadingNext keeps this stream to one read in flight; a plain function
+        // pointer keeps the request free of allocations on the audio thread
+        StreamingIOService::Request request;
+        request.owner = this;
+        request.key = &stream;
+        request.chunkIndex = chunkIndex;
+        request.generation = stream.loadGeneration.load(std::memory_order_relaxed);
+        request.deadline = StreamingIOService::Clock::now() +
+            std::chrono::duration_cast<StreamingIOService::Clock::duration>(std::chrono::duration<double>(secondsUntilNeeded));
+        request.read = &TaffyAudioProcessor::readStreamingChunk;
+        if (!StreamingIOService::instance().submit(request)) {
+            stream.isLoadingNext = false;
         }
-        loaderCV_.notify_one();
-        std::cout << "🔔 Notified background loader" << std::endl;
     }
 
 } // namespace tremor::audio
\ No newline at end of file
@@ -1,17 +1,22 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <unordered_map>
 #include <memory>
 #include <cmath>
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <condition_variable>
 #include <queue>
 #include "include/taffy.h"
 #include "include/taffy_streaming.h"
 #include "logger.h"
+#include "taffy_parameter_queue.h"
+#include "taffy_mapped_stream.h"
+#include "taffy_stream_io.h"
 
 namespace tremor::audio {
 
@@ -52,16 +57,19 @@ namespace tremor::audio {
         void processAudio(float* outputBuffer, uint32_t frameCount, uint32_t channelCount = 2);
 
         /**
-         * Set a parameter value
+         * Queue a parameter change for the built-in voice
+         * Lock-free; call from a single producer thread. The change is applied
+         * by processAudio at the given sample of the next block.
          * @param parameterHash Hash of the parameter name
          * @param value New value
+         * @param sampleOffset Sample offset from the start of the next block
          */
-        void setParameter(uint64_t parameterHash, float value);
+        void setParameter(uint64_t parameterHash, float value, uint32_t sampleOffset = 0);
 
         /**
          * Get current time in seconds
          */
-        float getCurrentTime() const { return current_time_; }
+        float getCurrentTime() const { return voice_.currentTime; }
 
     private:
         // Waveform types for oscillators
@@ -110,11 +118,9 @@ namespace tremor::audio {
             Beeper = 5      // 1-bit ZX Spectrum style
         };
 
-        // Node processing state
+        // Mutable DSP state of one node in one voice
         struct NodeState {
-            Taffy::AudioChunk::Node node;
-            std::vector<float> outputBuffer;  // Output values for this node
-            float phase = 0.0f;              // For oscillators
+            float phase = 0.0f;              // Oscillator phase in cycles [0, 1)
             float lastValue = 0.0f;          // For filters, envelopes, etc.
             
             // Envelope specific state
@@ -145,43 +151,245 @@ namespace tremor::audio {
             float strength;
         };
 
-        // Parameter info
-        struct ParameterInfo {
-            Taffy::AudioChunk::Parameter param;
-            float currentValue;
+        // Named parameters a node processor reads, resolved to parameterList_ indices at compile time
+        enum class NodeParam : uint32_t {
+            Frequency = 0,
+            Waveform,
+            Amplitude,
+            MasterGain,
+            Attack,
+            Decay,
+            Sustain,
+            Release,
+            Cutoff,
+            Resonance,
+            Type,
+            Drive,
+            Mix,
+            SampleIndex,
+            Pitch,
+            StartPosition,
+            Loop,
+            Count
         };
 
+        static constexpr uint32_t kInvalidIndex = 0xFFFFFFFFu;
+        static constexpr uint32_t kMaxNodeInputs = 64;
+
+        // A connection resolved to the slot of its source node
+        struct PlanInput {
+            uint32_t sourceSlot;
+            uint32_t sourceOutput;
+            uint32_t destInput;
+            float strength;
+        };
+
+        // Connections feeding one input of a node, as a range into ExecutionPlan::inputs
+        struct PlanPort {
+            uint32_t inputBegin = 0;
+            uint32_t inputCount = 0;
+        };
+
+        // One node evaluation in the compiled execution plan
+        struct PlanStep {
+            uint32_t nodeSlot = kInvalidIndex;
+            uint32_t inputBegin = 0;          // Range into ExecutionPlan::inputs, ordered by destInput
+            uint32_t inputCount = 0;
+            uint32_t portBegin = 0;           // Range into ExecutionPlan::ports, indexed by input number
+            uint32_t portCount = 0;
+            uint32_t gainBegin = 0;           // Mixer per-input gain params in ExecutionPlan::gainParams
+            uint32_t streamCursor = kInvalidIndex;  // Streaming samplers: index into VoiceState::streamCursors
+            std::array<uint32_t, static_cast<size_t>(NodeParam::Count)> params{};
+        };
+
+        /**
+         * Flat, index-addressed form of the audio graph.
+         * Built once per graph load so the audio callback never sorts, hashes or allocates.
+         */
+        struct ExecutionPlan {
+            std::vector<PlanStep> steps;      // Dependency order
+            std::vector<PlanInput> inputs;
+            std::vector<PlanPort> ports;
+            std::vector<uint32_t> gainParams;
+            std::vector<uint32_t> feedbackSlots;  // Nodes read before they run (cycles), carried per voice
+            uint32_t maxPortCount = 0;
+            uint32_t outputSlot = kInvalidIndex;
+            uint32_t timeParam = kInvalidIndex;
+            uint32_t streamCursorCount = 0;
+            bool sharesStreamState = false;   // A streaming sampler reads a stream that isn't memory-mapped
+
+            void clear() {
+                steps.clear();
+                inputs.clear();
+                ports.clear();
+                gainParams.clear();
+                feedbackSlots.clear();
+                maxPortCount = 0;
+                outputSlot = kInvalidIndex;
+                timeParam = kInvalidIndex;
+                streamCursorCount = 0;
+                sharesStreamState = false;
+            }
+        };
+
+    public:
+        /**
+         * Mutable state of one voice playing the loaded graph
+         * The graph, parameter metadata and samples stay in the processor and are
+         * shared by every voice, so a voice costs a few bytes per node and parameter.
+         */
+        class VoiceState {
+        public:
+            float getCurrentTime() const { return currentTime; }
+
+        private:
+            friend class TaffyAudioProcessor;
+
+            std::vector<NodeState> nodes;            // DSP state by node slot, contiguous
+            std::vector<float> parameters;           // Current parameter values, parallel to parameterList_
+            std::vector<float> feedback;             // Previous block of each ExecutionPlan::feedbackSlots node
+            std::vector<MappedStreamCursor> streamCursors;  // Play position per streaming sampler
+            float currentTime = 0.0f;
+            uint64_t sampleCount = 0;
+            uint64_t graphGeneration = 0;            // Graph the state was built for
+        };
+
+        /**
+         * Block-sized working buffers for rendering one voice at a time
+         * Reused across voices and blocks; grows only when a larger block or graph arrives.
+         */
+        class RenderScratch {
+        private:
+            friend class TaffyAudioProcessor;
+
+            std::vector<float> nodeOutputs;          // One block per node slot
+            std::vector<float> inputs;               // Summed input buffers, one per port of the current node
+            std::vector<float> phases;               // Oscillator phase ramp for the current block
+            std::vector<float> increments;           // Per-sample phase increments under FM
+            uint32_t frames = 0;                     // Frames per buffer
+            uint32_t nodeCount = 0;
+            uint32_t portCount = 0;
+
+            float* output(uint32_t slot) { return nodeOutputs.data() + static_cast<size_t>(slot) * frames; }
+        };
+
+        /**
+         * Create a voice for the loaded graph with every parameter at its default
+         */
+        VoiceState createVoice() const;
+
+        /**
+         * Set a parameter value on one voice
+         * @param parameterHash Hash of the parameter name
+         * @param value New value, clamped to the parameter's range
+         */
+        void setVoiceParameter(VoiceState& voice, uint64_t parameterHash, float value) const;
+
+        /**
+         * Render one voice of the loaded graph
+         * @param voice Voice state; rebuilt if it belongs to a previously loaded graph
+         * @param scratch Working buffers, must not be shared by concurrent renders
+         * @param outputBuffer Mono output, frameCount samples
+         */
+        void processVoice(VoiceState& voice, RenderScratch& scratch, float* outputBuffer, uint32_t frameCount);
+
+        /**
+         * Shared hold on the graph for a whole block of voice work; never blocks
+         * Fails (owns_lock() is false) while a load holds the graph. While it is
+         * held, the *Locked calls below may be used from any render thread in
+         * place of their locking versions, which must not be called.
+         */
+        std::shared_lock<std::shared_mutex> tryLockGraph() const;
+        void setVoiceParameterLocked(VoiceState& voice, uint64_t parameterHash, float value) const;
+        void processVoiceLocked(VoiceState& voice, RenderScratch& scratch, float* outputBuffer, uint32_t frameCount);
+        bool hasSharedStreamStateLocked() const { return plan_.sharesStreamState; }
+
+        /**
+         * Whether a streaming sampler in the loaded graph plays a stream that is
+         * not memory-mapped; that stream's state is shared by all voices, so such
+         * graphs must not render voices concurrently
+         */
+        bool hasSharedStreamState() const;
+
+        /**
+         * Render time spent in one node type, summed over all voices
+         */
+        struct NodeTypeCost {
+            Taffy::AudioChunk::NodeType type;
+            uint64_t calls = 0;
+            uint64_t frames = 0;
+            double seconds = 0.0;
+        };
+
+        /**
+         * Time every node evaluation by node type; off by default since it
+         * reads the clock twice per node per block
+         */
+        void setNodeProfiling(bool enabled);
+        std::vector<NodeTypeCost> nodeTypeCosts() const;
+        void resetNodeTypeCosts();
+
+        static const char* nodeTypeName(Taffy::AudioChunk::NodeType type);
+
+    private:
         uint32_t sample_rate_;
-        float current_time_;
-        uint64_t sample_count_;
 
-        // Loaded audio chunk data
+        // Loaded audio chunk data (shared by all voices)
         Taffy::AudioChunk header_;
-        std::unordered_map<uint32_t, NodeState> nodes_;
+        std::vector<Taffy::AudioChunk::Node> nodes_;              // Node descriptors by slot
+        std::unordered_map<uint32_t, uint32_t> nodeSlots_;        // Node ID -> slot (load time only)
         std::vector<ConnectionInfo> connections_;
-        std::unordered_map<uint64_t, ParameterInfo> parameters_;  // Global parameters by hash
-        std::vector<ParameterInfo> parameterList_;               // All parameters in order
+        std::vector<Taffy::AudioChunk::Parameter> parameterList_; // All parameters in order
+        std::unordered_map<uint64_t, uint32_t> parameterIndex_;   // Global parameters by hash (first in list)
         std::vector<SampleData> samples_;                         // Loaded samples
         
+        ExecutionPlan plan_;                                      // Rebuilt only when the graph changes
+        uint64_t graphGeneration_ = 0;                            // Bumped on every load so stale voices reset
+
+        // Built-in voice used by processAudio/setParameter
+        VoiceState voice_;
+        RenderScratch scratch_;
+        ParameterEventQueue parameterEvents_;                     // setParameter -> processAudio
+        
+        // Per node type render cost, indexed by NodeType value
+        static constexpr size_t kProfiledNodeTypes = 64;
+        std::atomic<bool> nodeProfiling_{false};
+        std::array<std::atomic<uint64_t>, kProfiledNodeTypes> nodeTypeNanos_{};
+        std::array<std::atomic<uint64_t>, kProfiledNodeTypes> nodeTypeCalls_{};
+        std::array<std::atomic<uint64_t>, kProfiledNodeTypes> nodeTypeFrames_{};
+        
         // Mutex to protect the audio graph during loading/processing
-        mutable std::mutex graphMutex_;
+        // Exclusive for loading and the built-in voice, shared for processVoice
+        mutable std::shared_mutex graphMutex_;
+
+        // Execution plan
+        void compileExecutionPlan();
+        float planParameter(const VoiceState& voice, const PlanStep& step, NodeParam param, float fallback) const {
+            uint32_t index = step.params[static_cast<size_t>(param)];
+            return index != kInvalidIndex ? voice.parameters[index] : fallback;
+        }
 
         // Processing helpers
-        void processNode(NodeState& node, uint32_t frameCount);
-        float getNodeInput(uint32_t nodeId, uint32_t inputIndex);
-        float getParameterValue(uint64_t paramHash);
-        float getNodeParameterValue(const NodeState& node, uint64_t paramHash);
+        void resetVoice(VoiceState& voice) const;
+        void applyVoiceParameter(VoiceState& voice, uint64_t parameterHash, float value) const;
+        void renderVoice(VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processNode(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void runNode(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void ensureBlockCapacity(RenderScratch& scratch, uint32_t frameCount) const;
+        const float* getNodeInput(RenderScratch& scratch, const PlanStep& step, uint32_t inputIndex, uint32_t frameCount) const;
 
         // Node processors
-        void processOscillator(NodeState& node, uint32_t frameCount);
-        void processAmplifier(NodeState& node, uint32_t frameCount);
-        void processParameter(NodeState& node, uint32_t frameCount);
-        void processMixer(NodeState& node, uint32_t frameCount);
-        void processEnvelope(NodeState& node, uint32_t frameCount);
-        void processFilter(NodeState& node, uint32_t frameCount);
-        void processDistortion(NodeState& node, uint32_t frameCount);
-        void processSampler(NodeState& node, uint32_t frameCount);
-        void processStreamingSampler(NodeState& node, uint32_t frameCount);
+        void processOscillator(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processAmplifier(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processParameter(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processMixer(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processEnvelope(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processFilter(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processDistortion(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processSampler(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processStreamingSampler(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount);
+        void processMappedStreamingSampler(const PlanStep& step, VoiceState& voice, RenderScratch& scratch, uint32_t frameCount,
+                                           const MappedAudioSource& source);
         
     private:
         // Streaming support
@@ -204,8 +412,10 @@ namespace tremor::audio {
             bool nextChunkReady = false;
             bool needsPreload = true;
             
-            // Async loading state
+            // Async loading state. isLoadingNext stays raised until the submitted
+            // read finishes; loadGeneration orphans it when the stream stops.
             std::atomic<bool> isLoadingNext{false};
+            std::atomic<uint32_t> loadGeneration{0};
             
             // For TAF-embedded audio data
             const uint8_t* embeddedData = nullptr;  // Pointer to embedded audio in TAF
@@ -218,6 +428,10 @@ namespace tremor::audio {
             std::shared_ptr<Taffy::StreamingTaffyLoader> tafLoader;
             uint32_t totalChunks = 0;
             
+            // Zero-copy view of the PCM in a memory-mapped .taf; when set it
+            // replaces the chunk buffers, file stream and embedded copy above
+            MappedAudioSource mapped;
+            
             // Constructor
             StreamingAudioInfo() = default;
             
@@ -230,7 +444,8 @@ namespace tremor::audio {
                   currentChunk(other.currentChunk), bufferPosition(other.bufferPosition),
                   nextChunkReady(other.nextChunkReady), needsPreload(other.needsPreload),
                   isLoadingNext(false), embeddedDataCopy(other.embeddedDataCopy),
-                  embeddedDataSize(other.embeddedDataSize), nextChunkIndex(other.nextChunkIndex) {
+                  embeddedDataSize(other.embeddedDataSize), nextChunkIndex(other.nextChunkIndex),
+                  mapped(other.mapped) {
                 // Update embedded data pointer to point to our copy
                 if (!embeddedDataCopy.empty()) {
                     embeddedData = embeddedDataCopy.data();
@@ -249,20 +464,11 @@ namespace tremor::audio {
         void preloadStreamingChunk(StreamingAudioInfo& stream, uint32_t chunkIndex);
         void preloadStreamingChunkAsync(StreamingAudioInfo& stream, uint32_t chunkIndex);
         
-        // Background loading thread
-        std::unique_ptr<std::thread> loaderThread_;
-        std::atomic<bool> shouldStopLoader_{false};
-        std::mutex loaderMutex_;
-        std::condition_variable loaderCV_;
-        
-        struct LoadRequest {
-            StreamingAudioInfo* stream;
-            uint32_t chunkIndex;
-        };
-        std::queue<LoadRequest> loadQueue_;
-        
-        void backgroundLoader();
+        // Background reads run on the process-wide StreamingIOService
+        void loadStreamingChunkInBackground(StreamingAudioInfo* stream, uint32_t chunkIndex, uint32_t generation);
+        static void readStreamingChunk(void* owner, void* key, uint32_t chunkIndex, uint32_t generation);
         void clearLoadQueueForStream(StreamingAudioInfo* stream);
+        void updateStreamSharing();
         
     public:
         // Set TAF loader for chunked streaming
@@ -278,15 +484,20 @@ namespace tremor::audio {
             }
         }
         
+        /**
+         * Stream from a memory mapping of the .taf the graph was loaded from
+         * PCM is decoded straight from the mapping per voice, so voices can play
+         * streams independently and concurrently without copying the audio.
+         * The mapping is shared with any other processor streaming the same file.
+         * @param tafPath Path of the .taf file containing the loaded audio chunk
+         * @return false if the file can't be mapped or holds no audio chunk
+         */
+        bool setStreamingTafFile(const std::string& tafPath);
+        
         // Set the TAF file path for streaming audio (needed for file access)
         void setStreamingAudioFilePath(const std::string& filePath) {
-            // Wait for any pending loads to complete
-            {
-                std::lock_guard<std::mutex> lock(loaderMutex_);
-                while (!loadQueue_.empty()) {
-                    loadQueue_.pop();
-                }
-            }
+            // Drop pending loads and wait for running ones to complete
+            StreamingIOService::instance().cancelOwner(this);
             
             {
                 std::lock_guard<std::mutex> vecLock(streamingAudiosMutex_);
@@ -0,0 +1,419 @@
+// Offline renderer and benchmark for Taffy audio graphs.
+//
+// Loads the audio graph of a .taf asset, plays scripted parameter automation
+// against it and renders to a 32-bit float WAV without an audio device.
+// Reports the real-time factor and the render cost of each node type so DSP
+// regressions show up on headless build machines.
+//
+// Usage: TremorAudioRender <asset.taf> [options]
+//   --seconds N          Length to render (default 5)
+//   --out FILE.wav       Write the render to a WAV file
+//   --rate HZ            Sample rate (default 48000)
+//   --block FRAMES       Frames per processAudio call (default 512)
+//   --poly               Render through TaffyPolyphonicProcessor
+//   --threads N          Polyphonic render worker threads (default 0)
+//   --buffered           Stream through the chunk loader instead of a memory mapping
+//   --automation FILE    Parameter automation, one "<seconds> <parameter> <value>" per line
+//   --set NAME=VALUE     Set a parameter before the first block (repeatable)
+//   --no-profile         Skip per-node timing (measures the real-time factor alone)
+//
+// Parameters are given by name (hashed like the asset compiler does) or as a
+// 0x-prefixed hash. Lines starting with # in the automation file are ignored.
+
+#include "taffy_audio_processor.h"
+#include "taffy_polyphonic_processor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+    using namespace tremor::audio;
+
+    constexpr uint32_t kChannels = 2;
+
+    struct Options {
+        std::string assetPath;
+        std::string outputPath;
+        std::string automationPath;
+        double seconds = 5.0;
+        uint32_t sampleRate = 48000;
+        uint32_t blockFrames = 512;
+        uint32_t renderThreads = 0;
+        bool polyphonic = false;
+        bool buffered = false;
+        bool profile = true;
+        std::vector<std::pair<std::string, float>> initialValues;
+    };
+
+    struct AutomationEvent {
+        uint64_t frame = 0;
+        uint64_t parameterHash = 0;
+        float value = 0.0f;
+    };
+
+    void printUsage() {
+        std::cout << "Usage: TremorAudioRender <asset.taf> [--seconds N] [--out file.wav] [--rate HZ]\n"
+                  << "                         [--block FRAMES] [--poly] [--threads N] [--buffered]\n"
+                  << "                         [--automation file] [--set name=value] [--no-profile]" << std::endl;
+    }
+
+    uint64_t parameterHash(const std::string& name) {
+        if (name.size() > 2 && name[0] == '0' && (name[1] == 'x' || name[1] == 'X')) {
+            return std::strtoull(name.c_str() + 2, nullptr, 16);
+        }
+        return Taffy::fnv1a_hash(name.c_str());
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> const char* {
+                return i + 1 < argc ? argv[++i] : nullptr;
+            };
+
+            if (arg == "--poly") {
+                options.polyphonic = true;
+            } else if (arg == "--buffered") {
+                options.buffered = true;
+            } else if (arg == "--no-profile") {
+                options.profile = false;
+            } else if (arg == "--seconds" || arg == "--out" || arg == "--rate" || arg == "--block" ||
+                       arg == "--threads" || arg == "--automation" || arg == "--set") {
+                const char* v = value();
+                if (!v) {
+                    std::cerr << "❌ Missing value for " << arg << std::endl;
+                    return false;
+                }
+                if (arg == "--seconds") {
+                    options.seconds = std::atof(v);
+                } else if (arg == "--out") {
+                    options.outputPath = v;
+                } else if (arg == "--rate") {
+                    options.sampleRate = static_cast<uint32_t>(std::atoi(v));
+                } else if (arg == "--block") {
+                    options.blockFrames = static_cast<uint32_t>(std::atoi(v));
+                } else if (arg == "--threads") {
+                    options.renderThreads = static_cast<uint32_t>(std::atoi(v));
+                } else if (arg == "--automation") {
+                    options.automationPath = v;
+                } else {
+                    std::string assignment = v;
+                    size_t eq = assignment.find('=');
+                    if (eq == std::string::npos || eq == 0) {
+                        std::cerr << "❌ Expected name=value for --set, got " << assignment << std::endl;
+                        return false;
+                    }
+                    options.initialValues.emplace_back(assignment.substr(0, eq),
+                                                       static_cast<float>(std::atof(assignment.c_str() + eq + 1)));
+                }
+            } else if (!arg.empty() && arg[0] != '-' && options.assetPath.empty()) {
+                options.assetPath = arg;
+            } else {
+                std::cerr << "❌ Unknown argument: " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.assetPath.empty()) {
+            return false;
+        }
+        if (options.seconds <= 0.0 || options.sampleRate == 0 || options.blockFrames == 0) {
+            std::cerr << "❌ --seconds, --rate and --block must be positive" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool loadAutomation(const std::string& path, uint32_t sampleRate, std::vector<AutomationEvent>& events) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "❌ Failed to open automation file: " << path << std::endl;
+            return false;
+        }
+
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') {
+                continue;
+            }
+
+            std::istringstream fields(line);
+            double time;
+            std::string name;
+            float value;
+            if (!(fields >> time >> name >> value) || time < 0.0) {
+                std::cerr << "❌ " << path << ":" << lineNumber << ": expected <seconds> <parameter> <value>" << std::endl;
+                return false;
+            }
+            events.push_back({static_cast<uint64_t>(std::llround(time * sampleRate)), parameterHash(name), value});
+        }
+
+        // Same-frame events keep file order, matching the processors' arrival order
+        std::stable_sort(events.begin(), events.end(),
+                         [](const AutomationEvent& a, const AutomationEvent& b) { return a.frame < b.frame; });
+        return true;
+    }
+
+    template <typename T>
+    void writeValue(std::ofstream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    bool writeWav(const std::string& path, const std::vector<float>& samples, uint32_t sampleRate) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            std::cerr << "❌ Failed to create " << path << std::endl;
+            return false;
+        }
+
+        // WAVE_FORMAT_IEEE_FLOAT, interleaved stereo
+        const uint32_t dataBytes = static_cast<uint32_t>(samples.size() * sizeof(float));
+        out.write("RIFF", 4);
+        writeValue<uint32_t>(out, 36 + dataBytes);
+        out.write("WAVE", 4);
+        out.write("fmt ", 4);
+        writeValue<uint32_t>(out, 16);
+        writeValue<uint16_t>(out, 3);
+        writeValue<uint16_t>(out, kChannels);
+        writeValue<uint32_t>(out, sampleRate);
+        writeValue<uint32_t>(out, sampleRate * kChannels * sizeof(float));
+        writeValue<uint16_t>(out, kChannels * sizeof(float));
+        writeValue<uint16_t>(out, 32);
+        out.write("data", 4);
+        writeValue<uint32_t>(out, dataBytes);
+        out.write(reinterpret_cast<const char*>(samples.data()), dataBytes);
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * Common front end over the single-voice and polyphonic processors
+     */
+    class Renderer {
+    public:
+        virtual ~Renderer() = default;
+        virtual bool load(const Options& options) = 0;
+        virtual void setParameter(uint64_t parameterHash, float value, uint32_t sampleOffset) = 0;
+        virtual void process(float* output, uint32_t frameCount) = 0;
+        virtual void setNodeProfiling(bool enabled) = 0;
+        virtual std::vector<TaffyAudioProcessor::NodeTypeCost> nodeTypeCosts() const = 0;
+        virtual void reportVoices() const {}
+    };
+
+    template <typename Processor>
+    class ProcessorRenderer : public Renderer {
+    public:
+        explicit ProcessorRenderer(uint32_t sampleRate) : processor_(sampleRate) {}
+
+        bool load(const Options& options) override {
+            Taffy::StreamingTaffyLoader loader;
+            if (!loader.open(options.assetPath)) {
+                std::cerr << "❌ Failed to open " << options.assetPath << std::endl;
+                return false;
+            }
+            std::vector<uint8_t> audioChunk = loader.loadChunk(Taffy::ChunkType::AUDI);
+            if (audioChunk.empty() || !processor_.loadAudioChunk(audioChunk)) {
+                std::cerr << "❌ No loadable audio graph in " << options.assetPath << std::endl;
+                return false;
+            }
+
+            // Assets without streamed audio have nothing to map; that's not an error
+            if (options.buffered) {
+                auto streamingLoader = std::make_shared<Taffy::StreamingTaffyLoader>();
+                if (streamingLoader->open(options.assetPath)) {
+                    processor_.setStreamingTafLoader(streamingLoader);
+                }
+            } else {
+                processor_.setStreamingTafFile(options.assetPath);
+            }
+
+            if constexpr (std::is_same_v<Processor, TaffyPolyphonicProcessor>) {
+                if (options.renderThreads > 0) {
+                    processor_.setRenderThreads(options.renderThreads);
+                }
+            }
+            return true;
+        }
+
+        void setParameter(uint64_t parameterHash, float value, uint32_t sampleOffset) override {
+            processor_.setParameter(parameterHash, value, sampleOffset);
+        }
+
+        void process(float* output, uint32_t frameCount) override {
+            processor_.processAudio(output, frameCount, kChannels);
+        }
+
+        void setNodeProfiling(bool enabled) override {
+            processor_.setNodeProfiling(enabled);
+        }
+
+        std::vector<TaffyAudioProcessor::NodeTypeCost> nodeTypeCosts() const override {
+            return processor_.nodeTypeCosts();
+        }
+
+        void reportVoices() const override {
+            if constexpr (std::is_same_v<Processor, TaffyPolyphonicProcessor>) {
+                const TaffyPolyphonicProcessor::VoiceStats stats = processor_.voiceStats();
+                std::cout << "  Voices:             " << stats.started << " started, " << stats.released
+                          << " released, " << stats.stolen << " stolen, " << stats.finished << " finished"
+                          << std::endl;
+            }
+        }
+
+    private:
+        Processor processor_;
+    };
+
+    void reportNodeCosts(const std::vector<TaffyAudioProcessor::NodeTypeCost>& costs, double renderSeconds) {
+        if (costs.empty()) {
+            return;
+        }
+
+        std::cout << "\nPer node type (all voices):" << std::endl;
+        std::cout << "  " << std::left << std::setw(18) << "node" << std::right
+                  << std::setw(12) << "calls" << std::setw(14) << "ms" << std::setw(10) << "share"
+                  << std::setw(14) << "ns/frame" << std::endl;
+
+        double total = 0.0;
+        for (const auto& cost : costs) {
+            total += cost.seconds;
+        }
+
+        std::vector<TaffyAudioProcessor::NodeTypeCost> sorted = costs;
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const auto& a, const auto& b) { return a.seconds > b.seconds; });
+        for (const auto& cost : sorted) {
+            std::cout << "  " << std::left << std::setw(18) << TaffyAudioProcessor::nodeTypeName(cost.type) << std::right
+                      << std::setw(12) << cost.calls
+                      << std::setw(14) << std::fixed << std::setprecision(3) << cost.seconds * 1e3
+                      << std::setw(9) << std::setprecision(1) << (total > 0.0 ? 100.0 * cost.seconds / total : 0.0) << "%"
+                      << std::setw(14) << std::setprecision(2)
+                      << (cost.frames > 0 ? cost.seconds * 1e9 / static_cast<double>(cost.frames) : 0.0)
+                      << std::endl;
+        }
+        std::cout << "  Node time covers " << std::setprecision(1)
+                  << (renderSeconds > 0.0 ? 100.0 * total / renderSeconds : 0.0)
+                  << "% of render time (more than 100% with render threads)" << std::endl;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<AutomationEvent> automation;
+    if (!options.automationPath.empty() && !loadAutomation(options.automationPath, options.sampleRate, automation)) {
+        return 1;
+    }
+
+    std::unique_ptr<Renderer> renderer;
+    if (options.polyphonic) {
+        renderer = std::make_unique<ProcessorRenderer<TaffyPolyphonicProcessor>>(options.sampleRate);
+    } else {
+        renderer = std::make_unique<ProcessorRenderer<TaffyAudioProcessor>>(options.sampleRate);
+    }
+
+    // The processors narrate loading and streaming on stdout; keep the report readable
+    std::ostringstream processorLog;
+    std::streambuf* consoleBuffer = std::cout.rdbuf(processorLog.rdbuf());
+    bool loaded = renderer->load(options);
+    std::cout.rdbuf(consoleBuffer);
+    if (!loaded) {
+        return 1;
+    }
+
+    for (const auto& [name, value] : options.initialValues) {
+        renderer->setParameter(parameterHash(name), value, 0);
+    }
+    renderer->setNodeProfiling(options.profile);
+
+    const uint64_t totalFrames = static_cast<uint64_t>(std::llround(options.seconds * options.sampleRate));
+    std::vector<float> rendered;
+    if (!options.outputPath.empty()) {
+        rendered.reserve(totalFrames * kChannels);
+    }
+    std::vector<float> block(static_cast<size_t>(options.blockFrames) * kChannels);
+
+    uint32_t slowestBlockIndex = 0;
+    double slowestBlockSeconds = 0.0;
+    size_t nextEvent = 0;
+
+    std::cout.rdbuf(processorLog.rdbuf());
+    auto renderStart = std::chrono::steady_clock::now();
+    for (uint64_t blockStart = 0; blockStart < totalFrames; blockStart += options.blockFrames) {
+        uint32_t frames = static_cast<uint32_t>(std::min<uint64_t>(options.blockFrames, totalFrames - blockStart));
+
+        // Hand this block's automation to the processor with in-block offsets
+        while (nextEvent < automation.size() && automation[nextEvent].frame < blockStart + frames) {
+            const AutomationEvent& event = automation[nextEvent++];
+            uint32_t offset = event.frame > blockStart ? static_cast<uint32_t>(event.frame - blockStart) : 0;
+            renderer->setParameter(event.parameterHash, event.value, offset);
+        }
+
+        auto blockStartTime = std::chrono::steady_clock::now();
+        renderer->process(block.data(), frames);
+        std::chrono::duration<double> blockTime = std::chrono::steady_clock::now() - blockStartTime;
+        if (blockTime.count() > slowestBlockSeconds) {
+            slowestBlockSeconds = blockTime.count();
+            slowestBlockIndex = static_cast<uint32_t>(blockStart / options.blockFrames);
+        }
+
+        if (!options.outputPath.empty()) {
+            rendered.insert(rendered.end(), block.begin(), block.begin() + static_cast<size_t>(frames) * kChannels);
+        }
+
+        // Processors log from the render path too; don't let the capture grow without bound
+        if (processorLog.tellp() > (1 << 20)) {
+            processorLog.str({});
+        }
+    }
+    std::chrono::duration<double> renderTime = std::chrono::steady_clock::now() - renderStart;
+    std::cout.rdbuf(consoleBuffer);
+
+    const double audioSeconds = static_cast<double>(totalFrames) / options.sampleRate;
+    const double blockSeconds = static_cast<double>(options.blockFrames) / options.sampleRate;
+    std::cout << "🔊 Rendered " << std::fixed << std::setprecision(2) << audioSeconds << " s of "
+              << options.assetPath << " (" << (options.polyphonic ? "polyphonic" : "single voice")
+              << ", " << options.sampleRate << " Hz, " << options.blockFrames << "-frame blocks";
+    if (options.polyphonic && options.renderThreads > 0) {
+        std::cout << ", " << options.renderThreads << " render threads";
+    }
+    std::cout << ", " << automation.size() << " automation events)" << std::endl;
+
+    std::cout << "  Render time:        " << std::setprecision(3) << renderTime.count() * 1e3 << " ms" << std::endl;
+    std::cout << "  Real-time factor:   " << std::setprecision(4) << renderTime.count() / audioSeconds
+              << " (" << std::setprecision(1) << audioSeconds / std::max(renderTime.count(), 1e-9) << "x real time)"
+              << std::endl;
+    std::cout << "  Slowest block:      #" << slowestBlockIndex << " " << std::setprecision(3)
+              << slowestBlockSeconds * 1e3 << " ms (" << std::setprecision(1)
+              << 100.0 * slowestBlockSeconds / blockSeconds << "% of its " << std::setprecision(2)
+              << blockSeconds * 1e3 << " ms budget)" << std::endl;
+    renderer->reportVoices();
+
+    if (options.profile) {
+        reportNodeCosts(renderer->nodeTypeCosts(), renderTime.count());
+    }
+
+    if (!options.outputPath.empty()) {
+        if (!writeWav(options.outputPath, rendered, options.sampleRate)) {
+            return 1;
+        }
+        std::cout << "\n💾 Wrote " << options.outputPath << std::endl;
+    }
+    return 0;
+}
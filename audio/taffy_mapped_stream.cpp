@@ -0,0 +1,283 @@
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "taffy_mapped_stream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace tremor::audio {
+
+    namespace {
+
+        // Live mappings by path; entries expire with the last stream using them
+        std::mutex& mappingRegistryMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::unordered_map<std::string, std::weak_ptr<MappedFile>>& mappingRegistry() {
+            static std::unordered_map<std::string, std::weak_ptr<MappedFile>> registry;
+            return registry;
+        }
+
+        // Mix one interleaved frame down to mono
+        inline float decodeFrame(const MappedAudioSource& source, const uint8_t* frame) {
+            float sum = 0.0f;
+            for (uint32_t ch = 0; ch < source.channelCount; ++ch) {
+                if (source.format == 1) {
+                    float value;
+                    std::memcpy(&value, frame + ch * 4, sizeof(value));
+                    sum += value;
+                } else if (source.bitDepth == 16) {
+                    int16_t value;
+                    std::memcpy(&value, frame + ch * 2, sizeof(value));
+                    sum += value / 32768.0f;
+                } else if (source.bitDepth == 24) {
+                    const uint8_t* s = frame + ch * 3;
+                    int32_t value = (s[0] << 8) | (s[1] << 16) | (s[2] << 24);
+                    sum += value / 2147483648.0f;
+                } else {
+                    int32_t value;
+                    std::memcpy(&value, frame + ch * 4, sizeof(value));
+                    sum += value / 2147483648.0f;
+                }
+            }
+            return sum / static_cast<float>(source.channelCount);
+        }
+
+    } // namespace
+
+    std::shared_ptr<MappedFile> MappedFile::open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mappingRegistryMutex());
+        auto& registry = mappingRegistry();
+        auto it = registry.find(path);
+        if (it != registry.end()) {
+            if (auto existing = it->second.lock()) {
+                return existing;
+            }
+        }
+
+        std::shared_ptr<MappedFile> file(new MappedFile());
+        file->path_ = path;
+
+#ifdef _WIN32
+        HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            std::cerr << "❌ Failed to open file for mapping: " << path << std::endl;
+            return nullptr;
+        }
+        file->fileHandle_ = handle;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+            std::cerr << "❌ Cannot map empty or unreadable file: " << path << std::endl;
+            return nullptr;
+        }
+        file->size_ = static_cast<size_t>(fileSize.QuadPart);
+
+        HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            std::cerr << "❌ CreateFileMapping failed for " << path << std::endl;
+            return nullptr;
+        }
+        file->mappingHandle_ = mapping;
+
+        file->data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "❌ Failed to open file for mapping: " << path << std::endl;
+            return nullptr;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            std::cerr << "❌ Cannot map empty or unreadable file: " << path << std::endl;
+            ::close(fd);
+            return nullptr;
+        }
+        file->size_ = static_cast<size_t>(info.st_size);
+
+        void* address = mmap(nullptr, file->size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);  // The mapping keeps its own reference to the file
+        if (address != MAP_FAILED) {
+            file->data_ = static_cast<const uint8_t*>(address);
+            // Streams read forward; let the kernel read ahead aggressively
+            madvise(address, file->size_, MADV_SEQUENTIAL);
+        }
+#endif
+
+        if (!file->data_) {
+            std::cerr << "❌ Failed to map file: " << path << std::endl;
+            return nullptr;
+        }
+
+        std::cout << "🗺️ Mapped " << path << " (" << file->size_ / (1024.0 * 1024.0) << " MB)" << std::endl;
+        registry[path] = file;
+        return file;
+    }
+
+    MappedFile::~MappedFile() {
+#ifdef _WIN32
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mappingHandle_) {
+            CloseHandle(static_cast<HANDLE>(mappingHandle_));
+        }
+        if (fileHandle_) {
+            CloseHandle(static_cast<HANDLE>(fileHandle_));
+        }
+#else
+        if (data_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+        }
+#endif
+    }
+
+    void MappedFile::prefetch(uint64_t offset, uint64_t length) const {
+        if (!data_ || offset >= size_) {
+            return;
+        }
+        length = std::min<uint64_t>(length, size_ - offset);
+
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>(data_ + offset);
+        range.NumberOfBytes = static_cast<SIZE_T>(length);
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+        // madvise wants a page-aligned start
+        static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        uint64_t alignedOffset = offset - offset % pageSize;
+        madvise(const_cast<uint8_t*>(data_ + alignedOffset), static_cast<size_t>(length + offset - alignedOffset),
+                MADV_WILLNEED);
+#endif
+    }
+
+    bool MappedAudioSource::valid() const {
+        if (!file || channelCount == 0 || framesPerSegment == 0 || frameCount == 0 || segmentOffsets.empty()) {
+            return false;
+        }
+        if (format == 1 ? bitDepth != 32 : (bitDepth != 16 && bitDepth != 24 && bitDepth != 32)) {
+            return false;
+        }
+        if (segmentOffsets.size() * framesPerSegment < frameCount) {
+            return false;
+        }
+
+        for (size_t s = 0; s < segmentOffsets.size(); ++s) {
+            uint64_t firstFrame = s * framesPerSegment;
+            if (firstFrame >= frameCount) {
+                break;
+            }
+            uint64_t frames = std::min(framesPerSegment, frameCount - firstFrame);
+            if (segmentOffsets[s] + frames * bytesPerFrame() > file->size()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void MappedStreamCursor::reset() {
+        ring_.assign(kRingFrames, 0.0f);
+        ringStart_ = 0;
+        ringEnd_ = 0;
+        prefetchedUntil_ = 0;
+        position_ = 0.0;
+    }
+
+    void MappedStreamCursor::seek(const MappedAudioSource& source, double frame) {
+        position_ = std::max(0.0, frame);
+        uint64_t start = static_cast<uint64_t>(position_);
+        ringStart_ = start;
+        ringEnd_ = start;
+        prefetchedUntil_ = start;
+        prefetchAhead(source, start);
+    }
+
+    float MappedStreamCursor::sample(const MappedAudioSource& source) {
+        uint64_t frame = static_cast<uint64_t>(position_);
+        float frac = static_cast<float>(position_ - static_cast<double>(frame));
+        float s1 = frameAt(source, frame);
+        float s2 = frameAt(source, frame + 1);
+        return s1 * (1.0f - frac) + s2 * frac;
+    }
+
+    float MappedStreamCursor::frameAt(const MappedAudioSource& source, uint64_t frame) {
+        if (frame >= source.frameCount || ring_.empty()) {
+            return 0.0f;
+        }
+
+        if (frame < ringStart_ || frame >= ringEnd_ + kRingFrames / 2) {
+            // Jumped outside the decoded window; restart the ring here
+            ringStart_ = frame;
+            ringEnd_ = frame;
+        }
+        if (frame >= ringEnd_) {
+            prefetchAhead(source, frame);
+            decode(source, std::min(frame + kDecodeFrames, source.frameCount));
+        }
+        return ring_[frame & (kRingFrames - 1)];
+    }
+
+    void MappedStreamCursor::decode(const MappedAudioSource& source, uint64_t endFrame) {
+        const uint32_t bytesPerFrame = source.bytesPerFrame();
+        const uint8_t* base = source.file->data();
+
+        uint64_t frame = ringEnd_;
+        while (frame < endFrame) {
+            // Decode one contiguous run within a segment
+            uint64_t segment = frame / source.framesPerSegment;
+            uint64_t inSegment = frame - segment * source.framesPerSegment;
+            uint64_t runEnd = std::min(endFrame, (segment + 1) * source.framesPerSegment);
+            const uint8_t* bytes = base + source.segmentOffsets[segment] + inSegment * bytesPerFrame;
+            for (; frame < runEnd; ++frame, bytes += bytesPerFrame) {
+                ring_[frame & (kRingFrames - 1)] = decodeFrame(source, bytes);
+            }
+        }
+
+        ringEnd_ = endFrame;
+        ringStart_ = std::max(ringStart_, ringEnd_ > kRingFrames ? ringEnd_ - kRingFrames : 0);
+    }
+
+    void MappedStreamCursor::prefetchAhead(const MappedAudioSource& source, uint64_t frame) {
+        // Keep about a second of audio requested ahead, in half-second steps
+        const uint64_t lookahead = std::max<uint64_t>(source.sampleRate, kRingFrames);
+        if (frame + lookahead <= prefetchedUntil_ || prefetchedUntil_ >= source.frameCount) {
+            return;
+        }
+
+        uint64_t from = std::max(prefetchedUntil_, frame);
+        uint64_t to = std::min(frame + lookahead + lookahead / 2, source.frameCount);
+        const uint32_t bytesPerFrame = source.bytesPerFrame();
+        while (from < to) {
+            uint64_t segment = from / source.framesPerSegment;
+            uint64_t runEnd = std::min(to, (segment + 1) * source.framesPerSegment);
+            uint64_t offset = source.segmentOffsets[segment] + (from - segment * source.framesPerSegment) * bytesPerFrame;
+            source.file->prefetch(offset, (runEnd - from) * bytesPerFrame);
+            from = runEnd;
+        }
+        prefetchedUntil_ = to;
+    }
+
+} // namespace tremor::audio
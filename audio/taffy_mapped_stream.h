@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tremor::audio {
+
+    /**
+     * Read-only memory mapping of a file
+     * Mappings are shared: opening a path that is already mapped returns the
+     * live mapping, so every stream reading one asset shares its pages.
+     */
+    class MappedFile {
+    public:
+        /**
+         * Map a file, reusing the existing mapping of the same path if there is one
+         * @return nullptr if the file can't be opened or mapped
+         */
+        static std::shared_ptr<MappedFile> open(const std::string& path);
+
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* data() const { return data_; }
+        size_t size() const { return size_; }
+        const std::string& path() const { return path_; }
+
+        /**
+         * Hint that a byte range will be read soon; starts read-ahead without waiting for it
+         */
+        void prefetch(uint64_t offset, uint64_t length) const;
+
+    private:
+        MappedFile() = default;
+
+        std::string path_;
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void* fileHandle_ = nullptr;
+        void* mappingHandle_ = nullptr;
+#endif
+    };
+
+    /**
+     * Where one streamed asset's PCM lives inside a mapped file
+     * The audio may be split into segments (one per chunk of a chunked TAF);
+     * every segment except the last holds exactly framesPerSegment frames.
+     */
+    struct MappedAudioSource {
+        std::shared_ptr<MappedFile> file;
+        std::vector<uint64_t> segmentOffsets;    // Byte offset of each segment in the file
+        uint64_t frameCount = 0;
+        uint64_t framesPerSegment = 0;
+        uint32_t sampleRate = 0;
+        uint32_t channelCount = 0;
+        uint32_t bitDepth = 0;
+        uint32_t format = 0;                     // 0 = integer PCM, 1 = 32-bit float
+
+        uint32_t bytesPerFrame() const { return channelCount * (bitDepth / 8); }
+
+        /**
+         * Whether the layout is decodable and every segment lies inside the file
+         */
+        bool valid() const;
+    };
+
+    /**
+     * Per-voice playback cursor over a MappedAudioSource
+     *
+     * Decodes mono frames straight from the mapping into a small ring just ahead
+     * of the play position, so any number of cursors can play the same file
+     * without copying it. Read-ahead hints are issued for the pages the cursor
+     * will reach in about a second, keeping page faults off the audio thread.
+     */
+    class MappedStreamCursor {
+    public:
+        static constexpr uint32_t kRingFrames = 2048;    // Power of two
+        static constexpr uint32_t kDecodeFrames = 256;   // Frames decoded per refill
+
+        /**
+         * Allocate the ring; call once outside the audio callback
+         */
+        void reset();
+
+        /**
+         * Move the play position, dropping decoded frames and prefetching around it
+         */
+        void seek(const MappedAudioSource& source, double frame);
+
+        double position() const { return position_; }
+        void advance(double frames) { position_ += frames; }
+
+        /**
+         * Mono sample at the play position, linearly interpolated
+         * Frames past the end of the source read as silence.
+         */
+        float sample(const MappedAudioSource& source);
+
+    private:
+        float frameAt(const MappedAudioSource& source, uint64_t frame);
+        void decode(const MappedAudioSource& source, uint64_t endFrame);
+        void prefetchAhead(const MappedAudioSource& source, uint64_t frame);
+
+        std::vector<float> ring_;
+        uint64_t ringStart_ = 0;                 // Decoded frames are [ringStart_, ringEnd_)
+        uint64_t ringEnd_ = 0;
+        uint64_t prefetchedUntil_ = 0;
+        double position_ = 0.0;
+    };
+
+} // namespace tremor::audio
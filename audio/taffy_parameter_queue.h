@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace tremor::audio {
+
+    /**
+     * Parameter change scheduled at a sample offset from the start of the next
+     * audio block; offsets past the end of that block carry over to later blocks
+     */
+    struct ParameterEvent {
+        uint64_t parameterHash = 0;
+        float value = 0.0f;
+        uint32_t sampleOffset = 0;
+    };
+
+    /**
+     * Wait-free single-producer/single-consumer ring buffer
+     * Exactly one thread may push and exactly one other thread may pop.
+     * Neither side blocks or allocates.
+     */
+    template <typename T, size_t Capacity>
+    class SpscRing {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+    public:
+        /**
+         * Producer side; returns false if the ring is full
+         */
+        bool push(const T& item) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+            items_[head & (Capacity - 1)] = item;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Consumer side; returns false if the ring is empty
+         */
+        bool pop(T& item) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = items_[tail & (Capacity - 1)];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        // Separate cache lines so producer and consumer don't false-share
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+        alignas(64) std::array<T, Capacity> items_{};
+    };
+
+    /**
+     * Sample-accurate parameter schedule for one audio processor
+     *
+     * Gameplay code pushes events from a single thread. At the start of each
+     * block the audio thread calls collect(), then walks the block in segments:
+     * apply every event returned by popDue(segmentStart), render up to
+     * nextOffset(frameCount), repeat. endBlock(frameCount) carries late events
+     * into the next block.
+     */
+    class ParameterEventQueue {
+    public:
+        static constexpr size_t kCapacity = 1024;
+
+        /**
+         * Producer side; returns false if the queue is full and the event was dropped
+         */
+        bool push(const ParameterEvent& event) {
+            return ring_.push(event);
+        }
+
+        /**
+         * Move queued events into the schedule, ordered by offset and then arrival
+         */
+        void collect() {
+            ParameterEvent event;
+            while (scheduledCount_ < kCapacity && ring_.pop(event)) {
+                size_t pos = scheduledCount_++;
+                while (pos > dueIndex_ && scheduled_[pos - 1].sampleOffset > event.sampleOffset) {
+                    scheduled_[pos] = scheduled_[pos - 1];
+                    --pos;
+                }
+                scheduled_[pos] = event;
+            }
+        }
+
+        /**
+         * Pop the next event due at or before the given offset
+         */
+        bool popDue(uint32_t offset, ParameterEvent& event) {
+            if (dueIndex_ == scheduledCount_ || scheduled_[dueIndex_].sampleOffset > offset) {
+                return false;
+            }
+            event = scheduled_[dueIndex_++];
+            return true;
+        }
+
+        /**
+         * Offset of the next pending event within the block, or frameCount if there is none
+         */
+        uint32_t nextOffset(uint32_t frameCount) const {
+            if (dueIndex_ == scheduledCount_) {
+                return frameCount;
+            }
+            uint32_t offset = scheduled_[dueIndex_].sampleOffset;
+            return offset < frameCount ? offset : frameCount;
+        }
+
+        /**
+         * Drop applied events and rebase the remaining ones onto the next block
+         */
+        void endBlock(uint32_t frameCount) {
+            size_t remaining = 0;
+            for (size_t i = dueIndex_; i < scheduledCount_; ++i) {
+                ParameterEvent event = scheduled_[i];
+                event.sampleOffset = event.sampleOffset > frameCount ? event.sampleOffset - frameCount : 0;
+                scheduled_[remaining++] = event;
+            }
+            scheduledCount_ = remaining;
+            dueIndex_ = 0;
+        }
+
+    private:
+        SpscRing<ParameterEvent, kCapacity> ring_;
+
+        // Audio thread only
+        std::array<ParameterEvent, kCapacity> scheduled_{};
+        size_t scheduledCount_ = 0;
+        size_t dueIndex_ = 0;
+    };
+
+} // namespace tremor::audio
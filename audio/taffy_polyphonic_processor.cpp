@@ -1,3 +1,16 @@
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "taffy_polyphonic_processor.h"
 #include "include/tools.h"
 #include <cstring>
@@ -5,8 +18,28 @@
 
 namespace tremor::audio {
 
+    namespace {
+
+        // Share of each block the audio thread may spend waiting on workers
+        // before it mixes without the voices they still hold
+        constexpr double kWorkerWaitBudget = 0.5;
+
+        // Puts the calling worker just below the usual audio callback priority.
+        // Best effort: without the privilege for it the worker keeps its normal priority.
+        bool raiseRenderThreadPriority() {
+#ifdef _WIN32
+            return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+            sched_param param{};
+            param.sched_priority = std::max(sched_get_priority_max(SCHED_FIFO) - 1, sched_get_priority_min(SCHED_FIFO));
+            return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#endif
+        }
+
+    } // namespace
+
     TaffyPolyphonicProcessor::TaffyPolyphonicProcessor(uint32_t sampleRate) 
-        : sampleRate_(sampleRate) {
+        : sampleRate_(sampleRate), processor_(sampleRate) {
         
         // Initialize all voices
         for (int i = 0; i < MAX_VOICES; ++i) {
@@ -14,147 +47,344 @@ namespace tremor::audio {
             voices_[i].active = false;
             voices_[i].age = 0;
             voices_[i].priority = 0.0f;
-            voices_[i].processor = std::make_unique<TaffyAudioProcessor>(sampleRate);
             voices_[i].triggerParam = 0;
             voices_[i].lastGate = 0.0f;
             voices_[i].releaseAge = 0;
         }
         
+        renderScratch_.resize(1);
+        voiceOutputFrames_ = 1024;
+        voiceOutputs_.assign(static_cast<size_t>(MAX_VOICES) * voiceOutputFrames_, 0.0f);
+        
         Logger::get().info("🎹 TaffyPolyphonicProcessor initialized with {} voices", MAX_VOICES);
     }
     
     TaffyPolyphonicProcessor::~TaffyPolyphonicProcessor() {
+        stopRenderPool();
     }
     
     bool TaffyPolyphonicProcessor::loadAudioChunk(const std::vector<uint8_t>& audioData) {
         std::lock_guard<std::mutex> lock(voicesMutex_);
+        waitForStalledVoices();
         
-        // Cache the audio data
-        audioChunkData_ = audioData;
+        // Parse the graph and samples once; every voice renders from it
+        if (!processor_.loadAudioChunk(audioData)) {
+            Logger::get().error("Failed to load audio chunk into polyphonic processor");
+            return false;
+        }
         
-        // Load into all voices
-        bool success = true;
         for (auto& voice : voices_) {
-            if (!voice.processor->loadAudioChunk(audioData)) {
-                Logger::get().error("Failed to load audio chunk into voice {}", voice.id);
-                success = false;
-            }
+            voice.state = processor_.createVoice();
+            voice.active = false;
         }
+        parameterRoutes_.fill(ParameterRoute{});
         
-        Logger::get().info("✅ Loaded audio chunk into {} voices", MAX_VOICES);
-        return success;
+        Logger::get().info("✅ Loaded audio chunk for {} voices", MAX_VOICES);
+        return true;
     }
     
     void TaffyPolyphonicProcessor::processAudio(float* outputBuffer, uint32_t frameCount, uint32_t channelCount) {
-        std::lock_guard<std::mutex> lock(voicesMutex_);
-        
         // Clear output buffer first
         std::memset(outputBuffer, 0, frameCount * channelCount * sizeof(float));
         
-        // Temporary buffer for each voice
-        std::vector<float> voiceBuffer(frameCount * channelCount);
+        // Only loading contends for this lock; output silence rather than block.
+        // Queued parameter events stay queued until the next block.
+        std::unique_lock<std::mutex> lock(voicesMutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return;
+        }
+        
+        // One shared hold on the graph covers every parameter change and voice
+        // render in the block; a load holding it means silence, as with processVoice
+        std::shared_lock<std::shared_mutex> graphLock = processor_.tryLockGraph();
+        if (!graphLock.owns_lock()) {
+            return;
+        }
         
-        // Process each active voice
+        // Per-voice mono blocks; only grow if the host asks for a larger block.
+        // A stalled worker may still be writing into the old ones.
+        if (voiceOutputFrames_ < frameCount) {
+            waitForStalledVoices();
+            voiceOutputFrames_ = frameCount;
+            voiceOutputs_.assign(static_cast<size_t>(MAX_VOICES) * voiceOutputFrames_, 0.0f);
+        }
+        
+        // Split the block at queued parameter events so gates and other
+        // changes land on their exact sample
+        parameterEvents_.collect();
+        const auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(kWorkerWaitBudget * frameCount / sampleRate_));
+        int activeVoices = 0;
+        uint32_t segmentStart = 0;
+        while (segmentStart < frameCount) {
+            ParameterEvent event;
+            while (parameterEvents_.popDue(segmentStart, event)) {
+                applyParameter(event.parameterHash, event.value);
+            }
+            uint32_t segmentEnd = parameterEvents_.nextOffset(frameCount);
+            activeVoices = std::max(activeVoices, renderSegment(outputBuffer, segmentStart, segmentEnd - segmentStart, channelCount, deadline));
+            segmentStart = segmentEnd;
+        }
+        parameterEvents_.endBlock(frameCount);
+        activeVoiceCount_.store(activeVoices, std::memory_order_relaxed);
+    }
+    
+    int TaffyPolyphonicProcessor::renderSegment(float* outputBuffer, uint32_t segmentStart, uint32_t segmentFrames, uint32_t channelCount,
+                                                std::chrono::steady_clock::time_point deadline) {
+        // Collect active voices in slot order; this order fixes the summing order.
+        // Voices a stalled worker still holds sit out until it finishes them.
         int activeVoices = 0;
         for (auto& voice : voices_) {
-            if (voice.active) {
-                // Clear voice buffer
-                std::memset(voiceBuffer.data(), 0, voiceBuffer.size() * sizeof(float));
-                
-                // Process this voice
-                voice.processor->processAudio(voiceBuffer.data(), frameCount, channelCount);
-                
-                // Mix into output buffer
-                for (uint32_t i = 0; i < frameCount * channelCount; ++i) {
-                    outputBuffer[i] += voiceBuffer[i];
-                }
-                
-                activeVoices++;
+            if (voice.active && !voiceStalled(voice.id)) {
+                jobVoices_[activeVoices++].store(voice.id, std::memory_order_relaxed);
             }
         }
         
-        // Update voice ages
-        updateVoiceAges(frameCount);
+        // Buffered (unmapped) streams share one stream cursor, so those graphs stay serial
+        bool parallel = !renderThreads_.empty() && activeVoices > 1 && !processor_.hasSharedStreamStateLocked();
+        if (parallel) {
+            // Publish the job; job data is visible to any worker that acquires the cursor
+            uint32_t generation = jobGeneration_.load(std::memory_order_relaxed) + 1;
+            jobOffset_.store(segmentStart, std::memory_order_relaxed);
+            jobFrames_.store(segmentFrames, std::memory_order_relaxed);
+            for (int j = 0; j < activeVoices; ++j) {
+                voicePending_[jobVoices_[j].load(std::memory_order_relaxed)].store(true, std::memory_order_relaxed);
+            }
+            jobCursor_.store(static_cast<uint64_t>(generation) << 32 | static_cast<uint64_t>(activeVoices) << 16,
+                             std::memory_order_release);
+            jobGeneration_.store(generation, std::memory_order_release);
+            jobGeneration_.notify_all();
+            
+            // The audio thread renders every voice no worker has claimed, then
+            // waits for the stragglers until the deadline. Past it, a voice a
+            // preempted worker is still rendering is left out of this mix.
+            renderJobVoices(renderScratch_[0], generation);
+            for (int j = 0; j < activeVoices; ++j) {
+                int id = jobVoices_[j].load(std::memory_order_relaxed);
+                while (voiceStalled(id) && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+            }
+        } else {
+            for (int j = 0; j < activeVoices; ++j) {
+                int id = jobVoices_[j].load(std::memory_order_relaxed);
+                processor_.processVoiceLocked(voices_[id].state, renderScratch_[0],
+                                        voiceOutputs_.data() + static_cast<size_t>(id) * voiceOutputFrames_ + segmentStart,
+                                        segmentFrames);
+            }
+        }
         
         // Apply some gain reduction if many voices are active to prevent clipping
-        if (activeVoices > 1) {
-            float mixGain = 1.0f / std::sqrt(static_cast<float>(activeVoices));
-            for (uint32_t i = 0; i < frameCount * channelCount; ++i) {
-                outputBuffer[i] *= mixGain;
+        float mixGain = activeVoices > 1 ? 1.0f / std::sqrt(static_cast<float>(activeVoices)) : 1.0f;
+        
+        // Deterministic mix: always sum in slot order, whichever thread rendered the voice
+        float* segmentOutput = outputBuffer + static_cast<size_t>(segmentStart) * channelCount;
+        for (int j = 0; j < activeVoices; ++j) {
+            int id = jobVoices_[j].load(std::memory_order_relaxed);
+            if (voiceStalled(id)) {
+                continue;
+            }
+            const float* voiceBlock = voiceOutputs_.data() + static_cast<size_t>(id) * voiceOutputFrames_ + segmentStart;
+            for (uint32_t i = 0; i < segmentFrames; ++i) {
+                float sample = voiceBlock[i] * mixGain;
+                for (uint32_t ch = 0; ch < channelCount; ++ch) {
+                    segmentOutput[i * channelCount + ch] += sample;
+                }
             }
         }
         
-        // Debug logging (only occasionally)
-        static int processCount = 0;
-        if (++processCount % 100 == 0 && activeVoices > 0) {
-            Logger::get().debug("🎵 Polyphonic processor: {} active voices", activeVoices);
+        // Update voice ages
+        updateVoiceAges(segmentFrames);
+        return activeVoices;
+    }
+    
+    void TaffyPolyphonicProcessor::setParameter(uint64_t parameterHash, float value, uint32_t sampleOffset) {
+        // Lock-free hand-off to the audio thread, which applies it in processAudio
+        if (!parameterEvents_.push({parameterHash, value, sampleOffset})) {
+            Logger::get().warning("Polyphonic parameter queue full, dropping update 0x{:x}", parameterHash);
         }
     }
     
-    void TaffyPolyphonicProcessor::setParameter(uint64_t parameterHash, float value) {
-        std::lock_guard<std::mutex> lock(voicesMutex_);
-        
+    void TaffyPolyphonicProcessor::applyParameter(uint64_t parameterHash, float value) {
+        // Audio thread with the graph held: no logging, locking or allocation here
         // Special handling for gate parameters - these trigger new voices
         if (parameterHash == Taffy::fnv1a_hash("gate")) {
             // Check if this is a rising edge (0->1)
-            auto routeIt = parameterRoutes_.find(parameterHash);
-            float lastValue = 0.0f;
-            
-            if (routeIt != parameterRoutes_.end()) {
-                lastValue = routeIt->second.lastValue;
-            }
+            ParameterRoute* route = findRoute(parameterHash);
+            float lastValue = route != nullptr ? route->lastValue : 0.0f;
             
             if (lastValue < 0.5f && value >= 0.5f) {
                 // Rising edge - allocate a new voice
                 int voiceId = allocateVoice(parameterHash);
                 if (voiceId >= 0) {
-                    Logger::get().info("🎵 Gate rising edge - allocated voice {}", voiceId);
-                    voices_[voiceId].processor->setParameter(parameterHash, value);
+                    processor_.setVoiceParameterLocked(voices_[voiceId].state, parameterHash, value);
                     voices_[voiceId].lastGate = value;
+                    voicesStarted_.fetch_add(1, std::memory_order_relaxed);
                     
-                    // Update routing
-                    parameterRoutes_[parameterHash] = {parameterHash, voiceId, value};
+                    // Update routing, taking a free slot for a new gate parameter
+                    if (route == nullptr) {
+                        route = findRoute(0);
+                    }
+                    if (route != nullptr) {
+                        *route = {parameterHash, voiceId, value};
+                    }
                 }
             } else if (lastValue >= 0.5f && value < 0.5f) {
                 // Falling edge - find the voice and set gate off
-                if (routeIt != parameterRoutes_.end() && routeIt->second.voiceId >= 0) {
-                    int voiceId = routeIt->second.voiceId;
+                if (route != nullptr && route->voiceId >= 0) {
+                    int voiceId = route->voiceId;
                     if (voiceId < MAX_VOICES && voices_[voiceId].active) {
-                        voices_[voiceId].processor->setParameter(parameterHash, value);
+                        if (!voiceStalled(voiceId)) {
+                            processor_.setVoiceParameterLocked(voices_[voiceId].state, parameterHash, value);
+                        }
                         voices_[voiceId].lastGate = value;
                         voices_[voiceId].releaseAge = 0;  // Start counting release time
-                        Logger::get().info("🎵 Gate falling edge - voice {} released", voiceId);
+                        voicesReleased_.fetch_add(1, std::memory_order_relaxed);
                     }
                 }
                 
                 // Clear the parameter route so next trigger allocates a new voice
-                parameterRoutes_.erase(parameterHash);
+                if (route != nullptr) {
+                    *route = ParameterRoute{};
+                }
             }
         } else {
             // Non-gate parameter - send to all active voices
             for (auto& voice : voices_) {
-                if (voice.active) {
-                    voice.processor->setParameter(parameterHash, value);
+                if (voice.active && !voiceStalled(voice.id)) {
+                    processor_.setVoiceParameterLocked(voice.state, parameterHash, value);
                 }
             }
         }
     }
     
+    TaffyPolyphonicProcessor::ParameterRoute* TaffyPolyphonicProcessor::findRoute(uint64_t parameterHash) {
+        for (auto& route : parameterRoutes_) {
+            if (route.paramHash == parameterHash) {
+                return &route;
+            }
+        }
+        return nullptr;
+    }
+    
+    TaffyPolyphonicProcessor::VoiceStats TaffyPolyphonicProcessor::voiceStats() const {
+        VoiceStats stats;
+        stats.started = voicesStarted_.load(std::memory_order_relaxed);
+        stats.released = voicesReleased_.load(std::memory_order_relaxed);
+        stats.stolen = voicesStolen_.load(std::memory_order_relaxed);
+        stats.finished = voicesFinished_.load(std::memory_order_relaxed);
+        stats.active = activeVoiceCount_.load(std::memory_order_relaxed);
+        return stats;
+    }
+    
     void TaffyPolyphonicProcessor::setStreamingTafLoader(std::shared_ptr<Taffy::StreamingTaffyLoader> loader) {
         std::lock_guard<std::mutex> lock(voicesMutex_);
+        waitForStalledVoices();
         
-        // Set loader for all voices
-        for (auto& voice : voices_) {
-            voice.processor->setStreamingTafLoader(loader);
-        }
+        // Streaming state lives in the shared processor
+        processor_.setStreamingTafLoader(loader);
         
         Logger::get().info("✅ Set streaming TAF loader for all {} voices", MAX_VOICES);
     }
     
+    bool TaffyPolyphonicProcessor::setStreamingTafFile(const std::string& tafPath) {
+        std::lock_guard<std::mutex> lock(voicesMutex_);
+        waitForStalledVoices();
+        
+        // Voices keep their own cursors into the shared mapping
+        return processor_.setStreamingTafFile(tafPath);
+    }
+    
+    void TaffyPolyphonicProcessor::setRenderThreads(uint32_t threadCount) {
+        std::lock_guard<std::mutex> lock(voicesMutex_);
+        
+        stopRenderPool();
+        
+        // One scratch per renderer so no render state is shared between threads
+        renderScratch_.resize(static_cast<size_t>(threadCount) + 1);
+        stopRenderThreads_.store(false, std::memory_order_relaxed);
+        renderThreads_.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i) {
+            renderThreads_.emplace_back(&TaffyPolyphonicProcessor::renderWorker, this, static_cast<size_t>(i) + 1);
+        }
+        
+        Logger::get().info("🧵 Polyphonic voice rendering on {} worker threads", threadCount);
+    }
+    
+    void TaffyPolyphonicProcessor::stopRenderPool() {
+        if (renderThreads_.empty()) {
+            return;
+        }
+        
+        stopRenderThreads_.store(true, std::memory_order_release);
+        jobGeneration_.fetch_add(1, std::memory_order_acq_rel);
+        jobGeneration_.notify_all();
+        for (auto& thread : renderThreads_) {
+            thread.join();
+        }
+        renderThreads_.clear();
+    }
+    
+    void TaffyPolyphonicProcessor::waitForStalledVoices() const {
+        for (const auto& pending : voicePending_) {
+            while (pending.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    void TaffyPolyphonicProcessor::renderWorker(size_t scratchIndex) {
+        if (!raiseRenderThreadPriority()) {
+            Logger::get().warning("Polyphonic render worker {} could not get real-time priority", scratchIndex);
+        }
+        
+        uint32_t seen = jobGeneration_.load(std::memory_order_acquire);
+        while (true) {
+            jobGeneration_.wait(seen, std::memory_order_acquire);
+            seen = jobGeneration_.load(std::memory_order_acquire);
+            if (stopRenderThreads_.load(std::memory_order_acquire)) {
+                return;
+            }
+            renderJobVoices(renderScratch_[scratchIndex], seen);
+        }
+    }
+    
+    void TaffyPolyphonicProcessor::renderJobVoices(TaffyAudioProcessor::RenderScratch& scratch, uint32_t generation) {
+        uint64_t cursor = jobCursor_.load(std::memory_order_acquire);
+        while (true) {
+            // Stop once the job is exhausted or a newer job has replaced it. The
+            // bound comes from the cursor word, so a successful claim always
+            // refers to the job that was published with that cursor.
+            uint32_t next = static_cast<uint32_t>(cursor & 0xFFFF);
+            uint32_t count = static_cast<uint32_t>((cursor >> 16) & 0xFFFF);
+            if (static_cast<uint32_t>(cursor >> 32) != generation || next >= count) {
+                return;
+            }
+            
+            // Read the job before claiming. The audio thread only rewrites it after
+            // seeing this job's cursor exhausted, so a successful claim means these
+            // are this job's values even if the audio thread moves on mid-render.
+            int id = jobVoices_[next].load(std::memory_order_relaxed);
+            uint32_t offset = jobOffset_.load(std::memory_order_relaxed);
+            uint32_t frames = jobFrames_.load(std::memory_order_relaxed);
+            if (!jobCursor_.compare_exchange_weak(cursor, cursor + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                continue;
+            }
+            
+            // Each voice owns its state and output block, so no further synchronization is needed
+            processor_.processVoiceLocked(voices_[id].state, scratch,
+                                    voiceOutputs_.data() + static_cast<size_t>(id) * voiceOutputFrames_ + offset,
+                                    frames);
+            voicePending_[id].store(false, std::memory_order_release);
+            cursor = jobCursor_.load(std::memory_order_acquire);
+        }
+    }
+    
     int TaffyPolyphonicProcessor::allocateVoice(uint64_t triggerParam) {
-        // First, try to find an inactive voice
+        // First, try to find an inactive voice; a stalled worker may still hold a deactivated one
         for (int i = 0; i < MAX_VOICES; ++i) {
-            if (!voices_[i].active) {
+            if (!voices_[i].active && !voiceStalled(i)) {
                 voices_[i].active = true;
                 voices_[i].age = 0;
                 voices_[i].priority = 1.0f;
@@ -167,8 +397,7 @@ namespace tremor::audio {
         // All voices active - steal the oldest one
         int oldestVoice = findOldestVoice();
         if (oldestVoice >= 0) {
-            Logger::get().info("🔄 Voice stealing: taking voice {} (age={})", 
-                             oldestVoice, voices_[oldestVoice].age);
+            voicesStolen_.fetch_add(1, std::memory_order_relaxed);
             
             // Reset the voice
             voices_[oldestVoice].active = true;
@@ -178,7 +407,7 @@ namespace tremor::audio {
             voices_[oldestVoice].releaseAge = 0;
             
             // Force gate off first
-            voices_[oldestVoice].processor->setParameter(Taffy::fnv1a_hash("gate"), 0.0f);
+            processor_.setVoiceParameterLocked(voices_[oldestVoice].state, Taffy::fnv1a_hash("gate"), 0.0f);
             
             return oldestVoice;
         }
@@ -199,8 +428,7 @@ namespace tremor::audio {
                     // Deactivate after 50ms (typical drum tail)
                     if (voice.releaseAge > sampleRate_ / 20) {
                         voice.active = false;
-                        Logger::get().debug("🔕 Voice {} auto-deactivated after {} samples", 
-                                          voice.id, voice.releaseAge);
+                        voicesFinished_.fetch_add(1, std::memory_order_relaxed);
                     }
                 }
             }
@@ -212,7 +440,7 @@ namespace tremor::audio {
         int maxAge = -1;
         
         for (int i = 0; i < MAX_VOICES; ++i) {
-            if (voices_[i].active && voices_[i].age > maxAge) {
+            if (voices_[i].active && !voiceStalled(i) && voices_[i].age > maxAge) {
                 maxAge = voices_[i].age;
                 oldestVoice = i;
             }
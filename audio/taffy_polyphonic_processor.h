@@ -2,24 +2,38 @@
 
 #include "taffy_audio_processor.h"
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <queue>
+#include <thread>
 
 namespace tremor::audio {
 
     /**
      * Polyphonic wrapper for TaffyAudioProcessor
-     * Manages multiple voices for polyphonic playback
+     * Manages multiple voices for polyphonic playback. The graph and samples are
+     * loaded once into a shared processor; each voice only carries its DSP state.
+     *
+     * Voices can optionally be rendered on a fixed pool of worker threads. Every
+     * voice renders into its own mono block and the blocks are summed in voice
+     * order, so the mix is bit-identical regardless of the thread count.
+     * The workers run at real-time priority where the OS allows it, and the
+     * audio thread never waits on them past half the block: a voice still
+     * being rendered by a preempted worker sits out of the mix until it is done.
+     * processAudio takes the graph once per block without blocking; a stalled
+     * worker can outlive that hold, so anything that reloads the graph first
+     * waits for stalled voices.
      */
     class TaffyPolyphonicProcessor {
     public:
-        static constexpr int MAX_VOICES = 16;  // Maximum simultaneous voices
+        static constexpr int MAX_VOICES = 128;  // Maximum simultaneous voices
         
         struct Voice {
             int id;
             bool active;
             int age;  // How many samples since voice started
             float priority;  // For voice stealing
-            std::unique_ptr<TaffyAudioProcessor> processor;
+            TaffyAudioProcessor::VoiceState state;  // Per-voice DSP state for the shared graph
             
             // Voice-specific parameters
             uint64_t triggerParam;  // Parameter that triggered this voice
@@ -27,11 +41,19 @@ namespace tremor::audio {
             int releaseAge;         // Samples since gate was released
         };
         
+        struct VoiceStats {
+            uint64_t started = 0;    // Gate rising edges that got a voice
+            uint64_t released = 0;   // Gate falling edges that released a voice
+            uint64_t stolen = 0;     // Playing voices taken for a new note
+            uint64_t finished = 0;   // Voices deactivated after their release
+            int active = 0;          // Voices rendered in the last block
+        };
+        
         TaffyPolyphonicProcessor(uint32_t sampleRate = 48000);
         ~TaffyPolyphonicProcessor();
         
         /**
-         * Load audio chunk into all voices
+         * Load audio chunk into the shared graph and reset all voices
          */
         bool loadAudioChunk(const std::vector<uint8_t>& audioData);
         
@@ -41,32 +63,105 @@ namespace tremor::audio {
         void processAudio(float* outputBuffer, uint32_t frameCount, uint32_t channelCount = 2);
         
         /**
-         * Set a parameter value (will route to appropriate voice)
+         * Queue a parameter change (will route to appropriate voice)
+         * Lock-free; call from a single producer thread. Gate changes allocate
+         * and release voices when the audio thread applies them.
+         * @param sampleOffset Sample offset from the start of the next block
          */
-        void setParameter(uint64_t parameterHash, float value);
+        void setParameter(uint64_t parameterHash, float value, uint32_t sampleOffset = 0);
         
         /**
          * Set streaming TAF loader for all voices
          */
         void setStreamingTafLoader(std::shared_ptr<Taffy::StreamingTaffyLoader> loader);
         
+        /**
+         * Stream from a memory mapping of the .taf the graph was loaded from;
+         * every voice then plays streamed audio independently
+         */
+        bool setStreamingTafFile(const std::string& tafPath);
+        
+        /**
+         * Render voices on a pool of worker threads alongside the audio thread
+         * @param threadCount Number of worker threads; 0 renders all voices on the audio thread
+         */
+        void setRenderThreads(uint32_t threadCount);
+        
+        /**
+         * Per node type render cost of the shared graph, summed over all voices
+         */
+        void setNodeProfiling(bool enabled) { processor_.setNodeProfiling(enabled); }
+        std::vector<TaffyAudioProcessor::NodeTypeCost> nodeTypeCosts() const { return processor_.nodeTypeCosts(); }
+        void resetNodeTypeCosts() { processor_.resetNodeTypeCosts(); }
+        
+        /**
+         * Voice allocation counters kept by the audio thread; safe to read from any thread
+         */
+        VoiceStats voiceStats() const;
+        
     private:
         uint32_t sampleRate_;
+        TaffyAudioProcessor processor_;         // Shared graph, samples and streaming state
         std::array<Voice, MAX_VOICES> voices_;
-        std::vector<uint8_t> audioChunkData_;  // Cached audio chunk for new voices
+        
+        // Preallocated render buffers, grown only when a larger block arrives.
+        // renderScratch_[0] belongs to the audio thread, [i + 1] to worker i.
+        std::vector<TaffyAudioProcessor::RenderScratch> renderScratch_;
+        std::vector<float> voiceOutputs_;       // One mono block per voice slot
+        uint32_t voiceOutputFrames_ = 0;
+        
+        // Render job shared with the workers. The cursor packs the job
+        // generation in the high 32 bits, the job's voice count in the next 16
+        // and the next job index in the low 16. Claims are bounded by the count
+        // in the same word, so a worker waking late can never claim a voice
+        // from a newer job, even while the audio thread rewrites the job data.
+        std::vector<std::thread> renderThreads_;
+        std::array<std::atomic<int>, MAX_VOICES> jobVoices_{};
+        std::atomic<uint32_t> jobOffset_{0};
+        std::atomic<uint32_t> jobFrames_{0};
+        std::atomic<uint64_t> jobCursor_{0};
+        std::atomic<uint32_t> jobGeneration_{0};
+        std::atomic<bool> stopRenderThreads_{false};
+        
+        // Raised for every voice of a parallel job and cleared by whichever thread
+        // renders it. A voice still raised after the wait belongs to a stalled
+        // worker: the audio thread leaves its state and output block alone until then.
+        std::array<std::atomic<bool>, MAX_VOICES> voicePending_{};
+        
+        int renderSegment(float* outputBuffer, uint32_t segmentStart, uint32_t segmentFrames, uint32_t channelCount,
+                          std::chrono::steady_clock::time_point deadline);
+        void renderWorker(size_t scratchIndex);
+        void renderJobVoices(TaffyAudioProcessor::RenderScratch& scratch, uint32_t generation);
+        void stopRenderPool();
+        bool voiceStalled(int id) const { return voicePending_[id].load(std::memory_order_acquire); }
+        void waitForStalledVoices() const;
+        
+        // Parameter events from setParameter, applied on the audio thread while
+        // processAudio holds the graph, so applying them never locks or allocates
+        ParameterEventQueue parameterEvents_;
+        void applyParameter(uint64_t parameterHash, float value);
         
         // Voice allocation
         int allocateVoice(uint64_t triggerParam);
         void updateVoiceAges(uint32_t frameCount);
         int findOldestVoice();
         
-        // Parameter routing
+        // Parameter routing: the voice each gate parameter is currently holding
+        static constexpr size_t kMaxParameterRoutes = 16;
         struct ParameterRoute {
-            uint64_t paramHash;
-            int voiceId;
-            float lastValue;
+            uint64_t paramHash = 0;  // 0 marks a free slot
+            int voiceId = -1;
+            float lastValue = 0.0f;
         };
-        std::unordered_map<uint64_t, ParameterRoute> parameterRoutes_;
+        std::array<ParameterRoute, kMaxParameterRoutes> parameterRoutes_{};
+        ParameterRoute* findRoute(uint64_t parameterHash);
+        
+        // Written by the audio thread, read through voiceStats()
+        std::atomic<uint64_t> voicesStarted_{0};
+        std::atomic<uint64_t> voicesReleased_{0};
+        std::atomic<uint64_t> voicesStolen_{0};
+        std::atomic<uint64_t> voicesFinished_{0};
+        std::atomic<int> activeVoiceCount_{0};
         
         // Mutex for thread safety
         mutable std::mutex voicesMutex_;
@@ -0,0 +1,154 @@
+#include "taffy_stream_io.h"
+#include "logger.h"
+#include <algorithm>
+
+namespace tremor::audio {
+
+    StreamingIOService& StreamingIOService::instance() {
+        // Never destroyed: processors owned by other statics may still cancel
+        // their reads during shutdown
+        static StreamingIOService* service = new StreamingIOService();
+        return *service;
+    }
+
+    StreamingIOService::StreamingIOService() {
+        // Threads start here so the first submit on the audio thread never spawns one
+        std::lock_guard<std::mutex> lock(mutex_);
+        startThreads(1);
+    }
+
+    StreamingIOService::~StreamingIOService() {
+        stopThreads();
+    }
+
+    void StreamingIOService::setThreadCount(uint32_t threadCount) {
+        threadCount = std::max(threadCount, 1u);
+        stopThreads();
+        std::lock_guard<std::mutex> lock(mutex_);
+        startThreads(threadCount);
+    }
+
+    void StreamingIOService::startThreads(uint32_t threadCount) {
+        // Called with mutex_ held; workers block on it until the caller releases it
+        stopping_ = false;
+        for (uint32_t i = 0; i < threadCount; ++i) {
+            threads_.emplace_back(&StreamingIOService::worker, this);
+        }
+        Logger::get().info("💾 Streaming I/O service running {} threads", threadCount);
+    }
+
+    void StreamingIOService::stopThreads() {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            threads.swap(threads_);
+        }
+        wakeups_.fetch_add(1, std::memory_order_release);
+        wakeups_.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void StreamingIOService::wake() {
+        wakeups_.fetch_add(1, std::memory_order_release);
+        wakeups_.notify_one();
+    }
+
+    bool StreamingIOService::submit(const Request& request) {
+        submitted_.fetch_add(1, std::memory_order_relaxed);
+        if (!intake_.push({request, Clock::now()})) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        wake();
+        return true;
+    }
+
+    void StreamingIOService::drainIntake() {
+        // Called with mutex_ held, which serializes the ring's consumer side
+        Intake intake;
+        while (intake_.pop(intake)) {
+            Clock::time_point deadline = intake.request.deadline;
+            pending_.emplace(deadline, Pending{intake.request, intake.submitted});
+        }
+    }
+
+    void StreamingIOService::cancelOwner(const void* owner) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drainIntake();
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            it = it->second.request.owner == owner ? pending_.erase(it) : std::next(it);
+        }
+        readFinished_.wait(lock, [this, owner] {
+            return std::find(inFlightOwners_.begin(), inFlightOwners_.end(), owner) == inFlightOwners_.end();
+        });
+    }
+
+    void StreamingIOService::reportUnderrun() {
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    StreamingIOService::Stats StreamingIOService::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats = stats_;
+        stats.submitted = submitted_.load(std::memory_order_relaxed);
+        stats.dropped = dropped_.load(std::memory_order_relaxed);
+        stats.underruns = underruns_.load(std::memory_order_relaxed);
+        stats.averageLatencyMs = stats_.completed > 0 ? totalLatencyMs_ / static_cast<double>(stats_.completed) : 0.0;
+        stats.pending = pending_.size();
+        stats.threads = static_cast<uint32_t>(threads_.size());
+        return stats;
+    }
+
+    void StreamingIOService::logStats() const {
+        Stats s = stats();
+        Logger::get().info("💾 Streaming I/O: {} reads of {} submitted ({} dropped), {} late, {} underruns, "
+                           "latency avg {:.2f} ms / max {:.2f} ms, {} pending on {} threads",
+                           s.completed, s.submitted, s.dropped, s.lateReads, s.underruns,
+                           s.averageLatencyMs, s.maxLatencyMs, s.pending, s.threads);
+    }
+
+    void StreamingIOService::worker() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            // Read the wake counter before draining so a push that lands after
+            // the drain changes it and the wait below returns at once
+            const uint32_t seen = wakeups_.load(std::memory_order_acquire);
+            if (stopping_) {
+                return;
+            }
+            drainIntake();
+            if (pending_.empty()) {
+                lock.unlock();
+                wakeups_.wait(seen, std::memory_order_acquire);
+                lock.lock();
+                continue;
+            }
+
+            // Earliest deadline first
+            auto it = pending_.begin();
+            Pending job = it->second;
+            pending_.erase(it);
+            inFlightOwners_.push_back(job.request.owner);
+
+            lock.unlock();
+            job.request.read(job.request.owner, job.request.key, job.request.chunkIndex, job.request.generation);
+            Clock::time_point finished = Clock::now();
+            lock.lock();
+
+            double latencyMs = std::chrono::duration<double, std::milli>(finished - job.submitted).count();
+            ++stats_.completed;
+            totalLatencyMs_ += latencyMs;
+            stats_.maxLatencyMs = std::max(stats_.maxLatencyMs, latencyMs);
+            if (finished > job.request.deadline) {
+                ++stats_.lateReads;
+            }
+
+            inFlightOwners_.erase(std::find(inFlightOwners_.begin(), inFlightOwners_.end(), job.request.owner));
+            readFinished_.notify_all();
+        }
+    }
+
+} // namespace tremor::audio
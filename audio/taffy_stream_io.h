@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tremor::audio {
+
+    /**
+     * Lock-free bounded multi-producer/single-consumer ring buffer
+     * Any number of threads may push; pops must be serialized by the caller.
+     * Producers never block or allocate.
+     */
+    template <typename T, size_t Capacity>
+    class MpscRing {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MpscRing capacity must be a power of two");
+
+    public:
+        MpscRing() {
+            for (size_t i = 0; i < Capacity; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Producer side; returns false if the ring is full
+         */
+        bool push(const T& item) {
+            size_t pos = head_.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = cells_[pos & (Capacity - 1)];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.item = item;
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * Consumer side; returns false if the ring is empty
+         */
+        bool pop(T& item) {
+            const size_t pos = tail_.load(std::memory_order_relaxed);
+            Cell& cell = cells_[pos & (Capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+                return false;
+            }
+            item = cell.item;
+            cell.sequence.store(pos + Capacity, std::memory_order_release);
+            tail_.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence{0};
+            T item{};
+        };
+
+        // Separate cache lines so producers and the consumer don't false-share
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+        alignas(64) std::array<Cell, Capacity> cells_{};
+    };
+
+    /**
+     * Process-wide I/O service for streaming audio reads
+     *
+     * Every audio processor submits its chunk reads here instead of running its
+     * own loader thread. Pending reads are served earliest-deadline-first, where
+     * the deadline is the moment the stream would run out of decoded audio.
+     * submit() and reportUnderrun() are called on the audio path, so they only
+     * push to a lock-free intake ring and bump atomics; the I/O threads move
+     * intake into the deadline queue. Reads are coalesced at the source: a
+     * stream keeps its one read in flight (isLoadingNext) until the read has
+     * run, and a stream that stops orphans that read through the generation
+     * passed back to it rather than recalling it.
+     */
+    class StreamingIOService {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using ReadFn = void (*)(void* owner, void* key, uint32_t chunkIndex, uint32_t generation);
+
+        struct Request {
+            void* owner = nullptr;           // Submitting processor, for cancelOwner
+            void* key = nullptr;             // Buffer the read fills
+            uint32_t chunkIndex = 0;
+            uint32_t generation = 0;         // Passed back to read, for spotting orphaned reads
+            Clock::time_point deadline;
+            ReadFn read = nullptr;           // Runs on an I/O thread
+        };
+
+        struct Stats {
+            uint64_t submitted = 0;
+            uint64_t dropped = 0;            // Submits lost to a full intake ring
+            uint64_t completed = 0;
+            uint64_t lateReads = 0;          // Reads that finished after their deadline
+            uint64_t underruns = 0;          // Reported by processors that had to read synchronously
+            double averageLatencyMs = 0.0;   // Submit to completion
+            double maxLatencyMs = 0.0;
+            size_t pending = 0;
+            uint32_t threads = 0;
+        };
+
+        static StreamingIOService& instance();
+
+        ~StreamingIOService();
+        StreamingIOService(const StreamingIOService&) = delete;
+        StreamingIOService& operator=(const StreamingIOService&) = delete;
+
+        /**
+         * Set the number of I/O threads (default 1); pending reads are kept
+         */
+        void setThreadCount(uint32_t threadCount);
+
+        /**
+         * Queue a read; never blocks or allocates. Returns false if the intake ring is full.
+         */
+        bool submit(const Request& request);
+
+        /**
+         * Drop all pending reads of an owner and wait for its in-flight reads to finish
+         * Call before destroying anything the owner's read callbacks touch. Blocks.
+         */
+        void cancelOwner(const void* owner);
+
+        /**
+         * Record that a stream ran dry and had to be read on the audio thread
+         */
+        void reportUnderrun();
+
+        Stats stats() const;
+        void logStats() const;
+
+    private:
+        StreamingIOService();
+
+        static constexpr size_t kIntakeCapacity = 256;
+
+        struct Intake {
+            Request request;
+            Clock::time_point submitted;
+        };
+
+        struct Pending {
+            Request request;
+            Clock::time_point submitted;
+        };
+
+        void worker();
+        void startThreads(uint32_t threadCount);
+        void stopThreads();
+        void drainIntake();
+        void wake();
+
+        MpscRing<Intake, kIntakeCapacity> intake_;
+        std::atomic<uint32_t> wakeups_{0};   // Bumped per intake push; workers wait on it
+        std::atomic<uint64_t> submitted_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<uint64_t> underruns_{0};
+
+        mutable std::mutex mutex_;           // Never taken on the audio path
+        std::condition_variable readFinished_;
+        std::multimap<Clock::time_point, Pending> pending_;    // Ordered by deadline
+        std::vector<const void*> inFlightOwners_;              // One entry per running read
+        std::vector<std::thread> threads_;
+        bool stopping_ = false;
+
+        Stats stats_;
+        double totalLatencyMs_ = 0.0;
+    };
+
+} // namespace tremor::audio
@@ -60,13 +60,24 @@ set(TREMOR_RUNTIME_SCRIPTING_HEADERS
     ${CMAKE_CURRENT_SOURCE_DIR}/physics_interop.h
 )
 
+set(TREMOR_RUNTIME_GAMEPLAY_SOURCES
+    ${CMAKE_CURRENT_SOURCE_DIR}/dmc_crowd_kernels.cpp
+)
+
 set(TREMOR_RUNTIME_GAMEPLAY_HEADERS
     ${CMAKE_CURRENT_SOURCE_DIR}/dmc_survivors.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/dmc_spatial_hash.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/dmc_physics_lod.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/dmc_crowd_kernels.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/dmc_stage_queue.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/dmc_determinism.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/dmc_snapshot.h
 )
 
 set(TREMOR_RUNTIME_PHYSICS_SOURCES
     ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physics_core.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physics_backend.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physics_contact_stream.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physics_backend_adapter.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physx_physics_world.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/dmc_physics.cpp
@@ -77,6 +88,7 @@ set(TREMOR_RUNTIME_PHYSICS_SOURCES
 set(TREMOR_RUNTIME_PHYSICS_HEADERS
     ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physics_core.h
     ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physics_backend.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physics_contact_stream.h
     ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physics_backend_adapter.h
     ${CMAKE_CURRENT_SOURCE_DIR}/Source/Runtime/TremorPhysics/physx_physics_world.h
     ${CMAKE_CURRENT_SOURCE_DIR}/dmc_physics.h
@@ -86,12 +98,19 @@ set(TREMOR_RUNTIME_PHYSICS_HEADERS
 
 set(TREMOR_RUNTIME_AUDIO_SOURCES
     ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_audio_processor.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_audio_kernels.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_polyphonic_processor.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_mapped_stream.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_stream_io.cpp
 )
 
 set(TREMOR_RUNTIME_AUDIO_HEADERS
     ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_audio_processor.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_audio_kernels.h
     ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_polyphonic_processor.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_parameter_queue.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_mapped_stream.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/audio/taffy_stream_io.h
 )
 
 set(TREMOR_RUNTIME_VM_SOURCES
@@ -185,6 +204,7 @@ set(TREMOR_ALL_SOURCES
     ${TREMOR_FOUNDATION_SOURCES}
     ${TREMOR_RUNTIME_ASSET_SOURCES}
     ${TREMOR_RUNTIME_SCRIPTING_SOURCES}
+    ${TREMOR_RUNTIME_GAMEPLAY_SOURCES}
     ${TREMOR_RUNTIME_PHYSICS_SOURCES}
     ${TREMOR_RUNTIME_AUDIO_SOURCES}
     ${TREMOR_RUNTIME_VM_SOURCES}
@@ -220,6 +240,7 @@ function(tremor_assign_source_groups)
     source_group("Source\\Runtime\\TremorGameplay" FILES
         ${TREMOR_RUNTIME_SCRIPTING_SOURCES}
         ${TREMOR_RUNTIME_SCRIPTING_HEADERS}
+        ${TREMOR_RUNTIME_GAMEPLAY_SOURCES}
         ${TREMOR_RUNTIME_GAMEPLAY_HEADERS})
 
     source_group("Source\\Runtime\\TremorPhysics" FILES
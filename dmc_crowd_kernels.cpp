@@ -0,0 +1,151 @@
+#include "dmc_crowd_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TREMOR_CROWD_KERNELS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TREMOR_CROWD_KERNELS_SSE2 1
+#endif
+
+namespace DMCSurvivors::crowd {
+
+namespace {
+
+// Below this squared distance two agents count as stacked and get no push
+constexpr float kCoincidentDistanceSq = 1e-10f;
+
+// One lane; also used for the tail of every vector loop
+struct ScalarOps {
+    using V = float;
+    using M = bool;
+    static constexpr uint32_t width = 1;
+
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V v) { *p = v; }
+    static V set1(float x) { return x; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V madd(V a, V b, V c) { return a * b + c; }
+    static V max(V a, V b) { return std::max(a, b); }
+    static V sqrt(V a) { return std::sqrt(a); }
+    static M less(V a, V b) { return a < b; }
+    static V select(M m, V a, V b) { return m ? a : b; }
+};
+
+#if defined(TREMOR_CROWD_KERNELS_AVX2)
+struct WideOps {
+    using V = __m256;
+    using M = __m256;
+    static constexpr uint32_t width = 8;
+
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float x) { return _mm256_set1_ps(x); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V madd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    static M less(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+};
+#elif defined(TREMOR_CROWD_KERNELS_SSE2)
+struct WideOps {
+    using V = __m128;
+    using M = __m128;
+    static constexpr uint32_t width = 4;
+
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(float x) { return _mm_set1_ps(x); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V madd(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    static V sqrt(V a) { return _mm_sqrt_ps(a); }
+    static M less(V a, V b) { return _mm_cmplt_ps(a, b); }
+    static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+#else
+using WideOps = ScalarOps;
+#endif
+
+template <typename Ops>
+inline float sumLanes(typename Ops::V v) {
+    float lanes[Ops::width];
+    Ops::store(lanes, v);
+    float sum = 0.0f;
+    for (float lane : lanes) {
+        sum += lane;
+    }
+    return sum;
+}
+
+// Push, and stacked-neighbour count, from neighbours [begin, end) in steps of Ops::width
+template <typename Ops>
+inline uint32_t separationBlock(float x, float z, const float* neighborX, const float* neighborZ,
+                                uint32_t begin, uint32_t end, float radius, SeparationPush& push) {
+    using V = typename Ops::V;
+    const V px = Ops::set1(x);
+    const V pz = Ops::set1(z);
+    const V r = Ops::set1(radius);
+    const V invR = Ops::set1(1.0f / radius);
+    const V zero = Ops::set1(0.0f);
+    const V one = Ops::set1(1.0f);
+    const V coincidentSq = Ops::set1(kCoincidentDistanceSq);
+
+    V sumX = zero;
+    V sumZ = zero;
+    V stacked = zero;
+    uint32_t i = begin;
+    for (; i + Ops::width <= end; i += Ops::width) {
+        const V dx = Ops::sub(px, Ops::load(neighborX + i));
+        const V dz = Ops::sub(pz, Ops::load(neighborZ + i));
+        const V distanceSq = Ops::madd(dx, dx, Ops::mul(dz, dz));
+        const V distance = Ops::sqrt(Ops::max(distanceSq, coincidentSq));
+
+        // (r - d) / (r * d): the direction dx/d scaled by 1 - d/r, zero beyond the radius.
+        // Stacked neighbours have dx == dz == 0 and so add nothing here.
+        const V weight = Ops::div(Ops::mul(Ops::max(Ops::sub(r, distance), zero), invR), distance);
+        sumX = Ops::madd(dx, weight, sumX);
+        sumZ = Ops::madd(dz, weight, sumZ);
+        stacked = Ops::add(stacked, Ops::select(Ops::less(distanceSq, coincidentSq), one, zero));
+    }
+
+    push.x += sumLanes<Ops>(sumX);
+    push.z += sumLanes<Ops>(sumZ);
+    push.coincident += static_cast<uint32_t>(sumLanes<Ops>(stacked));
+    return i;
+}
+
+} // namespace
+
+const char* instructionSet() {
+#if defined(TREMOR_CROWD_KERNELS_AVX2)
+    return "AVX2";
+#elif defined(TREMOR_CROWD_KERNELS_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+void accumulateSeparation(float x, float z, const float* neighborX, const float* neighborZ,
+                          uint32_t count, float radius, SeparationPush& push) {
+    if (count == 0 || !(radius > 0.0f)) {
+        return;
+    }
+    const uint32_t done = separationBlock<WideOps>(x, z, neighborX, neighborZ, 0, count, radius, push);
+    separationBlock<ScalarOps>(x, z, neighborX, neighborZ, done, count, radius, push);
+}
+
+} // namespace DMCSurvivors::crowd
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace DMCSurvivors::crowd {
+
+// Separation kernels for the enemy crowd. Neighbours are passed as contiguous
+// X/Z arrays (one cell of the per-frame crowd index), so the distance math runs
+// several neighbours per instruction: AVX2/FMA when this file is built with
+// TREMOR_CROWD_AVX2, SSE2 on any other x86 target, scalar everywhere else.
+
+struct SeparationPush {
+    float x = 0.0f;
+    float z = 0.0f;
+    uint32_t coincident = 0;    // Neighbours at the agent's exact position, itself included
+};
+
+// Name of the instruction set the kernels were compiled for
+const char* instructionSet();
+
+// Add the push away from every neighbour closer than radius to push. Each
+// neighbour contributes a unit direction scaled by 1 - distance / radius.
+void accumulateSeparation(float x, float z, const float* neighborX, const float* neighborZ,
+                          uint32_t count, float radius, SeparationPush& push);
+
+} // namespace DMCSurvivors::crowd
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "logger.h"
+
+namespace DMCSurvivors {
+
+enum class DeterminismMode : uint8_t {
+    Off,
+    Record,  // Write one state hash per frame
+    Verify   // Compare each frame's hash with a recorded trace
+};
+
+// Per-frame state hashes for comparing two runs of the simulation, typically one
+// with a single thread and one with flecs workers. Only meaningful when both runs
+// use the same seed, a fixed frame time and the same input.
+class DeterminismTrace {
+public:
+    DeterminismTrace() = default;
+    DeterminismTrace(const DeterminismTrace&) = delete;
+    DeterminismTrace& operator=(const DeterminismTrace&) = delete;
+
+    ~DeterminismTrace() {
+        if (mode_ == DeterminismMode::Verify && mismatchFrame_ < 0) {
+            Logger::get().info("Determinism check passed for {} frames", frame_);
+        }
+    }
+
+    bool open(DeterminismMode mode, const std::string& path) {
+        mode_ = mode;
+        if (mode_ == DeterminismMode::Record) {
+            output_.open(path, std::ios::trunc);
+        } else if (mode_ == DeterminismMode::Verify) {
+            input_.open(path);
+        }
+        if (mode_ != DeterminismMode::Off && !output_.is_open() && !input_.is_open()) {
+            Logger::get().error("Failed to open determinism trace '{}'", path);
+            mode_ = DeterminismMode::Off;
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] DeterminismMode mode() const { return mode_; }
+    [[nodiscard]] bool enabled() const { return mode_ != DeterminismMode::Off; }
+    [[nodiscard]] bool diverged() const { return mismatchFrame_ >= 0; }
+
+    // Returns false on the first frame that doesn't match the recorded trace
+    bool frame(uint64_t stateHash) {
+        const int64_t frame = frame_++;
+        if (mode_ == DeterminismMode::Record) {
+            output_ << frame << ' ' << stateHash << '\n';
+            return true;
+        }
+        if (mode_ != DeterminismMode::Verify || diverged()) {
+            return !diverged();
+        }
+
+        int64_t recordedFrame = 0;
+        uint64_t recordedHash = 0;
+        if (!(input_ >> recordedFrame >> recordedHash)) {
+            return true;  // Ran past the end of the recording
+        }
+        if (recordedFrame != frame || recordedHash != stateHash) {
+            mismatchFrame_ = frame;
+            Logger::get().error(
+                "Determinism check failed at frame {}: state hash {:016x}, recorded {:016x}",
+                frame, stateHash, recordedHash);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    DeterminismMode mode_ = DeterminismMode::Off;
+    std::ofstream output_;
+    std::ifstream input_;
+    int64_t frame_ = 0;
+    int64_t mismatchFrame_ = -1;
+};
+
+} // namespace DMCSurvivors
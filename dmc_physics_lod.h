@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace DMCSurvivors {
+
+// Decides which enemies hold one of the limited physics bodies. Candidates are
+// added every frame; select() picks the nearest eligible ones with a partial
+// selection instead of a full sort, and hands out at most a few promotions and
+// demotions per frame so body creation never lands on a single frame.
+class PhysicsLODSelector {
+public:
+    struct Config {
+        size_t capacity = 24;
+        float promoteDistance = 18.0f;
+        float demoteDistance = 24.0f;
+        // Enemies that already have a body compete at this fraction of their squared
+        // distance, so two enemies at nearly the same range don't trade a body every frame
+        float retainBias = 0.81f;
+        size_t maxPromotionsPerFrame = 4;
+        size_t maxDemotionsPerFrame = 4;
+    };
+
+    struct Stats {
+        size_t candidates = 0;
+        size_t eligible = 0;
+        size_t selected = 0;
+        size_t bodies = 0;              // Bodies held after this frame's changes
+        size_t promotions = 0;
+        size_t demotions = 0;
+        size_t deferredPromotions = 0;  // Held back by the per-frame budget or a full pool
+        size_t deferredDemotions = 0;
+    };
+
+    PhysicsLODSelector() = default;
+    explicit PhysicsLODSelector(const Config& config) : config_(config) {}
+
+    [[nodiscard]] const Config& config() const { return config_; }
+    [[nodiscard]] const Stats& stats() const { return stats_; }
+    [[nodiscard]] std::span<const uint64_t> promotions() const { return promotions_; }
+    [[nodiscard]] std::span<const uint64_t> demotions() const { return demotions_; }
+
+    void begin() {
+        candidates_.clear();
+        promotions_.clear();
+        demotions_.clear();
+        stats_ = {};
+    }
+
+    // pinned candidates (launched enemies) are always eligible, come first and are never demoted
+    void add(uint64_t id, float distanceSq, bool hasBody, bool pinned) {
+        const float promoteDistanceSq = config_.promoteDistance * config_.promoteDistance;
+        const float demoteDistanceSq = config_.demoteDistance * config_.demoteDistance;
+        Candidate candidate;
+        candidate.id = id;
+        candidate.key = hasBody ? distanceSq * config_.retainBias : distanceSq;
+        candidate.hasBody = hasBody;
+        candidate.pinned = pinned;
+        candidate.eligible = pinned || distanceSq <= (hasBody ? demoteDistanceSq : promoteDistanceSq);
+        candidates_.push_back(candidate);
+    }
+
+    void select() {
+        stats_.candidates = candidates_.size();
+
+        // Eligible candidates to the front, then the best `capacity` of them to the front of that
+        const auto eligibleEnd = std::partition(candidates_.begin(), candidates_.end(),
+                                                [](const Candidate& candidate) { return candidate.eligible; });
+        stats_.eligible = static_cast<size_t>(eligibleEnd - candidates_.begin());
+        stats_.selected = std::min(stats_.eligible, config_.capacity);
+        const auto selectedEnd = candidates_.begin() + static_cast<std::ptrdiff_t>(stats_.selected);
+        if (stats_.eligible > config_.capacity) {
+            std::nth_element(candidates_.begin(), selectedEnd, eligibleEnd, betterCandidate);
+        }
+
+        size_t bodies = 0;
+        promotionIndices_.clear();
+        demotionIndices_.clear();
+        for (size_t index = 0; index < candidates_.size(); ++index) {
+            Candidate& candidate = candidates_[index];
+            candidate.selected = index < stats_.selected;
+            bodies += candidate.hasBody ? 1 : 0;
+            if (candidate.hasBody && !candidate.selected && !candidate.pinned) {
+                demotionIndices_.push_back(static_cast<uint32_t>(index));
+            } else if (!candidate.hasBody && candidate.selected) {
+                promotionIndices_.push_back(static_cast<uint32_t>(index));
+            }
+        }
+
+        // Demotions go first so their bodies can be handed out this frame. Only the
+        // budgeted number is applied, farthest first; the rest keep their body for now.
+        const size_t demotionCount = std::min(demotionIndices_.size(), config_.maxDemotionsPerFrame);
+        stats_.deferredDemotions = demotionIndices_.size() - demotionCount;
+        if (stats_.deferredDemotions > 0) {
+            std::nth_element(demotionIndices_.begin(),
+                             demotionIndices_.begin() + static_cast<std::ptrdiff_t>(demotionCount),
+                             demotionIndices_.end(), [this](uint32_t left, uint32_t right) {
+                                 return candidates_[left].key > candidates_[right].key;
+                             });
+        }
+        for (size_t i = 0; i < demotionCount; ++i) {
+            demotions_.push_back(candidates_[demotionIndices_[i]].id);
+        }
+        bodies -= demotionCount;
+
+        // Nearest first; pinned promotions skip the per-frame budget but not the pool size
+        std::sort(promotionIndices_.begin(), promotionIndices_.end(), [this](uint32_t left, uint32_t right) {
+            return betterCandidate(candidates_[left], candidates_[right]);
+        });
+        size_t budgeted = 0;
+        for (uint32_t index : promotionIndices_) {
+            const Candidate& candidate = candidates_[index];
+            if (bodies >= config_.capacity || (!candidate.pinned && budgeted >= config_.maxPromotionsPerFrame)) {
+                break;
+            }
+            budgeted += candidate.pinned ? 0 : 1;
+            promotions_.push_back(candidate.id);
+            ++bodies;
+        }
+        stats_.deferredPromotions = promotionIndices_.size() - promotions_.size();
+
+        stats_.promotions = promotions_.size();
+        stats_.demotions = demotions_.size();
+        stats_.bodies = bodies;
+    }
+
+private:
+    struct Candidate {
+        uint64_t id = 0;
+        float key = 0.0f;
+        bool hasBody = false;
+        bool pinned = false;
+        bool eligible = false;
+        bool selected = false;
+    };
+
+    static bool betterCandidate(const Candidate& left, const Candidate& right) {
+        if (left.pinned != right.pinned) {
+            return left.pinned;
+        }
+        return left.key < right.key;
+    }
+
+    Config config_;
+    Stats stats_;
+    std::vector<Candidate> candidates_;
+    std::vector<uint64_t> promotions_;
+    std::vector<uint64_t> demotions_;
+    std::vector<uint32_t> promotionIndices_;
+    std::vector<uint32_t> demotionIndices_;
+};
+
+} // namespace DMCSurvivors
@@ -0,0 +1,241 @@
+// Headless benchmark for the DMC Survivors simulation.
+//
+// Builds DMCSurvivors::Game without SDL or Vulkan, runs it at a fixed time
+// step under scripted input and reports the simulation throughput together
+// with the per-system timings collected by tremor::trace::Profiler as JSON,
+// so CI hosts without a GPU can track simulation cost across commits.
+//
+// Usage: TremorSimBench [options]
+//   --seconds N          Simulated time (default 60)
+//   --rate HZ            Fixed ticks per second (default 60)
+//   --wave-size N        Enemies per wave, held for the whole run (default 200)
+//   --spawn-interval S   Seconds between enemy spawns (default 0.05)
+//   --threads N          flecs worker threads (default 1)
+//   --physics NAME       jolt or physx (default jolt)
+//   --seed N             Spawn RNG seed (default 1)
+//   --out FILE.json      Write the report to a file instead of stdout
+
+#include "dmc_survivors.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct Options {
+        double seconds = 60.0;
+        uint32_t tickRate = 60;
+        int waveSize = 200;
+        float spawnInterval = 0.05f;
+        uint32_t threads = 1;
+        uint32_t seed = 1;
+        tremor::physics::PhysicsBackendKind backend = tremor::physics::PhysicsBackendKind::Jolt;
+        std::string outputPath;
+    };
+
+    // Whole-run totals for one profiler zone
+    struct ZoneTotals {
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+        uint64_t calls = 0;
+    };
+
+    void printUsage() {
+        std::cerr << "Usage: TremorSimBench [--seconds N] [--rate HZ] [--wave-size N] [--spawn-interval S]\n"
+                  << "                      [--threads N] [--physics jolt|physx] [--seed N] [--out file.json]"
+                  << std::endl;
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (!v) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            ++i;
+
+            if (arg == "--seconds") {
+                options.seconds = std::atof(v);
+            } else if (arg == "--rate") {
+                options.tickRate = static_cast<uint32_t>(std::atoi(v));
+            } else if (arg == "--wave-size") {
+                options.waveSize = std::atoi(v);
+            } else if (arg == "--spawn-interval") {
+                options.spawnInterval = static_cast<float>(std::atof(v));
+            } else if (arg == "--threads") {
+                options.threads = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+            } else if (arg == "--seed") {
+                options.seed = static_cast<uint32_t>(std::strtoul(v, nullptr, 10));
+            } else if (arg == "--physics") {
+                const std::string name = v;
+                if (name == "physx") {
+                    options.backend = tremor::physics::PhysicsBackendKind::PhysX;
+                } else if (name != "jolt") {
+                    std::cerr << "Unknown physics backend: " << name << std::endl;
+                    return false;
+                }
+            } else if (arg == "--out") {
+                options.outputPath = v;
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.seconds <= 0.0 || options.tickRate == 0 || options.waveSize <= 0 || options.spawnInterval <= 0.0f) {
+            std::cerr << "--seconds, --rate, --wave-size and --spawn-interval must be positive" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // The player circles the arena, attacks on a fixed rhythm and dashes and jumps
+    // now and then, so melee, dash and launch paths all see load
+    DMCSurvivors::InputCommand scriptedInput(uint64_t tick, uint32_t tickRate) {
+        const double time = static_cast<double>(tick) / tickRate;
+        const uint64_t second = tick / tickRate;
+        const uint64_t tickInSecond = tick % tickRate;
+
+        DMCSurvivors::InputCommand input;
+        const float angle = static_cast<float>(time * 0.5);
+        input.moveDirection = glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+        input.lightAttack = tickInSecond % (tickRate / 4 + 1) == 0;
+        input.heavyAttack = tickInSecond == 0 && second % 2 == 1;
+        input.dash = tickInSecond == tickRate / 2 && second % 3 == 0;
+        input.jump = tickInSecond == 0 && second % 5 == 4;
+        return input;
+    }
+
+    std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+                quoted += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                std::ostringstream escaped;
+                escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+                quoted += escaped.str();
+            } else {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    // The game narrates spawns and waves at info level; keep stdout for the report
+    Logger::get().setLevel(Logger::Level::Error);
+
+    DMCSurvivors::GameOptions gameOptions;
+    gameOptions.simulationThreads = options.threads;
+    gameOptions.seed = options.seed;
+    DMCSurvivors::Game game(options.backend, gameOptions);
+    game.setSystemProfiling(true);
+
+    flecs::world& world = game.getWorld();
+    const auto holdWaveSize = [&]() {
+        // Wave changes reset the count, so reapply it every tick
+        world.each([&](flecs::entity, DMCSurvivors::WaveSpawner& spawner) {
+            spawner.enemiesPerWave = options.waveSize;
+            spawner.spawnInterval = options.spawnInterval;
+        });
+    };
+
+    auto& profiler = tremor::trace::Profiler::instance();
+    const float dt = 1.0f / static_cast<float>(options.tickRate);
+    const uint64_t tickCount = static_cast<uint64_t>(std::llround(options.seconds * options.tickRate));
+
+    std::map<std::string, ZoneTotals> zones;
+    uint64_t entityTicks = 0;
+    size_t peakEntities = 0;
+    double slowestTickMs = 0.0;
+
+    const auto runStart = std::chrono::steady_clock::now();
+    for (uint64_t tick = 0; tick < tickCount; ++tick) {
+        holdWaveSize();
+
+        profiler.beginFrame();
+        const auto tickStart = std::chrono::steady_clock::now();
+        game.processInput(scriptedInput(tick, options.tickRate));
+        game.update(dt);
+        const double tickMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart).count();
+        profiler.endFrame();
+
+        slowestTickMs = std::max(slowestTickMs, tickMs);
+        for (const tremor::trace::ProfileDisplayRecord& record : profiler.frameRecords()) {
+            ZoneTotals& zone = zones[record.name];
+            zone.totalMs += record.lastMs;
+            zone.maxMs = std::max(zone.maxMs, record.lastMs);
+            zone.calls += record.callCount;
+        }
+
+        const size_t entities = static_cast<size_t>(world.count<DMCSurvivors::Position>());
+        entityTicks += entities;
+        peakEntities = std::max(peakEntities, entities);
+    }
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    std::vector<std::pair<std::string, ZoneTotals>> sortedZones(zones.begin(), zones.end());
+    std::sort(sortedZones.begin(), sortedZones.end(), [](const auto& left, const auto& right) {
+        return left.second.totalMs > right.second.totalMs;
+    });
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4);
+    json << "{\n"
+         << "  \"physics\": " << jsonString(options.backend == tremor::physics::PhysicsBackendKind::PhysX ? "physx" : "jolt") << ",\n"
+         << "  \"threads\": " << options.threads << ",\n"
+         << "  \"tick_rate\": " << options.tickRate << ",\n"
+         << "  \"ticks\": " << tickCount << ",\n"
+         << "  \"wave_size\": " << options.waveSize << ",\n"
+         << "  \"seed\": " << options.seed << ",\n"
+         << "  \"wall_seconds\": " << wallSeconds << ",\n"
+         << "  \"ticks_per_second\": " << tickCount / std::max(wallSeconds, 1e-9) << ",\n"
+         << "  \"entity_ticks_per_second\": " << entityTicks / std::max(wallSeconds, 1e-9) << ",\n"
+         << "  \"mean_entities\": " << static_cast<double>(entityTicks) / std::max<uint64_t>(tickCount, 1) << ",\n"
+         << "  \"peak_entities\": " << peakEntities << ",\n"
+         << "  \"mean_tick_ms\": " << wallSeconds * 1000.0 / std::max<uint64_t>(tickCount, 1) << ",\n"
+         << "  \"max_tick_ms\": " << slowestTickMs << ",\n"
+         << "  \"zones\": [";
+    for (size_t index = 0; index < sortedZones.size(); ++index) {
+        const auto& [name, zone] = sortedZones[index];
+        json << (index == 0 ? "\n" : ",\n")
+             << "    {\"name\": " << jsonString(name)
+             << ", \"total_ms\": " << zone.totalMs
+             << ", \"mean_ms\": " << zone.totalMs / std::max<uint64_t>(tickCount, 1)
+             << ", \"max_ms\": " << zone.maxMs
+             << ", \"calls\": " << zone.calls << "}";
+    }
+    json << "\n  ]\n}\n";
+
+    if (options.outputPath.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream file(options.outputPath, std::ios::trunc);
+        if (!file) {
+            std::cerr << "Failed to write " << options.outputPath << std::endl;
+            return 1;
+        }
+        file << json.str();
+    }
+    return 0;
+}
@@ -0,0 +1,478 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "flecs_interpreter.h"
+
+namespace DMCSurvivors {
+
+// Appends a snapshot's fields as raw little-endian bytes. Layouts are fixed per
+// field, so two snapshots of a similar world line up byte for byte and delta well.
+class SnapshotWriter {
+public:
+    void bytes(const void* data, size_t size) {
+        const auto* begin = static_cast<const uint8_t*>(data);
+        data_.insert(data_.end(), begin, begin + size);
+    }
+
+    template <typename T>
+    void pod(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values are written raw");
+        bytes(&value, sizeof(T));
+    }
+
+    void string(std::string_view text) {
+        pod(static_cast<uint32_t>(text.size()));
+        bytes(text.data(), text.size());
+    }
+
+    // Objects are written with their fields in key order so equal values give equal bytes
+    void value(const tremor::script::Value& value) {
+        using tremor::script::ValueType;
+        const ValueType type = value.type();
+        pod(type);
+        switch (type) {
+            case ValueType::Null:
+                break;
+            case ValueType::Number:
+                pod(*value.asNumber());
+                break;
+            case ValueType::Bool:
+                pod(static_cast<uint8_t>(*value.asBool() ? 1 : 0));
+                break;
+            case ValueType::String:
+                string(*value.asStringView());
+                break;
+            case ValueType::Object:
+                valueMap(value.asObject()->fields);
+                break;
+            case ValueType::Lambda: {
+                const tremor::script::LambdaValue* lambda = value.asLambda();
+                string(lambda->debugName);
+                pod(static_cast<uint32_t>(lambda->parameters.size()));
+                for (const std::string& parameter : lambda->parameters) {
+                    string(parameter);
+                }
+                string(lambda->bodySource);
+                break;
+            }
+            case ValueType::Entity:
+                pod(static_cast<uint64_t>(*value.asEntityId()));
+                break;
+        }
+    }
+
+    void valueMap(const tremor::script::ValueMap& values) {
+        std::vector<const std::pair<const std::string, tremor::script::Value>*> sorted;
+        sorted.reserve(values.size());
+        for (const auto& entry : values) {
+            sorted.push_back(&entry);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const auto* left, const auto* right) {
+            return left->first < right->first;
+        });
+
+        pod(static_cast<uint32_t>(sorted.size()));
+        for (const auto* entry : sorted) {
+            string(entry->first);
+            value(entry->second);
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return data_.size(); }
+    std::vector<uint8_t> take() { return std::move(data_); }
+
+private:
+    std::vector<uint8_t> data_;
+};
+
+// Reads what SnapshotWriter wrote. Every read is bounds checked; after the first
+// short or malformed read the reader fails and stays failed.
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::span<const uint8_t> data) : data_(data) {}
+
+    bool bytes(void* out, size_t size) {
+        if (failed_ || data_.size() - offset_ < size) {
+            failed_ = true;
+            return false;
+        }
+        std::memcpy(out, data_.data() + offset_, size);
+        offset_ += size;
+        return true;
+    }
+
+    template <typename T>
+    bool pod(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values are read raw");
+        return bytes(&value, sizeof(T));
+    }
+
+    bool string(std::string& text) {
+        uint32_t size = 0;
+        if (!pod(size) || data_.size() - offset_ < size) {
+            failed_ = true;
+            return false;
+        }
+        text.assign(reinterpret_cast<const char*>(data_.data() + offset_), size);
+        offset_ += size;
+        return true;
+    }
+
+    bool value(tremor::script::Value& out, uint32_t depth = 0) {
+        using tremor::script::Value;
+        using tremor::script::ValueType;
+        ValueType type = ValueType::Null;
+        // Deeper than any script builds; a corrupt snapshot must not recurse forever
+        if (!pod(type) || depth > kMaxValueDepth) {
+            failed_ = true;
+            return false;
+        }
+        switch (type) {
+            case ValueType::Null:
+                out = Value();
+                return true;
+            case ValueType::Number: {
+                double number = 0.0;
+                if (pod(number)) {
+                    out = Value(number);
+                }
+                break;
+            }
+            case ValueType::Bool: {
+                uint8_t boolean = 0;
+                if (pod(boolean)) {
+                    out = Value(boolean != 0);
+                }
+                break;
+            }
+            case ValueType::String: {
+                std::string text;
+                if (string(text)) {
+                    out = Value(std::move(text));
+                }
+                break;
+            }
+            case ValueType::Object: {
+                out = Value::makeObject();
+                valueMap(out.asObject()->fields, depth + 1);
+                break;
+            }
+            case ValueType::Lambda: {
+                std::string debugName;
+                string(debugName);
+                out = Value::makeLambda(std::move(debugName));
+                tremor::script::LambdaValue* lambda = out.asLambda();
+                uint32_t parameterCount = 0;
+                pod(parameterCount);
+                for (uint32_t index = 0; index < parameterCount && !failed_; ++index) {
+                    string(lambda->parameters.emplace_back());
+                }
+                string(lambda->bodySource);
+                break;
+            }
+            case ValueType::Entity: {
+                uint64_t entity = 0;
+                if (pod(entity)) {
+                    out = Value(static_cast<flecs::entity_t>(entity));
+                }
+                break;
+            }
+            default:
+                failed_ = true;
+                break;
+        }
+        return !failed_;
+    }
+
+    bool valueMap(tremor::script::ValueMap& out, uint32_t depth = 0) {
+        uint32_t count = 0;
+        if (!pod(count)) {
+            return false;
+        }
+        out.clear();
+        for (uint32_t index = 0; index < count && !failed_; ++index) {
+            std::string key;
+            tremor::script::Value entry;
+            if (string(key) && value(entry, depth)) {
+                out.insert_or_assign(std::move(key), std::move(entry));
+            }
+        }
+        return !failed_;
+    }
+
+    [[nodiscard]] bool failed() const { return failed_; }
+    [[nodiscard]] bool atEnd() const { return offset_ == data_.size(); }
+
+private:
+    static constexpr uint32_t kMaxValueDepth = 64;
+
+    std::span<const uint8_t> data_;
+    size_t offset_ = 0;
+    bool failed_ = false;
+};
+
+namespace SnapshotDelta {
+
+inline void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline bool readVarint(std::span<const uint8_t> data, size_t& offset, uint64_t& value) {
+    value = 0;
+    for (uint32_t shift = 0; shift < 64 && offset < data.size(); shift += 7) {
+        const uint8_t byte = data[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// target XOR base (base read as zeros past its end), stored as alternating
+// runs: varint zero count, varint literal count, literal bytes. Frames where
+// little changed are mostly zero runs and shrink to a few bytes per change.
+inline std::vector<uint8_t> encode(std::span<const uint8_t> base, std::span<const uint8_t> target) {
+    // Short zero runs cost more to split out than to carry as literals
+    constexpr size_t kMinZeroRun = 4;
+
+    std::vector<uint8_t> out;
+    writeVarint(out, target.size());
+    const auto xorAt = [&](size_t index) -> uint8_t {
+        return target[index] ^ (index < base.size() ? base[index] : uint8_t{0});
+    };
+
+    size_t index = 0;
+    while (index < target.size()) {
+        const size_t zeroStart = index;
+        while (index < target.size() && xorAt(index) == 0) {
+            ++index;
+        }
+        const size_t zeros = index - zeroStart;
+
+        const size_t literalStart = index;
+        size_t zeroRun = 0;
+        while (index < target.size()) {
+            if (xorAt(index) == 0) {
+                if (++zeroRun == kMinZeroRun) {
+                    index -= kMinZeroRun - 1;
+                    break;
+                }
+            } else {
+                zeroRun = 0;
+            }
+            ++index;
+        }
+        // A trailing zero tail shorter than kMinZeroRun stays in the literal
+        const size_t literals = index - literalStart;
+
+        writeVarint(out, zeros);
+        writeVarint(out, literals);
+        for (size_t offset = literalStart; offset < index; ++offset) {
+            out.push_back(xorAt(offset));
+        }
+    }
+    return out;
+}
+
+inline bool decode(std::span<const uint8_t> base, std::span<const uint8_t> delta, std::vector<uint8_t>& out) {
+    size_t offset = 0;
+    uint64_t size = 0;
+    if (!readVarint(delta, offset, size)) {
+        return false;
+    }
+    out.resize(static_cast<size_t>(size));
+    std::fill(out.begin(), out.end(), uint8_t{0});
+    std::copy_n(base.begin(), std::min(base.size(), out.size()), out.begin());
+
+    size_t index = 0;
+    while (offset < delta.size()) {
+        uint64_t zeros = 0;
+        uint64_t literals = 0;
+        if (!readVarint(delta, offset, zeros) || !readVarint(delta, offset, literals)) {
+            return false;
+        }
+        if (zeros > out.size() - index || literals > out.size() - index - zeros || literals > delta.size() - offset) {
+            return false;
+        }
+        index += static_cast<size_t>(zeros);
+        for (uint64_t literal = 0; literal < literals; ++literal) {
+            out[index++] ^= delta[offset++];
+        }
+    }
+    return true;
+}
+
+} // namespace SnapshotDelta
+
+// The last `capacity` snapshots of a running game, each stored as a delta against
+// the one before it, with a full keyframe every keyframeInterval snapshots so
+// loading one never replays more than that many deltas. The oldest entry is
+// always a keyframe; when it is evicted its successor is expanded in its place.
+class SnapshotRing {
+public:
+    explicit SnapshotRing(size_t capacity = 0, size_t keyframeInterval = 30)
+        : capacity_(capacity), keyframeInterval_(std::max<size_t>(1, keyframeInterval)) {}
+
+    [[nodiscard]] bool enabled() const { return capacity_ > 0; }
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+    [[nodiscard]] bool empty() const { return entries_.empty(); }
+    [[nodiscard]] std::optional<uint64_t> oldestFrame() const {
+        return entries_.empty() ? std::nullopt : std::optional<uint64_t>(entries_.front().frame);
+    }
+    [[nodiscard]] std::optional<uint64_t> newestFrame() const {
+        return entries_.empty() ? std::nullopt : std::optional<uint64_t>(entries_.back().frame);
+    }
+
+    // Bytes held, against what the same snapshots would take uncompressed
+    [[nodiscard]] size_t storedBytes() const { return storedBytes_; }
+    [[nodiscard]] size_t rawBytes() const { return rawBytes_; }
+
+    // Frames must increase; anything at or after frame is dropped first
+    void push(uint64_t frame, std::vector<uint8_t> snapshot) {
+        if (!enabled()) {
+            return;
+        }
+        discardFrom(frame);
+
+        Entry entry;
+        entry.frame = frame;
+        entry.rawSize = snapshot.size();
+        entry.keyframe = entries_.empty() || ++sinceKeyframe_ >= keyframeInterval_;
+        if (!entry.keyframe) {
+            entry.data = SnapshotDelta::encode(latest_, snapshot);
+            // Little in common with the last frame: a keyframe is no bigger
+            entry.keyframe = entry.data.size() >= snapshot.size();
+        }
+        if (entry.keyframe) {
+            entry.data = snapshot;
+            sinceKeyframe_ = 0;
+        }
+        latest_ = std::move(snapshot);
+        add(std::move(entry));
+
+        while (entries_.size() > capacity_) {
+            evictOldest();
+        }
+    }
+
+    bool load(uint64_t frame, std::vector<uint8_t>& out) const {
+        const auto found = std::find_if(entries_.begin(), entries_.end(), [frame](const Entry& entry) {
+            return entry.frame == frame;
+        });
+        if (found == entries_.end()) {
+            return false;
+        }
+        if (found == entries_.end() - 1) {
+            out = latest_;
+            return true;
+        }
+
+        auto keyframe = found;
+        while (!keyframe->keyframe) {
+            --keyframe;
+        }
+        out = keyframe->data;
+        std::vector<uint8_t> next;
+        for (auto entry = keyframe + 1; entry != found + 1; ++entry) {
+            if (!SnapshotDelta::decode(out, entry->data, next)) {
+                return false;
+            }
+            out.swap(next);
+        }
+        return true;
+    }
+
+    // Drop every snapshot from frame on, e.g. the frames a rollback is about to re-simulate
+    void discardFrom(uint64_t frame) {
+        if (entries_.empty() || entries_.back().frame < frame) {
+            return;
+        }
+        auto keep = std::find_if(entries_.begin(), entries_.end(), [frame](const Entry& entry) {
+            return entry.frame >= frame;
+        });
+        if (keep != entries_.begin()) {
+            // The next push deltas against the newest survivor
+            load((keep - 1)->frame, latest_);
+        }
+        while (entries_.end() != keep) {
+            remove(entries_.back());
+            entries_.pop_back();
+        }
+        if (entries_.empty()) {
+            latest_.clear();
+        }
+        sinceKeyframe_ = 0;
+        for (auto entry = entries_.rbegin(); entry != entries_.rend() && !entry->keyframe; ++entry) {
+            ++sinceKeyframe_;
+        }
+    }
+
+    void clear() {
+        entries_.clear();
+        latest_.clear();
+        storedBytes_ = 0;
+        rawBytes_ = 0;
+        sinceKeyframe_ = 0;
+    }
+
+private:
+    struct Entry {
+        uint64_t frame = 0;
+        bool keyframe = false;
+        size_t rawSize = 0;
+        std::vector<uint8_t> data;  // Whole snapshot for keyframes, else a delta against the previous entry
+    };
+
+    void add(Entry entry) {
+        storedBytes_ += entry.data.size();
+        rawBytes_ += entry.rawSize;
+        entries_.push_back(std::move(entry));
+    }
+
+    void remove(const Entry& entry) {
+        storedBytes_ -= entry.data.size();
+        rawBytes_ -= entry.rawSize;
+    }
+
+    void evictOldest() {
+        Entry& oldest = entries_.front();
+        if (entries_.size() > 1 && !entries_[1].keyframe) {
+            Entry& next = entries_[1];
+            std::vector<uint8_t> expanded;
+            SnapshotDelta::decode(oldest.data, next.data, expanded);
+            storedBytes_ = storedBytes_ - next.data.size() + expanded.size();
+            next.data = std::move(expanded);
+            next.keyframe = true;
+        }
+        remove(oldest);
+        entries_.pop_front();
+    }
+
+    size_t capacity_ = 0;
+    size_t keyframeInterval_ = 30;
+    size_t sinceKeyframe_ = 0;
+    std::deque<Entry> entries_;
+    // Newest snapshot in full, the base for the next delta
+    std::vector<uint8_t> latest_;
+    size_t storedBytes_ = 0;
+    size_t rawBytes_ = 0;
+};
+
+} // namespace DMCSurvivors
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "include/quan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace DMCSurvivors {
+
+// Uniform grid over the XZ plane, bucketing entities by the cell their quantized
+// position falls in. The arena is flat, so cells are columns and Y only enters
+// the distance tests. update() only touches buckets when an entity changes cell.
+class SpatialHashGrid {
+public:
+    struct Neighbor {
+        uint64_t id = 0;
+        float distanceSq = 0.0f;
+    };
+
+    explicit SpatialHashGrid(float cellSize = 4.0f)
+        : cellSize_(cellSize),
+          cellSizeQ_(std::max<int64_t>(1, Vec3Q::fromFloat(glm::vec3(cellSize, 0.0f, 0.0f)).x)) {
+    }
+
+    [[nodiscard]] float cellSize() const { return cellSize_; }
+    [[nodiscard]] size_t size() const { return locations_.size(); }
+    [[nodiscard]] bool contains(uint64_t id) const { return locations_.contains(id); }
+
+    // Insert an entity or move it to its new position
+    void update(uint64_t id, const Vec3Q& quantized, const glm::vec3& position) {
+        const uint64_t cell = cellKey(cellCoord(quantized.x), cellCoord(quantized.z));
+        const auto [found, inserted] = locations_.try_emplace(id);
+        if (!inserted) {
+            Location& location = found->second;
+            if (location.cell == cell) {
+                cells_[cell][location.slot].position = position;
+                return;
+            }
+            removeFromCell(location);
+        }
+
+        std::vector<Item>& items = cells_[cell];
+        found->second = {cell, static_cast<uint32_t>(items.size())};
+        items.push_back({id, position});
+    }
+
+    void remove(uint64_t id) {
+        const auto found = locations_.find(id);
+        if (found == locations_.end()) {
+            return;
+        }
+        removeFromCell(found->second);
+        locations_.erase(found);
+    }
+
+    void clear() {
+        cells_.clear();
+        locations_.clear();
+    }
+
+    // Calls fn(id, position) for every entity within radius of center
+    template <typename Fn>
+    void forEachInRadius(const glm::vec3& center, float radius, Fn&& fn) const {
+        if (!(radius >= 0.0f) || locations_.empty()) {
+            return;
+        }
+
+        // Bounds go through the same quantization as the entities, so no boundary cell is missed
+        const float radiusSq = radius * radius;
+        const Vec3Q minCorner = Vec3Q::fromFloat(center - glm::vec3(radius));
+        const Vec3Q maxCorner = Vec3Q::fromFloat(center + glm::vec3(radius));
+        for (int64_t x = cellCoord(minCorner.x); x <= cellCoord(maxCorner.x); ++x) {
+            for (int64_t z = cellCoord(minCorner.z); z <= cellCoord(maxCorner.z); ++z) {
+                const auto found = cells_.find(cellKey(x, z));
+                if (found == cells_.end()) {
+                    continue;
+                }
+                for (const Item& item : found->second) {
+                    const glm::vec3 delta = item.position - center;
+                    if (glm::dot(delta, delta) <= radiusSq) {
+                        fn(item.id, item.position);
+                    }
+                }
+            }
+        }
+    }
+
+    // Appends the ids within radius of center to out; returns how many were added
+    size_t queryRadius(const glm::vec3& center, float radius, std::vector<uint64_t>& out) const {
+        const size_t before = out.size();
+        forEachInRadius(center, radius, [&out](uint64_t id, const glm::vec3&) {
+            out.push_back(id);
+        });
+        return out.size() - before;
+    }
+
+    // The k nearest entities within maxRadius of center, nearest first. Searches
+    // rings of cells outward and stops once no closer entity can remain.
+    size_t queryNearest(const glm::vec3& center, size_t k, float maxRadius, std::vector<Neighbor>& out) const {
+        out.clear();
+        if (k == 0 || !(maxRadius >= 0.0f) || locations_.empty()) {
+            return 0;
+        }
+
+        const float maxRadiusSq = maxRadius * maxRadius;
+        const Vec3Q centerQ = Vec3Q::fromFloat(center);
+        const int64_t centerX = cellCoord(centerQ.x);
+        const int64_t centerZ = cellCoord(centerQ.z);
+        const int64_t maxRing = std::isfinite(maxRadius)
+            ? static_cast<int64_t>(std::ceil(maxRadius / cellSize_)) + 1
+            : std::numeric_limits<int64_t>::max();
+        const auto farther = [](const Neighbor& left, const Neighbor& right) {
+            return left.distanceSq < right.distanceSq;
+        };
+
+        size_t visited = 0;
+        for (int64_t ring = 0; ring <= maxRing && visited < locations_.size(); ++ring) {
+            // Everything in this ring is at least (ring - 1) cells from the center
+            if (ring > 1) {
+                const float bound = static_cast<float>(ring - 1) * cellSize_;
+                const float boundSq = bound * bound;
+                if (boundSq > maxRadiusSq || (out.size() == k && boundSq > out.front().distanceSq)) {
+                    break;
+                }
+            }
+
+            forEachCellInRing(centerX, centerZ, ring, [&](const std::vector<Item>& items) {
+                visited += items.size();
+                for (const Item& item : items) {
+                    const glm::vec3 delta = item.position - center;
+                    const float distanceSq = glm::dot(delta, delta);
+                    if (distanceSq > maxRadiusSq) {
+                        continue;
+                    }
+                    // out is a max-heap on distance while searching
+                    if (out.size() < k) {
+                        out.push_back({item.id, distanceSq});
+                        std::push_heap(out.begin(), out.end(), farther);
+                    } else if (distanceSq < out.front().distanceSq) {
+                        std::pop_heap(out.begin(), out.end(), farther);
+                        out.back() = {item.id, distanceSq};
+                        std::push_heap(out.begin(), out.end(), farther);
+                    }
+                }
+            });
+        }
+
+        std::sort_heap(out.begin(), out.end(), farther);
+        return out.size();
+    }
+
+private:
+    struct Item {
+        uint64_t id = 0;
+        glm::vec3 position{0.0f};
+    };
+
+    struct Location {
+        uint64_t cell = 0;
+        uint32_t slot = 0;
+    };
+
+    int64_t cellCoord(int64_t quantized) const {
+        // Floor division, so cells on either side of the origin have the same width
+        const int64_t cell = quantized / cellSizeQ_;
+        return (quantized % cellSizeQ_ != 0 && quantized < 0) ? cell - 1 : cell;
+    }
+
+    static uint64_t cellKey(int64_t x, int64_t z) {
+        return (static_cast<uint64_t>(x) << 32) ^ (static_cast<uint64_t>(z) & 0xffffffffull);
+    }
+
+    template <typename Fn>
+    void forEachCellInRing(int64_t centerX, int64_t centerZ, int64_t ring, Fn&& fn) const {
+        auto visit = [&](int64_t x, int64_t z) {
+            const auto found = cells_.find(cellKey(x, z));
+            if (found != cells_.end()) {
+                fn(found->second);
+            }
+        };
+
+        if (ring == 0) {
+            visit(centerX, centerZ);
+            return;
+        }
+        for (int64_t x = centerX - ring; x <= centerX + ring; ++x) {
+            visit(x, centerZ - ring);
+            visit(x, centerZ + ring);
+        }
+        for (int64_t z = centerZ - ring + 1; z <= centerZ + ring - 1; ++z) {
+            visit(centerX - ring, z);
+            visit(centerX + ring, z);
+        }
+    }
+
+    void removeFromCell(const Location& location) {
+        const auto found = cells_.find(location.cell);
+        std::vector<Item>& items = found->second;
+
+        // Swap-remove, then point the moved entity at its new slot
+        if (location.slot + 1 != items.size()) {
+            items[location.slot] = items.back();
+            locations_[items[location.slot].id].slot = location.slot;
+        }
+        items.pop_back();
+        if (items.empty()) {
+            cells_.erase(found);
+        }
+    }
+
+    float cellSize_;
+    int64_t cellSizeQ_;
+    std::unordered_map<uint64_t, std::vector<Item>> cells_;
+    std::unordered_map<uint64_t, Location> locations_;
+};
+
+} // namespace DMCSurvivors
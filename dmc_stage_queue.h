@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DMCSurvivors {
+
+// Requests from multi-threaded systems for work that has to happen on the main
+// thread (physics calls, entity destruction). Each flecs stage pushes to its own
+// queue, so workers never share a vector; the main thread drains them in stage
+// order once the producing systems have finished.
+template <typename T>
+class StageQueue {
+public:
+    // One queue per flecs stage; call again whenever the world's thread count changes
+    void resize(size_t stageCount) {
+        queues_.resize(std::max<size_t>(1, stageCount));
+    }
+
+    [[nodiscard]] size_t stageCount() const { return queues_.size(); }
+
+    void push(int32_t stage, const T& value) {
+        queues_[static_cast<size_t>(stage)].values.push_back(value);
+    }
+
+    [[nodiscard]] bool empty() const {
+        return std::all_of(queues_.begin(), queues_.end(), [](const Queue& queue) { return queue.values.empty(); });
+    }
+
+    // Append everything queued to out, stage 0 first, and clear the queues
+    void drainInto(std::vector<T>& out) {
+        for (Queue& queue : queues_) {
+            out.insert(out.end(), queue.values.begin(), queue.values.end());
+            queue.values.clear();
+        }
+    }
+
+    void clear() {
+        for (Queue& queue : queues_) {
+            queue.values.clear();
+        }
+    }
+
+private:
+    // Padded so two workers pushing at once don't share a cache line
+    struct alignas(64) Queue {
+        std::vector<T> values;
+    };
+
+    std::vector<Queue> queues_ = std::vector<Queue>(1);
+};
+
+} // namespace DMCSurvivors
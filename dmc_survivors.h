@@ -11,8 +11,16 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "include/quan.h"
 #include "flecs_interpreter.h"
+#if !defined(TREMOR_HEADLESS)
 #include "vk.h"  // Include VulkanBackend for rendering
+#endif
+#include "dmc_crowd_kernels.h"
+#include "dmc_determinism.h"
 #include "dmc_physics.h"
+#include "dmc_physics_lod.h"
+#include "dmc_snapshot.h"
+#include "dmc_spatial_hash.h"
+#include "dmc_stage_queue.h"
 #include "physics_interop.h"
 #include "Source/Runtime/TremorPhysics/physics_backend.h"
 #include "Source/Runtime/TremorPhysics/physics_backend_adapter.h"
@@ -22,10 +30,16 @@
 #include <random>
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
 #include <optional>
 #include <string>
 #include <deque>
 #include <mutex>
+#include <span>
+#include <sstream>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <filesystem>
@@ -57,6 +71,11 @@ struct Position {
     Vec3Q getQuantized() const { return quantized; }
 };
 
+// Physics body position blended between the last two fixed steps, for rendering
+struct InterpolatedPosition {
+    glm::vec3 value{0.0f};
+};
+
 struct Velocity {
     glm::vec3 value{0.0f};
 };
@@ -274,6 +293,18 @@ struct InputCommand {
     glm::vec3 aimDirection{0.0f};
 };
 
+struct GameOptions {
+    // flecs worker threads for the systems marked multi_threaded; 1 runs everything on the caller
+    uint32_t simulationThreads = 1;
+    // 0 seeds the spawn RNG from std::random_device
+    uint32_t seed = 0;
+    // Per-frame state hashes, to compare a single-threaded run with a multi-threaded one
+    DeterminismMode determinismMode = DeterminismMode::Off;
+    std::string determinismTracePath;
+    // Snapshots of the last N frames kept for rollbackToFrame(); 0 keeps none
+    size_t snapshotHistoryFrames = 0;
+};
+
 class Game {
 private:
     flecs::world world;
@@ -283,8 +314,37 @@ private:
     std::uniform_real_distribution<float> angleDist{0.0f, 2.0f * 3.14159f};
     std::uniform_real_distribution<float> radiusDist{15.0f, 25.0f};
     float gameTime = 0.0f;
-    std::vector<flecs::entity> entitiesMarkedForDeletion;
+    // Destroyed after the frame's systems have run; see StageQueue
+    StageQueue<flecs::entity> entitiesMarkedForDeletion;
+    std::vector<flecs::entity> entitiesToDestroy;
+    DeterminismTrace determinismTrace;
+    // Frames completed by update(), and the most recent of them as snapshots
+    uint64_t simulationFrame = 0;
+    SnapshotRing snapshotHistory;
+    flecs::query<> snapshotQuery;
+    uint32_t snapshotSchemaGeneration = UINT32_MAX;  // Script schemas snapshotQuery was built for
+    std::vector<flecs::entity> snapshotEntities;
+    std::vector<uint8_t> snapshotScratch;
+    std::string snapshotText;
+
+    struct ProfiledSystem {
+        flecs::entity system;
+        std::string name;
+        double timeSpent = 0.0;  // Seconds, as of the last sample
+    };
+    std::vector<ProfiledSystem> profiledSystems;
     std::unique_ptr<tremor::script::FlecsInterpreterHost> interpreterHost;
+    // wave_state.* paths, synced every time a spawner changes
+    struct WaveStateSlots {
+        tremor::script::BlackboardSlot currentWave;
+        tremor::script::BlackboardSlot enemiesSpawned;
+        tremor::script::BlackboardSlot enemiesPerWave;
+        tremor::script::BlackboardSlot waveIntensity;
+        tremor::script::BlackboardSlot spawnInterval;
+        tremor::script::BlackboardSlot defaultEnemyCount;
+        tremor::script::BlackboardSlot defaultSpawnInterval;
+        tremor::script::BlackboardSlot defaultWaveIntensity;
+    } waveStateSlots;
 
     std::unique_ptr<DMCSurvivors::PhysicsWorld> physicsWorld;
     std::unique_ptr<tremor::physics::PhysicsInteropBackendAdapter> physicsAdapter;
@@ -292,16 +352,83 @@ private:
     tremor::render::RenderInteropRegistry renderRegistry;
     tremor::render::ScriptRenderCamera renderCamera;
     tremor::physics::PhysicsBackendKind physicsBackendKind = tremor::physics::PhysicsBackendKind::Jolt;
-    std::mutex physicsContactEventsMutex;
     std::vector<tremor::physics::PhysicsContactEvent> pendingPhysicsContactEvents;
     static constexpr float EnemyPhysicsPromoteDistance = 18.0f;
     static constexpr float EnemyPhysicsDemoteDistance = 24.0f;
     static constexpr size_t MaxActiveEnemyPhysicsBodies = 24;
+    static constexpr float EnemyCapsuleRadius = 0.4f;
+    static constexpr float EnemyCapsuleHeight = 1.6f;
+    // Body creation and removal is spread over frames when many enemies cross the LOD range at once
+    static constexpr size_t EnemyPhysicsPromotionsPerFrame = 4;
+    static constexpr size_t EnemyPhysicsDemotionsPerFrame = 4;
+    static constexpr float EnemyPhysicsRetainBias = 0.81f;
+    PhysicsLODSelector enemyPhysicsLOD{{
+        MaxActiveEnemyPhysicsBodies,
+        EnemyPhysicsPromoteDistance,
+        EnemyPhysicsDemoteDistance,
+        EnemyPhysicsRetainBias,
+        EnemyPhysicsPromotionsPerFrame,
+        EnemyPhysicsDemotionsPerFrame
+    }};
+    static constexpr float PhysicsStepRate = 60.0f;
+    static constexpr uint32_t MaxPhysicsSubsteps = 4;
+
+    // Scratch for batched physics body calls, reused every frame
+    std::vector<BodyID> physicsBatchBodies;
+    std::vector<glm::vec3> physicsBatchValues;
+    std::vector<glm::vec3> physicsBatchTargets;
+    std::vector<uint8_t> physicsBatchSleeping;
+    std::vector<BodyID> physicsBatchWakes;
+    std::vector<Position*> physicsSyncPositions;
+    // Filled per stage by EnemyAISystem, applied on the main thread by EnemySleepStateSystem
+    StageQueue<BodyID> enemySleepRequests;
+    StageQueue<BodyID> enemyWakeRequests;
+    std::vector<BodyID> enemyBodiesToSleep;
+    std::vector<BodyID> enemyBodiesToWake;
+
+    // Entity owning each live body, so scene query hits map back to gameplay entities
+    std::unordered_map<uint64_t, flecs::entity> physicsBodyOwners;
+    std::vector<BodyID> physicsQueryBodies;
+    // Enemies left without a body by the physics LOD, which scene queries can't see, and pickups
+    SpatialHashGrid enemyGrid{SpatialCellSize};
+    SpatialHashGrid pickupGrid{SpatialCellSize};
+    std::vector<SpatialHashGrid::Neighbor> spatialNeighbors;
+    static constexpr float SpatialCellSize = 4.0f;
+    // Grids are synced once per frame; queries search this much farther and recheck Position
+    static constexpr float SpatialQuerySlack = 1.0f;
+    // Most entities spatial_query_nearest returns, whatever count the script asks for
+    static constexpr size_t SpatialQueryMaxCount = 1024;
+    static constexpr float EnemyCollisionRadius = 0.4f;
+    static constexpr float PickupCollisionRadius = 0.3f;
+
+    // Enemy X/Z positions as SoA, sorted by crowd cell and rebuilt every frame for separation.
+    // Cells are one separation radius wide, so an enemy's neighbours are in the 3x3 around it.
+    struct CrowdAgent {
+        uint64_t cell = 0;
+        float x = 0.0f;
+        float z = 0.0f;
+    };
+    std::vector<CrowdAgent> crowdAgents;
+    std::vector<float> crowdX;
+    std::vector<float> crowdZ;
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> crowdCells; // cell -> [begin, end)
+    static constexpr float EnemyChaseSpeed = 3.0f;
+    static constexpr float CrowdSeparationRadius = 2.0f * EnemyCollisionRadius + 0.2f;
+    static constexpr float CrowdSeparationSpeed = 2.5f; // At full overlap
 
 public:
     explicit Game(
-        tremor::physics::PhysicsBackendKind backendKind = tremor::physics::PhysicsBackendKind::Jolt
-    ) : physicsBackendKind(backendKind) {
+        tremor::physics::PhysicsBackendKind backendKind = tremor::physics::PhysicsBackendKind::Jolt,
+        const GameOptions& options = {}
+    ) : snapshotHistory(options.snapshotHistoryFrames), physicsBackendKind(backendKind) {
+        if (options.seed != 0) {
+            rng.seed(options.seed);
+        }
+        if (options.determinismMode != DeterminismMode::Off) {
+            determinismTrace.open(options.determinismMode, options.determinismTracePath);
+        }
+        setSimulationThreads(options.simulationThreads);
+
         // Initialize physics world first
         initializePhysics();
 
@@ -325,7 +452,7 @@ public:
         // Update physics world
         if (physicsWorld) {
             TREMOR_PROFILE_SCOPE("Physics Step");
-            physicsWorld->Update(deltaTime);
+            physicsWorld->Advance(deltaTime);
         }
 
         {
@@ -336,16 +463,210 @@ public:
             TREMOR_PROFILE_SCOPE("World Progress");
             world.progress(deltaTime);
         }
+        if (!profiledSystems.empty()) {
+            sampleSystemTimes();
+        }
         if (interpreterHost) {
             TREMOR_PROFILE_SCOPE("Script Update");
             interpreterHost->update(deltaTime);
         }
 
         // Process entity deletion queue after all systems have run
-        for (auto& entity : entitiesMarkedForDeletion) {
-            entity.destruct();
+        entitiesMarkedForDeletion.drainInto(entitiesToDestroy);
+        for (auto& entity : entitiesToDestroy) {
+            destroyEntity(entity);
+        }
+        entitiesToDestroy.clear();
+
+        if (determinismTrace.enabled()) {
+            determinismTrace.frame(stateHash());
+        }
+
+        ++simulationFrame;
+        if (snapshotHistory.enabled()) {
+            TREMOR_PROFILE_SCOPE("Snapshot");
+            snapshotHistory.push(simulationFrame, captureSnapshot());
+        }
+    }
+
+    // Worker threads for multi_threaded systems. Everything else, and every system
+    // that calls into physicsWorld, still runs on the thread calling update().
+    void setSimulationThreads(uint32_t threads) {
+        if (threads > 1) {
+            world.set_threads(static_cast<int32_t>(threads));
+        }
+        const size_t stageCount = static_cast<size_t>(std::max(1, world.get_stage_count()));
+        entitiesMarkedForDeletion.resize(stageCount);
+        enemySleepRequests.resize(stageCount);
+        enemyWakeRequests.resize(stageCount);
+        Logger::get().info("DMC simulation running on {} thread(s)", stageCount);
+    }
+
+    // Hash of the gameplay state the simulation systems write, in entity id order so it
+    // doesn't depend on table layout. Equal across runs only when the simulation is.
+    uint64_t stateHash() {
+        struct EntityState {
+            uint64_t id = 0;
+            uint64_t hash = 0;
+        };
+        std::vector<EntityState> states;
+        const auto mix = [](uint64_t hash, const void* data, size_t size) {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            for (size_t index = 0; index < size; ++index) {
+                hash = (hash ^ bytes[index]) * 1099511628211ull;
+            }
+            return hash;
+        };
+        world.each([&](flecs::entity e, const Position& pos) {
+            uint64_t hash = 14695981039346656037ull;
+            const glm::vec3 position = pos.getFloat();
+            hash = mix(hash, &position, sizeof(position));
+            if (const Velocity* vel = e.get<Velocity>()) {
+                hash = mix(hash, &vel->value, sizeof(vel->value));
+            }
+            if (const Health* health = e.get<Health>()) {
+                hash = mix(hash, &health->current, sizeof(health->current));
+            }
+            if (const LaunchState* launch = e.get<LaunchState>()) {
+                hash = mix(hash, &launch->launchTime, sizeof(launch->launchTime));
+            }
+            if (const StyleMeter* style = e.get<StyleMeter>()) {
+                hash = mix(hash, &style->points, sizeof(style->points));
+            }
+            if (const RedOrb* orb = e.get<RedOrb>()) {
+                hash = mix(hash, &orb->magnetized, sizeof(orb->magnetized));
+            }
+            states.push_back({e.id(), hash});
+        });
+        std::sort(states.begin(), states.end(), [](const EntityState& left, const EntityState& right) {
+            return left.id < right.id;
+        });
+
+        uint64_t hash = 14695981039346656037ull;
+        for (const EntityState& state : states) {
+            hash = mix(hash, &state, sizeof(state));
         }
-        entitiesMarkedForDeletion.clear();
+        return hash;
+    }
+
+    [[nodiscard]] bool determinismDiverged() const { return determinismTrace.diverged(); }
+
+    [[nodiscard]] uint64_t frameNumber() const { return simulationFrame; }
+    [[nodiscard]] const SnapshotRing& snapshots() const { return snapshotHistory; }
+
+    // Gameplay state between two frames as a binary blob: the entities' components,
+    // their physics bodies' motion, the spawn RNG and the script blackboard. Bodies
+    // are re-created rather than restored bit for bit, so contact caches start cold.
+    std::vector<uint8_t> captureSnapshot() {
+        refreshSnapshotQuery();
+        snapshotEntities.clear();
+        snapshotQuery.each([this](flecs::entity e) {
+            snapshotEntities.push_back(e);
+        });
+        std::sort(snapshotEntities.begin(), snapshotEntities.end(), [](flecs::entity left, flecs::entity right) {
+            return left.id() < right.id();
+        });
+
+        SnapshotWriter out;
+        out.pod(SnapshotMagic);
+        out.pod(SnapshotVersion);
+        out.pod(simulationFrame);
+        out.pod(gameTime);
+        std::ostringstream rngState;
+        rngState << rng;
+        out.string(rngState.str());
+        out.pod(static_cast<uint64_t>(player.id()));
+        out.pod(static_cast<uint64_t>(currentTarget.id()));
+        out.pod(physicsWorld ? physicsWorld->stepAccumulator() : 0.0f);
+
+        // Ids first, so a restore can clear out entities that aren't in the snapshot before reviving any
+        out.pod(static_cast<uint32_t>(snapshotEntities.size()));
+        for (flecs::entity e : snapshotEntities) {
+            out.pod(static_cast<uint64_t>(e.id()));
+        }
+
+        physicsBatchBodies.clear();
+        for (flecs::entity e : snapshotEntities) {
+            uint32_t mask = 0;
+            forEachSnapshotComponent(SnapshotComponents{}, [&]<typename T>(uint32_t bit) {
+                if (e.has<T>()) {
+                    mask |= 1u << bit;
+                }
+            });
+            out.pod(mask);
+            forEachSnapshotComponent(SnapshotComponents{}, [&]<typename T>(uint32_t) {
+                if (const T* component = e.get<T>()) {
+                    writeSnapshotComponent(out, *component);
+                }
+            });
+            writeScriptSchemaComponents(out, e);
+
+            const PhysicsBody* body = e.get<PhysicsBody>();
+            const bool hasBody = physicsWorld && body && !body->bodyId.IsInvalid();
+            out.pod(static_cast<uint8_t>(hasBody ? 1 : 0));
+            if (hasBody) {
+                physicsBatchBodies.push_back(body->bodyId);
+            }
+        }
+
+        // Motion of the bodies flagged above, in the same order
+
+        physicsBatchValues.resize(physicsBatchBodies.size());
+        physicsBatchTargets.resize(physicsBatchBodies.size());
+        physicsBatchSleeping.resize(physicsBatchBodies.size());
+        if (physicsWorld) {
+            physicsWorld->readBodyPositions(physicsBatchBodies, physicsBatchValues);
+            physicsWorld->readBodyVelocities(physicsBatchBodies, physicsBatchTargets);
+            physicsWorld->readBodySleeping(physicsBatchBodies, physicsBatchSleeping);
+        }
+        for (size_t index = 0; index < physicsBatchBodies.size(); ++index) {
+            out.pod(physicsBatchValues[index]);
+            out.pod(physicsBatchTargets[index]);
+            out.pod(physicsBatchSleeping[index]);
+        }
+
+        out.valueMap(interpreterHost ? interpreterHost->getBlackboard() : tremor::script::ValueMap{});
+        return out.take();
+    }
+
+    // Put the world back to a captureSnapshot() state. Entities that have appeared since
+    // are destroyed and removed ones are revived under their old ids. Call between
+    // updates; a malformed snapshot is rejected before anything is touched.
+    bool restoreSnapshot(std::span<const uint8_t> snapshot) {
+        if (!readSnapshot(snapshot, false)) {
+            Logger::get().error("Rejected malformed DMC snapshot ({} bytes)", snapshot.size());
+            return false;
+        }
+        readSnapshot(snapshot, true);
+        return true;
+    }
+
+    // Restore a frame from the snapshot history. Later frames are dropped; the
+    // next update() simulates forward from the restored one.
+    bool rollbackToFrame(uint64_t frame) {
+        std::vector<uint8_t> snapshot;
+        if (!snapshotHistory.load(frame, snapshot)) {
+            Logger::get().warning("No snapshot for frame {} to roll back to", frame);
+            return false;
+        }
+        if (!restoreSnapshot(snapshot)) {
+            return false;
+        }
+        snapshotHistory.discardFrom(frame + 1);
+        return true;
+    }
+
+    // One profiler zone per flecs system, from flecs' own system timers. Off by
+    // default since flecs then reads the clock around every system.
+    void setSystemProfiling(bool enabled) {
+        world.measure_system_time(enabled);
+        profiledSystems.clear();
+        if (!enabled) {
+            return;
+        }
+        world.query_builder<>().with(flecs::System).build().each([this](flecs::entity system) {
+            profiledSystems.push_back({system, std::string(system.name()), 0.0});
+        });
     }
 
     void processInput(const InputCommand& input) {
@@ -397,6 +718,7 @@ public:
     flecs::entity getPlayer() { return player; }
     flecs::world& getWorld() { return world; }
 
+#if !defined(TREMOR_HEADLESS)
     // Render all entities - called from main loop
     void renderEntities(void* renderBackend) {
         TREMOR_PROFILE_SCOPE("DMC Render");
@@ -427,8 +749,8 @@ public:
 
         // Get player position for camera following
         glm::vec3 playerPos{0.0f, 0.0f, 0.0f};
-        world.each([&](flecs::entity entity, const Position& pos, const Player& playerTag) {
-            playerPos = pos.getFloat();
+        world.each([&](flecs::entity entity, const Position& pos, const InterpolatedPosition* smoothed, const Player& playerTag) {
+            playerPos = smoothed ? smoothed->value : pos.getFloat();
         });
 
         // Create a camera that follows the player from behind and above
@@ -469,16 +791,16 @@ public:
             TREMOR_PROFILE_SCOPE("Crowd Gather");
 
             // Render player entities
-            world.each([&](flecs::entity, const Position& pos, const Player&, const MeshRenderer&) {
-                glm::vec3 worldPos = pos.quantized.relativeTo(cameraPos);
+            world.each([&](flecs::entity, const Position& pos, const InterpolatedPosition* smoothed, const Player&, const MeshRenderer&) {
+                glm::vec3 worldPos = renderPosition(pos, smoothed).relativeTo(cameraPos);
                 cubeModels.push_back(
                     glm::scale(glm::translate(glm::mat4(1.0f), worldPos), glm::vec3(1.0f, 2.0f, 1.0f))
                 );
             });
 
             // Render enemy entities
-            world.each([&](flecs::entity, const Position& pos, const Enemy&, const MeshRenderer&) {
-                glm::vec3 worldPos = pos.quantized.relativeTo(cameraPos);
+            world.each([&](flecs::entity, const Position& pos, const InterpolatedPosition* smoothed, const Enemy&, const MeshRenderer&) {
+                glm::vec3 worldPos = renderPosition(pos, smoothed).relativeTo(cameraPos);
                 sphereModels.push_back(
                     glm::scale(glm::translate(glm::mat4(1.0f), worldPos), glm::vec3(1.2f))
                 );
@@ -507,6 +829,7 @@ public:
             overlayManager->renderMeshAssetBatch(sphereCrowdAssetPath, cmd, viewProj, sphereModels);
         }
     }
+#endif
 
   private:
     static const char* physicsBackendName(tremor::physics::PhysicsBackendKind backendKind) {
@@ -561,9 +884,13 @@ public:
         blockBroadPhaseCollision(DefaultPhysicsLayers::Enemy, DefaultPhysicsLayers::Enemy);
     }
 
-    void queuePhysicsContactEvent(const tremor::physics::PhysicsContactEvent& event) {
-        std::lock_guard<std::mutex> lock(physicsContactEventsMutex);
-        pendingPhysicsContactEvents.push_back(event);
+    static Vec3Q renderPosition(const Position& position, const InterpolatedPosition* smoothed) {
+        return smoothed ? Vec3Q::fromFloat(smoothed->value) : position.quantized;
+    }
+
+    // Called from Advance() on this thread, once per frame with the merged batch
+    void queuePhysicsContactEvents(std::span<const tremor::physics::PhysicsContactEvent> events) {
+        pendingPhysicsContactEvents.insert(pendingPhysicsContactEvents.end(), events.begin(), events.end());
     }
 
     void syncPhysicsBodyToPosition(flecs::entity entity, const Position& position) {
@@ -586,13 +913,14 @@ public:
 
         BodyID enemyPhysicsBody = physicsWorld->CreateDynamicBody(
             position,
-            0.4f,
-            1.6f,
+            EnemyCapsuleRadius,
+            EnemyCapsuleHeight,
             DMCSurvivors::Layers::ENEMY
         );
 
         if (!enemyPhysicsBody.IsInvalid()) {
             physicsWorld->SetBodySleepingAllowed(enemyPhysicsBody, true);
+            physicsWorld->setBodyInterpolated(enemyPhysicsBody, true);
             if (glm::dot(velocity, velocity) > 0.0001f) {
                 physicsWorld->SetBodyVelocity(enemyPhysicsBody, velocity);
             }
@@ -609,19 +937,518 @@ public:
         const BodyID bodyId = createEnemyPhysicsBodyAt(position.getFloat(), velocity.value);
         if (!bodyId.IsInvalid()) {
             enemy.set<PhysicsBody>({bodyId, false});
+            enemy.set<InterpolatedPosition>({position.getFloat()});
+            trackPhysicsBody(enemy, bodyId);
+            enemyGrid.remove(enemy.id());
+        }
+    }
+
+    void trackPhysicsBody(flecs::entity entity, BodyID bodyId) {
+        if (!bodyId.IsInvalid()) {
+            physicsBodyOwners[bodyId.raw()] = entity;
         }
     }
 
+    // Capsule bodies go back to the backend's pool for the next promotion or spawn
+    void releasePhysicsBody(BodyID bodyId) {
+        if (physicsWorld && !bodyId.IsInvalid()) {
+            physicsWorld->ReleaseBody(bodyId);
+        }
+        physicsBodyOwners.erase(bodyId.raw());
+    }
+
+    // Release the entity's body too, or it keeps simulating (and interpolating) with no owner
+    void destroyEntity(flecs::entity entity) {
+        if (!entity.is_alive()) {
+            return;
+        }
+        const PhysicsBody* physicsBody = entity.get<PhysicsBody>();
+        if (physicsBody != nullptr) {
+            releasePhysicsBody(physicsBody->bodyId);
+        }
+        enemyGrid.remove(entity.id());
+        pickupGrid.remove(entity.id());
+        entity.destruct();
+    }
+
+    // Calls fn(entity, position) for every enemy with a physics body whose position may lie
+    // within range of center. A sphere of the full range touches every capsule centered inside it.
+    template <typename Fn>
+    void forEachBodiedEnemyNear(const glm::vec3& center, float range, Fn&& fn) {
+        if (!physicsWorld || physicsBodyOwners.empty()) {
+            return;
+        }
+
+        physicsQueryBodies.resize(physicsBodyOwners.size());
+        const size_t found = physicsWorld->Overlap(
+            tremor::physics::PhysicsQueryShape::sphere(range),
+            center,
+            physicsQueryBodies,
+            tremor::physics::PhysicsQueryFilter::onlyLayers({DMCSurvivors::Layers::ENEMY})
+        );
+        for (size_t index = 0; index < found; ++index) {
+            const auto owner = physicsBodyOwners.find(physicsQueryBodies[index].raw());
+            if (owner == physicsBodyOwners.end() || !owner->second.is_alive() || !owner->second.has<Enemy>()) {
+                continue;
+            }
+            if (Position* position = owner->second.get_mut<Position>()) {
+                fn(owner->second, *position);
+            }
+        }
+    }
+
+    // Calls fn(entity, position) for every entity in grid whose position may lie within range of center
+    template <typename Fn>
+    void forEachGridEntityNear(const SpatialHashGrid& grid, const glm::vec3& center, float range, Fn&& fn) {
+        grid.forEachInRadius(center, range + SpatialQuerySlack, [&](uint64_t id, const glm::vec3&) {
+            flecs::entity entity(world, id);
+            if (!entity.is_alive()) {
+                return;
+            }
+            if (Position* position = entity.get_mut<Position>()) {
+                fn(entity, *position);
+            }
+        });
+    }
+
+    // Calls fn(entity, position) for every enemy whose position lies within range of center.
+    // Enemies with bodies come from a physics overlap, the rest from the enemy grid.
+    template <typename Fn>
+    void forEachEnemyInRange(const glm::vec3& center, float range, Fn&& fn) {
+        const float rangeSq = range * range;
+        auto visit = [&](flecs::entity enemy, Position& position) {
+            const glm::vec3 delta = position.getFloat() - center;
+            if (glm::dot(delta, delta) < rangeSq) {
+                fn(enemy, position);
+            }
+        };
+        forEachBodiedEnemyNear(center, range, visit);
+        forEachGridEntityNear(enemyGrid, center, range, visit);
+    }
+
+    // Up to count enemies nearest to center within maxRange, nearest first
+    void findNearestEnemies(
+        const glm::vec3& center,
+        size_t count,
+        float maxRange,
+        std::vector<SpatialHashGrid::Neighbor>& out
+    ) {
+        enemyGrid.queryNearest(center, count, maxRange, out);
+
+        const float maxRangeSq = maxRange * maxRange;
+        bool addedBodied = false;
+        forEachBodiedEnemyNear(center, maxRange, [&](flecs::entity enemy, const Position& position) {
+            const glm::vec3 delta = position.getFloat() - center;
+            const float distanceSq = glm::dot(delta, delta);
+            if (distanceSq <= maxRangeSq) {
+                out.push_back({enemy.id(), distanceSq});
+                addedBodied = true;
+            }
+        });
+
+        if (addedBodied) {
+            std::sort(out.begin(), out.end(), [](const auto& left, const auto& right) {
+                return left.distanceSq < right.distanceSq;
+            });
+            out.resize(std::min(out.size(), count));
+        }
+    }
+
+    void syncEnemyGridEntry(flecs::entity enemy, const Position& position) {
+        enemyGrid.update(enemy.id(), position.quantized, position.getFloat());
+    }
+
     void demoteEnemyFromPhysics(flecs::entity enemy, Position& position, Velocity& velocity, const PhysicsBody& physicsBody) {
         if (!physicsWorld || physicsBody.bodyId.IsInvalid()) {
             enemy.remove<PhysicsBody>();
+            enemy.remove<InterpolatedPosition>();
             return;
         }
 
         position.setFloat(physicsWorld->GetBodyPosition(physicsBody.bodyId));
         velocity.value = physicsWorld->GetBodyVelocity(physicsBody.bodyId);
-        physicsWorld->RemoveBody(physicsBody.bodyId);
+        releasePhysicsBody(physicsBody.bodyId);
         enemy.remove<PhysicsBody>();
+        enemy.remove<InterpolatedPosition>();
+        syncEnemyGridEntry(enemy, position);
+    }
+
+    static constexpr uint32_t SnapshotMagic = 0x53434D44;  // "DMCS"
+    static constexpr uint16_t SnapshotVersion = 3;
+
+    template <typename... T>
+    struct SnapshotComponentList {};
+
+    // Bit i of an entity's snapshot mask is the i-th component here. PhysicsBody is
+    // left out: body handles don't survive a restore, so bodies are saved by motion.
+    // Changing the list changes the format, so bump SnapshotVersion with it.
+    using SnapshotComponents = SnapshotComponentList<
+        Position, InterpolatedPosition, Velocity, Rotation, Scale, Health, CollisionRadius,
+        CombatStats, ComboState, StyleMeter, MovementState, JumpState, AttackState, LaunchState,
+        WeaponSlot, GunState, EnemyAI, Experience, RedOrb, WaveSpawner, MeshRenderer,
+        ParticleEffect, Player, Enemy, Boss, Projectile, tremor::ecs::ScriptComponentData>;
+
+    template <typename... T, typename Fn>
+    static void forEachSnapshotComponent(SnapshotComponentList<T...>, Fn&& fn) {
+        static_assert(sizeof...(T) <= 32, "snapshot component masks are 32 bits");
+        uint32_t bit = 0;
+        (fn.template operator()<T>(bit++), ...);
+    }
+
+    // Plain components are written as their bytes; ones holding strings, containers
+    // or entity handles get a codec of their own below
+    template <typename T>
+    static void writeSnapshotComponent(SnapshotWriter& out, const T& component) {
+        out.pod(component);
+    }
+
+    template <typename T>
+    bool readSnapshotComponent(SnapshotReader& in, T& component) {
+        return in.pod(component);
+    }
+
+    static void writeSnapshotComponent(SnapshotWriter& out, const ComboState& combo) {
+        out.pod(combo.hitCount);
+        out.pod(combo.timer);
+        out.pod(combo.maxTime);
+        out.string(combo.currentCombo);
+        out.string(std::string(combo.inputBuffer.begin(), combo.inputBuffer.end()));
+        out.pod(combo.inputBufferTime);
+    }
+
+    bool readSnapshotComponent(SnapshotReader& in, ComboState& combo) {
+        std::string inputBuffer;
+        in.pod(combo.hitCount);
+        in.pod(combo.timer);
+        in.pod(combo.maxTime);
+        in.string(combo.currentCombo);
+        in.string(inputBuffer);
+        in.pod(combo.inputBufferTime);
+        combo.inputBuffer.assign(inputBuffer.begin(), inputBuffer.end());
+        return !in.failed();
+    }
+
+    static void writeSnapshotComponent(SnapshotWriter& out, const ParticleEffect& effect) {
+        out.string(effect.effectName);
+        out.pod(effect.lifetime);
+    }
+
+    bool readSnapshotComponent(SnapshotReader& in, ParticleEffect& effect) {
+        in.string(effect.effectName);
+        return in.pod(effect.lifetime);
+    }
+
+    static void writeSnapshotComponent(SnapshotWriter& out, const EnemyAI& ai) {
+        out.pod(static_cast<uint64_t>(ai.target.id()));
+        out.pod(ai.aggroRange);
+        out.pod(ai.attackRange);
+        out.pod(ai.attackCooldown);
+        out.pod(ai.stunDuration);
+    }
+
+    bool readSnapshotComponent(SnapshotReader& in, EnemyAI& ai) {
+        uint64_t target = 0;
+        in.pod(target);
+        in.pod(ai.aggroRange);
+        in.pod(ai.attackRange);
+        in.pod(ai.attackCooldown);
+        in.pod(ai.stunDuration);
+        ai.target = target != 0 ? flecs::entity(world, target) : flecs::entity();
+        return !in.failed();
+    }
+
+    static void writeSnapshotComponent(SnapshotWriter& out, const tremor::ecs::ScriptComponentData& data) {
+        out.valueMap(data.fields);
+    }
+
+    bool readSnapshotComponent(SnapshotReader& in, tremor::ecs::ScriptComponentData& data) {
+        return in.valueMap(data.fields);
+    }
+
+    // Components declared by scripts with ecs_define_component follow the fixed list
+    // as (schema index, bytes) pairs, schemas being never removed. String fields hold
+    // interned ids that may be recycled later, so their text follows the bytes and
+    // is interned again on restore.
+    void writeScriptSchemaComponents(SnapshotWriter& out, flecs::entity e) {
+        const auto* schemas = world.get<tremor::ecs::ScriptComponentSchemas>();
+        uint32_t count = 0;
+        if (schemas) {
+            for (const tremor::ecs::ScriptComponentSchema& schema : schemas->schemas) {
+                count += e.has(schema.component) ? 1 : 0;
+            }
+        }
+        out.pod(count);
+        if (count == 0) {
+            return;
+        }
+        for (uint32_t index = 0; index < schemas->schemas.size(); ++index) {
+            const tremor::ecs::ScriptComponentSchema& schema = schemas->schemas[index];
+            if (const void* data = e.get(schema.component)) {
+                out.pod(index);
+                out.bytes(data, schema.size);
+                for (const tremor::ecs::ScriptComponentField& field : schema.fields) {
+                    if (field.type != tremor::ecs::ScriptFieldType::String) {
+                        continue;
+                    }
+                    uint32_t id = 0;
+                    std::memcpy(&id, static_cast<const std::byte*>(data) + field.offset, sizeof(id));
+                    const std::optional<std::string_view> text = schemas->string(id);
+                    out.pod(static_cast<uint8_t>(text ? 1 : 0));
+                    if (text) {
+                        out.string(*text);
+                    }
+                }
+            }
+        }
+    }
+
+    bool readScriptSchemaComponents(SnapshotReader& in, flecs::entity e, bool apply) {
+        auto* schemas = world.get_mut<tremor::ecs::ScriptComponentSchemas>();
+        const size_t schemaCount = schemas ? schemas->schemas.size() : 0;
+        uint32_t count = 0;
+        if (!in.pod(count) || count > schemaCount) {
+            return false;
+        }
+
+        size_t next = 0;
+        for (uint32_t read = 0; read < count; ++read) {
+            uint32_t index = 0;
+            if (!in.pod(index) || index < next || index >= schemaCount) {
+                return false;
+            }
+            const tremor::ecs::ScriptComponentSchema& schema = schemas->schemas[index];
+            snapshotScratch.resize(schema.size);
+            if (!in.bytes(snapshotScratch.data(), schema.size)) {
+                return false;
+            }
+            for (const tremor::ecs::ScriptComponentField& field : schema.fields) {
+                if (field.type != tremor::ecs::ScriptFieldType::String) {
+                    continue;
+                }
+                uint8_t present = 0;
+                if (!in.pod(present) || (present != 0 && !in.string(snapshotText))) {
+                    return false;
+                }
+                const uint32_t id = apply && present != 0 ? schemas->internString(snapshotText) : 0;
+                std::memcpy(snapshotScratch.data() + field.offset, &id, sizeof(id));
+            }
+            if (apply) {
+                // Schemas the entity no longer has in the snapshot come off
+                for (; next < index; ++next) {
+                    e.remove(schemas->schemas[next].component);
+                }
+                std::memcpy(e.ensure(schema.component), snapshotScratch.data(), schema.size);
+                e.modified(schema.component);
+            }
+            next = index + 1;
+        }
+        if (apply) {
+            for (; next < schemaCount; ++next) {
+                e.remove(schemas->schemas[next].component);
+            }
+        }
+        return true;
+    }
+
+    // snapshotQuery matches every entity with something captureSnapshot() saves, so it
+    // picks up each script-declared component as schemas appear
+    void refreshSnapshotQuery() {
+        const auto* schemas = world.get<tremor::ecs::ScriptComponentSchemas>();
+        const uint32_t generation = schemas ? schemas->generation : 0;
+        if (generation == snapshotSchemaGeneration) {
+            return;
+        }
+        snapshotSchemaGeneration = generation;
+
+        // Gameplay entities all have a Position, the wave spawner and script-created entities may not
+        auto builder = world.query_builder<>();
+        builder.with<Position>().or_()
+            .with<WaveSpawner>().or_()
+            .with<tremor::ecs::ScriptComponentData>();
+        if (schemas) {
+            for (const tremor::ecs::ScriptComponentSchema& schema : schemas->schemas) {
+                builder.or_().with(schema.component);
+            }
+        }
+        snapshotQuery = builder.build();
+    }
+
+    // Parses a captureSnapshot() blob; applies it only when apply is set, so a dry
+    // run first can reject a bad snapshot while the world is still intact
+    bool readSnapshot(std::span<const uint8_t> snapshot, bool apply) {
+        SnapshotReader in(snapshot);
+        uint32_t magic = 0;
+        uint16_t version = 0;
+        if (!in.pod(magic) || !in.pod(version) || magic != SnapshotMagic || version != SnapshotVersion) {
+            return false;
+        }
+
+        uint64_t frame = 0;
+        float time = 0.0f;
+        std::string rngText;
+        uint64_t playerId = 0;
+        uint64_t targetId = 0;
+        float stepAccumulator = 0.0f;
+        uint32_t entityCount = 0;
+        in.pod(frame);
+        in.pod(time);
+        in.string(rngText);
+        in.pod(playerId);
+        in.pod(targetId);
+        in.pod(stepAccumulator);
+        if (!in.pod(entityCount) || entityCount > snapshot.size() / sizeof(uint64_t)) {
+            return false;
+        }
+
+        std::mt19937 restoredRng;
+        std::istringstream rngStream(rngText);
+        if (!(rngStream >> restoredRng)) {
+            return false;
+        }
+
+        std::vector<uint64_t> ids(entityCount);
+        for (uint64_t& id : ids) {
+            in.pod(id);
+        }
+        if (in.failed() || std::adjacent_find(ids.begin(), ids.end(), std::greater_equal<uint64_t>()) != ids.end()) {
+            return false;
+        }
+
+        if (apply) {
+            refreshSnapshotQuery();
+
+            // Entities the snapshot doesn't have go first, so none of them holds an id index a revived entity needs
+            snapshotEntities.clear();
+            snapshotQuery.each([&](flecs::entity e) {
+                if (!std::binary_search(ids.begin(), ids.end(), static_cast<uint64_t>(e.id()))) {
+                    snapshotEntities.push_back(e);
+                }
+            });
+            for (flecs::entity e : snapshotEntities) {
+                destroyEntity(e);
+            }
+
+            // Requests made during the frames being abandoned
+            entitiesMarkedForDeletion.clear();
+            enemySleepRequests.clear();
+            enemyWakeRequests.clear();
+            pendingPhysicsContactEvents.clear();
+        }
+
+        std::vector<flecs::entity> bodied;
+        size_t bodyCount = 0;
+        for (uint64_t id : ids) {
+            flecs::entity e = apply ? world.make_alive(id) : flecs::entity();
+            uint32_t mask = 0;
+            in.pod(mask);
+            forEachSnapshotComponent(SnapshotComponents{}, [&]<typename T>(uint32_t bit) {
+                if ((mask & (1u << bit)) == 0) {
+                    if (apply) {
+                        e.remove<T>();
+                    }
+                    return;
+                }
+                T component{};
+                if (readSnapshotComponent(in, component) && apply) {
+                    e.set<T>(std::move(component));
+                }
+            });
+            if (!readScriptSchemaComponents(in, e, apply)) {
+                return false;
+            }
+
+            uint8_t hasBody = 0;
+            if (!in.pod(hasBody)) {
+                return false;
+            }
+            if (hasBody != 0) {
+                ++bodyCount;
+                if (apply) {
+                    bodied.push_back(e);
+                }
+            } else if (apply) {
+                if (const PhysicsBody* body = e.get<PhysicsBody>()) {
+                    releasePhysicsBody(body->bodyId);
+                    e.remove<PhysicsBody>();
+                }
+            }
+        }
+
+        std::vector<glm::vec3> bodyPositions(bodyCount);
+        std::vector<glm::vec3> bodyVelocities(bodyCount);
+        std::vector<uint8_t> bodySleeping(bodyCount);
+        for (size_t index = 0; index < bodyCount; ++index) {
+            in.pod(bodyPositions[index]);
+            in.pod(bodyVelocities[index]);
+            in.pod(bodySleeping[index]);
+        }
+
+        tremor::script::ValueMap blackboard;
+        in.valueMap(blackboard);
+        if (in.failed() || !in.atEnd()) {
+            return false;
+        }
+        if (!apply) {
+            return true;
+        }
+
+        if (physicsWorld) {
+            // Revived entities get a fresh body from the pool; every body then takes its saved motion
+            std::vector<BodyID> bodies;
+            std::vector<BodyID> awake;
+            std::vector<BodyID> asleep;
+            size_t kept = 0;
+            for (size_t index = 0; index < bodied.size(); ++index) {
+                flecs::entity e = bodied[index];
+                const PhysicsBody* body = e.get<PhysicsBody>();
+                BodyID bodyId = body != nullptr ? body->bodyId : BodyID{};
+                if (bodyId.IsInvalid()) {
+                    bodyId = e.has<Player>()
+                        ? createPlayerPhysicsBodyAt(bodyPositions[index])
+                        : createEnemyPhysicsBodyAt(bodyPositions[index]);
+                    if (bodyId.IsInvalid()) {
+                        e.remove<PhysicsBody>();
+                        continue;
+                    }
+                    e.set<PhysicsBody>({bodyId, false});
+                    trackPhysicsBody(e, bodyId);
+                }
+                bodies.push_back(bodyId);
+                bodyPositions[kept] = bodyPositions[index];
+                bodyVelocities[kept] = bodyVelocities[index];
+                (bodySleeping[index] != 0 ? asleep : awake).push_back(bodyId);
+                ++kept;
+            }
+            bodyPositions.resize(kept);
+            bodyVelocities.resize(kept);
+            physicsWorld->setBodyPositions(bodies, bodyPositions);
+            physicsWorld->setBodyVelocities(bodies, bodyVelocities);
+            physicsWorld->wakeBodies(awake);
+            physicsWorld->sleepBodies(asleep);
+            physicsWorld->setStepAccumulator(stepAccumulator);
+        }
+
+        // The grids only track entities without bodies, and are cheaper to rebuild than to diff
+        enemyGrid.clear();
+        pickupGrid.clear();
+        world.each([this](flecs::entity enemy, const Position& pos, const Enemy&) {
+            if (!enemy.has<PhysicsBody>()) {
+                syncEnemyGridEntry(enemy, pos);
+            }
+        });
+        world.each([this](flecs::entity orb, const Position& pos, const RedOrb&) {
+            pickupGrid.update(orb.id(), pos.quantized, pos.getFloat());
+        });
+
+        simulationFrame = frame;
+        gameTime = time;
+        rng = restoredRng;
+        player = playerId != 0 ? flecs::entity(world, playerId) : flecs::entity();
+        currentTarget = targetId != 0 ? flecs::entity(world, targetId) : flecs::entity();
+        if (interpreterHost) {
+            interpreterHost->replaceBlackboard(std::move(blackboard));
+        }
+        return true;
     }
 
     void resolveCharacterOverlap(flecs::entity e1, flecs::entity e2) {
@@ -675,21 +1502,26 @@ public:
         syncPhysicsBodyToPosition(e2, *pos2);
     }
 
+    void sampleSystemTimes() {
+        auto& profiler = tremor::trace::Profiler::instance();
+        for (ProfiledSystem& profiled : profiledSystems) {
+            const ecs_system_t* system = ecs_system_get(world, profiled.system);
+            if (system == nullptr) {
+                continue;
+            }
+            const double timeSpent = static_cast<double>(system->time_spent);
+            profiler.addSample(profiled.name, (timeSpent - profiled.timeSpent) * 1000.0);
+            profiled.timeSpent = timeSpent;
+        }
+    }
+
     void flushPendingPhysicsContactEvents() {
         if (!interpreterHost) {
+            pendingPhysicsContactEvents.clear();
             return;
         }
 
-        std::vector<tremor::physics::PhysicsContactEvent> eventsToDispatch;
-        {
-            std::lock_guard<std::mutex> lock(physicsContactEventsMutex);
-            if (pendingPhysicsContactEvents.empty()) {
-                return;
-            }
-            eventsToDispatch.swap(pendingPhysicsContactEvents);
-        }
-
-        for (const auto& event : eventsToDispatch) {
+        for (const auto& event : pendingPhysicsContactEvents) {
             interpreterHost->emitEvent({
                 physicsContactEventName(event.phase),
                 {
@@ -698,46 +1530,49 @@ public:
                 }
             });
         }
+        pendingPhysicsContactEvents.clear();
     }
 
     void setupInterpreterHost() {
         interpreterHost = std::make_unique<tremor::script::FlecsInterpreterHost>(world);
+        waveStateSlots = {
+            interpreterHost->internBlackboardPath("wave_state.current_wave"),
+            interpreterHost->internBlackboardPath("wave_state.enemies_spawned"),
+            interpreterHost->internBlackboardPath("wave_state.enemies_per_wave"),
+            interpreterHost->internBlackboardPath("wave_state.wave_intensity"),
+            interpreterHost->internBlackboardPath("wave_state.spawn_interval"),
+            interpreterHost->internBlackboardPath("wave_state.default_enemy_count"),
+            interpreterHost->internBlackboardPath("wave_state.default_spawn_interval"),
+            interpreterHost->internBlackboardPath("wave_state.default_wave_intensity"),
+        };
         tremor::ecs::registerScriptComponentCommands(*interpreterHost);
         tremor::physics::registerPhysicsLayerConfigCommands(*interpreterHost, physicsLayerConfig);
         tremor::render::registerScriptRenderFrameCommands(*interpreterHost, renderRegistry, renderCamera);
 
-        interpreterHost->registerCommand("set_wave_spawn_interval", [this](
+        using tremor::script::CommandArgType;
+
+        interpreterHost->registerTypedCommand("set_wave_spawn_interval", {{CommandArgType::Number}, 1, "<seconds>"}, [this](
             const tremor::script::CommandContext&,
-            std::string_view argument
+            std::span<const tremor::script::Value> args
         ) {
-            try {
-                const float interval = std::stof(std::string(argument));
-                world.each([interval](flecs::entity, WaveSpawner& spawner) {
-                    spawner.spawnInterval = std::max(0.1f, interval);
-                });
-                Logger::get().info("Interpreter set wave spawn interval to {}", interval);
-                return true;
-            } catch (const std::exception&) {
-                Logger::get().error("Interpreter failed to parse wave spawn interval '{}'", argument);
-                return false;
-            }
+            const float interval = static_cast<float>(*args[0].asNumber());
+            world.each([interval](flecs::entity, WaveSpawner& spawner) {
+                spawner.spawnInterval = std::max(0.1f, interval);
+            });
+            Logger::get().info("Interpreter set wave spawn interval to {}", interval);
+            return true;
         });
 
-        interpreterHost->registerCommand("set_wave_enemy_count", [this](
+        interpreterHost->registerTypedCommand("set_wave_enemy_count", {{CommandArgType::Number}, 1, "<count>"}, [this](
             const tremor::script::CommandContext&,
-            std::string_view argument
+            std::span<const tremor::script::Value> args
         ) {
-            try {
-                const int enemiesPerWave = std::max(1, std::stoi(std::string(argument)));
-                world.each([enemiesPerWave](flecs::entity, WaveSpawner& spawner) {
-                    spawner.enemiesPerWave = enemiesPerWave;
-                });
-                Logger::get().info("Interpreter set enemies per wave to {}", enemiesPerWave);
-                return true;
-            } catch (const std::exception&) {
-                Logger::get().error("Interpreter failed to parse enemies per wave '{}'", argument);
-                return false;
-            }
+            const int enemiesPerWave = std::max(1, static_cast<int>(*args[0].asNumber()));
+            world.each([enemiesPerWave](flecs::entity, WaveSpawner& spawner) {
+                spawner.enemiesPerWave = enemiesPerWave;
+            });
+            Logger::get().info("Interpreter set enemies per wave to {}", enemiesPerWave);
+            return true;
         });
 
         interpreterHost->registerCommand("spawn_enemy", [this](
@@ -751,12 +1586,134 @@ public:
             return true;
         });
 
+        // spatial_query_radius <enemies|pickups> x y z radius <result>
+        interpreterHost->registerTypedCommand("spatial_query_radius", {
+            {CommandArgType::String, CommandArgType::Number, CommandArgType::Number, CommandArgType::Number,
+                CommandArgType::Number, CommandArgType::String},
+            6,
+            "<enemies|pickups> x y z radius <result>",
+        }, [this](
+            const tremor::script::CommandContext&,
+            std::span<const tremor::script::Value> arguments
+        ) {
+            const std::optional<SpatialQueryArgs> args = spatialQueryArgs(arguments);
+            if (!args) {
+                Logger::get().error("spatial_query_radius expects '<enemies|pickups> x y z radius <result>'");
+                return false;
+            }
+
+            std::vector<uint64_t> ids;
+            auto collect = [&ids](flecs::entity entity, const Position&) {
+                ids.push_back(entity.id());
+            };
+            if (args->pickups) {
+                const float radiusSq = args->radius * args->radius;
+                forEachGridEntityNear(pickupGrid, args->center, args->radius, [&](flecs::entity orb, const Position& orbPos) {
+                    const glm::vec3 delta = orbPos.getFloat() - args->center;
+                    if (glm::dot(delta, delta) < radiusSq) {
+                        collect(orb, orbPos);
+                    }
+                });
+            } else {
+                forEachEnemyInRange(args->center, args->radius, collect);
+            }
+            return writeSpatialQueryResult(args->resultPath, ids);
+        });
+
+        // spatial_query_nearest <enemies|pickups> x y z radius count <result>; nearest first
+        interpreterHost->registerTypedCommand("spatial_query_nearest", {
+            {CommandArgType::String, CommandArgType::Number, CommandArgType::Number, CommandArgType::Number,
+                CommandArgType::Number, CommandArgType::Number, CommandArgType::String},
+            7,
+            "<enemies|pickups> x y z radius count <result>",
+        }, [this](
+            const tremor::script::CommandContext&,
+            std::span<const tremor::script::Value> arguments
+        ) {
+            const std::optional<SpatialQueryArgs> args = spatialQueryArgs(arguments);
+            if (!args) {
+                Logger::get().error("spatial_query_nearest expects '<enemies|pickups> x y z radius count <result>'");
+                return false;
+            }
+
+            if (args->pickups) {
+                pickupGrid.queryNearest(args->center, args->count, args->radius, spatialNeighbors);
+            } else {
+                findNearestEnemies(args->center, args->count, args->radius, spatialNeighbors);
+            }
+
+            std::vector<uint64_t> ids;
+            ids.reserve(spatialNeighbors.size());
+            for (const SpatialHashGrid::Neighbor& neighbor : spatialNeighbors) {
+                ids.push_back(neighbor.id);
+            }
+            return writeSpatialQueryResult(args->resultPath, ids);
+        });
+
         if (physicsWorld) {
             physicsAdapter = std::make_unique<tremor::physics::PhysicsInteropBackendAdapter>(*physicsWorld);
             tremor::physics::registerPhysicsInteropCommands(*interpreterHost, *physicsAdapter);
         }
     }
 
+    struct SpatialQueryArgs {
+        bool pickups = false;
+        glm::vec3 center{0.0f};
+        float radius = 0.0f;
+        size_t count = 0;
+        std::string resultPath;
+    };
+
+    // Typed arguments: set x y z radius [count] result
+    static std::optional<SpatialQueryArgs> spatialQueryArgs(std::span<const tremor::script::Value> arguments) {
+        const std::string_view set = *arguments[0].asStringView();
+        if (set != "enemies" && set != "pickups") {
+            return std::nullopt;
+        }
+
+        // Scripts supply the numbers, so NaN and values outside float range are
+        // rejected before they are converted
+        std::array<float, 4> numbers{};
+        for (size_t index = 0; index < numbers.size(); ++index) {
+            const double value = *arguments[index + 1].asNumber();
+            if (!(std::abs(value) <= std::numeric_limits<float>::max())) {
+                return std::nullopt;
+            }
+            numbers[index] = static_cast<float>(value);
+        }
+
+        SpatialQueryArgs args;
+        args.pickups = set == "pickups";
+        args.resultPath = *arguments.back().asStringView();
+        args.center = glm::vec3(numbers[0], numbers[1], numbers[2]);
+        args.radius = std::max(0.0f, numbers[3]);
+        if (arguments.size() == 7) {
+            const double count = *arguments[5].asNumber();
+            if (std::isnan(count)) {
+                return std::nullopt;
+            }
+            args.count = static_cast<size_t>(std::clamp(count, 0.0, static_cast<double>(SpatialQueryMaxCount)));
+        }
+        return args;
+    }
+
+    // Result object: "count" plus the entities under "0", "1", ...
+    bool writeSpatialQueryResult(const std::string& path, const std::vector<uint64_t>& ids) {
+        tremor::script::Value result = tremor::script::Value::makeObject();
+        tremor::script::ObjectValue* fields = result.asObject();
+        fields->fields.emplace("count", tremor::script::Value(static_cast<double>(ids.size())));
+        for (size_t index = 0; index < ids.size(); ++index) {
+            fields->fields.emplace(std::to_string(index), tremor::script::Value(static_cast<flecs::entity_t>(ids[index])));
+        }
+
+        std::string error;
+        if (!interpreterHost->setBlackboardValue(path, std::move(result), &error)) {
+            Logger::get().error("Spatial query could not write '{}': {}", path, error);
+            return false;
+        }
+        return true;
+    }
+
     void applyWaveSpawnIntervalPolicy(WaveSpawner& spawner, float baseInterval) {
         if (!interpreterHost || !interpreterHost->hasBoundHostCallback("wave_spawn_interval_policy")) {
             return;
@@ -846,20 +1803,20 @@ public:
         }
 
         std::string ignoredError;
-        interpreterHost->setBlackboardValue("wave_state.current_wave", tremor::script::Value(static_cast<double>(spawner.currentWave)), &ignoredError);
-        interpreterHost->setBlackboardValue("wave_state.enemies_spawned", tremor::script::Value(static_cast<double>(spawner.enemiesSpawned)), &ignoredError);
-        interpreterHost->setBlackboardValue("wave_state.enemies_per_wave", tremor::script::Value(static_cast<double>(spawner.enemiesPerWave)), &ignoredError);
-        interpreterHost->setBlackboardValue("wave_state.wave_intensity", tremor::script::Value(static_cast<double>(spawner.waveIntensity)), &ignoredError);
-        interpreterHost->setBlackboardValue("wave_state.spawn_interval", tremor::script::Value(static_cast<double>(spawner.spawnInterval)), &ignoredError);
+        interpreterHost->setBlackboardValue(waveStateSlots.currentWave, tremor::script::Value(static_cast<double>(spawner.currentWave)), &ignoredError);
+        interpreterHost->setBlackboardValue(waveStateSlots.enemiesSpawned, tremor::script::Value(static_cast<double>(spawner.enemiesSpawned)), &ignoredError);
+        interpreterHost->setBlackboardValue(waveStateSlots.enemiesPerWave, tremor::script::Value(static_cast<double>(spawner.enemiesPerWave)), &ignoredError);
+        interpreterHost->setBlackboardValue(waveStateSlots.waveIntensity, tremor::script::Value(static_cast<double>(spawner.waveIntensity)), &ignoredError);
+        interpreterHost->setBlackboardValue(waveStateSlots.spawnInterval, tremor::script::Value(static_cast<double>(spawner.spawnInterval)), &ignoredError);
 
         if (defaultEnemyCount >= 0) {
-            interpreterHost->setBlackboardValue("wave_state.default_enemy_count", tremor::script::Value(static_cast<double>(defaultEnemyCount)), &ignoredError);
+            interpreterHost->setBlackboardValue(waveStateSlots.defaultEnemyCount, tremor::script::Value(static_cast<double>(defaultEnemyCount)), &ignoredError);
         }
         if (defaultSpawnInterval >= 0.0f) {
-            interpreterHost->setBlackboardValue("wave_state.default_spawn_interval", tremor::script::Value(static_cast<double>(defaultSpawnInterval)), &ignoredError);
+            interpreterHost->setBlackboardValue(waveStateSlots.defaultSpawnInterval, tremor::script::Value(static_cast<double>(defaultSpawnInterval)), &ignoredError);
         }
         if (defaultWaveIntensity >= 0.0f) {
-            interpreterHost->setBlackboardValue("wave_state.default_wave_intensity", tremor::script::Value(static_cast<double>(defaultWaveIntensity)), &ignoredError);
+            interpreterHost->setBlackboardValue(waveStateSlots.defaultWaveIntensity, tremor::script::Value(static_cast<double>(defaultWaveIntensity)), &ignoredError);
         }
     }
 
@@ -1006,44 +1963,80 @@ action command emit_ui_message wave advanced
         world.component<MeshRenderer>();
         world.component<ParticleEffect>();
         world.component<PhysicsBody>();
+        world.component<InterpolatedPosition>();
         world.component<Player>();
         world.component<Enemy>();
         world.component<Boss>();
         world.component<Projectile>();
         world.component<InputCommand>();
+
+        refreshSnapshotQuery();
     }
 
     void setupSystems() {
-        // Movement system - applies movement forces while preserving physics velocity
+        // Movement system - applies movement forces while preserving physics velocity.
+        // Gathers every body first so sleep state, velocities and wakes are one batched call each.
         world.system<const Velocity, const PhysicsBody>("PhysicsMovementSystem")
-            .each([this](flecs::entity e, const Velocity& vel, const PhysicsBody& physicsBody) {
-                if (physicsWorld && !physicsBody.bodyId.IsInvalid()) {
-                    const glm::vec2 horizontalVelocity(vel.value.x, vel.value.z);
+            .run([this](flecs::iter& it) {
+                physicsBatchBodies.clear();
+                physicsBatchTargets.clear();
+                while (it.next()) {
+                    auto velocities = it.field<const Velocity>(0);
+                    auto physicsBodies = it.field<const PhysicsBody>(1);
+                    for (auto i : it) {
+                        if (!physicsBodies[i].bodyId.IsInvalid()) {
+                            physicsBatchBodies.push_back(physicsBodies[i].bodyId);
+                            physicsBatchTargets.push_back(velocities[i].value);
+                        }
+                    }
+                }
+                if (!physicsWorld || physicsBatchBodies.empty()) {
+                    return;
+                }
+
+                const size_t bodyCount = physicsBatchBodies.size();
+                physicsBatchSleeping.resize(bodyCount);
+                physicsBatchValues.resize(bodyCount);
+                physicsWorld->readBodySleeping(physicsBatchBodies, physicsBatchSleeping);
+                physicsWorld->readBodyVelocities(physicsBatchBodies, physicsBatchValues);
+
+                // Compact the bodies that get a new velocity to the front of the batch
+                physicsBatchWakes.clear();
+                size_t updateCount = 0;
+                for (size_t index = 0; index < bodyCount; ++index) {
+                    const glm::vec3& target = physicsBatchTargets[index];
+                    const glm::vec2 horizontalVelocity(target.x, target.z);
                     const bool hasHorizontalMotion = glm::dot(horizontalVelocity, horizontalVelocity) > 0.0001f;
-                    const bool isSleeping = physicsWorld->IsBodySleeping(physicsBody.bodyId);
+                    const bool isSleeping = physicsBatchSleeping[index] != 0;
 
                     if (!hasHorizontalMotion && isSleeping) {
-                        return;
+                        continue;
                     }
 
                     if (hasHorizontalMotion && isSleeping) {
-                        physicsWorld->WakeBody(physicsBody.bodyId);
+                        physicsBatchWakes.push_back(physicsBatchBodies[index]);
                     }
 
-                    // Get current physics velocity
-                    glm::vec3 currentVel = physicsWorld->GetBodyVelocity(physicsBody.bodyId);
-
                     // Only override X and Z (horizontal movement), preserve Y (gravity/jumping)
-                    glm::vec3 newVel = currentVel;
-                    newVel.x = vel.value.x;
-                    newVel.z = vel.value.z;
+                    glm::vec3 newVel = physicsBatchValues[index];
+                    newVel.x = target.x;
+                    newVel.z = target.z;
 
-                    physicsWorld->SetBodyVelocity(physicsBody.bodyId, newVel);
+                    physicsBatchBodies[updateCount] = physicsBatchBodies[index];
+                    physicsBatchValues[updateCount] = newVel;
+                    ++updateCount;
                 }
+
+                physicsWorld->wakeBodies(physicsBatchWakes);
+                physicsWorld->setBodyVelocities(
+                    std::span<const BodyID>(physicsBatchBodies.data(), updateCount),
+                    std::span<const glm::vec3>(physicsBatchValues.data(), updateCount)
+                );
             });
 
         world.system<Position, const Velocity>("NonPhysicsMovementSystem")
             .without<PhysicsBody>()
+            .multi_threaded()
             .each([](flecs::entity e, Position& pos, const Velocity& vel) {
                 const float dt = e.world().delta_time();
                 if (dt <= 0.0f) {
@@ -1059,17 +2052,43 @@ action command emit_ui_message wave advanced
 
         // Physics sync system - sync ECS positions FROM physics bodies AFTER physics update
         world.system<Position, const PhysicsBody>("PhysicsSyncSystem")
-            .each([this](flecs::entity e, Position& pos, const PhysicsBody& physicsBody) {
+            .run([this](flecs::iter& it) {
+                physicsBatchBodies.clear();
+                physicsSyncPositions.clear();
+                while (it.next()) {
+                    auto positions = it.field<Position>(0);
+                    auto physicsBodies = it.field<const PhysicsBody>(1);
+                    for (auto i : it) {
+                        if (!physicsBodies[i].bodyId.IsInvalid()) {
+                            physicsBatchBodies.push_back(physicsBodies[i].bodyId);
+                            physicsSyncPositions.push_back(&positions[i]);
+                        }
+                    }
+                }
+                if (!physicsWorld || physicsBatchBodies.empty()) {
+                    return;
+                }
+
+                // Physics is authoritative; read every body in one batch
+                physicsBatchValues.resize(physicsBatchBodies.size());
+                physicsWorld->readBodyPositions(physicsBatchBodies, physicsBatchValues);
+                for (size_t index = 0; index < physicsSyncPositions.size(); ++index) {
+                    physicsSyncPositions[index]->setFloat(physicsBatchValues[index]);
+                }
+            });
+
+        // Render-side blend between the last two fixed physics steps
+        world.system<InterpolatedPosition, const PhysicsBody>("PhysicsInterpolationSystem")
+            .each([this](flecs::entity e, InterpolatedPosition& smoothed, const PhysicsBody& physicsBody) {
                 if (physicsWorld && !physicsBody.bodyId.IsInvalid()) {
-                    // Get position from physics body (physics is authoritative)
-                    glm::vec3 physicsPos = physicsWorld->GetBodyPosition(physicsBody.bodyId);
-                    pos.setFloat(physicsPos);
+                    smoothed.value = physicsWorld->GetInterpolatedBodyPosition(physicsBody.bodyId);
                 }
             });
 
         // Jump state system - physics handles gravity automatically
         world.system<const Position, JumpState, const PhysicsBody>("JumpStateSystem")
-            .each([this](flecs::entity e, const Position& pos, JumpState& jump, const PhysicsBody& physicsBody) {
+            .multi_threaded()
+            .each([](flecs::entity e, const Position& pos, JumpState& jump, const PhysicsBody& physicsBody) {
                 float currentY = pos.getFloat().y;
 
                 // Check if grounded based on physics body position
@@ -1084,6 +2103,7 @@ action command emit_ui_message wave advanced
 
         // Dash system
         world.system<Position, Velocity, MovementState>("DashSystem")
+            .multi_threaded()
             .each([](flecs::entity e, Position& pos, Velocity& vel, MovementState& movement) {
                 float dt = e.world().delta_time();
 
@@ -1106,7 +2126,8 @@ action command emit_ui_message wave advanced
 
         // Combat system
         world.system<AttackState, CombatStats>("CombatSystem")
-            .each([this](flecs::entity e, AttackState& attack, const CombatStats& stats) {
+            .multi_threaded()
+            .each([](flecs::entity e, AttackState& attack, const CombatStats& stats) {
                 float dt = e.world().delta_time();
 
                 if (attack.isAttacking) {
@@ -1126,6 +2147,7 @@ action command emit_ui_message wave advanced
 
         // Combo system
         world.system<ComboState, StyleMeter>("ComboSystem")
+            .multi_threaded()
             .each([](flecs::entity e, ComboState& combo, StyleMeter& style) {
                 float dt = e.world().delta_time();
 
@@ -1162,22 +2184,15 @@ action command emit_ui_message wave advanced
 
         // Enemy AI system
         world.system<Position, Velocity, const EnemyAI, const Enemy>("EnemyAISystem")
+            .multi_threaded()
             .each([this](flecs::entity e, Position& pos, Velocity& vel, const EnemyAI& ai, const Enemy&) {
                 const PhysicsBody* physicsBody = e.get<PhysicsBody>();
+                // Queued per stage for EnemySleepStateSystem; sleeping is allowed on enemy bodies from creation
                 auto setEnemySleepState = [&](bool shouldSleep) {
-                    if (!physicsWorld || physicsBody == nullptr || physicsBody->bodyId.IsInvalid()) {
+                    if (physicsBody == nullptr || physicsBody->bodyId.IsInvalid()) {
                         return;
                     }
-
-                    physicsWorld->SetBodySleepingAllowed(physicsBody->bodyId, true);
-                    const bool isSleeping = physicsWorld->IsBodySleeping(physicsBody->bodyId);
-                    if (shouldSleep) {
-                        if (!isSleeping) {
-                            physicsWorld->SleepBody(physicsBody->bodyId);
-                        }
-                    } else if (isSleeping) {
-                        physicsWorld->WakeBody(physicsBody->bodyId);
-                    }
+                    (shouldSleep ? enemySleepRequests : enemyWakeRequests).push(e.world().get_stage_id(), physicsBody->bodyId);
                 };
 
                 if (const LaunchState* launch = e.get<LaunchState>(); launch && launch->isLaunched) {
@@ -1208,7 +2223,7 @@ action command emit_ui_message wave advanced
                         if (distance > ai.attackRange && distance < ai.aggroRange) {
                             direction.y = 0; // Keep on ground
                             direction = glm::normalize(direction);
-                            vel.value = direction * 3.0f; // Enemy speed
+                            vel.value = direction * EnemyChaseSpeed;
                         } else if (distance <= ai.attackRange) {
                             vel.value = glm::vec3(0.0f);
                             // Attack logic would go here
@@ -1225,98 +2240,86 @@ action command emit_ui_message wave advanced
                 }
             });
 
-        world.system<>("EnemyPhysicsLODSystem")
+        setupCrowdSystems();
+
+        // Apply the sleep and wake requests from EnemyAISystem in two batches.
+        // Bodies already in the requested state are left alone by the backend.
+        world.system<>("EnemySleepStateSystem")
             .kind(flecs::OnUpdate)
             .run([this](flecs::iter&) {
-                if (!physicsWorld || !player.is_alive()) {
-                    return;
+                enemySleepRequests.drainInto(enemyBodiesToSleep);
+                enemyWakeRequests.drainInto(enemyBodiesToWake);
+                if (physicsWorld) {
+                    physicsWorld->sleepBodies(enemyBodiesToSleep);
+                    physicsWorld->wakeBodies(enemyBodiesToWake);
                 }
+                enemyBodiesToSleep.clear();
+                enemyBodiesToWake.clear();
+            });
 
-                const Position* playerPos = player.get<Position>();
-                if (playerPos == nullptr) {
-                    return;
-                }
-
-                struct EnemyPhysicsCandidate {
-                    flecs::entity entity;
-                    float distanceSq = 0.0f;
-                    bool hasPhysics = false;
-                    bool launched = false;
-                    bool eligible = false;
-                };
-
-                const glm::vec3 playerPosition = playerPos->getFloat();
-                const float promoteDistanceSq = EnemyPhysicsPromoteDistance * EnemyPhysicsPromoteDistance;
-                const float demoteDistanceSq = EnemyPhysicsDemoteDistance * EnemyPhysicsDemoteDistance;
-
-                std::vector<EnemyPhysicsCandidate> candidates;
-                candidates.reserve(128);
-
-                world.each([&](flecs::entity enemy, Position& pos, Velocity& vel, const Enemy&) {
-                    const glm::vec3 delta = pos.getFloat() - playerPosition;
-                    const float distanceSq = glm::dot(delta, delta);
-                    const PhysicsBody* physicsBody = enemy.get<PhysicsBody>();
-                    const LaunchState* launch = enemy.get<LaunchState>();
-                    const bool launched = launch != nullptr && launch->isLaunched;
-                    const bool hasPhysics = physicsBody != nullptr && !physicsBody->bodyId.IsInvalid();
-
-                    const bool eligible = launched ||
-                        (!hasPhysics && distanceSq <= promoteDistanceSq) ||
-                        (hasPhysics && distanceSq <= demoteDistanceSq);
-
-                    candidates.push_back({enemy, distanceSq, hasPhysics, launched, eligible});
-                });
-
-                std::sort(candidates.begin(), candidates.end(), [](const EnemyPhysicsCandidate& left, const EnemyPhysicsCandidate& right) {
-                    if (left.launched != right.launched) {
-                        return left.launched > right.launched;
-                    }
-                    return left.distanceSq < right.distanceSq;
-                });
+        // Picks which enemies hold the limited physics bodies; see PhysicsLODSelector
+        world.system<const Position, const Enemy, const PhysicsBody*, const LaunchState*>("EnemyPhysicsLODSystem")
+            .kind(flecs::OnUpdate)
+            .run([this](flecs::iter& it) {
+                const Position* playerPos = physicsWorld && player.is_alive() ? player.get<Position>() : nullptr;
+                const glm::vec3 playerPosition = playerPos != nullptr ? playerPos->getFloat() : glm::vec3(0.0f);
 
-                std::vector<uint64_t> selectedEnemies;
-                selectedEnemies.reserve(MaxActiveEnemyPhysicsBodies);
-                for (const auto& candidate : candidates) {
-                    if (!candidate.eligible) {
+                enemyPhysicsLOD.begin();
+                while (it.next()) {
+                    if (playerPos == nullptr) {
                         continue;
                     }
-
-                    if (selectedEnemies.size() >= MaxActiveEnemyPhysicsBodies) {
-                        break;
+                    auto positions = it.field<const Position>(0);
+                    // Optional fields; only read when the table has them
+                    auto physicsBodies = it.field<const PhysicsBody>(2);
+                    auto launches = it.field<const LaunchState>(3);
+                    const bool tableHasBodies = it.is_set(2);
+                    const bool tableHasLaunch = it.is_set(3);
+                    for (auto i : it) {
+                        const glm::vec3 delta = positions[i].getFloat() - playerPosition;
+                        const bool hasPhysics = tableHasBodies && !physicsBodies[i].bodyId.IsInvalid();
+                        const bool launched = tableHasLaunch && launches[i].isLaunched;
+                        enemyPhysicsLOD.add(it.entity(i).id(), glm::dot(delta, delta), hasPhysics, launched);
                     }
-
-                    selectedEnemies.push_back(candidate.entity.id());
+                }
+                if (playerPos == nullptr) {
+                    return;
                 }
 
-                auto isSelected = [&selectedEnemies](flecs::entity enemy) {
-                    return std::find(selectedEnemies.begin(), selectedEnemies.end(), enemy.id()) != selectedEnemies.end();
-                };
+                enemyPhysicsLOD.select();
 
-                for (const auto& candidate : candidates) {
-                    Position* pos = candidate.entity.get_mut<Position>();
-                    Velocity* vel = candidate.entity.get_mut<Velocity>();
-                    if (pos == nullptr || vel == nullptr) {
-                        continue;
+                // Only the budgeted changes touch components
+                for (uint64_t id : enemyPhysicsLOD.demotions()) {
+                    flecs::entity enemy = world.entity(id);
+                    Position* pos = enemy.get_mut<Position>();
+                    Velocity* vel = enemy.get_mut<Velocity>();
+                    const PhysicsBody* physicsBody = enemy.get<PhysicsBody>();
+                    if (pos != nullptr && vel != nullptr && physicsBody != nullptr) {
+                        demoteEnemyFromPhysics(enemy, *pos, *vel, *physicsBody);
                     }
-
-                    const PhysicsBody* physicsBody = candidate.entity.get<PhysicsBody>();
-                    if (isSelected(candidate.entity)) {
-                        if (physicsBody == nullptr || physicsBody->bodyId.IsInvalid()) {
-                            promoteEnemyToPhysics(candidate.entity, *pos, *vel);
-                        }
-                    } else if (physicsBody != nullptr && !physicsBody->bodyId.IsInvalid()) {
-                        const LaunchState* launch = candidate.entity.get<LaunchState>();
-                        if (launch != nullptr && launch->isLaunched) {
-                            continue;
-                        }
-
-                        demoteEnemyFromPhysics(candidate.entity, *pos, *vel, *physicsBody);
+                }
+                for (uint64_t id : enemyPhysicsLOD.promotions()) {
+                    flecs::entity enemy = world.entity(id);
+                    const Position* pos = enemy.get<Position>();
+                    const Velocity* vel = enemy.get<Velocity>();
+                    if (pos != nullptr && vel != nullptr) {
+                        promoteEnemyToPhysics(enemy, *pos, *vel);
                     }
                 }
+
+                const PhysicsLODSelector::Stats& stats = enemyPhysicsLOD.stats();
+                auto& profiler = tremor::trace::Profiler::instance();
+                profiler.setCounter("LOD enemies", static_cast<double>(stats.candidates));
+                profiler.setCounter("LOD bodies", static_cast<double>(stats.bodies));
+                profiler.setCounter("LOD +", static_cast<double>(stats.promotions));
+                profiler.setCounter("LOD -", static_cast<double>(stats.demotions));
+                profiler.setCounter("LOD deferred", static_cast<double>(stats.deferredPromotions + stats.deferredDemotions));
+                profiler.setCounter("Pooled bodies", static_cast<double>(physicsWorld->bodyPoolStats().pooledBodies));
             });
 
         // Launch/Juggle system
         world.system<Position, Velocity, LaunchState>("LaunchSystem")
+            .multi_threaded()
             .each([](flecs::entity e, Position& pos, Velocity& vel, LaunchState& launch) {
                 if (launch.isLaunched) {
                     launch.launchTime += e.world().delta_time();
@@ -1335,6 +2338,7 @@ action command emit_ui_message wave advanced
 
         // Red Orb magnet system
         world.system<Position, Velocity, RedOrb>("OrbMagnetSystem")
+            .multi_threaded()
             .each([this](flecs::entity e, Position& pos, Velocity& vel, RedOrb& orb) {
                 auto playerPos = player.get<Position>();
 
@@ -1352,6 +2356,9 @@ action command emit_ui_message wave advanced
                 }
             });
 
+        // Spatial hash sync, after everything that moves body-less entities
+        setupSpatialHashSystems();
+
         // Collision system
         setupCollisionSystem();
 
@@ -1418,6 +2425,109 @@ action command emit_ui_message wave advanced
             });
     }
 
+    static int64_t crowdCellCoord(float value) {
+        return static_cast<int64_t>(std::floor(value / CrowdSeparationRadius));
+    }
+
+    static uint64_t crowdCellKey(int64_t cellX, int64_t cellZ) {
+        return (static_cast<uint64_t>(cellX) << 32) ^ (static_cast<uint64_t>(cellZ) & 0xffffffffull);
+    }
+
+    // Enemy-vs-enemy separation on top of the chase velocity from EnemyAISystem. Only a few
+    // enemies near the player get bodies, so without this the rest converge on one point.
+    void setupCrowdSystems() {
+        // Pull every enemy position out of the flecs tables into the cell-sorted SoA index
+        world.system<const Position, const Enemy>("EnemyCrowdGatherSystem")
+            .run([this](flecs::iter& it) {
+                crowdAgents.clear();
+                while (it.next()) {
+                    auto positions = it.field<const Position>(0);
+                    for (auto i : it) {
+                        const glm::vec3 position = positions[i].getFloat();
+                        const uint64_t cell = crowdCellKey(crowdCellCoord(position.x), crowdCellCoord(position.z));
+                        crowdAgents.push_back({cell, position.x, position.z});
+                    }
+                }
+
+                std::sort(crowdAgents.begin(), crowdAgents.end(), [](const CrowdAgent& left, const CrowdAgent& right) {
+                    return left.cell < right.cell;
+                });
+
+                const size_t count = crowdAgents.size();
+                crowdX.resize(count);
+                crowdZ.resize(count);
+                crowdCells.clear();
+                for (size_t index = 0; index < count; ++index) {
+                    crowdX[index] = crowdAgents[index].x;
+                    crowdZ[index] = crowdAgents[index].z;
+                    auto [cell, inserted] = crowdCells.try_emplace(
+                        crowdAgents[index].cell, static_cast<uint32_t>(index), static_cast<uint32_t>(index));
+                    cell->second.second = static_cast<uint32_t>(index + 1);
+                }
+            });
+
+        // Reads only the index built above and writes only its own Velocity, so flecs may
+        // split it across worker threads when the world has them
+        world.system<Velocity, const Position, const EnemyAI, const Enemy>("EnemySeparationSystem")
+            .multi_threaded()
+            .each([this](flecs::entity e, Velocity& vel, const Position& pos, const EnemyAI& ai, const Enemy&) {
+                if (ai.stunDuration > 0) {
+                    return;
+                }
+                if (const LaunchState* launch = e.get<LaunchState>(); launch && launch->isLaunched) {
+                    return;
+                }
+
+                const glm::vec3 position = pos.getFloat();
+                const int64_t cellX = crowdCellCoord(position.x);
+                const int64_t cellZ = crowdCellCoord(position.z);
+                crowd::SeparationPush push;
+                for (int64_t x = cellX - 1; x <= cellX + 1; ++x) {
+                    for (int64_t z = cellZ - 1; z <= cellZ + 1; ++z) {
+                        const auto found = crowdCells.find(crowdCellKey(x, z));
+                        if (found == crowdCells.end()) {
+                            continue;
+                        }
+                        const auto [begin, end] = found->second;
+                        crowd::accumulateSeparation(position.x, position.z, crowdX.data() + begin,
+                                                    crowdZ.data() + begin, end - begin, CrowdSeparationRadius, push);
+                    }
+                }
+
+                glm::vec2 separation(push.x, push.z);
+                if (push.coincident > 1) {
+                    // Stacked exactly on another enemy (the count includes this one): there is no
+                    // direction to push along, so pick one from the entity id to pull the stack apart
+                    const float angle = static_cast<float>(e.id() % 1024) * 2.39996323f;
+                    separation += glm::vec2(std::cos(angle), std::sin(angle));
+                }
+                if (glm::dot(separation, separation) <= 1e-8f) {
+                    return;
+                }
+
+                glm::vec2 horizontal = glm::vec2(vel.value.x, vel.value.z) + separation * CrowdSeparationSpeed;
+                const float speedSq = glm::dot(horizontal, horizontal);
+                if (speedSq > EnemyChaseSpeed * EnemyChaseSpeed) {
+                    horizontal *= EnemyChaseSpeed / std::sqrt(speedSq);
+                }
+                vel.value.x = horizontal.x;
+                vel.value.z = horizontal.y;
+            });
+    }
+
+    void setupSpatialHashSystems() {
+        world.system<const Position, const Enemy>("EnemySpatialHashSystem")
+            .without<PhysicsBody>()
+            .each([this](flecs::entity enemy, const Position& pos, const Enemy&) {
+                syncEnemyGridEntry(enemy, pos);
+            });
+
+        world.system<const Position, const RedOrb>("PickupSpatialHashSystem")
+            .each([this](flecs::entity orb, const Position& pos, const RedOrb&) {
+                pickupGrid.update(orb.id(), pos.quantized, pos.getFloat());
+            });
+    }
+
     void setupCollisionSystem() {
         world.system<>("CollisionSystem")
             .kind(flecs::OnUpdate)
@@ -1432,38 +2542,57 @@ action command emit_ui_message wave advanced
                     return;
                 }
 
-                world.each([&](flecs::entity other, const Position& otherPos, const CollisionRadius& otherRadius) {
-                    if (other == player) {
+                const glm::vec3 playerPosition = playerPos->getFloat();
+                const float playerRadiusValue = playerRadius->value;
+                forEachEnemyInRange(playerPosition, playerRadiusValue + EnemyCollisionRadius, [&](flecs::entity enemy, const Position& enemyPos) {
+                    const CollisionRadius* enemyRadius = enemy.get<CollisionRadius>();
+                    if (enemyRadius == nullptr) {
                         return;
                     }
 
-                    if (!other.has<Enemy>() && !other.has<RedOrb>()) {
+                    const float dist = glm::length(playerPosition - enemyPos.getFloat());
+                    if (dist < playerRadiusValue + enemyRadius->value) {
+                        resolveCharacterOverlap(player, enemy);
+                        handleCollision(player, enemy);
+                    }
+                });
+
+                forEachGridEntityNear(pickupGrid, playerPosition, playerRadiusValue + PickupCollisionRadius, [&](flecs::entity orb, const Position& orbPos) {
+                    const CollisionRadius* orbRadius = orb.get<CollisionRadius>();
+                    if (orbRadius == nullptr) {
                         return;
                     }
 
-                    const float dist = glm::length(playerPos->getFloat() - otherPos.getFloat());
-                    if (dist < playerRadius->value + otherRadius.value) {
-                        resolveCharacterOverlap(player, other);
-                        handleCollision(player, other);
+                    const float dist = glm::length(playerPosition - orbPos.getFloat());
+                    if (dist < playerRadiusValue + orbRadius->value) {
+                        resolveCharacterOverlap(player, orb);
+                        handleCollision(player, orb);
                     }
                 });
             });
     }
 
+    BodyID createPlayerPhysicsBodyAt(const glm::vec3& position) {
+        if (!physicsWorld) {
+            return {};
+        }
+
+        BodyID playerPhysicsBody = physicsWorld->CreateDynamicBody(
+            position,
+            0.5f,   // radius
+            1.8f,   // height (humanoid)
+            DMCSurvivors::Layers::PLAYER
+        );
+        physicsWorld->SetBodySleepingAllowed(playerPhysicsBody, false);
+        physicsWorld->setBodyInterpolated(playerPhysicsBody, true);
+        return playerPhysicsBody;
+    }
+
     void createPlayer() {
         glm::vec3 startPos(0.0f, 1.0f, 0.0f); // Start slightly above ground
 
         // Create physics body for player
-        BodyID playerPhysicsBody;
-        if (physicsWorld) {
-            playerPhysicsBody = physicsWorld->CreateDynamicBody(
-                startPos,
-                0.5f,   // radius
-                1.8f,   // height (humanoid)
-                DMCSurvivors::Layers::PLAYER
-            );
-            physicsWorld->SetBodySleepingAllowed(playerPhysicsBody, false);
-        }
+        BodyID playerPhysicsBody = createPlayerPhysicsBodyAt(startPos);
 
         player = world.entity("Player")
             .set<Position>(Position(startPos))
@@ -1481,8 +2610,10 @@ action command emit_ui_message wave advanced
             .set<WeaponSlot>({})
             .set<Experience>({0.0f, 100.0f, 1})
             .set<PhysicsBody>({playerPhysicsBody, false})
+            .set<InterpolatedPosition>({startPos})
             .set<Player>({})
             .set<MeshRenderer>({0, glm::vec4(0.2f, 0.5f, 1.0f, 1.0f)});
+        trackPhysicsBody(player, playerPhysicsBody);
 
         Logger::get().info("🎯 Created player with physics body");
     }
@@ -1527,7 +2658,7 @@ action command emit_ui_message wave advanced
             .set<Velocity>({glm::vec3(0.0f)})
             .set<Rotation>({glm::quat(1.0f, 0.0f, 0.0f, 0.0f)})
             .set<Health>({50.0f * healthMult, 50.0f * healthMult})
-            .set<CollisionRadius>({0.4f})
+            .set<CollisionRadius>({EnemyCollisionRadius})
             .set<CombatStats>({10.0f * damageMult, 0.8f, 0.05f, 1.5f})
             .set<LaunchState>({})
             .set<Enemy>({})
@@ -1536,6 +2667,8 @@ action command emit_ui_message wave advanced
 
         if (!enemyPhysicsBody.IsInvalid()) {
             enemyBuilder.set<PhysicsBody>({enemyPhysicsBody, false});
+            enemyBuilder.set<InterpolatedPosition>({spawnPos});
+            trackPhysicsBody(enemyBuilder, enemyPhysicsBody);
         }
 
         auto enemy = enemyBuilder;
@@ -1556,7 +2689,7 @@ action command emit_ui_message wave advanced
         world.entity()
             .set<Position>({position})
             .set<Velocity>({glm::vec3(0.0f)})
-            .set<CollisionRadius>({0.3f})
+            .set<CollisionRadius>({PickupCollisionRadius})
             .set<RedOrb>({value})
             .set<MeshRenderer>({2, glm::vec4(1.0f, 0.2f, 0.2f, 1.0f)});
     }
@@ -1679,11 +2812,10 @@ action command emit_ui_message wave advanced
 
         // Check for enemies in range and collect entities to delete
         std::vector<flecs::entity> enemiesToDelete;
-        world.each([&](flecs::entity enemy, Position& enemyPos, Health& health, const Enemy&) {
-            float dist = glm::length(enemyPos.getFloat() - playerPos->getFloat());
-
-            if (dist < range) {
-                health.current -= damage;
+        forEachEnemyInRange(playerPos->getFloat(), range, [&](flecs::entity enemy, const Position& enemyPos) {
+            Health* health = enemy.get_mut<Health>();
+            if (health != nullptr) {
+                health->current -= damage;
 
                 // Launch enemy on launcher attack
                 if (type == LAUNCHER) {
@@ -1700,7 +2832,7 @@ action command emit_ui_message wave advanced
                 }
 
                 // Mark enemy for deletion if defeated
-                if (health.current <= 0) {
+                if (health->current <= 0) {
                     spawnRedOrb(enemyPos.getFloat(), 10.0f * (1.0f + gameTime / 1000.0f));
                     enemiesToDelete.push_back(enemy);
 
@@ -1714,7 +2846,7 @@ action command emit_ui_message wave advanced
 
         // Delete enemies after iteration is complete
         for (auto& enemy : enemiesToDelete) {
-            enemy.destruct();
+            destroyEntity(enemy);
         }
     }
 
@@ -1726,18 +2858,10 @@ action command emit_ui_message wave advanced
             auto playerPos = player.get<Position>();
             if (!playerPos) return;
 
-            flecs::entity nearest;
-            float nearestDist = 20.0f; // Max lock-on range
-
-            world.each([&](flecs::entity enemy, const Position& enemyPos, const Enemy&) {
-                float dist = glm::length(enemyPos.getFloat() - playerPos->getFloat());
-                if (dist < nearestDist) {
-                    nearestDist = dist;
-                    nearest = enemy;
-                }
-            });
-
-            currentTarget = nearest;
+            findNearestEnemies(playerPos->getFloat(), 1, 20.0f, spatialNeighbors); // Max lock-on range
+            currentTarget = spatialNeighbors.empty()
+                ? flecs::entity()
+                : flecs::entity(world, spatialNeighbors.front().id);
         }
     }
 
@@ -1783,7 +2907,8 @@ action command emit_ui_message wave advanced
                     }
                 }
 
-                entitiesMarkedForDeletion.push_back(e2);
+                // CollisionSystem runs on the main thread, stage 0
+                entitiesMarkedForDeletion.push(0, e2);
             }
         }
     }
@@ -1799,6 +2924,8 @@ action command emit_ui_message wave advanced
             settings.layers = physicsLayerConfig.build();
         }
         applyDmcPhysicsLayerPolicy(settings.layers);
+        settings.fixedStepRate = PhysicsStepRate;
+        settings.maxSubsteps = MaxPhysicsSubsteps;
 
         auto tryInitializeBackend = [this](tremor::physics::PhysicsBackendKind backendKindToTry, const tremor::physics::PhysicsSettings& settingsToUse) {
             auto candidate = tremor::physics::createPhysicsWorldBackend(backendKindToTry, settingsToUse);
@@ -1824,15 +2951,22 @@ action command emit_ui_message wave advanced
             return;
         }
 
-        physicsWorld->setContactCallback([this](const tremor::physics::PhysicsContactEvent& event) {
-            queuePhysicsContactEvent(event);
+        physicsWorld->setContactBatchCallback([this](std::span<const tremor::physics::PhysicsContactEvent> events) {
+            queuePhysicsContactEvents(events);
         });
+        // Enemies and pickups resting on level geometry touch it constantly; nothing reacts to that
+        physicsWorld->setContactLayerPairEnabled(DMCSurvivors::Layers::NON_MOVING, DMCSurvivors::Layers::ENEMY, false);
+        physicsWorld->setContactLayerPairEnabled(DMCSurvivors::Layers::NON_MOVING, DMCSurvivors::Layers::PICKUP, false);
 
         Logger::get().info(
             "✅ Physics backend initialized successfully: {}",
             physicsBackendName(physicsBackendKind)
         );
 
+        // Enemy bodies are promoted and demoted constantly; build the whole budget up front
+        physicsWorld->reserveDynamicCapsules(
+            EnemyCapsuleRadius, EnemyCapsuleHeight, DMCSurvivors::Layers::ENEMY, MaxActiveEnemyPhysicsBodies);
+
         // Create ground plane
         createGroundPlane();
     }
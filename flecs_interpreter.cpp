@@ -135,11 +135,10 @@ std::string stripVarPrefix(std::string_view path) {
     return result;
 }
 
-const Value* resolveBlackboardPath(
+const Value* resolveBlackboardSegments(
     const std::unordered_map<std::string, Value>& blackboard,
-    std::string_view path
+    const std::vector<std::string>& segments
 ) {
-    const std::vector<std::string> segments = splitPath(path);
     if (segments.empty()) {
         return nullptr;
     }
@@ -167,74 +166,6 @@ const Value* resolveBlackboardPath(
     return current;
 }
 
-bool assignBlackboardPath(
-    std::unordered_map<std::string, Value>& blackboard,
-    std::string_view path,
-    Value value,
-    std::string* outError
-) {
-    const std::vector<std::string> segments = splitPath(path);
-    if (segments.empty()) {
-        if (outError != nullptr) {
-            *outError = "assignment target path is empty";
-        }
-        return false;
-    }
-
-    if (segments.size() == 1) {
-        blackboard[segments.front()] = std::move(value);
-        return true;
-    }
-
-    Value& root = blackboard[segments.front()];
-    if (root.isNull()) {
-        root = Value::makeObject();
-    }
-
-    Value* current = &root;
-    for (size_t i = 1; i + 1 < segments.size(); ++i) {
-        ObjectValue* object = current->asObject();
-        if (object == nullptr) {
-            if (outError != nullptr) {
-                *outError = std::format(
-                    "path segment '{}' is not an object",
-                    segments[i - 1]
-                );
-            }
-            return false;
-        }
-
-        Value& child = object->fields[segments[i]];
-        if (child.isNull()) {
-            child = Value::makeObject();
-        } else if (child.asObject() == nullptr) {
-            if (outError != nullptr) {
-                *outError = std::format(
-                    "path segment '{}' is not an object",
-                    segments[i]
-                );
-            }
-            return false;
-        }
-
-        current = &child;
-    }
-
-    ObjectValue* object = current->asObject();
-    if (object == nullptr) {
-        if (outError != nullptr) {
-            *outError = std::format(
-                "path segment '{}' is not an object",
-                segments[segments.size() - 2]
-            );
-        }
-        return false;
-    }
-
-    object->fields[segments.back()] = std::move(value);
-    return true;
-}
-
 std::optional<flecs::entity_t> parseEntityId(std::string_view text) {
     std::string value = trimCopy(text);
     if (value.empty()) {
@@ -258,7 +189,7 @@ std::optional<flecs::entity_t> parseEntityId(std::string_view text) {
 
 std::optional<flecs::entity> resolveEntityRef(
     flecs::world& world,
-    const ValueMap& blackboard,
+    const Blackboard& blackboard,
     std::string_view reference,
     std::string* outError
 ) {
@@ -271,7 +202,7 @@ std::optional<flecs::entity> resolveEntityRef(
     }
 
     if (startsWith(text, "var.")) {
-        const Value* value = resolveBlackboardPath(blackboard, text.substr(4));
+        const Value* value = blackboard.find(std::string_view(text).substr(4));
         if (value == nullptr) {
             if (outError != nullptr) {
                 *outError = std::format("blackboard entity reference '{}' is unset", text);
@@ -327,14 +258,6 @@ flecs::entity getOrCreateTag(flecs::world& world, std::string_view name) {
     return world.entity(tagName.c_str());
 }
 
-std::optional<Value> evaluateExpression(
-    std::string_view expression,
-    const InterpreterEvent* event,
-    const ValueMap& blackboard,
-    const ValueMap* locals,
-    std::string* outError
-);
-
 bool valueEquals(const Value& left, const Value& right) {
     if (left.type() != right.type()) {
         return false;
@@ -396,194 +319,166 @@ bool coerceValueToBool(const Value& value) {
     return false;
 }
 
-class ExpressionParser {
+// Recursive descent over the expression grammar, emitting postfix code. The
+// grammar and the order operands are evaluated in match the old evaluate-while-
+// parsing interpreter, so compiled scripts behave as they did.
+class ExpressionCompiler {
 public:
-    ExpressionParser(
-        std::string_view source,
-        const InterpreterEvent* event,
-        const ValueMap& blackboard,
-        const ValueMap* locals = nullptr
-    )
-        : source_(source), event_(event), blackboard_(blackboard), locals_(locals) {
+    ExpressionCompiler(std::string_view source, CompiledExpression& out, Blackboard& blackboard)
+        : source_(source), out_(out), blackboard_(blackboard) {
     }
 
-    std::optional<Value> parse(std::string* outError) {
-        std::optional<Value> value = parseOr();
+    bool compile() {
+        const bool compiled = compileOr();
         skipWhitespace();
-        if (!value) {
-            if (outError != nullptr) {
-                *outError = error_;
-            }
-            return std::nullopt;
-        }
-
-        if (!atEnd()) {
+        if (compiled && !atEnd()) {
             setError(std::format("unexpected trailing input near '{}'", remainingSource()));
-            if (outError != nullptr) {
-                *outError = error_;
-            }
-            return std::nullopt;
         }
-
-        return value;
+        if (!compiled && error_.empty()) {
+            setError("invalid expression");
+        }
+        if (!error_.empty()) {
+            out_.code.clear();
+            out_.error = error_;
+            return false;
+        }
+        return true;
     }
 
 private:
-    std::optional<Value> parseOr() {
-        std::optional<Value> left = parseAnd();
-        while (left && consumeKeyword("or")) {
-            std::optional<Value> right = parseAnd();
-            if (!right) {
-                return std::nullopt;
+    using Op = CompiledExpression::Op;
+
+    void emit(Op op, uint32_t operand = 0) {
+        out_.code.push_back({op, operand});
+    }
+
+    template <typename T>
+    static uint32_t append(std::vector<T>& table, T entry) {
+        table.push_back(std::move(entry));
+        return static_cast<uint32_t>(table.size() - 1);
+    }
+
+    bool compileOr() {
+        if (!compileAnd()) {
+            return false;
+        }
+        while (consumeKeyword("or")) {
+            if (!compileAnd()) {
+                return false;
             }
-            left = Value(coerceValueToBool(*left) || coerceValueToBool(*right));
+            emit(Op::Or);
         }
-        return left;
+        return true;
     }
 
-    std::optional<Value> parseAnd() {
-        std::optional<Value> left = parseComparison();
-        while (left && consumeKeyword("and")) {
-            std::optional<Value> right = parseComparison();
-            if (!right) {
-                return std::nullopt;
+    bool compileAnd() {
+        if (!compileComparison()) {
+            return false;
+        }
+        while (consumeKeyword("and")) {
+            if (!compileComparison()) {
+                return false;
             }
-            left = Value(coerceValueToBool(*left) && coerceValueToBool(*right));
+            emit(Op::And);
         }
-        return left;
+        return true;
     }
 
-    std::optional<Value> parseComparison() {
-        std::optional<Value> left = parseAdditive();
-        while (left) {
-            std::string op;
-            if (consumeOperator("==")) op = "==";
-            else if (consumeOperator("!=")) op = "!=";
-            else if (consumeOperator(">=")) op = ">=";
-            else if (consumeOperator("<=")) op = "<=";
-            else if (consumeOperator(">")) op = ">";
-            else if (consumeOperator("<")) op = "<";
+    bool compileComparison() {
+        if (!compileAdditive()) {
+            return false;
+        }
+        while (true) {
+            Op op;
+            if (consumeOperator("==")) op = Op::Equal;
+            else if (consumeOperator("!=")) op = Op::NotEqual;
+            else if (consumeOperator(">=")) op = Op::GreaterEqual;
+            else if (consumeOperator("<=")) op = Op::LessEqual;
+            else if (consumeOperator(">")) op = Op::Greater;
+            else if (consumeOperator("<")) op = Op::Less;
             else break;
 
-            std::optional<Value> right = parseAdditive();
-            if (!right) {
-                return std::nullopt;
-            }
-
-            if (op == "==" || op == "!=") {
-                const bool equal = valueEquals(*left, *right);
-                left = Value(op == "==" ? equal : !equal);
-                continue;
-            }
-
-            const auto lhs = left->asNumber();
-            const auto rhs = right->asNumber();
-            if (!lhs || !rhs) {
-                setError(std::format("operator '{}' requires numeric operands", op));
-                return std::nullopt;
+            if (!compileAdditive()) {
+                return false;
             }
-
-            if (op == ">") left = Value(*lhs > *rhs);
-            else if (op == ">=") left = Value(*lhs >= *rhs);
-            else if (op == "<") left = Value(*lhs < *rhs);
-            else left = Value(*lhs <= *rhs);
+            emit(op);
         }
-
-        return left;
+        return true;
     }
 
-    std::optional<Value> parseAdditive() {
-        std::optional<Value> left = parseMultiplicative();
-        while (left) {
-            std::string op;
-            if (consumeOperator("+")) op = "+";
-            else if (consumeOperator("-")) op = "-";
+    bool compileAdditive() {
+        if (!compileMultiplicative()) {
+            return false;
+        }
+        while (true) {
+            Op op;
+            if (consumeOperator("+")) op = Op::Add;
+            else if (consumeOperator("-")) op = Op::Subtract;
             else break;
 
-            std::optional<Value> right = parseMultiplicative();
-            if (!right) {
-                return std::nullopt;
-            }
-
-            const auto lhs = left->asNumber();
-            const auto rhs = right->asNumber();
-            if (!lhs || !rhs) {
-                setError(std::format("operator '{}' requires numeric operands", op));
-                return std::nullopt;
+            if (!compileMultiplicative()) {
+                return false;
             }
-
-            left = Value(op == "+" ? *lhs + *rhs : *lhs - *rhs);
+            emit(op);
         }
-
-        return left;
+        return true;
     }
 
-    std::optional<Value> parseMultiplicative() {
-        std::optional<Value> left = parseUnary();
-        while (left) {
-            std::string op;
-            if (consumeOperator("*")) op = "*";
-            else if (consumeOperator("/")) op = "/";
+    bool compileMultiplicative() {
+        if (!compileUnary()) {
+            return false;
+        }
+        while (true) {
+            Op op;
+            if (consumeOperator("*")) op = Op::Multiply;
+            else if (consumeOperator("/")) op = Op::Divide;
             else break;
 
-            std::optional<Value> right = parseUnary();
-            if (!right) {
-                return std::nullopt;
-            }
-
-            const auto lhs = left->asNumber();
-            const auto rhs = right->asNumber();
-            if (!lhs || !rhs) {
-                setError(std::format("operator '{}' requires numeric operands", op));
-                return std::nullopt;
-            }
-
-            if (op == "/" && *rhs == 0.0) {
-                setError("division by zero");
-                return std::nullopt;
+            if (!compileUnary()) {
+                return false;
             }
-
-            left = Value(op == "*" ? *lhs * *rhs : *lhs / *rhs);
+            emit(op);
         }
-
-        return left;
+        return true;
     }
 
-    std::optional<Value> parseUnary() {
+    bool compileUnary() {
         if (consumeKeyword("not")) {
-            std::optional<Value> operand = parseUnary();
-            if (!operand) {
-                return std::nullopt;
+            if (!compileUnary()) {
+                return false;
             }
-            return Value(!coerceValueToBool(*operand));
+            emit(Op::Not);
+            return true;
         }
 
         if (consumeOperator("-")) {
-            std::optional<Value> operand = parseUnary();
-            if (!operand) {
-                return std::nullopt;
+            if (!compileUnary()) {
+                return false;
             }
 
-            const auto number = operand->asNumber();
-            if (!number) {
-                setError("unary '-' requires a numeric operand");
-                return std::nullopt;
+            // Negative number literals fold into the constant
+            CompiledExpression::Instruction& last = out_.code.back();
+            if (last.op == Op::PushConstant) {
+                if (const auto number = out_.constants[last.operand].asNumber()) {
+                    out_.constants[last.operand] = Value(-*number);
+                    return true;
+                }
             }
-
-            return Value(-*number);
+            emit(Op::Negate);
+            return true;
         }
 
-        return parsePrimary();
+        return compilePrimary();
     }
 
-    std::optional<Value> parsePrimary() {
+    bool compilePrimary() {
         skipWhitespace();
 
         if (consumeKeyword("fn")) {
             skipWhitespace();
             if (!consumeOperator("(")) {
                 setError("expected '(' after fn");
-                return std::nullopt;
+                return false;
             }
 
             auto lambda = std::make_shared<LambdaValue>();
@@ -596,7 +491,7 @@ private:
                         if (error_.empty()) {
                             setError("expected lambda parameter name");
                         }
-                        return std::nullopt;
+                        return false;
                     }
                     lambda->parameters.push_back(parameter);
 
@@ -607,7 +502,7 @@ private:
 
                     if (!consumeOperator(",")) {
                         setError("expected ',' or ')' in lambda parameter list");
-                        return std::nullopt;
+                        return false;
                     }
                 }
             }
@@ -615,7 +510,7 @@ private:
             skipWhitespace();
             if (!consumeOperator("{")) {
                 setError("expected '{' to start lambda body");
-                return std::nullopt;
+                return false;
             }
 
             const std::optional<std::string> bodySource = parseBalancedBlockBody();
@@ -623,118 +518,100 @@ private:
                 if (error_.empty()) {
                     setError("unterminated lambda body");
                 }
-                return std::nullopt;
+                return false;
             }
 
             lambda->bodySource = trimCopy(*bodySource);
             lambda->debugName = std::format("fn/{}", lambda->parameters.size());
-            return Value(std::move(lambda));
+            emit(Op::MakeLambda, append(out_.constants, Value(std::move(lambda))));
+            return true;
         }
 
         if (consumeOperator("(")) {
-            std::optional<Value> nested = parseOr();
-            if (!nested) {
-                return std::nullopt;
+            if (!compileOr()) {
+                return false;
             }
             if (!consumeOperator(")")) {
                 setError("expected ')'");
-                return std::nullopt;
+                return false;
             }
-            return nested;
+            return true;
         }
 
         if (consumeOperator("{")) {
-            Value objectValue = Value::makeObject();
-            ObjectValue* object = objectValue.asObject();
-            if (object == nullptr) {
-                setError("failed to create object value");
-                return std::nullopt;
-            }
+            std::vector<std::string> keys;
 
             skipWhitespace();
-            if (consumeOperator("}")) {
-                return objectValue;
-            }
-
-            while (true) {
-                const std::string key = parseObjectKey();
-                if (key.empty()) {
-                    if (error_.empty()) {
-                        setError("expected object field name");
+            if (!consumeOperator("}")) {
+                while (true) {
+                    std::string key = parseObjectKey();
+                    if (key.empty()) {
+                        if (error_.empty()) {
+                            setError("expected object field name");
+                        }
+                        return false;
                     }
-                    return std::nullopt;
-                }
-
-                if (!consumeOperator(":")) {
-                    setError("expected ':' after object field name");
-                    return std::nullopt;
-                }
 
-                std::optional<Value> fieldValue = parseOr();
-                if (!fieldValue) {
-                    return std::nullopt;
-                }
+                    if (!consumeOperator(":")) {
+                        setError("expected ':' after object field name");
+                        return false;
+                    }
 
-                object->fields[key] = *fieldValue;
+                    if (!compileOr()) {
+                        return false;
+                    }
+                    keys.push_back(std::move(key));
 
-                skipWhitespace();
-                if (consumeOperator("}")) {
-                    break;
-                }
+                    skipWhitespace();
+                    if (consumeOperator("}")) {
+                        break;
+                    }
 
-                if (!consumeOperator(",")) {
-                    setError("expected ',' or '}' in object literal");
-                    return std::nullopt;
+                    if (!consumeOperator(",")) {
+                        setError("expected ',' or '}' in object literal");
+                        return false;
+                    }
                 }
             }
 
-            return objectValue;
+            emit(Op::MakeObject, append(out_.objectKeys, std::move(keys)));
+            return true;
         }
 
         const std::string token = parseToken();
         if (token.empty()) {
             setError("expected expression");
-            return std::nullopt;
+            return false;
         }
 
         if (startsWith(token, "\"") && token.size() >= 2 && token.back() == '"') {
-            return parseLiteralValue(token);
+            emit(Op::PushConstant, append(out_.constants, parseLiteralValue(token)));
+            return true;
         }
 
         if (startsWith(token, "event.")) {
-            if (event_ == nullptr) {
-                return Value(nullptr);
-            }
-
-            const std::string fieldName = token.substr(6);
-            const auto found = event_->fields.find(fieldName);
-            if (found == event_->fields.end()) {
-                return Value(nullptr);
-            }
-            return parseLiteralValue(found->second);
+            emit(Op::PushEventField, append(out_.names, token.substr(6)));
+            return true;
         }
 
         if (startsWith(token, "var.")) {
-            const Value* value = resolveBlackboardPath(blackboard_, token.substr(4));
-            if (value == nullptr) {
-                return Value(nullptr);
+            const BlackboardSlot slot = blackboard_.intern(std::string_view(token).substr(4));
+            if (!slot.valid()) {
+                // "var." alone never resolves
+                emit(Op::PushConstant, append(out_.constants, Value(nullptr)));
+                return true;
             }
-            return *value;
+            emit(Op::PushVariable, slot.index);
+            return true;
         }
 
         if (startsWith(token, "arg.")) {
-            if (locals_ == nullptr) {
-                return Value(nullptr);
-            }
-
-            const Value* value = resolveBlackboardPath(*locals_, token.substr(4));
-            if (value == nullptr) {
-                return Value(nullptr);
-            }
-            return *value;
+            emit(Op::PushArgument, append(out_.paths, splitPath(std::string_view(token).substr(4))));
+            return true;
         }
 
-        return parseLiteralValue(token);
+        emit(Op::PushConstant, append(out_.constants, parseLiteralValue(token)));
+        return true;
     }
 
     std::string parseLambdaIdentifier() {
@@ -901,76 +778,381 @@ private:
     }
 
     std::string_view source_;
-    const InterpreterEvent* event_ = nullptr;
-    const ValueMap& blackboard_;
-    const ValueMap* locals_ = nullptr;
+    CompiledExpression& out_;
+    Blackboard& blackboard_;
     size_t position_ = 0;
     std::string error_;
 };
 
-std::optional<Value> evaluateExpression(
-    std::string_view expression,
+bool compileExpression(std::string_view source, CompiledExpression& out, Blackboard& blackboard) {
+    out = {};
+    out.source = std::string(source);
+    ExpressionCompiler compiler(out.source, out, blackboard);
+    return compiler.compile();
+}
+
+const char* binaryOperatorName(CompiledExpression::Op op) {
+    using Op = CompiledExpression::Op;
+    switch (op) {
+        case Op::Add: return "+";
+        case Op::Subtract: return "-";
+        case Op::Multiply: return "*";
+        case Op::Divide: return "/";
+        case Op::Less: return "<";
+        case Op::LessEqual: return "<=";
+        case Op::Greater: return ">";
+        case Op::GreaterEqual: return ">=";
+        default: return "?";
+    }
+}
+
+// Runs compiled code on stack, which callers keep between evaluations so its
+// storage is reused. Values already on the stack are left as they were, so an
+// evaluation may nest inside another.
+bool evaluateCompiled(
+    const CompiledExpression& expression,
     const InterpreterEvent* event,
-    const ValueMap& blackboard,
+    const Blackboard& blackboard,
     const ValueMap* locals,
+    std::vector<Value>& stack,
+    Value& outValue,
     std::string* outError
 ) {
-    ExpressionParser parser(expression, event, blackboard, locals);
-    return parser.parse(outError);
+    using Op = CompiledExpression::Op;
+
+    if (!expression.valid()) {
+        if (outError != nullptr) {
+            *outError = expression.error.empty() ? std::string("expression is empty") : expression.error;
+        }
+        return false;
+    }
+
+    const size_t base = stack.size();
+    const auto fail = [&](std::string message) {
+        stack.resize(base);
+        if (outError != nullptr) {
+            *outError = std::move(message);
+        }
+        return false;
+    };
+
+    for (const CompiledExpression::Instruction& instruction : expression.code) {
+        switch (instruction.op) {
+            case Op::PushConstant:
+                stack.push_back(expression.constants[instruction.operand]);
+                break;
+
+            case Op::PushVariable: {
+                const Value* value = blackboard.find(BlackboardSlot{instruction.operand});
+                stack.push_back(value != nullptr ? *value : Value(nullptr));
+                break;
+            }
+
+            case Op::PushArgument: {
+                const Value* value = locals != nullptr
+                    ? resolveBlackboardSegments(*locals, expression.paths[instruction.operand])
+                    : nullptr;
+                stack.push_back(value != nullptr ? *value : Value(nullptr));
+                break;
+            }
+
+            case Op::PushEventField: {
+                if (event == nullptr) {
+                    stack.push_back(Value(nullptr));
+                    break;
+                }
+                const auto found = event->fields.find(expression.names[instruction.operand]);
+                stack.push_back(found != event->fields.end() ? parseLiteralValue(found->second) : Value(nullptr));
+                break;
+            }
+
+            case Op::MakeLambda: {
+                // A fresh lambda per evaluation, as lambdas compare by identity
+                const LambdaValue* prototype = expression.constants[instruction.operand].asLambda();
+                stack.push_back(Value(std::make_shared<LambdaValue>(*prototype)));
+                break;
+            }
+
+            case Op::MakeObject: {
+                const std::vector<std::string>& keys = expression.objectKeys[instruction.operand];
+                Value object = Value::makeObject();
+                ObjectValue* fields = object.asObject();
+                const size_t first = stack.size() - keys.size();
+                for (size_t index = 0; index < keys.size(); ++index) {
+                    fields->fields[keys[index]] = std::move(stack[first + index]);
+                }
+                stack.resize(first);
+                stack.push_back(std::move(object));
+                break;
+            }
+
+            case Op::Not:
+                stack.back() = Value(!coerceValueToBool(stack.back()));
+                break;
+
+            case Op::Negate: {
+                const auto number = stack.back().asNumber();
+                if (!number) {
+                    return fail("unary '-' requires a numeric operand");
+                }
+                stack.back() = Value(-*number);
+                break;
+            }
+
+            case Op::Equal:
+            case Op::NotEqual: {
+                const bool equal = valueEquals(stack[stack.size() - 2], stack.back());
+                stack.pop_back();
+                stack.back() = Value(instruction.op == Op::Equal ? equal : !equal);
+                break;
+            }
+
+            case Op::And:
+            case Op::Or: {
+                const bool left = coerceValueToBool(stack[stack.size() - 2]);
+                const bool right = coerceValueToBool(stack.back());
+                stack.pop_back();
+                stack.back() = Value(instruction.op == Op::And ? left && right : left || right);
+                break;
+            }
+
+            case Op::Add:
+            case Op::Subtract:
+            case Op::Multiply:
+            case Op::Divide:
+            case Op::Less:
+            case Op::LessEqual:
+            case Op::Greater:
+            case Op::GreaterEqual: {
+                const auto lhs = stack[stack.size() - 2].asNumber();
+                const auto rhs = stack.back().asNumber();
+                if (!lhs || !rhs) {
+                    return fail(std::format("operator '{}' requires numeric operands", binaryOperatorName(instruction.op)));
+                }
+                if (instruction.op == Op::Divide && *rhs == 0.0) {
+                    return fail("division by zero");
+                }
+
+                Value result;
+                switch (instruction.op) {
+                    case Op::Add: result = Value(*lhs + *rhs); break;
+                    case Op::Subtract: result = Value(*lhs - *rhs); break;
+                    case Op::Multiply: result = Value(*lhs * *rhs); break;
+                    case Op::Divide: result = Value(*lhs / *rhs); break;
+                    case Op::Less: result = Value(*lhs < *rhs); break;
+                    case Op::LessEqual: result = Value(*lhs <= *rhs); break;
+                    case Op::Greater: result = Value(*lhs > *rhs); break;
+                    default: result = Value(*lhs >= *rhs); break;
+                }
+                stack.pop_back();
+                stack.back() = std::move(result);
+                break;
+            }
+        }
+    }
+
+    outValue = std::move(stack[base]);
+    stack.resize(base);
+    return true;
 }
 
-std::optional<std::string> interpolateCommandArgument(
-    std::string_view argument,
-    const InterpreterEvent* event,
-    const ValueMap& blackboard,
+// For sources only known at run time, such as set_blackboard's argument
+std::optional<Value> evaluateExpression(
+    std::string_view source,
+    Blackboard& blackboard,
+    std::vector<Value>& stack,
     std::string* outError
 ) {
-    std::string result;
+    CompiledExpression expression;
+    if (!compileExpression(source, expression, blackboard)) {
+        if (outError != nullptr) {
+            *outError = expression.error;
+        }
+        return std::nullopt;
+    }
+
+    Value value;
+    if (!evaluateCompiled(expression, nullptr, blackboard, nullptr, stack, value, outError)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+bool compileInterpolatedArgument(std::string_view argument, InterpolatedArgument& out, Blackboard& blackboard) {
+    out = {};
+    std::string text;
     size_t cursor = 0;
 
     while (cursor < argument.size()) {
         const size_t exprStart = argument.find("${", cursor);
         if (exprStart == std::string_view::npos) {
-            result.append(argument.substr(cursor));
+            text.append(argument.substr(cursor));
             break;
         }
 
-        result.append(argument.substr(cursor, exprStart - cursor));
+        text.append(argument.substr(cursor, exprStart - cursor));
         const size_t exprBodyStart = exprStart + 2;
         const size_t exprEnd = argument.find('}', exprBodyStart);
         if (exprEnd == std::string_view::npos) {
-            if (outError != nullptr) {
-                *outError = "unterminated '${...}' interpolation";
-            }
-            return std::nullopt;
+            out.error = "unterminated '${...}' interpolation";
+            return false;
         }
 
-        const std::string expression = trimCopy(argument.substr(exprBodyStart, exprEnd - exprBodyStart));
-        if (expression.empty()) {
-            if (outError != nullptr) {
-                *outError = "empty interpolation expression";
-            }
-            return std::nullopt;
+        const std::string source = trimCopy(argument.substr(exprBodyStart, exprEnd - exprBodyStart));
+        if (source.empty()) {
+            out.error = "empty interpolation expression";
+            return false;
+        }
+
+        CompiledExpression expression;
+        if (!compileExpression(source, expression, blackboard)) {
+            out.error = std::format(
+                "failed to compile interpolation expression '{}': {}",
+                source,
+                expression.error
+            );
+            return false;
         }
 
+        out.text.push_back(std::move(text));
+        text.clear();
+        out.expressions.push_back(std::move(expression));
+        cursor = exprEnd + 1;
+    }
+
+    out.text.push_back(std::move(text));
+    return true;
+}
+
+bool interpolateArgument(
+    const InterpolatedArgument& argument,
+    const InterpreterEvent* event,
+    const Blackboard& blackboard,
+    std::vector<Value>& stack,
+    std::string& out,
+    std::string* outError
+) {
+    out = argument.text.front();
+    for (size_t index = 0; index < argument.expressions.size(); ++index) {
+        const CompiledExpression& expression = argument.expressions[index];
+        Value value;
         std::string expressionError;
-        std::optional<Value> value = evaluateExpression(expression, event, blackboard, nullptr, &expressionError);
-        if (!value) {
+        if (!evaluateCompiled(expression, event, blackboard, nullptr, stack, value, &expressionError)) {
             if (outError != nullptr) {
                 *outError = std::format(
                     "failed to evaluate interpolation expression '{}': {}",
-                    expression,
+                    expression.source,
                     expressionError
                 );
             }
-            return std::nullopt;
+            return false;
         }
 
-        result.append(value->toString());
-        cursor = exprEnd + 1;
+        out.append(value.toString());
+        out.append(argument.text[index + 1]);
     }
+    return true;
+}
 
-    return result;
+// Splits on whitespace, keeping each ${...} inside the word it starts in
+bool splitCommandArgumentWords(std::string_view argument, std::vector<std::string_view>& words, std::string* outError) {
+    size_t cursor = 0;
+    while (cursor < argument.size()) {
+        if (std::isspace(static_cast<unsigned char>(argument[cursor])) != 0) {
+            ++cursor;
+            continue;
+        }
+
+        const size_t start = cursor;
+        while (cursor < argument.size() && std::isspace(static_cast<unsigned char>(argument[cursor])) == 0) {
+            if (argument.substr(cursor, 2) == "${") {
+                const size_t end = argument.find('}', cursor + 2);
+                if (end == std::string_view::npos) {
+                    if (outError != nullptr) {
+                        *outError = "unterminated '${...}' interpolation";
+                    }
+                    return false;
+                }
+                cursor = end;
+            }
+            ++cursor;
+        }
+        words.push_back(argument.substr(start, cursor - start));
+    }
+    return true;
+}
+
+std::optional<float> parseFloatArgument(std::string_view text) {
+    try {
+        size_t consumed = 0;
+        const float value = std::stof(std::string(text), &consumed);
+        if (consumed == text.size()) {
+            return value;
+        }
+    } catch (const std::exception&) {
+    }
+    return std::nullopt;
+}
+
+const char* describeCommandArgType(CommandArgType type) {
+    switch (type) {
+        case CommandArgType::Number: return "a number";
+        case CommandArgType::Bool: return "true or false";
+        case CommandArgType::String: return "a string";
+        case CommandArgType::Entity: return "an entity reference";
+    }
+    return "a value";
+}
+
+bool convertCommandArgument(Value& value, CommandArgType type) {
+    switch (type) {
+        case CommandArgType::Number:
+            if (value.asNumber()) {
+                return true;
+            }
+            if (const auto text = value.asStringView()) {
+                // Parsed as float, as the text commands always have
+                if (const std::optional<float> number = parseFloatArgument(*text)) {
+                    value = Value(static_cast<double>(*number));
+                    return true;
+                }
+            }
+            return false;
+
+        case CommandArgType::Bool:
+            if (value.asBool()) {
+                return true;
+            }
+            if (const auto text = value.asStringView(); text && (*text == "true" || *text == "false")) {
+                value = Value(*text == "true");
+                return true;
+            }
+            return false;
+
+        case CommandArgType::String:
+            if (!value.asStringView()) {
+                value = Value(value.toString());
+            }
+            return true;
+
+        case CommandArgType::Entity:
+            if (value.asEntityId()) {
+                return true;
+            }
+            if (const auto number = value.asNumber()) {
+                value = Value(static_cast<flecs::entity_t>(*number));
+                return true;
+            }
+            if (const auto text = value.asStringView()) {
+                // Anything that isn't an id is looked up by name when the command runs
+                if (const std::optional<flecs::entity_t> entityId = parseEntityId(*text)) {
+                    value = Value(*entityId);
+                }
+                return !text->empty();
+            }
+            return false;
+    }
+    return false;
 }
 
 }  // namespace
@@ -1129,32 +1311,173 @@ Value parseLiteralValue(std::string_view text) {
         return Value(nullptr);
     }
 
-    if (iequals(trimmed, "true")) {
-        return Value(true);
+    if (iequals(trimmed, "true")) {
+        return Value(true);
+    }
+
+    if (iequals(trimmed, "false")) {
+        return Value(false);
+    }
+
+    try {
+        size_t consumed = 0;
+        const double number = std::stod(trimmed, &consumed);
+        if (consumed == trimmed.size()) {
+            return Value(number);
+        }
+    } catch (const std::exception&) {
+    }
+
+    if (trimmed.size() >= 2 && trimmed.front() == '"' && trimmed.back() == '"') {
+        return Value(trimmed.substr(1, trimmed.size() - 2));
+    }
+
+    return Value(trimmed);
+}
+
+BlackboardSlot Blackboard::intern(std::string_view path) {
+    const auto found = pathSlots_.find(std::string(path));
+    if (found != pathSlots_.end()) {
+        return {found->second};
+    }
+
+    std::vector<std::string> segments = splitPath(path);
+    if (segments.empty()) {
+        return {};
+    }
+
+    const uint32_t index = static_cast<uint32_t>(paths_.size());
+    paths_.push_back({std::string(path), std::move(segments)});
+    pathSlots_.emplace(std::string(path), index);
+    return {index};
+}
+
+std::string_view Blackboard::path(BlackboardSlot slot) const {
+    return slot.valid() ? std::string_view(paths_[slot.index].text) : std::string_view();
+}
+
+const Value* Blackboard::find(BlackboardSlot slot) const {
+    return slot.valid() ? resolve(paths_[slot.index]) : nullptr;
+}
+
+const Value* Blackboard::find(std::string_view path) const {
+    return resolveBlackboardSegments(values_, splitPath(path));
+}
+
+bool Blackboard::assign(BlackboardSlot slot, Value value, std::string* outError) {
+    if (!slot.valid()) {
+        if (outError != nullptr) {
+            *outError = "assignment target path is empty";
+        }
+        return false;
+    }
+
+    // Overwriting a plain value in place leaves every cached pointer valid
+    const Path& path = paths_[slot.index];
+    if (const Value* current = resolve(path); current != nullptr && current->asObject() == nullptr) {
+        *const_cast<Value*>(current) = std::move(value);
+        return true;
+    }
+
+    return assignSegments(path.segments, std::move(value), outError);
+}
+
+bool Blackboard::assign(std::string_view path, Value value, std::string* outError) {
+    return assignSegments(splitPath(path), std::move(value), outError);
+}
+
+void Blackboard::replace(ValueMap values) {
+    values_ = std::move(values);
+    ++generation_;
+}
+
+const Value* Blackboard::resolve(const Path& path) const {
+    if (path.cachedGeneration == generation_) {
+        return path.cached;
+    }
+
+    const Value* value = resolveBlackboardSegments(values_, path.segments);
+    if (value != nullptr) {
+        path.cached = value;
+        path.cachedGeneration = generation_;
+    }
+    return value;
+}
+
+bool Blackboard::assignSegments(const std::vector<std::string>& segments, Value value, std::string* outError) {
+    if (segments.empty()) {
+        if (outError != nullptr) {
+            *outError = "assignment target path is empty";
+        }
+        return false;
+    }
+
+    // Replacing an object frees everything under it, cached or not
+    const auto store = [this](Value& target, Value value) {
+        if (target.asObject() != nullptr) {
+            ++generation_;
+        }
+        target = std::move(value);
+    };
+
+    if (segments.size() == 1) {
+        store(values_[segments.front()], std::move(value));
+        return true;
     }
 
-    if (iequals(trimmed, "false")) {
-        return Value(false);
+    Value& root = values_[segments.front()];
+    if (root.isNull()) {
+        root = Value::makeObject();
     }
 
-    try {
-        size_t consumed = 0;
-        const double number = std::stod(trimmed, &consumed);
-        if (consumed == trimmed.size()) {
-            return Value(number);
+    Value* current = &root;
+    for (size_t i = 1; i + 1 < segments.size(); ++i) {
+        ObjectValue* object = current->asObject();
+        if (object == nullptr) {
+            if (outError != nullptr) {
+                *outError = std::format(
+                    "path segment '{}' is not an object",
+                    segments[i - 1]
+                );
+            }
+            return false;
         }
-    } catch (const std::exception&) {
+
+        Value& child = object->fields[segments[i]];
+        if (child.isNull()) {
+            child = Value::makeObject();
+        } else if (child.asObject() == nullptr) {
+            if (outError != nullptr) {
+                *outError = std::format(
+                    "path segment '{}' is not an object",
+                    segments[i]
+                );
+            }
+            return false;
+        }
+
+        current = &child;
     }
 
-    if (trimmed.size() >= 2 && trimmed.front() == '"' && trimmed.back() == '"') {
-        return Value(trimmed.substr(1, trimmed.size() - 2));
+    ObjectValue* object = current->asObject();
+    if (object == nullptr) {
+        if (outError != nullptr) {
+            *outError = std::format(
+                "path segment '{}' is not an object",
+                segments[segments.size() - 2]
+            );
+        }
+        return false;
     }
 
-    return Value(trimmed);
+    store(object->fields[segments.back()], std::move(value));
+    return true;
 }
 
 FlecsInterpreterHost::FlecsInterpreterHost(flecs::world& world)
     : world_(world) {
+    evaluationStack_.reserve(64);
+
     registerCommand("set_blackboard", [this](const CommandContext&, std::string_view argument) {
         std::string text = trimCopy(argument);
         const size_t split = text.find(' ');
@@ -1171,7 +1494,7 @@ FlecsInterpreterHost::FlecsInterpreterHost(flecs::world& world)
         }
 
         std::string expressionError;
-        std::optional<Value> value = evaluateExpression(valueText, nullptr, blackboard_, nullptr, &expressionError);
+        std::optional<Value> value = evaluateExpression(valueText, blackboard_, evaluationStack_, &expressionError);
         if (!value) {
             recordError(std::format(
                 "set_blackboard failed to evaluate '{}': {}",
@@ -1182,7 +1505,7 @@ FlecsInterpreterHost::FlecsInterpreterHost(flecs::world& world)
         }
 
         std::string assignmentError;
-        if (!assignBlackboardPath(blackboard_, key, *value, &assignmentError)) {
+        if (!blackboard_.assign(key, *value, &assignmentError)) {
             recordError(std::format(
                 "set_blackboard failed to assign '{}': {}",
                 key,
@@ -1200,7 +1523,7 @@ FlecsInterpreterHost::FlecsInterpreterHost(flecs::world& world)
 
     registerCommand("log_blackboard", [this](const CommandContext&, std::string_view argument) {
         std::string key = trimCopy(argument);
-        const Value* value = resolveBlackboardPath(blackboard_, key);
+        const Value* value = blackboard_.find(key);
         if (value == nullptr) {
             Logger::get().info("Interpreter blackboard '{}' is unset", key);
             return true;
@@ -1263,7 +1586,7 @@ FlecsInterpreterHost::FlecsInterpreterHost(flecs::world& world)
 
         std::string assignmentError;
         const std::string targetPath = stripVarPrefix(args[0]);
-        if (!assignBlackboardPath(blackboard_, targetPath, Value(entity.id()), &assignmentError)) {
+        if (!blackboard_.assign(targetPath, Value(entity.id()), &assignmentError)) {
             recordError(std::format(
                 "ecs_create_entity failed to assign '{}': {}",
                 targetPath,
@@ -1297,7 +1620,7 @@ FlecsInterpreterHost::FlecsInterpreterHost(flecs::world& world)
             : Value(nullptr);
 
         std::string assignmentError;
-        if (!assignBlackboardPath(blackboard_, targetPath, std::move(value), &assignmentError)) {
+        if (!blackboard_.assign(targetPath, std::move(value), &assignmentError)) {
             recordError(std::format(
                 "ecs_find_entity failed to assign '{}': {}",
                 targetPath,
@@ -1409,7 +1732,7 @@ FlecsInterpreterHost::FlecsInterpreterHost(flecs::world& world)
 
         std::string assignmentError;
         const std::string targetPath = stripVarPrefix(args[0]);
-        if (!assignBlackboardPath(blackboard_, targetPath, Value(hasTag), &assignmentError)) {
+        if (!blackboard_.assign(targetPath, Value(hasTag), &assignmentError)) {
             recordError(std::format(
                 "ecs_has_tag failed to assign '{}': {}",
                 targetPath,
@@ -1446,8 +1769,7 @@ FlecsInterpreterHost::FlecsInterpreterHost(flecs::world& world)
 
         std::string assignmentError;
         const std::string targetPath = stripVarPrefix(args[0]);
-        if (!assignBlackboardPath(
-                blackboard_,
+        if (!blackboard_.assign(
                 targetPath,
                 Value(std::format("{}", static_cast<uint64_t>(entity->id()))),
                 &assignmentError
@@ -1643,6 +1965,7 @@ bool FlecsInterpreterHost::loadProgramFromText(std::string_view source, std::str
         if (rule.trigger == ScriptRule::Trigger::OnLoad) {
             rule.pendingOnLoad = true;
         }
+        compileRule(program, rule);
     }
 
     Logger::get().info(
@@ -1652,6 +1975,7 @@ bool FlecsInterpreterHost::loadProgramFromText(std::string_view source, std::str
         program.rules.size()
     );
     programs_.push_back(std::move(program));
+    indexEventRules(programs_.size() - 1);
     return true;
 }
 
@@ -1754,21 +2078,22 @@ void FlecsInterpreterHost::update(float deltaTime) {
         }
     }
 
-    size_t eventIndex = 0;
-    while (eventIndex < queuedEvents_.size()) {
-        const InterpreterEvent event = queuedEvents_[eventIndex++];
-        for (ScriptProgram& program : programs_) {
-            for (ScriptRule& rule : program.rules) {
-                if (rule.trigger != ScriptRule::Trigger::OnEvent || rule.eventName != event.name) {
-                    continue;
-                }
+    // Events emitted by rules while dispatching are handled in a later pass of
+    // this same update, so neither buffer grows while it is being read
+    while (!queuedEvents_.empty()) {
+        dispatchingEvents_.swap(queuedEvents_);
+        for (const InterpreterEvent& event : dispatchingEvents_) {
+            const auto id = eventIds_.find(event.name);
+            if (id == eventIds_.end()) {
+                continue;
+            }
 
-                executeRule(rule, &event);
+            for (const RuleRef& ref : eventRules_[id->second]) {
+                executeRule(programs_[ref.program].rules[ref.rule], &event);
             }
         }
+        dispatchingEvents_.clear();
     }
-
-    queuedEvents_.clear();
 }
 
 void FlecsInterpreterHost::emitEvent(std::string name) {
@@ -1780,7 +2105,25 @@ void FlecsInterpreterHost::emitEvent(InterpreterEvent event) {
 }
 
 void FlecsInterpreterHost::registerCommand(std::string name, CommandCallback callback) {
-    commands_[std::move(name)] = std::move(callback);
+    const bool replacedTyped = typedCommands_.erase(name) > 0;
+    commands_[name] = std::move(callback);
+
+    // Calls compiled for the typed form skipped interpolation; compile them as text now
+    if (replacedTyped) {
+        recompileCommandActions(name);
+    }
+}
+
+void FlecsInterpreterHost::registerTypedCommand(
+    std::string name,
+    CommandSignature signature,
+    TypedCommandCallback callback
+) {
+    commands_.erase(name);
+    typedCommands_[name] = {std::move(signature), std::move(callback)};
+
+    // Programs loaded before the command was registered parse their calls now
+    recompileCommandActions(name);
 }
 
 bool FlecsInterpreterHost::hasBoundHostCallback(std::string_view name) const {
@@ -1793,7 +2136,7 @@ bool FlecsInterpreterHost::bindHostCallback(std::string name, std::string_view b
         return false;
     }
 
-    const Value* value = resolveBlackboardPath(blackboard_, blackboardPath);
+    const Value* value = blackboard_.find(blackboardPath);
     if (value == nullptr) {
         recordError(std::format(
             "Cannot bind host callback '{}': blackboard path '{}' is unset",
@@ -1834,7 +2177,7 @@ std::optional<Value> FlecsInterpreterHost::invokeHostCallback(
         return std::nullopt;
     }
 
-    const Value* value = resolveBlackboardPath(blackboard_, binding->second);
+    const Value* value = blackboard_.find(binding->second);
     if (value == nullptr) {
         if (outError != nullptr) {
             *outError = std::format(
@@ -1857,15 +2200,19 @@ std::optional<Value> FlecsInterpreterHost::invokeHostCallback(
         return std::nullopt;
     }
 
-    ValueMap localValues = arguments;
+    auto compiled = compiledLambdas_.find(lambda->bodySource);
+    if (compiled == compiledLambdas_.end()) {
+        CompiledExpression expression;
+        compileExpression(lambda->bodySource, expression, blackboard_);
+        compiled = compiledLambdas_.emplace(lambda->bodySource, std::move(expression)).first;
+    }
+
+    std::optional<Value> result;
     std::string expressionError;
-    std::optional<Value> result = evaluateExpression(
-        lambda->bodySource,
-        nullptr,
-        blackboard_,
-        &localValues,
-        &expressionError
-    );
+    Value resultValue;
+    if (evaluateCompiled(compiled->second, nullptr, blackboard_, &arguments, evaluationStack_, resultValue, &expressionError)) {
+        result = std::move(resultValue);
+    }
     if (!result) {
         if (outError != nullptr) {
             *outError = std::format(
@@ -1887,7 +2234,7 @@ std::optional<Value> FlecsInterpreterHost::invokeHostCallback(
 
 bool FlecsInterpreterHost::setBlackboardValue(std::string_view path, Value value, std::string* outError) {
     std::string assignmentError;
-    if (!assignBlackboardPath(blackboard_, path, std::move(value), &assignmentError)) {
+    if (!blackboard_.assign(path, std::move(value), &assignmentError)) {
         if (outError != nullptr) {
             *outError = assignmentError;
         }
@@ -1898,7 +2245,24 @@ bool FlecsInterpreterHost::setBlackboardValue(std::string_view path, Value value
 }
 
 std::optional<Value> FlecsInterpreterHost::getBlackboardValue(std::string_view path) const {
-    const Value* value = resolveBlackboardPath(blackboard_, path);
+    const Value* value = blackboard_.find(path);
+    if (value == nullptr) {
+        return std::nullopt;
+    }
+
+    return *value;
+}
+
+BlackboardSlot FlecsInterpreterHost::internBlackboardPath(std::string_view path) {
+    return blackboard_.intern(path);
+}
+
+bool FlecsInterpreterHost::setBlackboardValue(BlackboardSlot slot, Value value, std::string* outError) {
+    return blackboard_.assign(slot, std::move(value), outError);
+}
+
+std::optional<Value> FlecsInterpreterHost::getBlackboardValue(BlackboardSlot slot) const {
+    const Value* value = blackboard_.find(slot);
     if (value == nullptr) {
         return std::nullopt;
     }
@@ -1906,6 +2270,14 @@ std::optional<Value> FlecsInterpreterHost::getBlackboardValue(std::string_view p
     return *value;
 }
 
+const ValueMap& FlecsInterpreterHost::getBlackboard() const {
+    return blackboard_.values();
+}
+
+void FlecsInterpreterHost::replaceBlackboard(ValueMap blackboard) {
+    blackboard_.replace(std::move(blackboard));
+}
+
 bool FlecsInterpreterHost::hasErrors() const {
     return !errors_.empty();
 }
@@ -1930,21 +2302,272 @@ const std::vector<std::string>& FlecsInterpreterHost::getErrors() const {
     return errors_;
 }
 
+void FlecsInterpreterHost::compileRule(const ScriptProgram& program, ScriptRule& rule) {
+    if (!rule.conditionExpression.empty() && !compileExpression(rule.conditionExpression, rule.condition, blackboard_)) {
+        recordError(std::format(
+            "{}: rule '{}' condition '{}' failed to compile: {}",
+            program.origin,
+            rule.name,
+            rule.conditionExpression,
+            rule.condition.error
+        ));
+    }
+
+    for (ScriptAction& action : rule.actions) {
+        if (action.type == ScriptAction::Type::SetBlackboard) {
+            action.target = blackboard_.intern(action.verb);
+            if (!compileExpression(action.argument, action.expression, blackboard_)) {
+                recordError(std::format(
+                    "{}: rule '{}' set expression for '{}' failed to compile: {}",
+                    program.origin,
+                    rule.name,
+                    action.verb,
+                    action.expression.error
+                ));
+            }
+        } else if (action.type == ScriptAction::Type::Command && typedCommands_.contains(action.verb)) {
+            compileCommandArguments(program, rule, action);
+        } else if (action.type == ScriptAction::Type::Command) {
+            compileCommandText(program, rule, action);
+        }
+    }
+}
+
+bool FlecsInterpreterHost::compileCommandText(
+    const ScriptProgram& program,
+    const ScriptRule& rule,
+    ScriptAction& action
+) {
+    action.typedArguments.clear();
+    action.typedArgumentsInvalid = false;
+    action.interpolated = {};
+    if (action.argument.find("${") == std::string::npos) {
+        return true;
+    }
+
+    if (!compileInterpolatedArgument(action.argument, action.interpolated, blackboard_)) {
+        recordError(std::format(
+            "{}: rule '{}' argument for '{}' failed to compile: {}",
+            program.origin,
+            rule.name,
+            action.verb,
+            action.interpolated.error
+        ));
+        return false;
+    }
+    return true;
+}
+
+void FlecsInterpreterHost::recompileCommandActions(std::string_view verb) {
+    // Programs loaded earlier compiled their calls for the previous form of the command
+    const bool typed = typedCommands_.contains(std::string(verb));
+    for (ScriptProgram& program : programs_) {
+        for (ScriptRule& rule : program.rules) {
+            for (ScriptAction& action : rule.actions) {
+                if (action.type != ScriptAction::Type::Command || action.verb != verb) {
+                    continue;
+                }
+                if (typed) {
+                    compileCommandArguments(program, rule, action);
+                } else {
+                    compileCommandText(program, rule, action);
+                }
+            }
+        }
+    }
+}
+
+void FlecsInterpreterHost::indexEventRules(size_t programIndex) {
+    std::vector<ScriptRule>& rules = programs_[programIndex].rules;
+    for (size_t ruleIndex = 0; ruleIndex < rules.size(); ++ruleIndex) {
+        ScriptRule& rule = rules[ruleIndex];
+        if (rule.trigger != ScriptRule::Trigger::OnEvent) {
+            continue;
+        }
+
+        const auto [id, inserted] = eventIds_.try_emplace(rule.eventName, static_cast<uint32_t>(eventRules_.size()));
+        if (inserted) {
+            eventRules_.emplace_back();
+        }
+        rule.eventId = id->second;
+        eventRules_[rule.eventId].push_back({
+            static_cast<uint32_t>(programIndex),
+            static_cast<uint32_t>(ruleIndex),
+        });
+    }
+}
+
+bool FlecsInterpreterHost::compileCommandArguments(
+    const ScriptProgram& program,
+    const ScriptRule& rule,
+    ScriptAction& action
+) {
+    const CommandSignature& signature = typedCommands_.at(action.verb).signature;
+    action.typedArguments.clear();
+    action.typedArgumentsInvalid = true;
+
+    const auto fail = [&](std::string message) {
+        recordError(std::format(
+            "{}: rule '{}' command '{}' {}",
+            program.origin,
+            rule.name,
+            action.verb,
+            message
+        ));
+        return false;
+    };
+
+    std::vector<std::string_view> words;
+    std::string splitError;
+    if (!splitCommandArgumentWords(action.argument, words, &splitError)) {
+        return fail(std::format("failed to compile: {}", splitError));
+    }
+    if (words.size() < signature.requiredCount || words.size() > signature.parameters.size()) {
+        return fail(std::format("expects '{}', got '{}'", signature.usage, action.argument));
+    }
+
+    action.typedArguments.reserve(words.size());
+    for (size_t index = 0; index < words.size(); ++index) {
+        const std::string_view word = words[index];
+        const CommandArgType type = signature.parameters[index];
+        CommandArgument& argument = action.typedArguments.emplace_back();
+
+        if (startsWith(word, "${") && word.find('}') == word.size() - 1) {
+            argument.kind = CommandArgument::Kind::Expression;
+            if (!compileExpression(trimCopy(word.substr(2, word.size() - 3)), argument.expression, blackboard_)) {
+                return fail(std::format(
+                    "argument {} '{}' failed to compile: {}",
+                    index + 1,
+                    word,
+                    argument.expression.error
+                ));
+            }
+            continue;
+        }
+
+        if (word.find("${") != std::string_view::npos) {
+            argument.kind = CommandArgument::Kind::Interpolated;
+            if (!compileInterpolatedArgument(word, argument.interpolated, blackboard_)) {
+                return fail(std::format(
+                    "argument {} '{}' failed to compile: {}",
+                    index + 1,
+                    word,
+                    argument.interpolated.error
+                ));
+            }
+            continue;
+        }
+
+        if (type == CommandArgType::Entity && startsWith(word, "var.")) {
+            argument.kind = CommandArgument::Kind::Variable;
+            argument.variable = blackboard_.intern(word.substr(4));
+            continue;
+        }
+
+        argument.constant = Value(std::string(word));
+        if (!convertCommandArgument(argument.constant, type)) {
+            return fail(std::format(
+                "argument {} '{}' is not {}",
+                index + 1,
+                word,
+                describeCommandArgType(type)
+            ));
+        }
+    }
+
+    action.typedArgumentsInvalid = false;
+    return true;
+}
+
+bool FlecsInterpreterHost::executeTypedCommand(
+    const ScriptAction& action,
+    const TypedCommand& command,
+    const InterpreterEvent* event
+) {
+    if (action.typedArgumentsInvalid) {
+        return false;
+    }
+
+    // Commands never run rules synchronously, so one buffer serves every call
+    commandArguments_.clear();
+    for (size_t index = 0; index < action.typedArguments.size(); ++index) {
+        const CommandArgument& argument = action.typedArguments[index];
+        Value& value = commandArguments_.emplace_back();
+        std::string error;
+
+        switch (argument.kind) {
+            case CommandArgument::Kind::Constant:
+                value = argument.constant;
+                continue;
+
+            case CommandArgument::Kind::Variable:
+                if (const Value* variable = blackboard_.find(argument.variable)) {
+                    value = *variable;
+                }
+                break;
+
+            case CommandArgument::Kind::Expression:
+                if (!evaluateCompiled(argument.expression, event, blackboard_, nullptr, evaluationStack_, value, &error)) {
+                    recordError(std::format(
+                        "Failed to interpolate command argument for '{}': failed to evaluate interpolation expression '{}': {}",
+                        action.verb,
+                        argument.expression.source,
+                        error
+                    ));
+                    return false;
+                }
+                break;
+
+            case CommandArgument::Kind::Interpolated: {
+                std::string text;
+                if (!interpolateArgument(argument.interpolated, event, blackboard_, evaluationStack_, text, &error)) {
+                    recordError(std::format(
+                        "Failed to interpolate command argument for '{}': {}",
+                        action.verb,
+                        error
+                    ));
+                    return false;
+                }
+                value = Value(std::move(text));
+                break;
+            }
+        }
+
+        const CommandArgType type = command.signature.parameters[index];
+        if (!convertCommandArgument(value, type)) {
+            recordError(std::format(
+                "Command '{}' argument {} expects {}, got {}",
+                action.verb,
+                index + 1,
+                describeCommandArgType(type),
+                value.debugString()
+            ));
+            return false;
+        }
+    }
+
+    CommandContext context{
+        .world = world_,
+        .event = event,
+        .blackboard = blackboard_,
+    };
+    return command.callback(context, std::span<const Value>(commandArguments_));
+}
+
 bool FlecsInterpreterHost::executeRule(ScriptRule& rule, const InterpreterEvent* event) {
     if (rule.cooldownRemainingSeconds > 0.0f) {
         return false;
     }
 
     if (!rule.conditionExpression.empty()) {
+        // A condition that failed to compile was reported at load and never passes
+        if (!rule.condition.valid()) {
+            return false;
+        }
+
         std::string conditionError;
-        std::optional<Value> conditionValue = evaluateExpression(
-            rule.conditionExpression,
-            event,
-            blackboard_,
-            nullptr,
-            &conditionError
-        );
-        if (!conditionValue) {
+        Value conditionValue;
+        if (!evaluateCompiled(rule.condition, event, blackboard_, nullptr, evaluationStack_, conditionValue, &conditionError)) {
             recordError(std::format(
                 "Rule '{}' condition failed to evaluate: {}",
                 rule.name,
@@ -1953,7 +2576,7 @@ bool FlecsInterpreterHost::executeRule(ScriptRule& rule, const InterpreterEvent*
             return false;
         }
 
-        if (!coerceValueToBool(*conditionValue)) {
+        if (!coerceValueToBool(conditionValue)) {
             return false;
         }
     }
@@ -1981,52 +2604,55 @@ bool FlecsInterpreterHost::executeAction(const ScriptAction& action, const Inter
             return true;
 
         case ScriptAction::Type::Command: {
+            if (const auto typed = typedCommands_.find(action.verb); typed != typedCommands_.end()) {
+                return executeTypedCommand(action, typed->second, event);
+            }
+
             const auto found = commands_.find(action.verb);
             if (found == commands_.end()) {
                 recordError(std::format("Unknown interpreter command '{}'", action.verb));
                 return false;
             }
 
-            std::string interpolatedArgument;
-            std::string interpolationError;
-            if (action.argument.find("${") != std::string::npos) {
-                std::optional<std::string> resolvedArgument = interpolateCommandArgument(
-                    action.argument,
-                    event,
-                    blackboard_,
-                    &interpolationError
-                );
-                if (!resolvedArgument) {
-                    recordError(std::format(
-                        "Failed to interpolate command argument for '{}': {}",
-                        action.verb,
-                        interpolationError
-                    ));
-                    return false;
-                }
-                interpolatedArgument = std::move(*resolvedArgument);
-            } else {
-                interpolatedArgument = action.argument;
-            }
-
             CommandContext context{
                 .world = world_,
                 .event = event,
                 .blackboard = blackboard_,
             };
+            if (!action.interpolated.error.empty()) {
+                return false;
+            }
+            if (action.interpolated.expressions.empty()) {
+                return found->second(context, action.argument);
+            }
+
+            std::string interpolatedArgument;
+            std::string interpolationError;
+            if (!interpolateArgument(
+                    action.interpolated,
+                    event,
+                    blackboard_,
+                    evaluationStack_,
+                    interpolatedArgument,
+                    &interpolationError)) {
+                recordError(std::format(
+                    "Failed to interpolate command argument for '{}': {}",
+                    action.verb,
+                    interpolationError
+                ));
+                return false;
+            }
             return found->second(context, interpolatedArgument);
         }
 
         case ScriptAction::Type::SetBlackboard: {
+            if (!action.expression.valid()) {
+                return false;
+            }
+
             std::string expressionError;
-            std::optional<Value> value = evaluateExpression(
-                action.argument,
-                event,
-                blackboard_,
-                nullptr,
-                &expressionError
-            );
-            if (!value) {
+            Value value;
+            if (!evaluateCompiled(action.expression, event, blackboard_, nullptr, evaluationStack_, value, &expressionError)) {
                 recordError(std::format(
                     "Failed to evaluate set expression for '{}': {}",
                     action.verb,
@@ -2036,7 +2662,7 @@ bool FlecsInterpreterHost::executeAction(const ScriptAction& action, const Inter
             }
 
             std::string assignmentError;
-            if (!assignBlackboardPath(blackboard_, action.verb, *value, &assignmentError)) {
+            if (!blackboard_.assign(action.target, value, &assignmentError)) {
                 recordError(std::format(
                     "Failed to assign blackboard path '{}': {}",
                     action.verb,
@@ -2048,7 +2674,7 @@ bool FlecsInterpreterHost::executeAction(const ScriptAction& action, const Inter
             Logger::get().info(
                 "Interpreter blackboard '{}' set to {}",
                 action.verb,
-                value->debugString()
+                value.debugString()
             );
             return true;
         }
@@ -2062,4 +2688,47 @@ void FlecsInterpreterHost::recordError(std::string message) {
     errors_.push_back(std::move(message));
 }
 
+std::optional<flecs::entity> resolveEntityArgument(
+    flecs::world& world,
+    const Value& argument,
+    std::string* outError
+) {
+    std::optional<flecs::entity_t> entityId = argument.asEntityId();
+    if (!entityId) {
+        if (const auto number = argument.asNumber()) {
+            entityId = static_cast<flecs::entity_t>(*number);
+        }
+    }
+
+    if (const auto text = argument.asStringView(); !entityId && text) {
+        entityId = parseEntityId(*text);
+        if (!entityId) {
+            flecs::entity named = world.lookup(std::string(*text).c_str());
+            if (!named || !named.is_alive()) {
+                if (outError != nullptr) {
+                    *outError = std::format("entity '{}' was not found", *text);
+                }
+                return std::nullopt;
+            }
+            return named;
+        }
+    }
+
+    if (!entityId) {
+        if (outError != nullptr) {
+            *outError = std::format("{} is not an entity reference", argument.debugString());
+        }
+        return std::nullopt;
+    }
+
+    flecs::entity entity(world, *entityId);
+    if (!entity.is_alive()) {
+        if (outError != nullptr) {
+            *outError = std::format("entity #{} is not alive", static_cast<uint64_t>(*entityId));
+        }
+        return std::nullopt;
+    }
+    return entity;
+}
+
 }  // namespace tremor::script
@@ -8,6 +8,7 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -76,6 +77,103 @@ struct LambdaValue {
     std::string bodySource;
 };
 
+using ValueMap = std::unordered_map<std::string, Value>;
+
+// Handle to an interned blackboard path
+struct BlackboardSlot {
+    uint32_t index = UINT32_MAX;
+
+    bool valid() const { return index != UINT32_MAX; }
+};
+
+// An expression parsed once, at load time, into postfix code for a small stack
+// machine. Evaluation walks the code against the blackboard without touching
+// the source text again. Variable reads refer to slots of the blackboard the
+// expression was compiled against.
+struct CompiledExpression {
+    enum class Op : uint8_t {
+        PushConstant,   // constants[operand]
+        PushVariable,   // Value of blackboard slot operand, null when unset
+        PushArgument,   // Lambda argument at paths[operand], null when unset
+        PushEventField, // Field names[operand] of the current event, null when absent
+        MakeLambda,     // A new lambda copied from constants[operand]
+        MakeObject,     // Object from the top objectKeys[operand].size() values
+        Not,
+        Negate,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        And,
+        Or,
+    };
+
+    struct Instruction {
+        Op op = Op::PushConstant;
+        uint32_t operand = 0;
+    };
+
+    std::string source;
+    std::vector<Instruction> code;
+    std::vector<Value> constants;
+    std::vector<std::vector<std::string>> paths;
+    std::vector<std::string> names;
+    std::vector<std::vector<std::string>> objectKeys;
+    // Set when the source failed to compile; such an expression never evaluates
+    std::string error;
+
+    bool valid() const { return error.empty() && !code.empty(); }
+};
+
+// A command argument split around its ${...} expressions:
+// text[0] expressions[0] text[1] ... expressions[n - 1] text[n]
+struct InterpolatedArgument {
+    std::vector<std::string> text;
+    std::vector<CompiledExpression> expressions;
+    // Set when the argument failed to compile
+    std::string error;
+};
+
+// Parameter types of a typed command. Arguments are converted to the declared
+// type before the command runs, so callbacks can read them without checking.
+enum class CommandArgType : uint8_t {
+    Number,
+    Bool,
+    String,
+    // An entity value, a numeric id, "#id" or an entity name; see resolveEntityArgument
+    Entity,
+};
+
+struct CommandSignature {
+    std::vector<CommandArgType> parameters;
+    // Parameters past this count may be left out
+    size_t requiredCount = 0;
+    // Reported when a call doesn't match, e.g. "<entity_ref> x y z"
+    std::string usage;
+};
+
+// One whitespace-separated word of a typed command's argument, parsed at load
+struct CommandArgument {
+    enum class Kind : uint8_t {
+        Constant,      // A literal, already converted to the parameter type
+        Variable,      // A var.* entity reference
+        Expression,    // A whole-word ${...}
+        Interpolated,  // Text with ${...} inside; evaluated to a string
+    };
+
+    Kind kind = Kind::Constant;
+    Value constant;
+    BlackboardSlot variable;
+    CompiledExpression expression;
+    InterpolatedArgument interpolated;
+};
+
 struct InterpreterEvent {
     std::string name;
     std::unordered_map<std::string, std::string> fields;
@@ -92,6 +190,16 @@ struct ScriptAction {
     Type type = Type::Log;
     std::string verb;
     std::string argument;
+    // Compiled from argument at load time: the value of a SetBlackboard action,
+    // the interpolated argument of a Command
+    CompiledExpression expression;
+    InterpolatedArgument interpolated;
+    // Interned verb of a SetBlackboard action
+    BlackboardSlot target;
+    // Arguments of a typed command, one per word
+    std::vector<CommandArgument> typedArguments;
+    // Set when the arguments failed to parse; the action never runs
+    bool typedArgumentsInvalid = false;
 };
 
 struct ScriptRule {
@@ -104,12 +212,15 @@ struct ScriptRule {
     std::string name;
     Trigger trigger = Trigger::OnLoad;
     std::string eventName;
+    // Interned eventName, assigned when the program is added to a host
+    uint32_t eventId = UINT32_MAX;
     float tickIntervalSeconds = 0.0f;
     float cooldownSeconds = 0.0f;
     float tickAccumulatorSeconds = 0.0f;
     float cooldownRemainingSeconds = 0.0f;
     bool pendingOnLoad = false;
     std::string conditionExpression;
+    CompiledExpression condition;
     std::vector<ScriptAction> actions;
 };
 
@@ -119,17 +230,56 @@ struct ScriptProgram {
     std::vector<ScriptRule> rules;
 };
 
+// Script variables, addressed by dotted path ("wave_state.current_wave"). Paths
+// interned once resolve through a slot table: each slot keeps its split path and
+// a pointer to the value it last resolved to, so repeated reads and writes of a
+// slot skip the path splitting and the per-segment map lookups. Slots are never
+// released. The cached pointers are dropped whenever an object that could
+// contain them is overwritten or the whole blackboard is replaced.
+class Blackboard {
+public:
+    // Invalid for an empty path
+    BlackboardSlot intern(std::string_view path);
+    std::string_view path(BlackboardSlot slot) const;
+
+    const Value* find(BlackboardSlot slot) const;
+    // Looks the path up without interning it
+    const Value* find(std::string_view path) const;
+    // Creates missing intermediate objects along the path
+    bool assign(BlackboardSlot slot, Value value, std::string* outError = nullptr);
+    bool assign(std::string_view path, Value value, std::string* outError = nullptr);
+
+    const ValueMap& values() const { return values_; }
+    void replace(ValueMap values);
+
+private:
+    struct Path {
+        std::string text;
+        std::vector<std::string> segments;
+        // Only hits are cached; a miss walks the path again next time
+        mutable const Value* cached = nullptr;
+        mutable uint64_t cachedGeneration = 0;
+    };
+
+    const Value* resolve(const Path& path) const;
+    bool assignSegments(const std::vector<std::string>& segments, Value value, std::string* outError);
+
+    ValueMap values_;
+    std::vector<Path> paths_;
+    std::unordered_map<std::string, uint32_t> pathSlots_;
+    uint64_t generation_ = 1;
+};
+
 struct CommandContext {
     flecs::world& world;
     const InterpreterEvent* event = nullptr;
-    std::unordered_map<std::string, Value>& blackboard;
+    Blackboard& blackboard;
 };
 
-using ValueMap = std::unordered_map<std::string, Value>;
-
 class FlecsInterpreterHost {
 public:
     using CommandCallback = std::function<bool(const CommandContext&, std::string_view argument)>;
+    using TypedCommandCallback = std::function<bool(const CommandContext&, std::span<const Value> arguments)>;
 
     explicit FlecsInterpreterHost(flecs::world& world);
 
@@ -142,6 +292,10 @@ public:
     void emitEvent(InterpreterEvent event);
 
     void registerCommand(std::string name, CommandCallback callback);
+    // Arguments are split and parsed when a program loads rather than on every
+    // call; literals, ${...} results and var.* entity references reach the
+    // callback as values without a round trip through text
+    void registerTypedCommand(std::string name, CommandSignature signature, TypedCommandCallback callback);
     bool hasBoundHostCallback(std::string_view name) const;
     bool bindHostCallback(std::string name, std::string_view blackboardPath);
     std::optional<Value> invokeHostCallback(
@@ -151,6 +305,13 @@ public:
     );
     bool setBlackboardValue(std::string_view path, Value value, std::string* outError = nullptr);
     std::optional<Value> getBlackboardValue(std::string_view path) const;
+    // For host code that touches the same paths every frame
+    BlackboardSlot internBlackboardPath(std::string_view path);
+    bool setBlackboardValue(BlackboardSlot slot, Value value, std::string* outError = nullptr);
+    std::optional<Value> getBlackboardValue(BlackboardSlot slot) const;
+    // The whole blackboard, for snapshots and rollback
+    const ValueMap& getBlackboard() const;
+    void replaceBlackboard(ValueMap blackboard);
 
     bool hasErrors() const;
     bool hasPrograms() const;
@@ -161,17 +322,53 @@ public:
     const std::vector<std::string>& getErrors() const;
 
 private:
+    struct TypedCommand {
+        CommandSignature signature;
+        TypedCommandCallback callback;
+    };
+
     bool executeRule(ScriptRule& rule, const InterpreterEvent* event);
     bool executeAction(const ScriptAction& action, const InterpreterEvent* event);
+    void compileRule(const ScriptProgram& program, ScriptRule& rule);
+    void indexEventRules(size_t programIndex);
+    bool compileCommandArguments(const ScriptProgram& program, const ScriptRule& rule, ScriptAction& action);
+    bool compileCommandText(const ScriptProgram& program, const ScriptRule& rule, ScriptAction& action);
+    void recompileCommandActions(std::string_view verb);
+    bool executeTypedCommand(const ScriptAction& action, const TypedCommand& command, const InterpreterEvent* event);
     void recordError(std::string message);
 
+    // A rule by position, as programs_ may reallocate while loading
+    struct RuleRef {
+        uint32_t program = 0;
+        uint32_t rule = 0;
+    };
+
     flecs::world& world_;
     std::vector<ScriptProgram> programs_;
     std::vector<std::string> errors_;
     std::vector<InterpreterEvent> queuedEvents_;
-    ValueMap blackboard_;
+    // Events being dispatched; anything emitted meanwhile goes to queuedEvents_
+    std::vector<InterpreterEvent> dispatchingEvents_;
+    std::unordered_map<std::string, uint32_t> eventIds_;
+    // Rules subscribed to each event ID, in program then rule order
+    std::vector<std::vector<RuleRef>> eventRules_;
+    Blackboard blackboard_;
     std::unordered_map<std::string, std::string> hostCallbackBindings_;
     std::unordered_map<std::string, CommandCallback> commands_;
+    std::unordered_map<std::string, TypedCommand> typedCommands_;
+    // Converted arguments of the typed command being run
+    std::vector<Value> commandArguments_;
+    // Lambda bodies compiled on first invocation, by source
+    std::unordered_map<std::string, CompiledExpression> compiledLambdas_;
+    // Operand stack shared by every evaluation; kept so evaluating doesn't allocate
+    std::vector<Value> evaluationStack_;
 };
 
+// Resolves an Entity argument of a typed command to a live entity
+std::optional<flecs::entity> resolveEntityArgument(
+    flecs::world& world,
+    const Value& argument,
+    std::string* outError = nullptr
+);
+
 }  // namespace tremor::script
@@ -3,8 +3,15 @@
 #include "logger.h"
 
 #include <Jolt/Core/Memory.h>
+#include <Jolt/Physics/Body/BodyFilter.h>
+#include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/CollideShape.h>
+#include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+#include <Jolt/Physics/Collision/RayCast.h>
+#include <Jolt/Physics/Collision/ShapeCast.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
 
 #include <algorithm>
 #include <thread>
@@ -12,6 +19,120 @@
 
 namespace tremor::physics {
 
+namespace {
+
+class QueryBroadPhaseLayerFilter final : public JPH::BroadPhaseLayerFilter {
+public:
+    QueryBroadPhaseLayerFilter(const PhysicsLayerConfig& config, const PhysicsQueryFilter& filter) {
+        // Skip whole broad phase trees that hold no layer the query accepts
+        for (PhysicsObjectLayer layer = 0; layer < config.layers.size(); ++layer) {
+            const PhysicsObjectLayer broadPhase = config.layers[layer].broadPhase;
+            if (broadPhase < 64 && filter.acceptsLayer(config, layer)) {
+                broadPhaseMask_ |= uint64_t{1} << broadPhase;
+            }
+        }
+    }
+
+    bool ShouldCollide(JPH::BroadPhaseLayer layer) const override {
+        const auto index = static_cast<uint32_t>(layer.GetValue());
+        return index < 64 && (broadPhaseMask_ & (uint64_t{1} << index)) != 0;
+    }
+
+private:
+    uint64_t broadPhaseMask_ = 0;
+};
+
+class QueryObjectLayerFilter final : public JPH::ObjectLayerFilter {
+public:
+    QueryObjectLayerFilter(const PhysicsLayerConfig& config, const PhysicsQueryFilter& filter)
+        : config_(config), filter_(filter) {
+    }
+
+    bool ShouldCollide(JPH::ObjectLayer layer) const override {
+        return filter_.acceptsLayer(config_, static_cast<PhysicsObjectLayer>(layer));
+    }
+
+private:
+    const PhysicsLayerConfig& config_;
+    const PhysicsQueryFilter& filter_;
+};
+
+// Query shapes live on the stack for the duration of one query
+template <typename Fn>
+bool withQueryShape(const PhysicsQueryShape& shape, Fn&& fn) {
+    switch (shape.type) {
+        case PhysicsQueryShapeType::Box: {
+            const JPH::Vec3 halfExtents(shape.halfExtents.x, shape.halfExtents.y, shape.halfExtents.z);
+            const float smallest = halfExtents.ReduceMin();
+            if (!(smallest > 0.0f)) {
+                return false;
+            }
+            JPH::BoxShape box(halfExtents, std::min(JPH::cDefaultConvexRadius, smallest));
+            box.SetEmbedded();
+            fn(static_cast<const JPH::Shape&>(box));
+            return true;
+        }
+        case PhysicsQueryShapeType::Capsule:
+            if (shape.halfHeight > 0.0f && shape.radius > 0.0f) {
+                JPH::CapsuleShape capsule(shape.halfHeight, shape.radius);
+                capsule.SetEmbedded();
+                fn(static_cast<const JPH::Shape&>(capsule));
+                return true;
+            }
+            [[fallthrough]];
+        case PhysicsQueryShapeType::Sphere:
+        default: {
+            if (!(shape.radius > 0.0f)) {
+                return false;
+            }
+            JPH::SphereShape sphere(shape.radius);
+            sphere.SetEmbedded();
+            fn(static_cast<const JPH::Shape&>(sphere));
+            return true;
+        }
+    }
+}
+
+} // namespace
+
+struct JoltPhysicsWorld::QueryFilters {
+    QueryFilters(const PhysicsLayerConfig& config, const PhysicsQueryFilter& filter)
+        : broadPhase(config, filter),
+          objectLayer(config, filter),
+          body(toBodyId(filter.ignoreBody)) {
+    }
+
+    QueryBroadPhaseLayerFilter broadPhase;
+    QueryObjectLayerFilter objectLayer;
+    JPH::IgnoreSingleBodyFilter body;
+};
+
+// Writes each overlapped body once into a caller-owned buffer
+class JoltPhysicsWorld::OverlapCollector final : public JPH::CollideShapeCollector {
+public:
+    explicit OverlapCollector(std::span<PhysicsBodyHandle> bodies)
+        : bodies_(bodies) {
+    }
+
+    void AddHit(const JPH::CollideShapeResult& result) override {
+        const PhysicsBodyHandle body = toHandle(result.mBodyID2);
+        const auto written = bodies_.first(count_);
+        if (std::find(written.begin(), written.end(), body) != written.end()) {
+            return;
+        }
+        bodies_[count_++] = body;
+        if (count_ == bodies_.size()) {
+            ForceEarlyOut();
+        }
+    }
+
+    [[nodiscard]] size_t count() const { return count_; }
+
+private:
+    std::span<PhysicsBodyHandle> bodies_;
+    size_t count_ = 0;
+};
+
 ConfigurableBroadPhaseLayerInterface::ConfigurableBroadPhaseLayerInterface(const PhysicsLayerConfig& config) {
     objectToBroadPhase_.resize(config.layers.size(), JPH::BroadPhaseLayer(0));
     broadPhaseNames_.resize(config.layers.size());
@@ -71,33 +192,39 @@ bool ConfigurableObjectLayerPairFilter::ShouldCollide(JPH::ObjectLayer left, JPH
     return left < collisions_.size() && right < collisions_[left].size() && collisions_[left][right];
 }
 
-LoggingContactListener::LoggingContactListener(JoltPhysicsWorld& owner)
+ContactEventListener::ContactEventListener(JoltPhysicsWorld& owner)
     : owner_(owner) {
 }
 
-void LoggingContactListener::OnContactAdded(
+void ContactEventListener::OnContactAdded(
     const JPH::Body& left,
     const JPH::Body& right,
     const JPH::ContactManifold&,
     JPH::ContactSettings&
 ) {
-    Logger::get().debug(
-        "Physics contact added between bodies {} and {}",
-        left.GetID().GetIndex(),
-        right.GetID().GetIndex()
-    );
+    // Runs on Jolt's worker threads; the event goes to this thread's contact buffer
     owner_.emitContactEvent({
         JoltPhysicsWorld::toHandle(left.GetID()),
         JoltPhysicsWorld::toHandle(right.GetID()),
-        PhysicsContactPhase::Added
+        PhysicsContactPhase::Added,
+        static_cast<PhysicsObjectLayer>(left.GetObjectLayer()),
+        static_cast<PhysicsObjectLayer>(right.GetObjectLayer())
     });
 }
 
-void LoggingContactListener::OnContactRemoved(const JPH::SubShapeIDPair& pair) {
+void ContactEventListener::OnContactRemoved(const JPH::SubShapeIDPair& pair) {
+    // Only IDs are given here and either body may already be gone
+    const JPH::BodyInterface& bodies = owner_.physicsSystem_->GetBodyInterfaceNoLock();
+    const auto layerOf = [&bodies](const JPH::BodyID& id) {
+        const JPH::ObjectLayer layer = bodies.GetObjectLayer(id);
+        return layer == JPH::cObjectLayerInvalid ? PhysicsContactEvent::UnknownLayer : static_cast<PhysicsObjectLayer>(layer);
+    };
     owner_.emitContactEvent({
         JoltPhysicsWorld::toHandle(pair.GetBody1ID()),
         JoltPhysicsWorld::toHandle(pair.GetBody2ID()),
-        PhysicsContactPhase::Removed
+        PhysicsContactPhase::Removed,
+        layerOf(pair.GetBody1ID()),
+        layerOf(pair.GetBody2ID())
     });
 }
 
@@ -144,7 +271,7 @@ bool JoltPhysicsWorld::initialize() {
         *objectLayerPairFilter_
     );
 
-    contactListener_ = std::make_unique<LoggingContactListener>(*this);
+    contactListener_ = std::make_unique<ContactEventListener>(*this);
     physicsSystem_->SetContactListener(contactListener_.get());
     physicsSystem_->SetGravity(toJoltVector(settings_.gravity));
 
@@ -162,11 +289,19 @@ void JoltPhysicsWorld::shutdown() {
         JPH::BodyIDVector bodies;
         physicsSystem_->GetBodies(bodies);
         for (JPH::BodyID bodyId : bodies) {
-            bodyInterface.RemoveBody(bodyId);
+            // Parked pool bodies exist but were never added back
+            if (bodyInterface.IsAdded(bodyId)) {
+                bodyInterface.RemoveBody(bodyId);
+            }
             bodyInterface.DestroyBody(bodyId);
         }
         Logger::get().info("Jolt physics world shut down");
     }
+    clearInterpolatedBodies();
+    bodyPools_.clear();
+    poolableBodies_.clear();
+    pooledBodyCount_ = 0;
+    shapeCache_.clear();
 
     physicsSystem_.reset();
     contactListener_.reset();
@@ -190,38 +325,7 @@ PhysicsBodyHandle JoltPhysicsWorld::createDynamicCapsule(
     float height,
     PhysicsObjectLayer layer
 ) {
-    JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterface();
-    JPH::RefConst<JPH::Shape> shape = new JPH::CapsuleShape(
-        static_cast<JPH::Real>(height * 0.5f),
-        static_cast<JPH::Real>(radius)
-    );
-
-    JPH::BodyCreationSettings bodySettings(
-        shape.GetPtr(),
-        toJoltPosition(position),
-        JPH::Quat::sIdentity(),
-        JPH::EMotionType::Dynamic,
-        static_cast<JPH::ObjectLayer>(layer)
-    );
-    bodySettings.mFriction = static_cast<JPH::Real>(0.5f);
-    bodySettings.mRestitution = static_cast<JPH::Real>(0.0f);
-    bodySettings.mLinearDamping = static_cast<JPH::Real>(0.0001f);
-    bodySettings.mAngularDamping = static_cast<JPH::Real>(0.05f);
-    bodySettings.mGravityFactor = static_cast<JPH::Real>(1.0f);
-    bodySettings.mAllowedDOFs =
-        JPH::EAllowedDOFs::TranslationX |
-        JPH::EAllowedDOFs::TranslationY |
-        JPH::EAllowedDOFs::TranslationZ |
-        JPH::EAllowedDOFs::RotationY;
-
-    JPH::Body* body = bodyInterface.CreateBody(bodySettings);
-    if (!body) {
-        Logger::get().error("Failed to create dynamic capsule body");
-        return {};
-    }
-
-    bodyInterface.AddBody(body->GetID(), JPH::EActivation::Activate);
-    return toHandle(body->GetID());
+    return acquireBody({PhysicsShapeKey::capsule(radius, height), layer}, position);
 }
 
 PhysicsBodyHandle JoltPhysicsWorld::createKinematicBox(
@@ -229,26 +333,7 @@ PhysicsBodyHandle JoltPhysicsWorld::createKinematicBox(
     const glm::vec3& halfExtents,
     PhysicsObjectLayer layer
 ) {
-    JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterface();
-    JPH::RefConst<JPH::Shape> shape = new JPH::BoxShape(toJoltVector(halfExtents));
-    JPH::BodyCreationSettings bodySettings(
-        shape.GetPtr(),
-        toJoltPosition(position),
-        JPH::Quat::sIdentity(),
-        JPH::EMotionType::Kinematic,
-        static_cast<JPH::ObjectLayer>(layer)
-    );
-    bodySettings.mFriction = static_cast<JPH::Real>(0.5f);
-    bodySettings.mRestitution = static_cast<JPH::Real>(0.0f);
-
-    JPH::Body* body = bodyInterface.CreateBody(bodySettings);
-    if (!body) {
-        Logger::get().error("Failed to create kinematic box body");
-        return {};
-    }
-
-    bodyInterface.AddBody(body->GetID(), JPH::EActivation::Activate);
-    return toHandle(body->GetID());
+    return acquireBody({PhysicsShapeKey::box(halfExtents), layer}, position);
 }
 
 PhysicsBodyHandle JoltPhysicsWorld::createStaticBox(
@@ -257,9 +342,8 @@ PhysicsBodyHandle JoltPhysicsWorld::createStaticBox(
     PhysicsObjectLayer layer
 ) {
     JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterface();
-    JPH::RefConst<JPH::Shape> shape = new JPH::BoxShape(toJoltVector(halfExtents));
     JPH::BodyCreationSettings bodySettings(
-        shape.GetPtr(),
+        cachedShape(PhysicsShapeKey::box(halfExtents)),
         toJoltPosition(position),
         JPH::Quat::sIdentity(),
         JPH::EMotionType::Static,
@@ -294,6 +378,7 @@ void JoltPhysicsWorld::setBodyPosition(PhysicsBodyHandle bodyId, const glm::vec3
         toJoltPosition(position),
         JPH::EActivation::Activate
     );
+    snapInterpolatedBody(bodyId, position);
 }
 
 glm::vec3 JoltPhysicsWorld::getBodyVelocity(PhysicsBodyHandle bodyId) const {
@@ -395,8 +480,474 @@ void JoltPhysicsWorld::removeBody(PhysicsBodyHandle bodyId) {
         return;
     }
     JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterface();
-    bodyInterface.RemoveBody(joltBodyId);
+    if (bodyInterface.IsAdded(joltBodyId)) {
+        bodyInterface.RemoveBody(joltBodyId);
+    } else if (const auto found = poolableBodies_.find(bodyId.raw()); found != poolableBodies_.end()) {
+        // Parked; take it out of its pool before destroying it
+        std::vector<JPH::BodyID>& pool = bodyPools_[found->second];
+        const auto parked = std::find(pool.begin(), pool.end(), joltBodyId);
+        if (parked != pool.end()) {
+            pool.erase(parked);
+            --pooledBodyCount_;
+        }
+    }
     bodyInterface.DestroyBody(joltBodyId);
+    poolableBodies_.erase(bodyId.raw());
+    forgetInterpolatedBody(bodyId);
+}
+
+void JoltPhysicsWorld::releaseBody(PhysicsBodyHandle bodyId) {
+    const auto found = poolableBodies_.find(bodyId.raw());
+    if (!physicsSystem_ || found == poolableBodies_.end()) {
+        removeBody(bodyId);
+        return;
+    }
+
+    const JPH::BodyID joltBodyId = toBodyId(bodyId);
+    JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterface();
+    if (!bodyInterface.IsAdded(joltBodyId)) {
+        return;
+    }
+    bodyInterface.RemoveBody(joltBodyId);
+    forgetInterpolatedBody(bodyId);
+    bodyPools_[found->second].push_back(joltBodyId);
+    ++pooledBodyCount_;
+}
+
+void JoltPhysicsWorld::reserveDynamicCapsules(float radius, float height, PhysicsObjectLayer layer, size_t count) {
+    reserveBodies({PhysicsShapeKey::capsule(radius, height), layer}, count);
+}
+
+void JoltPhysicsWorld::reserveKinematicBoxes(const glm::vec3& halfExtents, PhysicsObjectLayer layer, size_t count) {
+    reserveBodies({PhysicsShapeKey::box(halfExtents), layer}, count);
+}
+
+void JoltPhysicsWorld::reserveBodies(const PhysicsBodyPoolKey& key, size_t count) {
+    if (!physicsSystem_) {
+        return;
+    }
+
+    std::vector<JPH::BodyID>& pool = bodyPools_[key];
+    while (pool.size() < count) {
+        JPH::Body* body = createPoolableBody(key, glm::vec3(0.0f));
+        if (!body) {
+            return;
+        }
+        pool.push_back(body->GetID());
+        ++pooledBodyCount_;
+    }
+}
+
+void JoltPhysicsWorld::clearBodyPools() {
+    if (physicsSystem_) {
+        JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterface();
+        for (auto& [_, pool] : bodyPools_) {
+            for (JPH::BodyID bodyId : pool) {
+                bodyInterface.DestroyBody(bodyId);
+                poolableBodies_.erase(toHandle(bodyId).raw());
+            }
+        }
+    }
+    bodyPools_.clear();
+    pooledBodyCount_ = 0;
+}
+
+PhysicsBodyPoolStats JoltPhysicsWorld::bodyPoolStats() const {
+    return {pooledBodyCount_, shapeCache_.size(), createdBodies_, reusedBodies_};
+}
+
+const JPH::Shape* JoltPhysicsWorld::cachedShape(const PhysicsShapeKey& key) {
+    const auto [found, inserted] = shapeCache_.try_emplace(key);
+    if (inserted) {
+        if (key.type == PhysicsQueryShapeType::Capsule) {
+            found->second = new JPH::CapsuleShape(
+                static_cast<JPH::Real>(key.dimensions.y * 0.5f),
+                static_cast<JPH::Real>(key.dimensions.x)
+            );
+        } else {
+            found->second = new JPH::BoxShape(toJoltVector(key.dimensions));
+        }
+    }
+    return found->second.GetPtr();
+}
+
+JPH::Body* JoltPhysicsWorld::createPoolableBody(const PhysicsBodyPoolKey& key, const glm::vec3& position) {
+    const bool capsule = key.shape.type == PhysicsQueryShapeType::Capsule;
+    JPH::BodyCreationSettings bodySettings(
+        cachedShape(key.shape),
+        toJoltPosition(position),
+        JPH::Quat::sIdentity(),
+        capsule ? JPH::EMotionType::Dynamic : JPH::EMotionType::Kinematic,
+        static_cast<JPH::ObjectLayer>(key.layer)
+    );
+    bodySettings.mFriction = static_cast<JPH::Real>(0.5f);
+    bodySettings.mRestitution = static_cast<JPH::Real>(0.0f);
+    if (capsule) {
+        bodySettings.mLinearDamping = static_cast<JPH::Real>(0.0001f);
+        bodySettings.mAngularDamping = static_cast<JPH::Real>(0.05f);
+        bodySettings.mGravityFactor = static_cast<JPH::Real>(1.0f);
+        bodySettings.mAllowedDOFs =
+            JPH::EAllowedDOFs::TranslationX |
+            JPH::EAllowedDOFs::TranslationY |
+            JPH::EAllowedDOFs::TranslationZ |
+            JPH::EAllowedDOFs::RotationY;
+    }
+
+    JPH::Body* body = physicsSystem_->GetBodyInterface().CreateBody(bodySettings);
+    if (!body) {
+        Logger::get().error(capsule ? "Failed to create dynamic capsule body" : "Failed to create kinematic box body");
+        return nullptr;
+    }
+    poolableBodies_[toHandle(body->GetID()).raw()] = key;
+    return body;
+}
+
+PhysicsBodyHandle JoltPhysicsWorld::acquireBody(const PhysicsBodyPoolKey& key, const glm::vec3& position) {
+    if (!physicsSystem_) {
+        return {};
+    }
+
+    JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterface();
+    JPH::BodyID bodyId;
+    const auto pool = bodyPools_.find(key);
+    if (pool != bodyPools_.end() && !pool->second.empty()) {
+        bodyId = pool->second.back();
+        pool->second.pop_back();
+        --pooledBodyCount_;
+        ++reusedBodies_;
+
+        // Reset what the previous user may have left behind
+        bodyInterface.SetPositionAndRotation(bodyId, toJoltPosition(position), JPH::Quat::sIdentity(), JPH::EActivation::DontActivate);
+        bodyInterface.SetLinearAndAngularVelocity(bodyId, JPH::Vec3::sZero(), JPH::Vec3::sZero());
+        JPH::BodyLockWrite lock(physicsSystem_->GetBodyLockInterface(), bodyId);
+        if (lock.Succeeded()) {
+            lock.GetBody().SetAllowSleeping(true);
+        }
+    } else {
+        JPH::Body* body = createPoolableBody(key, position);
+        if (!body) {
+            return {};
+        }
+        bodyId = body->GetID();
+        ++createdBodies_;
+    }
+
+    bodyInterface.AddBody(bodyId, JPH::EActivation::Activate);
+    return toHandle(bodyId);
+}
+
+void JoltPhysicsWorld::readBodyPositions(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<glm::vec3> positions
+) const {
+    const size_t count = std::min(bodyIds.size(), positions.size());
+    if (!physicsSystem_) {
+        std::fill_n(positions.begin(), count, glm::vec3(0.0f));
+        return;
+    }
+
+    const std::vector<JPH::BodyID>& joltBodyIds = toBodyIds(bodyIds.first(count));
+    JPH::BodyLockMultiRead lock(physicsSystem_->GetBodyLockInterface(), joltBodyIds.data(), static_cast<int>(count));
+    for (size_t index = 0; index < count; ++index) {
+        const JPH::Body* body = lock.GetBody(static_cast<int>(index));
+        positions[index] = body != nullptr ? fromJolt(body->GetCenterOfMassPosition()) : glm::vec3(0.0f);
+    }
+}
+
+void JoltPhysicsWorld::readBodyVelocities(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<glm::vec3> velocities
+) const {
+    const size_t count = std::min(bodyIds.size(), velocities.size());
+    if (!physicsSystem_) {
+        std::fill_n(velocities.begin(), count, glm::vec3(0.0f));
+        return;
+    }
+
+    const std::vector<JPH::BodyID>& joltBodyIds = toBodyIds(bodyIds.first(count));
+    JPH::BodyLockMultiRead lock(physicsSystem_->GetBodyLockInterface(), joltBodyIds.data(), static_cast<int>(count));
+    for (size_t index = 0; index < count; ++index) {
+        const JPH::Body* body = lock.GetBody(static_cast<int>(index));
+        velocities[index] = body != nullptr ? fromJolt(body->GetLinearVelocity()) : glm::vec3(0.0f);
+    }
+}
+
+void JoltPhysicsWorld::readBodySleeping(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<uint8_t> sleeping
+) const {
+    const size_t count = std::min(bodyIds.size(), sleeping.size());
+    if (!physicsSystem_) {
+        std::fill_n(sleeping.begin(), count, uint8_t{0});
+        return;
+    }
+
+    const std::vector<JPH::BodyID>& joltBodyIds = toBodyIds(bodyIds.first(count));
+    JPH::BodyLockMultiRead lock(physicsSystem_->GetBodyLockInterface(), joltBodyIds.data(), static_cast<int>(count));
+    for (size_t index = 0; index < count; ++index) {
+        const JPH::Body* body = lock.GetBody(static_cast<int>(index));
+        sleeping[index] = body != nullptr && !body->IsActive() ? 1 : 0;
+    }
+}
+
+void JoltPhysicsWorld::setBodyPositions(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<const glm::vec3> positions
+) {
+    const size_t count = std::min(bodyIds.size(), positions.size());
+    if (!physicsSystem_ || count == 0) {
+        return;
+    }
+
+    {
+        // The no-lock interface does what SetPosition does minus the per-body lock we already hold
+        const std::vector<JPH::BodyID>& joltBodyIds = toBodyIds(bodyIds.first(count));
+        JPH::BodyLockMultiWrite lock(physicsSystem_->GetBodyLockInterface(), joltBodyIds.data(), static_cast<int>(count));
+        JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterfaceNoLock();
+        for (size_t index = 0; index < count; ++index) {
+            if (lock.GetBody(static_cast<int>(index)) != nullptr) {
+                bodyInterface.SetPosition(joltBodyIds[index], toJoltPosition(positions[index]), JPH::EActivation::Activate);
+            }
+        }
+    }
+
+    for (size_t index = 0; index < count; ++index) {
+        snapInterpolatedBody(bodyIds[index], positions[index]);
+    }
+}
+
+void JoltPhysicsWorld::setBodyVelocities(
+    std::span<const PhysicsBodyHandle> bodyIds,
+    std::span<const glm::vec3> velocities
+) {
+    const size_t count = std::min(bodyIds.size(), velocities.size());
+    if (!physicsSystem_ || count == 0) {
+        return;
+    }
+
+    const std::vector<JPH::BodyID>& joltBodyIds = toBodyIds(bodyIds.first(count));
+    JPH::BodyLockMultiWrite lock(physicsSystem_->GetBodyLockInterface(), joltBodyIds.data(), static_cast<int>(count));
+    JPH::BodyInterface& bodyInterface = physicsSystem_->GetBodyInterfaceNoLock();
+    for (size_t index = 0; index < count; ++index) {
+        if (lock.GetBody(static_cast<int>(index)) != nullptr) {
+            bodyInterface.SetLinearVelocity(joltBodyIds[index], toJoltVector(velocities[index]));
+        }
+    }
+}
+
+void JoltPhysicsWorld::wakeBodies(std::span<const PhysicsBodyHandle> bodyIds) {
+    if (!physicsSystem_ || bodyIds.empty()) {
+        return;
+    }
+    const std::vector<JPH::BodyID>& joltBodyIds = toBodyIds(bodyIds);
+    physicsSystem_->GetBodyInterface().ActivateBodies(joltBodyIds.data(), static_cast<int>(joltBodyIds.size()));
+}
+
+void JoltPhysicsWorld::sleepBodies(std::span<const PhysicsBodyHandle> bodyIds) {
+    if (!physicsSystem_ || bodyIds.empty()) {
+        return;
+    }
+    const std::vector<JPH::BodyID>& joltBodyIds = toBodyIds(bodyIds);
+    physicsSystem_->GetBodyInterface().DeactivateBodies(joltBodyIds.data(), static_cast<int>(joltBodyIds.size()));
+}
+
+std::optional<PhysicsQueryHit> JoltPhysicsWorld::raycast(
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    float maxDistance,
+    const PhysicsQueryFilter& filter
+) const {
+    if (!physicsSystem_) {
+        return std::nullopt;
+    }
+    const QueryFilters filters(settings_.layers, filter);
+    return castRay(filters, origin, direction, maxDistance);
+}
+
+std::optional<PhysicsQueryHit> JoltPhysicsWorld::sweep(
+    const PhysicsQueryShape& shape,
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    float maxDistance,
+    const PhysicsQueryFilter& filter
+) const {
+    if (!physicsSystem_) {
+        return std::nullopt;
+    }
+    const QueryFilters filters(settings_.layers, filter);
+    return castShape(filters, shape, origin, direction, maxDistance);
+}
+
+size_t JoltPhysicsWorld::overlap(
+    const PhysicsQueryShape& shape,
+    const glm::vec3& position,
+    std::span<PhysicsBodyHandle> bodies,
+    const PhysicsQueryFilter& filter
+) const {
+    if (!physicsSystem_) {
+        return 0;
+    }
+    const QueryFilters filters(settings_.layers, filter);
+    return collideShape(filters, shape, position, bodies);
+}
+
+void JoltPhysicsWorld::raycastBatch(
+    std::span<const PhysicsRaycastRequest> rays,
+    std::span<PhysicsQueryHit> hits,
+    const PhysicsQueryFilter& filter
+) const {
+    const size_t count = std::min(rays.size(), hits.size());
+    if (!physicsSystem_) {
+        std::fill_n(hits.begin(), count, PhysicsQueryHit{});
+        return;
+    }
+
+    const QueryFilters filters(settings_.layers, filter);
+    for (size_t index = 0; index < count; ++index) {
+        const PhysicsRaycastRequest& ray = rays[index];
+        hits[index] = castRay(filters, ray.origin, ray.direction, ray.maxDistance).value_or(PhysicsQueryHit{});
+    }
+}
+
+void JoltPhysicsWorld::sweepBatch(
+    std::span<const PhysicsSweepRequest> sweeps,
+    std::span<PhysicsQueryHit> hits,
+    const PhysicsQueryFilter& filter
+) const {
+    const size_t count = std::min(sweeps.size(), hits.size());
+    if (!physicsSystem_) {
+        std::fill_n(hits.begin(), count, PhysicsQueryHit{});
+        return;
+    }
+
+    const QueryFilters filters(settings_.layers, filter);
+    for (size_t index = 0; index < count; ++index) {
+        const PhysicsSweepRequest& request = sweeps[index];
+        hits[index] = castShape(filters, request.shape, request.origin, request.direction, request.maxDistance)
+            .value_or(PhysicsQueryHit{});
+    }
+}
+
+size_t JoltPhysicsWorld::overlapBatch(
+    std::span<const PhysicsOverlapRequest> overlaps,
+    std::span<PhysicsBodyHandle> bodies,
+    std::span<PhysicsOverlapRange> ranges,
+    const PhysicsQueryFilter& filter
+) const {
+    const size_t count = std::min(overlaps.size(), ranges.size());
+    if (!physicsSystem_) {
+        std::fill_n(ranges.begin(), count, PhysicsOverlapRange{});
+        return 0;
+    }
+
+    const QueryFilters filters(settings_.layers, filter);
+    size_t written = 0;
+    for (size_t index = 0; index < count; ++index) {
+        const size_t found = collideShape(filters, overlaps[index].shape, overlaps[index].position, bodies.subspan(written));
+        ranges[index] = {static_cast<uint32_t>(written), static_cast<uint32_t>(found)};
+        written += found;
+    }
+    return written;
+}
+
+std::optional<PhysicsQueryHit> JoltPhysicsWorld::castRay(
+    const QueryFilters& filters,
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    float maxDistance
+) const {
+    const float length = glm::length(direction);
+    if (!(length > 0.0f) || !(maxDistance > 0.0f)) {
+        return std::nullopt;
+    }
+
+    const JPH::RRayCast ray(toJoltPosition(origin), toJoltVector(direction * (maxDistance / length)));
+    JPH::RayCastResult result;
+    if (!physicsSystem_->GetNarrowPhaseQuery().CastRay(ray, result, filters.broadPhase, filters.objectLayer, filters.body)) {
+        return std::nullopt;
+    }
+
+    const JPH::RVec3 point = ray.GetPointOnRay(result.mFraction);
+    PhysicsQueryHit hit;
+    hit.body = toHandle(result.mBodyID);
+    hit.position = fromJolt(point);
+    hit.distance = result.mFraction * maxDistance;
+
+    JPH::BodyLockRead lock(physicsSystem_->GetBodyLockInterface(), result.mBodyID);
+    if (lock.Succeeded()) {
+        hit.normal = fromJolt(lock.GetBody().GetWorldSpaceSurfaceNormal(result.mSubShapeID2, point));
+    }
+    return hit;
+}
+
+std::optional<PhysicsQueryHit> JoltPhysicsWorld::castShape(
+    const QueryFilters& filters,
+    const PhysicsQueryShape& shape,
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    float maxDistance
+) const {
+    const float length = glm::length(direction);
+    if (!(length > 0.0f) || !(maxDistance > 0.0f)) {
+        return std::nullopt;
+    }
+
+    JPH::ClosestHitCollisionCollector<JPH::CastShapeCollector> collector;
+    const bool validShape = withQueryShape(shape, [&](const JPH::Shape& joltShape) {
+        const JPH::RShapeCast shapeCast(
+            &joltShape,
+            JPH::Vec3::sReplicate(1.0f),
+            JPH::RMat44::sTranslation(toJoltPosition(origin)),
+            toJoltVector(direction * (maxDistance / length))
+        );
+        physicsSystem_->GetNarrowPhaseQuery().CastShape(
+            shapeCast,
+            JPH::ShapeCastSettings(),
+            JPH::RVec3::sZero(),
+            collector,
+            filters.broadPhase,
+            filters.objectLayer,
+            filters.body
+        );
+    });
+    if (!validShape || !collector.HadHit()) {
+        return std::nullopt;
+    }
+
+    const JPH::ShapeCastResult& result = collector.mHit;
+    PhysicsQueryHit hit;
+    hit.body = toHandle(result.mBodyID2);
+    hit.position = fromJolt(result.mContactPointOn2);
+    hit.normal = fromJolt(-result.mPenetrationAxis.NormalizedOr(JPH::Vec3::sZero()));
+    hit.distance = result.mFraction * maxDistance;
+    return hit;
+}
+
+size_t JoltPhysicsWorld::collideShape(
+    const QueryFilters& filters,
+    const PhysicsQueryShape& shape,
+    const glm::vec3& position,
+    std::span<PhysicsBodyHandle> bodies
+) const {
+    if (bodies.empty()) {
+        return 0;
+    }
+
+    OverlapCollector collector(bodies);
+    withQueryShape(shape, [&](const JPH::Shape& joltShape) {
+        physicsSystem_->GetNarrowPhaseQuery().CollideShape(
+            &joltShape,
+            JPH::Vec3::sReplicate(1.0f),
+            JPH::RMat44::sTranslation(toJoltPosition(position)),
+            JPH::CollideShapeSettings(),
+            JPH::RVec3::sZero(),
+            collector,
+            filters.broadPhase,
+            filters.objectLayer,
+            filters.body
+        );
+    });
+    return collector.count();
 }
 
 PhysicsBodyHandle JoltPhysicsWorld::toHandle(JPH::BodyID bodyId) {
@@ -410,6 +961,15 @@ JPH::BodyID JoltPhysicsWorld::toBodyId(PhysicsBodyHandle handle) {
     return JPH::BodyID(static_cast<JPH::uint32>(handle.raw()));
 }
 
+const std::vector<JPH::BodyID>& JoltPhysicsWorld::toBodyIds(std::span<const PhysicsBodyHandle> handles) {
+    thread_local std::vector<JPH::BodyID> bodyIds;
+    bodyIds.clear();
+    for (const PhysicsBodyHandle handle : handles) {
+        bodyIds.push_back(toBodyId(handle));
+    }
+    return bodyIds;
+}
+
 JPH::RVec3 JoltPhysicsWorld::toJoltPosition(const glm::vec3& value) {
     return JPH::RVec3(
         static_cast<JPH::Real>(value.x),
@@ -8,6 +8,7 @@
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
 #include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/Body/BodyLockMulti.h>
 #include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h>
 #include <Jolt/Physics/Collision/ObjectLayer.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
@@ -21,6 +22,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace tremor::physics {
@@ -66,9 +68,9 @@ private:
     std::vector<std::vector<bool>> collisions_;
 };
 
-class LoggingContactListener : public JPH::ContactListener {
+class ContactEventListener : public JPH::ContactListener {
 public:
-    explicit LoggingContactListener(JoltPhysicsWorld& owner);
+    explicit ContactEventListener(JoltPhysicsWorld& owner);
 
     void OnContactAdded(
         const JPH::Body& left,
@@ -131,16 +133,100 @@ public:
     void setBodySleepingAllowed(PhysicsBodyHandle bodyId, bool allowed) override;
     void removeBody(PhysicsBodyHandle bodyId) override;
 
+    void releaseBody(PhysicsBodyHandle bodyId) override;
+    void reserveDynamicCapsules(float radius, float height, PhysicsObjectLayer layer, size_t count) override;
+    void reserveKinematicBoxes(const glm::vec3& halfExtents, PhysicsObjectLayer layer, size_t count) override;
+    void clearBodyPools() override;
+    PhysicsBodyPoolStats bodyPoolStats() const override;
+
+    void readBodyPositions(std::span<const PhysicsBodyHandle> bodyIds, std::span<glm::vec3> positions) const override;
+    void readBodyVelocities(std::span<const PhysicsBodyHandle> bodyIds, std::span<glm::vec3> velocities) const override;
+    void readBodySleeping(std::span<const PhysicsBodyHandle> bodyIds, std::span<uint8_t> sleeping) const override;
+    void setBodyPositions(std::span<const PhysicsBodyHandle> bodyIds, std::span<const glm::vec3> positions) override;
+    void setBodyVelocities(std::span<const PhysicsBodyHandle> bodyIds, std::span<const glm::vec3> velocities) override;
+    void wakeBodies(std::span<const PhysicsBodyHandle> bodyIds) override;
+    void sleepBodies(std::span<const PhysicsBodyHandle> bodyIds) override;
+
+    std::optional<PhysicsQueryHit> raycast(
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+    std::optional<PhysicsQueryHit> sweep(
+        const PhysicsQueryShape& shape,
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+    size_t overlap(
+        const PhysicsQueryShape& shape,
+        const glm::vec3& position,
+        std::span<PhysicsBodyHandle> bodies,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+    void raycastBatch(
+        std::span<const PhysicsRaycastRequest> rays,
+        std::span<PhysicsQueryHit> hits,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+    void sweepBatch(
+        std::span<const PhysicsSweepRequest> sweeps,
+        std::span<PhysicsQueryHit> hits,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+    size_t overlapBatch(
+        std::span<const PhysicsOverlapRequest> overlaps,
+        std::span<PhysicsBodyHandle> bodies,
+        std::span<PhysicsOverlapRange> ranges,
+        const PhysicsQueryFilter& filter = {}
+    ) const override;
+
     JPH::PhysicsSystem* getSystem() { return physicsSystem_.get(); }
     JPH::PhysicsSystem* GetSystem() { return getSystem(); }
     JPH::BodyInterface& getBodyInterface() { return physicsSystem_->GetBodyInterface(); }
     JPH::BodyInterface& GetBodyInterface() { return getBodyInterface(); }
 
 private:
-    friend class LoggingContactListener;
+    friend class ContactEventListener;
+
+    // Jolt-side filters for one PhysicsQueryFilter, built once per query or batch
+    struct QueryFilters;
+    class OverlapCollector;
+
+    std::optional<PhysicsQueryHit> castRay(
+        const QueryFilters& filters,
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance
+    ) const;
+    std::optional<PhysicsQueryHit> castShape(
+        const QueryFilters& filters,
+        const PhysicsQueryShape& shape,
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxDistance
+    ) const;
+    size_t collideShape(
+        const QueryFilters& filters,
+        const PhysicsQueryShape& shape,
+        const glm::vec3& position,
+        std::span<PhysicsBodyHandle> bodies
+    ) const;
+
+    // Shapes are immutable in Jolt, so every body with the same dimensions shares one
+    const JPH::Shape* cachedShape(const PhysicsShapeKey& key);
+    // Creates a body of a poolable kind without adding it to the simulation
+    JPH::Body* createPoolableBody(const PhysicsBodyPoolKey& key, const glm::vec3& position);
+    // Takes a parked body of this kind if there is one, otherwise creates one, and adds it
+    PhysicsBodyHandle acquireBody(const PhysicsBodyPoolKey& key, const glm::vec3& position);
+    void reserveBodies(const PhysicsBodyPoolKey& key, size_t count);
 
     static PhysicsBodyHandle toHandle(JPH::BodyID bodyId);
     static JPH::BodyID toBodyId(PhysicsBodyHandle handle);
+    // Converts into a per-thread scratch array, valid until the next call on this thread
+    static const std::vector<JPH::BodyID>& toBodyIds(std::span<const PhysicsBodyHandle> handles);
     static JPH::RVec3 toJoltPosition(const glm::vec3& value);
     static JPH::Vec3 toJoltVector(const glm::vec3& value);
     static glm::vec3 fromJolt(const JPH::RVec3& value);
@@ -154,7 +240,15 @@ private:
     std::unique_ptr<ConfigurableBroadPhaseLayerInterface> broadPhaseLayerInterface_;
     std::unique_ptr<ConfigurableObjectVsBroadPhaseLayerFilter> objectVsBroadPhaseLayerFilter_;
     std::unique_ptr<ConfigurableObjectLayerPairFilter> objectLayerPairFilter_;
-    std::unique_ptr<LoggingContactListener> contactListener_;
+    std::unique_ptr<ContactEventListener> contactListener_;
+
+    std::unordered_map<PhysicsShapeKey, JPH::RefConst<JPH::Shape>, PhysicsShapeKeyHash> shapeCache_;
+    std::unordered_map<PhysicsBodyPoolKey, std::vector<JPH::BodyID>, PhysicsBodyPoolKeyHash> bodyPools_;
+    // Kind of every live capsule and kinematic box body, parked or not, by handle
+    std::unordered_map<uint64_t, PhysicsBodyPoolKey> poolableBodies_;
+    size_t pooledBodyCount_ = 0;
+    uint64_t createdBodies_ = 0;
+    uint64_t reusedBodies_ = 0;
 };
 
 } // namespace tremor::physics
@@ -45,7 +45,9 @@
 #include <cmath>
 #include <cstring>
 #include <fstream>
+#include <optional>
 #include <string>
+#include <thread>
 
 // Forward declaration for chunked TAF creation
 bool createChunkedStreamingTAF(const std::string& inputWavPath,
@@ -100,6 +102,51 @@ const char* physicsBackendName(tremor::physics::PhysicsBackendKind backendKind)
     return backendKind == tremor::physics::PhysicsBackendKind::PhysX ? "PhysX" : "Jolt";
 }
 
+std::optional<std::string_view> findArgumentValue(int argc, char** argv, std::string_view prefix) {
+    for (int index = 1; index < argc; ++index) {
+        const std::string_view argument(argv[index] != nullptr ? argv[index] : "");
+        if (argument.substr(0, prefix.size()) == prefix) {
+            return argument.substr(prefix.size());
+        }
+    }
+    return std::nullopt;
+}
+
+// --sim-threads=N or TREMOR_SIM_THREADS; defaults to every hardware thread.
+// --determinism-record=path / --determinism-verify=path trace per-frame state hashes
+// with a fixed seed, frame time and no input, so a run with --sim-threads=1 can be
+// compared against a multi-threaded one.
+DMCSurvivors::GameOptions chooseGameOptions(int argc, char** argv) {
+    DMCSurvivors::GameOptions options;
+    options.simulationThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::optional<std::string> threads;
+    if (const auto value = findArgumentValue(argc, argv, "--sim-threads=")) {
+        threads = std::string(*value);
+    } else if (const char* envValue = std::getenv("TREMOR_SIM_THREADS")) {
+        threads = envValue;
+    }
+    if (threads) {
+        try {
+            options.simulationThreads = static_cast<uint32_t>(std::max(1, std::stoi(*threads)));
+        } catch (const std::exception&) {
+            Logger::get().warning("Ignoring invalid simulation thread count '{}'", *threads);
+        }
+    }
+
+    if (const auto path = findArgumentValue(argc, argv, "--determinism-record=")) {
+        options.determinismMode = DMCSurvivors::DeterminismMode::Record;
+        options.determinismTracePath = std::string(*path);
+    } else if (const auto path = findArgumentValue(argc, argv, "--determinism-verify=")) {
+        options.determinismMode = DMCSurvivors::DeterminismMode::Verify;
+        options.determinismTracePath = std::string(*path);
+    }
+    if (options.determinismMode != DMCSurvivors::DeterminismMode::Off) {
+        options.seed = 1;
+    }
+    return options;
+}
+
 } // namespace
 
 #include "RenderBackend.h"
@@ -121,6 +168,7 @@ public:
     int gateResetCounter = 0;  // Counter to reset gate after triggering
     bool bitCrushEnabled = false;  // Enable bit crusher effect
     tremor::physics::PhysicsBackendKind physicsBackendKind = tremor::physics::PhysicsBackendKind::Jolt;
+    DMCSurvivors::GameOptions gameOptions;
 
     std::unique_ptr<tremor::gfx::RenderBackend> rb;
     std::unique_ptr<tremor::audio::TaffyPolyphonicProcessor> audioProcessor;
@@ -236,7 +284,8 @@ public:
         : argc(argcIn),
           argv(argvIn),
           audioDevice(0),
-          physicsBackendKind(choosePhysicsBackend(argcIn, argvIn)) {
+          physicsBackendKind(choosePhysicsBackend(argcIn, argvIn)),
+          gameOptions(chooseGameOptions(argcIn, argvIn)) {
         Logger::get().critical("Engine constructor called!");
         Logger::get().critical("  Engine instance: {}", (void*)this);
         Logger::get().info("Selected gameplay physics backend: {}", physicsBackendName(physicsBackendKind));
@@ -263,7 +312,7 @@ public:
 
         // Initialize DMC Survivors game
         Logger::get().info("Initializing DMC Survivors game...");
-        game = std::make_unique<DMCSurvivors::Game>(physicsBackendKind);
+        game = std::make_unique<DMCSurvivors::Game>(physicsBackendKind, gameOptions);
         Logger::get().info("DMC Survivors game initialized!");
 
         // Initialize audio
@@ -547,10 +596,16 @@ public:
             input.dash = keystate[SDL_SCANCODE_LSHIFT];
             input.lockOn = keystate[SDL_SCANCODE_Q];
 
-            game->processInput(input);
+            if (gameOptions.determinismMode != DMCSurvivors::DeterminismMode::Off) {
+                // Both runs must see identical frames: no input and a fixed frame time
+                game->processInput(DMCSurvivors::InputCommand{});
+                game->update(1.0f / 60.0f);
+            } else {
+                game->processInput(input);
 
-            // Update game with actual frame time
-            game->update(deltaTime);
+                // Update game with actual frame time
+                game->update(deltaTime);
+            }
         }
 
 
@@ -4,6 +4,7 @@
 
 #include <format>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -21,115 +22,26 @@ std::vector<std::string> splitCommandWords(std::string_view text) {
     return words;
 }
 
-std::optional<float> parseFloat(std::string_view text) {
-    try {
-        size_t consumed = 0;
-        const float value = std::stof(std::string(text), &consumed);
-        if (consumed == text.size()) {
-            return value;
-        }
-    } catch (const std::exception&) {
-    }
-    return std::nullopt;
-}
-
-std::optional<glm::vec3> parseVec3Args(
-    const std::vector<std::string>& args,
-    size_t offset
-) {
-    if (args.size() < offset + 3) {
-        return std::nullopt;
-    }
-
-    const auto x = parseFloat(args[offset]);
-    const auto y = parseFloat(args[offset + 1]);
-    const auto z = parseFloat(args[offset + 2]);
-    if (!x || !y || !z) {
-        return std::nullopt;
-    }
-    return glm::vec3(*x, *y, *z);
-}
+using tremor::script::CommandArgType;
 
-std::optional<flecs::entity_t> parseEntityId(std::string value) {
-    if (value.empty()) {
-        return std::nullopt;
-    }
-    if (value.front() == '#') {
-        value.erase(0, 1);
-    }
-
-    try {
-        size_t consumed = 0;
-        const uint64_t parsed = std::stoull(value, &consumed);
-        if (consumed == value.size()) {
-            return static_cast<flecs::entity_t>(parsed);
-        }
-    } catch (const std::exception&) {
-    }
-    return std::nullopt;
+// Typed arguments arrive converted, so numbers are always present
+glm::vec3 vec3Argument(std::span<const tremor::script::Value> args, size_t offset) {
+    return glm::vec3(
+        static_cast<float>(*args[offset].asNumber()),
+        static_cast<float>(*args[offset + 1].asNumber()),
+        static_cast<float>(*args[offset + 2].asNumber())
+    );
 }
 
-std::optional<flecs::entity> resolveScriptEntity(
-    tremor::script::FlecsInterpreterHost& interpreterHost,
+std::optional<flecs::entity> resolveEntityOrLog(
     const tremor::script::CommandContext& context,
-    std::string_view reference,
-    std::string* outError
+    const tremor::script::Value& argument,
+    std::string_view commandName
 ) {
-    const std::string ref(reference);
-    if (ref.empty()) {
-        if (outError) *outError = "entity reference is empty";
-        return std::nullopt;
-    }
-
-    if (ref.starts_with("var.")) {
-        const std::optional<tremor::script::Value> value =
-            interpreterHost.getBlackboardValue(ref.substr(4));
-        if (!value) {
-            if (outError) *outError = std::format("blackboard entity reference '{}' is unset", ref);
-            return std::nullopt;
-        }
-
-        std::optional<flecs::entity_t> entityId = value->asEntityId();
-        if (!entityId) {
-            if (const auto text = value->asStringView()) {
-                entityId = parseEntityId(std::string(*text));
-                if (!entityId) {
-                    flecs::entity named = context.world.lookup(std::string(*text).c_str());
-                    if (named && named.is_alive()) {
-                        return named;
-                    }
-                }
-            } else if (const auto number = value->asNumber()) {
-                entityId = static_cast<flecs::entity_t>(*number);
-            }
-        }
-
-        if (!entityId) {
-            if (outError) {
-                *outError = std::format("blackboard value '{}' is not an entity reference", ref);
-            }
-            return std::nullopt;
-        }
-
-        flecs::entity entity(context.world, *entityId);
-        if (!entity.is_alive()) {
-            if (outError) *outError = std::format("entity '{}' is not alive", ref);
-            return std::nullopt;
-        }
-        return entity;
-    }
-
-    if (const std::optional<flecs::entity_t> entityId = parseEntityId(ref)) {
-        flecs::entity entity(context.world, *entityId);
-        if (entity.is_alive()) {
-            return entity;
-        }
-    }
-
-    flecs::entity entity = context.world.lookup(ref.c_str());
-    if (!entity || !entity.is_alive()) {
-        if (outError) *outError = std::format("entity '{}' was not found", ref);
-        return std::nullopt;
+    std::string error;
+    std::optional<flecs::entity> entity = tremor::script::resolveEntityArgument(context.world, argument, &error);
+    if (!entity) {
+        Logger::get().error("{} failed: {}", commandName, error);
     }
     return entity;
 }
@@ -169,36 +81,28 @@ void registerPhysicsInteropCommands(
     tremor::script::FlecsInterpreterHost& interpreterHost,
     PhysicsInteropAdapter& adapter
 ) {
-    interpreterHost.registerCommand("physics_create_dynamic_body", [&interpreterHost, &adapter](
+    interpreterHost.registerTypedCommand("physics_create_dynamic_body", {
+        {CommandArgType::Entity, CommandArgType::Number, CommandArgType::Number, CommandArgType::Number,
+            CommandArgType::Number, CommandArgType::Number, CommandArgType::String},
+        6,
+        "<entity_ref> x y z radius height [layer]",
+    }, [&adapter](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
         context.world.component<ScriptPhysicsBody>();
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.size() != 6 && args.size() != 7) {
-            Logger::get().error(
-                "physics_create_dynamic_body expects '<entity_ref> x y z radius height [layer]'"
-            );
+        const std::optional<flecs::entity> entity = resolveEntityOrLog(context, args[0], "physics_create_dynamic_body");
+        if (!entity) {
             return false;
         }
 
-        std::string error;
-        std::optional<flecs::entity> entity = resolveScriptEntity(interpreterHost, context, args[0], &error);
-        const std::optional<glm::vec3> position = parseVec3Args(args, 1);
-        const std::optional<float> radius = parseFloat(args[4]);
-        const std::optional<float> height = parseFloat(args[5]);
-        const std::string_view layer = args.size() == 7 ? std::string_view(args[6]) : std::string_view("default");
-
-        if (!entity || !position || !radius || !height) {
-            Logger::get().error("physics_create_dynamic_body failed: invalid argument '{}'", argument);
-            if (!error.empty()) {
-                Logger::get().error("  {}", error);
-            }
-            return false;
-        }
+        const glm::vec3 position = vec3Argument(args, 1);
+        const float radius = static_cast<float>(*args[4].asNumber());
+        const float height = static_cast<float>(*args[5].asNumber());
+        const std::string_view layer = args.size() == 7 ? *args[6].asStringView() : std::string_view("default");
 
         const std::optional<PhysicsBodyHandle> handle =
-            adapter.createDynamicCapsule(*position, *radius, *height, layer);
+            adapter.createDynamicCapsule(position, radius, height, layer);
         if (!handle || handle->IsInvalid()) {
             Logger::get().error("physics_create_dynamic_body failed: adapter did not create a body");
             return false;
@@ -208,35 +112,27 @@ void registerPhysicsInteropCommands(
         return true;
     });
 
-    interpreterHost.registerCommand("physics_create_kinematic_box", [&interpreterHost, &adapter](
+    interpreterHost.registerTypedCommand("physics_create_kinematic_box", {
+        {CommandArgType::Entity, CommandArgType::Number, CommandArgType::Number, CommandArgType::Number,
+            CommandArgType::Number, CommandArgType::Number, CommandArgType::Number, CommandArgType::String},
+        7,
+        "<entity_ref> x y z half_x half_y half_z [layer]",
+    }, [&adapter](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
         context.world.component<ScriptPhysicsBody>();
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.size() != 7 && args.size() != 8) {
-            Logger::get().error(
-                "physics_create_kinematic_box expects '<entity_ref> x y z half_x half_y half_z [layer]'"
-            );
+        const std::optional<flecs::entity> entity = resolveEntityOrLog(context, args[0], "physics_create_kinematic_box");
+        if (!entity) {
             return false;
         }
 
-        std::string error;
-        std::optional<flecs::entity> entity = resolveScriptEntity(interpreterHost, context, args[0], &error);
-        const std::optional<glm::vec3> position = parseVec3Args(args, 1);
-        const std::optional<glm::vec3> halfExtents = parseVec3Args(args, 4);
-        const std::string_view layer = args.size() == 8 ? std::string_view(args[7]) : std::string_view("default");
-
-        if (!entity || !position || !halfExtents) {
-            Logger::get().error("physics_create_kinematic_box failed: invalid argument '{}'", argument);
-            if (!error.empty()) {
-                Logger::get().error("  {}", error);
-            }
-            return false;
-        }
+        const glm::vec3 position = vec3Argument(args, 1);
+        const glm::vec3 halfExtents = vec3Argument(args, 4);
+        const std::string_view layer = args.size() == 8 ? *args[7].asStringView() : std::string_view("default");
 
         const std::optional<PhysicsBodyHandle> handle =
-            adapter.createKinematicBox(*position, *halfExtents, layer);
+            adapter.createKinematicBox(position, halfExtents, layer);
         if (!handle || handle->IsInvalid()) {
             Logger::get().error("physics_create_kinematic_box failed: adapter did not create a body");
             return false;
@@ -246,35 +142,27 @@ void registerPhysicsInteropCommands(
         return true;
     });
 
-    interpreterHost.registerCommand("physics_create_static_box", [&interpreterHost, &adapter](
+    interpreterHost.registerTypedCommand("physics_create_static_box", {
+        {CommandArgType::Entity, CommandArgType::Number, CommandArgType::Number, CommandArgType::Number,
+            CommandArgType::Number, CommandArgType::Number, CommandArgType::Number, CommandArgType::String},
+        7,
+        "<entity_ref> x y z half_x half_y half_z [layer]",
+    }, [&adapter](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
         context.world.component<ScriptPhysicsBody>();
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.size() != 7 && args.size() != 8) {
-            Logger::get().error(
-                "physics_create_static_box expects '<entity_ref> x y z half_x half_y half_z [layer]'"
-            );
+        const std::optional<flecs::entity> entity = resolveEntityOrLog(context, args[0], "physics_create_static_box");
+        if (!entity) {
             return false;
         }
 
-        std::string error;
-        std::optional<flecs::entity> entity = resolveScriptEntity(interpreterHost, context, args[0], &error);
-        const std::optional<glm::vec3> position = parseVec3Args(args, 1);
-        const std::optional<glm::vec3> halfExtents = parseVec3Args(args, 4);
-        const std::string_view layer = args.size() == 8 ? std::string_view(args[7]) : std::string_view("default");
-
-        if (!entity || !position || !halfExtents) {
-            Logger::get().error("physics_create_static_box failed: invalid argument '{}'", argument);
-            if (!error.empty()) {
-                Logger::get().error("  {}", error);
-            }
-            return false;
-        }
+        const glm::vec3 position = vec3Argument(args, 1);
+        const glm::vec3 halfExtents = vec3Argument(args, 4);
+        const std::string_view layer = args.size() == 8 ? *args[7].asStringView() : std::string_view("default");
 
         const std::optional<PhysicsBodyHandle> handle =
-            adapter.createStaticBox(*position, *halfExtents, layer);
+            adapter.createStaticBox(position, halfExtents, layer);
         if (!handle || handle->IsInvalid()) {
             Logger::get().error("physics_create_static_box failed: adapter did not create a body");
             return false;
@@ -284,14 +172,16 @@ void registerPhysicsInteropCommands(
         return true;
     });
 
-    interpreterHost.registerCommand("physics_remove_body", [&interpreterHost, &adapter](
+    interpreterHost.registerTypedCommand("physics_remove_body", {
+        {CommandArgType::Entity},
+        1,
+        "<entity_ref>",
+    }, [&adapter](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        std::string error;
-        std::optional<flecs::entity> entity = resolveScriptEntity(interpreterHost, context, argument, &error);
+        const std::optional<flecs::entity> entity = resolveEntityOrLog(context, args[0], "physics_remove_body");
         if (!entity) {
-            Logger::get().error("physics_remove_body failed: {}", error);
             return false;
         }
 
@@ -299,92 +189,63 @@ void registerPhysicsInteropCommands(
         return true;
     });
 
-    interpreterHost.registerCommand("physics_set_position", [&interpreterHost, &adapter](
+    // <entity_ref> x y z, applied to the entity's body
+    const tremor::script::CommandSignature bodyVectorSignature{
+        {CommandArgType::Entity, CommandArgType::Number, CommandArgType::Number, CommandArgType::Number},
+        4,
+        "<entity_ref> x y z",
+    };
+
+    interpreterHost.registerTypedCommand("physics_set_position", bodyVectorSignature, [&adapter](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.size() != 4) {
-            Logger::get().error("physics_set_position expects '<entity_ref> x y z'");
-            return false;
-        }
-
-        std::string error;
-        std::optional<flecs::entity> entity = resolveScriptEntity(interpreterHost, context, args[0], &error);
-        const std::optional<glm::vec3> position = parseVec3Args(args, 1);
-        if (!entity || !position) {
-            Logger::get().error("physics_set_position failed: invalid argument '{}'", argument);
+        const std::optional<flecs::entity> entity = resolveEntityOrLog(context, args[0], "physics_set_position");
+        if (!entity) {
             return false;
         }
 
         const ScriptPhysicsBody* body = getPhysicsBodyOrLog(*entity, "physics_set_position");
-        return body && adapter.setPosition(body->handle, *position);
+        return body && adapter.setPosition(body->handle, vec3Argument(args, 1));
     });
 
-    interpreterHost.registerCommand("physics_set_velocity", [&interpreterHost, &adapter](
+    interpreterHost.registerTypedCommand("physics_set_velocity", bodyVectorSignature, [&adapter](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.size() != 4) {
-            Logger::get().error("physics_set_velocity expects '<entity_ref> x y z'");
-            return false;
-        }
-
-        std::string error;
-        std::optional<flecs::entity> entity = resolveScriptEntity(interpreterHost, context, args[0], &error);
-        const std::optional<glm::vec3> velocity = parseVec3Args(args, 1);
-        if (!entity || !velocity) {
-            Logger::get().error("physics_set_velocity failed: invalid argument '{}'", argument);
+        const std::optional<flecs::entity> entity = resolveEntityOrLog(context, args[0], "physics_set_velocity");
+        if (!entity) {
             return false;
         }
 
         const ScriptPhysicsBody* body = getPhysicsBodyOrLog(*entity, "physics_set_velocity");
-        return body && adapter.setVelocity(body->handle, *velocity);
+        return body && adapter.setVelocity(body->handle, vec3Argument(args, 1));
     });
 
-    interpreterHost.registerCommand("physics_add_impulse", [&interpreterHost, &adapter](
+    interpreterHost.registerTypedCommand("physics_add_impulse", bodyVectorSignature, [&adapter](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.size() != 4) {
-            Logger::get().error("physics_add_impulse expects '<entity_ref> x y z'");
-            return false;
-        }
-
-        std::string error;
-        std::optional<flecs::entity> entity = resolveScriptEntity(interpreterHost, context, args[0], &error);
-        const std::optional<glm::vec3> impulse = parseVec3Args(args, 1);
-        if (!entity || !impulse) {
-            Logger::get().error("physics_add_impulse failed: invalid argument '{}'", argument);
+        const std::optional<flecs::entity> entity = resolveEntityOrLog(context, args[0], "physics_add_impulse");
+        if (!entity) {
             return false;
         }
 
         const ScriptPhysicsBody* body = getPhysicsBodyOrLog(*entity, "physics_add_impulse");
-        return body && adapter.addImpulse(body->handle, *impulse);
+        return body && adapter.addImpulse(body->handle, vec3Argument(args, 1));
     });
 
-    interpreterHost.registerCommand("physics_add_force", [&interpreterHost, &adapter](
+    interpreterHost.registerTypedCommand("physics_add_force", bodyVectorSignature, [&adapter](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.size() != 4) {
-            Logger::get().error("physics_add_force expects '<entity_ref> x y z'");
-            return false;
-        }
-
-        std::string error;
-        std::optional<flecs::entity> entity = resolveScriptEntity(interpreterHost, context, args[0], &error);
-        const std::optional<glm::vec3> force = parseVec3Args(args, 1);
-        if (!entity || !force) {
-            Logger::get().error("physics_add_force failed: invalid argument '{}'", argument);
+        const std::optional<flecs::entity> entity = resolveEntityOrLog(context, args[0], "physics_add_force");
+        if (!entity) {
             return false;
         }
 
         const ScriptPhysicsBody* body = getPhysicsBodyOrLog(*entity, "physics_add_force");
-        return body && adapter.addForce(body->handle, *force);
+        return body && adapter.addForce(body->handle, vec3Argument(args, 1));
     });
 }
 
@@ -5,6 +5,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 
@@ -21,30 +22,13 @@ std::vector<std::string> splitCommandWords(std::string_view text) {
     return words;
 }
 
-std::optional<float> parseFloat(std::string_view text) {
-    try {
-        size_t consumed = 0;
-        const float value = std::stof(std::string(text), &consumed);
-        if (consumed == text.size()) {
-            return value;
-        }
-    } catch (const std::exception&) {
-    }
-    return std::nullopt;
-}
-
-std::optional<glm::vec3> parseVec3Args(const std::vector<std::string>& args, size_t offset) {
-    if (args.size() < offset + 3) {
-        return std::nullopt;
-    }
-
-    const std::optional<float> x = parseFloat(args[offset]);
-    const std::optional<float> y = parseFloat(args[offset + 1]);
-    const std::optional<float> z = parseFloat(args[offset + 2]);
-    if (!x || !y || !z) {
-        return std::nullopt;
-    }
-    return glm::vec3(*x, *y, *z);
+// Typed arguments arrive converted, so numbers are always present
+glm::vec3 vec3Argument(std::span<const tremor::script::Value> args, size_t offset) {
+    return glm::vec3(
+        static_cast<float>(*args[offset].asNumber()),
+        static_cast<float>(*args[offset + 1].asNumber()),
+        static_cast<float>(*args[offset + 2].asNumber())
+    );
 }
 
 } // namespace
@@ -90,13 +74,21 @@ void registerRenderInteropCommands(
         return true;
     });
 
-    interpreterHost.registerCommand("render_mesh_pass", [&registry](
+    using tremor::script::CommandArgType;
+
+    interpreterHost.registerTypedCommand("render_mesh_pass", {
+        {CommandArgType::String, CommandArgType::String, CommandArgType::String, CommandArgType::String,
+            CommandArgType::Number, CommandArgType::Number, CommandArgType::Number,
+            CommandArgType::Number, CommandArgType::Number, CommandArgType::Number},
+        1,
+        "<tag> [asset_field] [position_field] [scale_field] [scale_x scale_y scale_z] [offset_x offset_y offset_z]",
+    }, [&registry](
         const tremor::script::CommandContext&,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.empty() || (args.size() != 1 && args.size() != 2 && args.size() != 3 &&
-                args.size() != 4 && args.size() != 7 && args.size() != 10)) {
+        // Vectors are all or nothing
+        if (args.size() != 1 && args.size() != 2 && args.size() != 3 &&
+                args.size() != 4 && args.size() != 7 && args.size() != 10) {
             Logger::get().error(
                 "render_mesh_pass expects '<tag> [asset_field] [position_field] [scale_field] [scale_x scale_y scale_z] [offset_x offset_y offset_z]'"
             );
@@ -104,33 +96,21 @@ void registerRenderInteropCommands(
         }
 
         RenderMeshPass pass;
-        pass.tagName = args[0];
+        pass.tagName = *args[0].asStringView();
         if (args.size() >= 2) {
-            pass.assetField = args[1];
+            pass.assetField = *args[1].asStringView();
         }
         if (args.size() >= 3) {
-            pass.positionField = args[2];
+            pass.positionField = *args[2].asStringView();
         }
         if (args.size() >= 4) {
-            pass.scaleField = args[3];
+            pass.scaleField = *args[3].asStringView();
         }
-
         if (args.size() >= 7) {
-            const std::optional<glm::vec3> scale = parseVec3Args(args, 4);
-            if (!scale) {
-                Logger::get().error("render_mesh_pass failed: invalid scale '{}'", argument);
-                return false;
-            }
-            pass.scaleMultiplier = *scale;
+            pass.scaleMultiplier = vec3Argument(args, 4);
         }
-
         if (args.size() == 10) {
-            const std::optional<glm::vec3> offset = parseVec3Args(args, 7);
-            if (!offset) {
-                Logger::get().error("render_mesh_pass failed: invalid offset '{}'", argument);
-                return false;
-            }
-            pass.offset = *offset;
+            pass.offset = vec3Argument(args, 7);
         }
 
         Logger::get().info(
@@ -4,6 +4,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -19,6 +20,11 @@ struct RenderableRecord {
     glm::vec3 scale{1.0f};
 };
 
+// State an adapter keeps between frames for one pass, such as a cached ECS query
+struct RenderAdapterCache {
+    virtual ~RenderAdapterCache() = default;
+};
+
 struct RenderMeshPass {
     std::string tagName;
     std::string assetField = "render.mesh";
@@ -26,6 +32,8 @@ struct RenderMeshPass {
     std::string scaleField = "transform.scale";
     glm::vec3 scaleMultiplier{1.0f};
     glm::vec3 offset{0.0f};
+    // Filled in by the adapter on first draw; lives and dies with the pass
+    mutable std::shared_ptr<RenderAdapterCache> adapterCache;
 };
 
 class RenderInteropAdapter {
@@ -2,15 +2,23 @@
 
 #include "logger.h"
 
+#include <algorithm>
+#include <cstring>
 #include <format>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
+#include <variant>
 #include <vector>
 
 namespace tremor::ecs {
 namespace {
 
+// A value as an ecs_set_* command parsed it. Native fields take its bytes
+// directly; it only becomes a script Value for fields kept in ScriptComponentData.
+using FieldInput = std::variant<float, bool, std::string_view, glm::vec3>;
+
 std::vector<std::string> splitWords(std::string_view text) {
     std::vector<std::string> words;
     std::istringstream stream{std::string(text)};
@@ -40,18 +48,6 @@ std::vector<std::string_view> splitPath(std::string_view path) {
     return parts;
 }
 
-std::optional<float> parseFloat(std::string_view text) {
-    try {
-        size_t consumed = 0;
-        const float value = std::stof(std::string(text), &consumed);
-        if (consumed == text.size()) {
-            return value;
-        }
-    } catch (const std::exception&) {
-    }
-    return std::nullopt;
-}
-
 std::optional<flecs::entity_t> parseEntityId(std::string value) {
     if (value.empty()) {
         return std::nullopt;
@@ -143,20 +139,244 @@ tremor::script::Value makeVec3Value(float x, float y, float z) {
     return value;
 }
 
+std::optional<glm::vec3> vec3FromValue(const tremor::script::Value& value) {
+    const tremor::script::ObjectValue* object = value.asObject();
+    if (object == nullptr) {
+        return std::nullopt;
+    }
+
+    const auto readAxis = [object](std::string_view axis) -> std::optional<float> {
+        const auto found = object->fields.find(std::string(axis));
+        if (found == object->fields.end()) {
+            return std::nullopt;
+        }
+        const std::optional<double> number = found->second.asNumber();
+        if (!number) {
+            return std::nullopt;
+        }
+        return static_cast<float>(*number);
+    };
+
+    const std::optional<float> x = readAxis("x");
+    const std::optional<float> y = readAxis("y");
+    const std::optional<float> z = readAxis("z");
+    if (!x || !y || !z) {
+        return std::nullopt;
+    }
+    return glm::vec3(*x, *y, *z);
+}
+
+std::optional<ScriptFieldType> parseFieldType(std::string_view name) {
+    if (name == "number" || name == "f32") return ScriptFieldType::Number;
+    if (name == "bool") return ScriptFieldType::Bool;
+    if (name == "string") return ScriptFieldType::String;
+    if (name == "entity") return ScriptFieldType::Entity;
+    if (name == "vec3") return ScriptFieldType::Vec3;
+    return std::nullopt;
+}
+
+std::string_view fieldTypeName(ScriptFieldType type) {
+    switch (type) {
+    case ScriptFieldType::Number: return "number";
+    case ScriptFieldType::Bool: return "bool";
+    case ScriptFieldType::String: return "string";
+    case ScriptFieldType::Entity: return "entity";
+    case ScriptFieldType::Vec3: return "vec3";
+    }
+    return "unknown";
+}
+
+// Reflection type used for vec3 members, shared by every schema
+flecs::entity_t scriptVec3Type(flecs::world& world) {
+    if (const flecs::entity existing = world.lookup("ScriptComponents::Vec3")) {
+        return existing.id();
+    }
+    return world.component("ScriptComponents::Vec3")
+        .member<float>("x")
+        .member<float>("y")
+        .member<float>("z")
+        .id();
+}
+
+flecs::entity_t memberType(flecs::world& world, ScriptFieldType type) {
+    switch (type) {
+    case ScriptFieldType::Number: return flecs::F32;
+    case ScriptFieldType::Bool: return flecs::Bool;
+    case ScriptFieldType::String: return flecs::U32;
+    case ScriptFieldType::Entity: return flecs::Entity;
+    case ScriptFieldType::Vec3: return scriptVec3Type(world);
+    }
+    return flecs::F32;
+}
+
+bool sameLayout(const ScriptComponentSchema& schema, const std::vector<ScriptComponentField>& fields) {
+    return std::equal(
+        schema.fields.begin(), schema.fields.end(),
+        fields.begin(), fields.end(),
+        [](const ScriptComponentField& left, const ScriptComponentField& right) {
+            return left.name == right.name && left.type == right.type;
+        }
+    );
+}
+
+// Registers the schema as a flecs component with one reflection member per
+// field, then reads back the offsets flecs laid the members out at
+bool defineScriptComponent(
+    flecs::world& world,
+    const std::string& name,
+    std::vector<ScriptComponentField> fields
+) {
+    if (const ScriptComponentSchemas* schemas = world.get<ScriptComponentSchemas>()) {
+        if (const ScriptComponentSchema* existing = schemas->find(name)) {
+            if (sameLayout(*existing, fields)) {
+                return true;
+            }
+            Logger::get().error(
+                "ecs_define_component failed: '{}' is already defined with a different layout",
+                name
+            );
+            return false;
+        }
+    }
+
+    flecs::untyped_component component = world.component(std::format("ScriptComponents::{}", name).c_str());
+    for (const ScriptComponentField& field : fields) {
+        component.member(memberType(world, field.type), field.name.c_str());
+    }
+
+    const flecs::Struct* layout = component.get<flecs::Struct>();
+    if (layout == nullptr || ecs_vec_count(&layout->members) != static_cast<int32_t>(fields.size())) {
+        Logger::get().error("ecs_define_component failed: flecs rejected the layout of '{}'", name);
+        return false;
+    }
+
+    const ecs_member_t* members = ecs_vec_first_t(&layout->members, ecs_member_t);
+    for (size_t index = 0; index < fields.size(); ++index) {
+        fields[index].offset = members[index].offset;
+    }
+    const flecs::Component* info = component.get<flecs::Component>();
+    const uint32_t size = info != nullptr ? static_cast<uint32_t>(info->size) : 0;
+
+    ScriptComponentSchemas& schemas = world.ensure<ScriptComponentSchemas>();
+    schemas.schemas.push_back({name, component.id(), size, std::move(fields)});
+    ++schemas.generation;
+    world.modified<ScriptComponentSchemas>();
+
+    Logger::get().info("Interpreter ECS defined component '{}'", name);
+    return true;
+}
+
+tremor::script::Value scriptValue(const FieldInput& input) {
+    if (const float* number = std::get_if<float>(&input)) {
+        return tremor::script::Value(static_cast<double>(*number));
+    }
+    if (const bool* flag = std::get_if<bool>(&input)) {
+        return tremor::script::Value(*flag);
+    }
+    if (const std::string_view* text = std::get_if<std::string_view>(&input)) {
+        return tremor::script::Value(std::string(*text));
+    }
+    const glm::vec3& vector = std::get<glm::vec3>(input);
+    return makeVec3Value(vector.x, vector.y, vector.z);
+}
+
+std::string describeInput(const FieldInput& input) {
+    if (const float* number = std::get_if<float>(&input)) {
+        return std::format("number {}", *number);
+    }
+    if (const bool* flag = std::get_if<bool>(&input)) {
+        return std::format("bool {}", *flag);
+    }
+    if (const std::string_view* text = std::get_if<std::string_view>(&input)) {
+        return std::format("string '{}'", *text);
+    }
+    const glm::vec3& vector = std::get<glm::vec3>(input);
+    return std::format("vec3 ({}, {}, {})", vector.x, vector.y, vector.z);
+}
+
+bool writeNativeField(
+    ScriptComponentSchemas& schemas,
+    flecs::entity entity,
+    const NativeScriptField& field,
+    std::string_view path,
+    const FieldInput& input
+) {
+    std::byte scratch[sizeof(float) * 3] = {};
+    size_t size = 0;
+
+    switch (field.type) {
+    case ScriptFieldType::Number:
+        if (const float* number = std::get_if<float>(&input)) {
+            std::memcpy(scratch, number, sizeof(float));
+            size = sizeof(float);
+        }
+        break;
+    case ScriptFieldType::Bool:
+        if (const bool* flag = std::get_if<bool>(&input)) {
+            std::memcpy(scratch, flag, sizeof(bool));
+            size = sizeof(bool);
+        }
+        break;
+    case ScriptFieldType::Entity:
+        if (const std::string_view* reference = std::get_if<std::string_view>(&input)) {
+            if (const std::optional<flecs::entity_t> id = parseEntityId(std::string(*reference))) {
+                std::memcpy(scratch, &*id, sizeof(flecs::entity_t));
+                size = sizeof(flecs::entity_t);
+            }
+        }
+        break;
+    case ScriptFieldType::Vec3:
+        if (const glm::vec3* vector = std::get_if<glm::vec3>(&input)) {
+            const float axes[3] = {vector->x, vector->y, vector->z};
+            std::memcpy(scratch, axes, sizeof(axes));
+            size = sizeof(axes);
+        }
+        break;
+    case ScriptFieldType::String:
+        if (const std::string_view* text = std::get_if<std::string_view>(&input)) {
+            flecs::world world = entity.world();
+            schemas.collectStringsIfDue(world);
+            const uint32_t id = schemas.internString(*text);
+            std::memcpy(scratch, &id, sizeof(id));
+            size = sizeof(id);
+        }
+        break;
+    }
+
+    if (size == 0) {
+        Logger::get().error(
+            "ecs_set failed: field '{}' holds a {}, got {}",
+            path,
+            fieldTypeName(field.type),
+            describeInput(input)
+        );
+        return false;
+    }
+
+    std::byte* data = static_cast<std::byte*>(entity.ensure(field.component)) + field.offset;
+    std::memcpy(data, scratch, size);
+    entity.modified(field.component);
+    return true;
+}
+
 bool setEntityField(
-    tremor::script::FlecsInterpreterHost& interpreterHost,
     const tremor::script::CommandContext& context,
-    std::string_view entityRef,
+    const std::optional<flecs::entity>& entity,
+    std::string_view error,
     std::string_view path,
-    tremor::script::Value value
+    const FieldInput& input
 ) {
-    std::string error;
-    std::optional<flecs::entity> entity = resolveEntity(interpreterHost, context, entityRef, &error);
     if (!entity) {
         Logger::get().error("ecs_set failed: {}", error);
         return false;
     }
 
+    if (ScriptComponentSchemas* schemas = context.world.get_mut<ScriptComponentSchemas>()) {
+        if (const std::optional<NativeScriptField> field = schemas->resolve(path)) {
+            return writeNativeField(*schemas, *entity, *field, path, input);
+        }
+    }
+
     context.world.component<ScriptComponentData>();
 
     ScriptComponentData data;
@@ -164,7 +384,7 @@ bool setEntityField(
         data = *existing;
     }
 
-    if (!setScriptField(data, path, std::move(value))) {
+    if (!setScriptField(data, path, scriptValue(input))) {
         Logger::get().error("ecs_set failed: invalid field path '{}'", path);
         return false;
     }
@@ -175,6 +395,140 @@ bool setEntityField(
 
 } // namespace
 
+const ScriptComponentField* ScriptComponentSchema::findField(std::string_view fieldName) const {
+    const auto found = std::find_if(fields.begin(), fields.end(), [fieldName](const ScriptComponentField& field) {
+        return field.name == fieldName;
+    });
+    return found == fields.end() ? nullptr : &*found;
+}
+
+const ScriptComponentSchema* ScriptComponentSchemas::find(std::string_view name) const {
+    const auto found = std::find_if(schemas.begin(), schemas.end(), [name](const ScriptComponentSchema& schema) {
+        return schema.name == name;
+    });
+    return found == schemas.end() ? nullptr : &*found;
+}
+
+std::optional<NativeScriptField> ScriptComponentSchemas::resolve(std::string_view path) const {
+    const size_t split = path.find('.');
+    if (split == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    const ScriptComponentSchema* schema = find(path.substr(0, split));
+    if (schema == nullptr) {
+        return std::nullopt;
+    }
+    const ScriptComponentField* field = schema->findField(path.substr(split + 1));
+    if (field == nullptr) {
+        return std::nullopt;
+    }
+    return NativeScriptField{schema->component, field->type, field->offset};
+}
+
+uint32_t ScriptComponentSchemas::internString(std::string_view text) {
+    if (strings.empty()) {
+        strings.emplace_back();
+    }
+    const auto found = stringIds.find(text);
+    if (found != stringIds.end()) {
+        return found->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    if (!freeStringIds.empty()) {
+        id = freeStringIds.back();
+        freeStringIds.pop_back();
+        strings[id] = std::string(text);
+    } else {
+        strings.emplace_back(text);
+    }
+    stringIds.emplace(strings[id], id);
+    return id;
+}
+
+void ScriptComponentSchemas::collectStringsIfDue(flecs::world& world) {
+    if (!freeStringIds.empty() || strings.size() < collectStringsAt) {
+        return;
+    }
+
+    // Mark every id a string field of a live component holds
+    std::vector<bool> live(strings.size(), false);
+    for (const ScriptComponentSchema& schema : schemas) {
+        std::vector<int32_t> offsets;
+        for (const ScriptComponentField& field : schema.fields) {
+            if (field.type == ScriptFieldType::String) {
+                offsets.push_back(field.offset);
+            }
+        }
+        if (offsets.empty()) {
+            continue;
+        }
+
+        flecs::query<> holders = world.query_builder().with(schema.component).in().build();
+        holders.run([&](flecs::iter& it) {
+            while (it.next()) {
+                const flecs::untyped_field column = it.field(0);
+                for (size_t row = 0; row < it.count(); ++row) {
+                    const std::byte* data = static_cast<const std::byte*>(column[row]);
+                    for (const int32_t offset : offsets) {
+                        uint32_t id = 0;
+                        std::memcpy(&id, data + offset, sizeof(id));
+                        if (id < live.size()) {
+                            live[id] = true;
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    size_t liveCount = 0;
+    for (uint32_t id = 1; id < strings.size(); ++id) {
+        if (live[id]) {
+            ++liveCount;
+            continue;
+        }
+        // Ids freed by an earlier collection no longer own their map entry
+        const auto found = stringIds.find(strings[id]);
+        if (found != stringIds.end() && found->second == id) {
+            stringIds.erase(found);
+            strings[id] = std::string();
+            freeStringIds.push_back(id);
+        }
+    }
+    collectStringsAt = std::max<size_t>(256, liveCount * 2);
+}
+
+std::optional<std::string_view> ScriptComponentSchemas::string(uint32_t id) const {
+    if (id == 0 || id >= strings.size()) {
+        return std::nullopt;
+    }
+    return strings[id];
+}
+
+std::optional<glm::vec3> readNativeVec3(const void* componentData, const NativeScriptField& field) {
+    if (componentData == nullptr || field.type != ScriptFieldType::Vec3) {
+        return std::nullopt;
+    }
+    float axes[3];
+    std::memcpy(axes, static_cast<const std::byte*>(componentData) + field.offset, sizeof(axes));
+    return glm::vec3(axes[0], axes[1], axes[2]);
+}
+
+std::optional<std::string_view> readNativeString(
+    const ScriptComponentSchemas& schemas,
+    const void* componentData,
+    const NativeScriptField& field
+) {
+    if (componentData == nullptr || field.type != ScriptFieldType::String) {
+        return std::nullopt;
+    }
+    uint32_t id = 0;
+    std::memcpy(&id, static_cast<const std::byte*>(componentData) + field.offset, sizeof(id));
+    return schemas.string(id);
+}
+
 bool setScriptField(ScriptComponentData& data, std::string_view path, tremor::script::Value value) {
     const std::vector<std::string_view> parts = splitPath(path);
     if (parts.empty()) {
@@ -225,31 +579,7 @@ std::optional<glm::vec3> readVec3Field(const ScriptComponentData& data, std::str
     if (value == nullptr) {
         return std::nullopt;
     }
-
-    const tremor::script::ObjectValue* object = value->asObject();
-    if (object == nullptr) {
-        return std::nullopt;
-    }
-
-    const auto readAxis = [object](std::string_view axis) -> std::optional<float> {
-        const auto found = object->fields.find(std::string(axis));
-        if (found == object->fields.end()) {
-            return std::nullopt;
-        }
-        const std::optional<double> number = found->second.asNumber();
-        if (!number) {
-            return std::nullopt;
-        }
-        return static_cast<float>(*number);
-    };
-
-    const std::optional<float> x = readAxis("x");
-    const std::optional<float> y = readAxis("y");
-    const std::optional<float> z = readAxis("z");
-    if (!x || !y || !z) {
-        return std::nullopt;
-    }
-    return glm::vec3(*x, *y, *z);
+    return vec3FromValue(*value);
 }
 
 std::optional<std::string_view> readStringField(const ScriptComponentData& data, std::string_view path) {
@@ -261,28 +591,68 @@ std::optional<std::string_view> readStringField(const ScriptComponentData& data,
 }
 
 void registerScriptComponentCommands(tremor::script::FlecsInterpreterHost& interpreterHost) {
-    interpreterHost.registerCommand("ecs_set_number", [&interpreterHost](
+    using tremor::script::CommandArgType;
+
+    interpreterHost.registerCommand("ecs_define_component", [](
         const tremor::script::CommandContext& context,
         std::string_view argument
     ) {
         const std::vector<std::string> args = splitWords(argument);
-        if (args.size() != 3) {
-            Logger::get().error("ecs_set_number expects '<entity_ref> <field_path> <number>'");
+        if (args.size() < 2) {
+            Logger::get().error("ecs_define_component expects '<name> <field>:<type>...'");
             return false;
         }
-
-        const std::optional<float> value = parseFloat(args[2]);
-        if (!value) {
-            Logger::get().error("ecs_set_number failed: invalid number '{}'", args[2]);
+        if (args[0].find('.') != std::string::npos) {
+            Logger::get().error("ecs_define_component failed: invalid component name '{}'", args[0]);
             return false;
         }
 
+        std::vector<ScriptComponentField> fields;
+        for (size_t index = 1; index < args.size(); ++index) {
+            const std::string_view declaration = args[index];
+            const size_t split = declaration.find(':');
+            const std::string_view fieldName = declaration.substr(0, split);
+            const std::optional<ScriptFieldType> type = split == std::string_view::npos
+                ? std::nullopt
+                : parseFieldType(declaration.substr(split + 1));
+            if (fieldName.empty() || fieldName.find('.') != std::string_view::npos || !type) {
+                Logger::get().error(
+                    "ecs_define_component failed: invalid field '{}' (types: number, bool, string, entity, vec3)",
+                    declaration
+                );
+                return false;
+            }
+
+            const bool duplicate = std::any_of(fields.begin(), fields.end(), [fieldName](const ScriptComponentField& field) {
+                return field.name == fieldName;
+            });
+            if (duplicate) {
+                Logger::get().error("ecs_define_component failed: field '{}' is declared twice", fieldName);
+                return false;
+            }
+            fields.push_back({std::string(fieldName), *type, 0});
+        }
+
+        return defineScriptComponent(context.world, args[0], std::move(fields));
+    });
+
+    interpreterHost.registerTypedCommand("ecs_set_number", {
+        {CommandArgType::Entity, CommandArgType::String, CommandArgType::Number},
+        3,
+        "<entity_ref> <field_path> <number>",
+    }, [](
+        const tremor::script::CommandContext& context,
+        std::span<const tremor::script::Value> args
+    ) {
+        std::string error;
+        const std::optional<flecs::entity> entity =
+            tremor::script::resolveEntityArgument(context.world, args[0], &error);
         return setEntityField(
-            interpreterHost,
             context,
-            args[0],
-            args[1],
-            tremor::script::Value(static_cast<double>(*value))
+            entity,
+            error,
+            *args[1].asStringView(),
+            static_cast<float>(*args[2].asNumber())
         );
     });
 
@@ -302,58 +672,47 @@ void registerScriptComponentCommands(tremor::script::FlecsInterpreterHost& inter
             return false;
         }
 
-        return setEntityField(
-            interpreterHost,
-            context,
-            args[0],
-            args[1],
-            tremor::script::Value(std::string(argument.substr(valueOffset)))
-        );
+        std::string error;
+        const std::optional<flecs::entity> entity = resolveEntity(interpreterHost, context, args[0], &error);
+        return setEntityField(context, entity, error, args[1], argument.substr(valueOffset));
     });
 
-    interpreterHost.registerCommand("ecs_set_bool", [&interpreterHost](
+    interpreterHost.registerTypedCommand("ecs_set_bool", {
+        {CommandArgType::Entity, CommandArgType::String, CommandArgType::Bool},
+        3,
+        "<entity_ref> <field_path> <true|false>",
+    }, [](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitWords(argument);
-        if (args.size() != 3 || (args[2] != "true" && args[2] != "false")) {
-            Logger::get().error("ecs_set_bool expects '<entity_ref> <field_path> <true|false>'");
-            return false;
-        }
-
-        return setEntityField(
-            interpreterHost,
-            context,
-            args[0],
-            args[1],
-            tremor::script::Value(args[2] == "true")
-        );
+        std::string error;
+        const std::optional<flecs::entity> entity =
+            tremor::script::resolveEntityArgument(context.world, args[0], &error);
+        return setEntityField(context, entity, error, *args[1].asStringView(), *args[2].asBool());
     });
 
-    interpreterHost.registerCommand("ecs_set_vec3", [&interpreterHost](
+    interpreterHost.registerTypedCommand("ecs_set_vec3", {
+        {CommandArgType::Entity, CommandArgType::String, CommandArgType::Number, CommandArgType::Number,
+            CommandArgType::Number},
+        5,
+        "<entity_ref> <field_path> <x> <y> <z>",
+    }, [](
         const tremor::script::CommandContext& context,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitWords(argument);
-        if (args.size() != 5) {
-            Logger::get().error("ecs_set_vec3 expects '<entity_ref> <field_path> <x> <y> <z>'");
-            return false;
-        }
-
-        const std::optional<float> x = parseFloat(args[2]);
-        const std::optional<float> y = parseFloat(args[3]);
-        const std::optional<float> z = parseFloat(args[4]);
-        if (!x || !y || !z) {
-            Logger::get().error("ecs_set_vec3 failed: invalid vector '{}'", argument);
-            return false;
-        }
-
+        std::string error;
+        const std::optional<flecs::entity> entity =
+            tremor::script::resolveEntityArgument(context.world, args[0], &error);
         return setEntityField(
-            interpreterHost,
             context,
-            args[0],
-            args[1],
-            makeVec3Value(*x, *y, *z)
+            entity,
+            error,
+            *args[1].asStringView(),
+            glm::vec3(
+                static_cast<float>(*args[2].asNumber()),
+                static_cast<float>(*args[3].asNumber()),
+                static_cast<float>(*args[4].asNumber())
+            )
         );
     });
 }
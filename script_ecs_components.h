@@ -2,8 +2,13 @@
 
 #include "flecs_interpreter.h"
 
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -13,6 +18,76 @@ struct ScriptComponentData {
     tremor::script::ValueMap fields;
 };
 
+enum class ScriptFieldType : uint8_t {
+    Number,  // f32
+    Bool,
+    String,  // u32 id into ScriptComponentSchemas::strings
+    Entity,
+    Vec3     // three f32
+};
+
+// One member of a native script component, located by its byte offset
+struct ScriptComponentField {
+    std::string name;
+    ScriptFieldType type = ScriptFieldType::Number;
+    int32_t offset = 0;
+};
+
+// A component declared by a script with ecs_define_component. It is a real
+// flecs component whose POD layout flecs computed from its reflection members,
+// so entities store it in contiguous table columns instead of a ValueMap and
+// its bytes can be copied as they are.
+struct ScriptComponentSchema {
+    std::string name;
+    flecs::entity_t component = 0;
+    uint32_t size = 0;
+    std::vector<ScriptComponentField> fields;
+
+    [[nodiscard]] const ScriptComponentField* findField(std::string_view fieldName) const;
+};
+
+// "component.field" resolved against a schema
+struct NativeScriptField {
+    flecs::entity_t component = 0;
+    ScriptFieldType type = ScriptFieldType::Number;
+    int32_t offset = 0;
+};
+
+// Lets the interned string map be searched with a string_view without allocating
+struct ScriptStringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+};
+
+// World singleton holding every schema declared so far. Schemas are only ever
+// appended, so their indices stay valid for the life of the world, across
+// snapshot restores included.
+//
+// String field values are interned; id 0 means unset. Ids are only valid while
+// a component holds them: once the table has grown to twice the strings in use
+// at the last collection, ids no component holds any more are recycled.
+// Snapshots therefore store string fields as text.
+struct ScriptComponentSchemas {
+    std::vector<ScriptComponentSchema> schemas;
+    uint32_t generation = 0;  // Bumped per schema, for caches of queries over them
+
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t, ScriptStringHash, std::equal_to<>> stringIds;
+    std::vector<uint32_t> freeStringIds;
+    size_t collectStringsAt = 256;
+
+    [[nodiscard]] const ScriptComponentSchema* find(std::string_view name) const;
+    [[nodiscard]] std::optional<NativeScriptField> resolve(std::string_view path) const;
+
+    // Never frees ids, so several may be interned before they are stored
+    uint32_t internString(std::string_view text);
+    [[nodiscard]] std::optional<std::string_view> string(uint32_t id) const;
+
+    // Frees the ids no component in the world holds if the table is due for it.
+    // Only call while every interned id is stored in its component.
+    void collectStringsIfDue(flecs::world& world);
+};
+
 void registerScriptComponentCommands(tremor::script::FlecsInterpreterHost& interpreterHost);
 
 bool setScriptField(ScriptComponentData& data, std::string_view path, tremor::script::Value value);
@@ -21,4 +96,12 @@ const tremor::script::Value* getScriptField(const ScriptComponentData& data, std
 std::optional<glm::vec3> readVec3Field(const ScriptComponentData& data, std::string_view path);
 std::optional<std::string_view> readStringField(const ScriptComponentData& data, std::string_view path);
 
+// Reads a native field out of the component data at componentData; nullopt on a type mismatch
+std::optional<glm::vec3> readNativeVec3(const void* componentData, const NativeScriptField& field);
+std::optional<std::string_view> readNativeString(
+    const ScriptComponentSchemas& schemas,
+    const void* componentData,
+    const NativeScriptField& field
+);
+
 } // namespace tremor::ecs
@@ -1,11 +1,17 @@
 #include "script_render_system.h"
 
 #include "script_ecs_components.h"
+#if !defined(TREMOR_HEADLESS)
 #include "vk.h"
+#endif
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -23,31 +29,212 @@ std::vector<std::string> splitCommandWords(std::string_view text) {
     return words;
 }
 
-std::optional<float> parseFloat(std::string_view text) {
-    try {
-        size_t consumed = 0;
-        const float value = std::stof(std::string(text), &consumed);
-        if (consumed == text.size()) {
-            return value;
+// Typed arguments arrive converted, so numbers are always present
+glm::vec3 vec3Argument(std::span<const tremor::script::Value> args, size_t offset) {
+    return glm::vec3(
+        static_cast<float>(*args[offset].asNumber()),
+        static_cast<float>(*args[offset + 1].asNumber()),
+        static_cast<float>(*args[offset + 2].asNumber())
+    );
+}
+
+#if !defined(TREMOR_HEADLESS)
+// Queries behind a set of field paths and a tag, kept on the pass or camera
+// between frames and rebuilt only when the tag entity, the paths or the
+// declared schemas change. Each path is read from its native component when it
+// resolves to one and the entity has it, and from ScriptComponentData otherwise.
+struct NativeFieldQuery final : RenderAdapterCache {
+    bool built = false;
+    uint32_t schemaGeneration = 0;
+    flecs::entity_t tag = 0;
+    std::vector<std::string> paths;
+
+    // Per path: the native field, and its term in query (-1 when the path isn't native)
+    std::vector<std::optional<tremor::ecs::NativeScriptField>> fields;
+    std::vector<int8_t> columns;
+    int8_t dataColumn = -1;  // Optional ScriptComponentData term, when some path isn't native
+    std::vector<flecs::entity_t> requiredComponents;
+
+    // Tagged entities with the native components of every required path that has
+    // one; false when no required path is native
+    bool native = false;
+    flecs::query<> query;
+
+    // Tagged entities with ScriptComponentData; the ones query covers are skipped
+    flecs::query<> dataQuery;
+
+    [[nodiscard]] bool coveredByQuery(flecs::entity entity) const {
+        return native && std::all_of(requiredComponents.begin(), requiredComponents.end(), [entity](flecs::entity_t component) {
+            return entity.has(component);
+        });
+    }
+};
+
+// Paths from requiredCount on become optional terms
+const NativeFieldQuery& nativeFieldQuery(
+    std::shared_ptr<RenderAdapterCache>& slot,
+    flecs::world& world,
+    flecs::entity tag,
+    std::initializer_list<std::string_view> paths,
+    size_t requiredCount
+) {
+    auto* cache = dynamic_cast<NativeFieldQuery*>(slot.get());
+    if (cache == nullptr) {
+        auto created = std::make_shared<NativeFieldQuery>();
+        cache = created.get();
+        slot = std::move(created);
+    }
+
+    const tremor::ecs::ScriptComponentSchemas* schemas = world.get<tremor::ecs::ScriptComponentSchemas>();
+    const uint32_t generation = schemas != nullptr ? schemas->generation : 0;
+    if (cache->built && cache->schemaGeneration == generation && cache->tag == tag.id() &&
+        std::equal(cache->paths.begin(), cache->paths.end(), paths.begin(), paths.end())) {
+        return *cache;
+    }
+
+    cache->built = true;
+    cache->schemaGeneration = generation;
+    cache->tag = tag.id();
+    cache->paths.assign(paths.begin(), paths.end());
+    cache->fields.clear();
+    cache->columns.clear();
+    cache->dataColumn = -1;
+    cache->requiredComponents.clear();
+
+    std::vector<flecs::entity_t> components;
+    bool needsData = false;
+    for (std::string_view path : paths) {
+        const std::optional<tremor::ecs::NativeScriptField> field =
+            schemas != nullptr ? schemas->resolve(path) : std::nullopt;
+        const bool required = cache->fields.size() < requiredCount;
+
+        int8_t column = -1;
+        if (field) {
+            const auto found = std::find(components.begin(), components.end(), field->component);
+            column = static_cast<int8_t>(found - components.begin());
+            if (found == components.end()) {
+                components.push_back(field->component);
+            }
+            if (required && std::find(cache->requiredComponents.begin(), cache->requiredComponents.end(),
+                                      field->component) == cache->requiredComponents.end()) {
+                cache->requiredComponents.push_back(field->component);
+            }
+        } else {
+            needsData = true;
         }
-    } catch (const std::exception&) {
+        cache->fields.push_back(field);
+        cache->columns.push_back(column);
     }
-    return std::nullopt;
+
+    cache->native = !cache->requiredComponents.empty();
+    cache->query = flecs::query<>();
+    if (cache->native) {
+        flecs::query_builder<> builder = world.query_builder();
+        for (flecs::entity_t component : components) {
+            builder.with(component).in();
+            if (std::find(cache->requiredComponents.begin(), cache->requiredComponents.end(), component) ==
+                cache->requiredComponents.end()) {
+                builder.optional();
+            }
+        }
+        if (needsData) {
+            cache->dataColumn = static_cast<int8_t>(components.size());
+            builder.with<tremor::ecs::ScriptComponentData>().in().optional();
+        }
+        builder.with(tag);
+        cache->query = builder.cached().build();
+    }
+
+    cache->dataQuery = world.query_builder()
+        .with<tremor::ecs::ScriptComponentData>().in()
+        .with(tag)
+        .cached()
+        .build();
+    return *cache;
 }
 
-std::optional<glm::vec3> parseVec3Args(const std::vector<std::string>& args, size_t offset) {
-    if (args.size() < offset + 3) {
-        return std::nullopt;
+// One table of a NativeFieldQuery's query
+class NativeFieldRows {
+public:
+    NativeFieldRows(const NativeFieldQuery& query, const tremor::ecs::ScriptComponentSchemas* schemas, flecs::iter& it)
+        : query_(query), schemas_(schemas), it_(it) {
     }
 
-    const std::optional<float> x = parseFloat(args[offset]);
-    const std::optional<float> y = parseFloat(args[offset + 1]);
-    const std::optional<float> z = parseFloat(args[offset + 2]);
-    if (!x || !y || !z) {
-        return std::nullopt;
+    std::optional<glm::vec3> vec3(size_t path, size_t row) const {
+        if (const void* data = nativeData(path, row)) {
+            return tremor::ecs::readNativeVec3(data, *query_.fields[path]);
+        }
+        const tremor::ecs::ScriptComponentData* data = scriptData(row);
+        return data != nullptr ? tremor::ecs::readVec3Field(*data, query_.paths[path]) : std::nullopt;
     }
-    return glm::vec3(*x, *y, *z);
-}
+
+    std::optional<std::string_view> string(size_t path, size_t row) const {
+        if (const void* data = nativeData(path, row)) {
+            return tremor::ecs::readNativeString(*schemas_, data, *query_.fields[path]);
+        }
+        const tremor::ecs::ScriptComponentData* data = scriptData(row);
+        return data != nullptr ? tremor::ecs::readStringField(*data, query_.paths[path]) : std::nullopt;
+    }
+
+private:
+    // Null when the path isn't native or this table lacks its optional component
+    const void* nativeData(size_t path, size_t row) const {
+        const int8_t column = query_.columns[path];
+        if (column < 0 || !it_.is_set(column)) {
+            return nullptr;
+        }
+        return it_.field(column)[row];
+    }
+
+    const tremor::ecs::ScriptComponentData* scriptData(size_t row) const {
+        if (query_.dataColumn < 0 || !it_.is_set(query_.dataColumn)) {
+            return nullptr;
+        }
+        return static_cast<const tremor::ecs::ScriptComponentData*>(it_.field(query_.dataColumn)[row]);
+    }
+
+    const NativeFieldQuery& query_;
+    const tremor::ecs::ScriptComponentSchemas* schemas_;
+    flecs::iter& it_;
+};
+
+// One entity of a NativeFieldQuery's dataQuery, whose native components may be partial
+class NativeFieldEntity {
+public:
+    NativeFieldEntity(
+        const NativeFieldQuery& query,
+        const tremor::ecs::ScriptComponentSchemas* schemas,
+        flecs::entity entity,
+        const tremor::ecs::ScriptComponentData& data
+    )
+        : query_(query), schemas_(schemas), entity_(entity), data_(data) {
+    }
+
+    std::optional<glm::vec3> vec3(size_t path) const {
+        if (const void* native = nativeData(path)) {
+            return tremor::ecs::readNativeVec3(native, *query_.fields[path]);
+        }
+        return tremor::ecs::readVec3Field(data_, query_.paths[path]);
+    }
+
+    std::optional<std::string_view> string(size_t path) const {
+        if (const void* native = nativeData(path)) {
+            return tremor::ecs::readNativeString(*schemas_, native, *query_.fields[path]);
+        }
+        return tremor::ecs::readStringField(data_, query_.paths[path]);
+    }
+
+private:
+    const void* nativeData(size_t path) const {
+        const std::optional<tremor::ecs::NativeScriptField>& field = query_.fields[path];
+        return field ? entity_.get(field->component) : nullptr;
+    }
+
+    const NativeFieldQuery& query_;
+    const tremor::ecs::ScriptComponentSchemas* schemas_;
+    flecs::entity entity_;
+    const tremor::ecs::ScriptComponentData& data_;
+};
 
 std::optional<glm::vec3> findScriptCameraOrigin(
     flecs::world& world,
@@ -58,13 +245,38 @@ std::optional<glm::vec3> findScriptCameraOrigin(
         return std::nullopt;
     }
 
+    const NativeFieldQuery& targets =
+        nativeFieldQuery(camera.targetCache, world, tag, {camera.targetPositionField}, 1);
+    const tremor::ecs::ScriptComponentSchemas* schemas = world.get<tremor::ecs::ScriptComponentSchemas>();
+
     std::optional<glm::vec3> origin;
-    world.each([&](flecs::entity entity, const tremor::ecs::ScriptComponentData& data) {
-        if (origin || !entity.has(tag)) {
-            return;
-        }
+    if (targets.native) {
+        targets.query.run([&](flecs::iter& it) {
+            while (it.next()) {
+                const NativeFieldRows rows(targets, schemas, it);
+                for (size_t row = 0; !origin && row < it.count(); ++row) {
+                    origin = rows.vec3(0, row);
+                }
+            }
+        });
+    }
+    if (origin) {
+        return origin;
+    }
 
-        origin = tremor::ecs::readVec3Field(data, camera.targetPositionField);
+    targets.dataQuery.run([&](flecs::iter& it) {
+        while (it.next()) {
+            const flecs::untyped_field data = it.field(0);
+            for (size_t row = 0; !origin && row < it.count(); ++row) {
+                const flecs::entity entity = it.entity(row);
+                if (targets.coveredByQuery(entity)) {
+                    continue;
+                }
+                const NativeFieldEntity fields(
+                    targets, schemas, entity, *static_cast<const tremor::ecs::ScriptComponentData*>(data[row]));
+                origin = fields.vec3(0);
+            }
+        }
     });
     return origin;
 }
@@ -84,28 +296,59 @@ public:
             return;
         }
 
-        context_.world.each([&](flecs::entity entity, const tremor::ecs::ScriptComponentData& data) {
-            if (!entity.has(tag)) {
-                return;
-            }
-
-            const std::optional<std::string_view> asset =
-                tremor::ecs::readStringField(data, pass.assetField);
-            const std::optional<glm::vec3> position =
-                tremor::ecs::readVec3Field(data, pass.positionField);
+        const NativeFieldQuery& renderables = nativeFieldQuery(
+            pass.adapterCache,
+            context_.world,
+            tag,
+            {pass.assetField, pass.positionField, pass.scaleField},
+            2
+        );
+        const tremor::ecs::ScriptComponentSchemas* schemas =
+            context_.world.get<tremor::ecs::ScriptComponentSchemas>();
+
+        const auto emit = [&](
+            flecs::entity entity,
+            const std::optional<std::string_view>& asset,
+            const std::optional<glm::vec3>& position,
+            const std::optional<glm::vec3>& scale
+        ) {
             if (!asset || !position) {
                 return;
             }
-
-            const std::optional<glm::vec3> scale =
-                tremor::ecs::readVec3Field(data, pass.scaleField);
-
             callback({
                 .entity = static_cast<uint64_t>(entity.id()),
                 .assetPath = std::string(*asset),
                 .position = *position - context_.origin,
                 .scale = scale.value_or(glm::vec3(1.0f)),
             });
+        };
+
+        // Table columns for the entities holding the native components
+        if (renderables.native) {
+            renderables.query.run([&](flecs::iter& it) {
+                while (it.next()) {
+                    const NativeFieldRows rows(renderables, schemas, it);
+                    for (size_t row = 0; row < it.count(); ++row) {
+                        emit(it.entity(row), rows.string(0, row), rows.vec3(1, row), rows.vec3(2, row));
+                    }
+                }
+            });
+        }
+
+        // Everything else tagged, whose fields live wholly or partly in ScriptComponentData
+        renderables.dataQuery.run([&](flecs::iter& it) {
+            while (it.next()) {
+                const flecs::untyped_field data = it.field(0);
+                for (size_t row = 0; row < it.count(); ++row) {
+                    const flecs::entity entity = it.entity(row);
+                    if (renderables.coveredByQuery(entity)) {
+                        continue;
+                    }
+                    const NativeFieldEntity fields(
+                        renderables, schemas, entity, *static_cast<const tremor::ecs::ScriptComponentData*>(data[row]));
+                    emit(entity, fields.string(0), fields.vec3(1), fields.vec3(2));
+                }
+            }
         });
     }
 
@@ -120,9 +363,11 @@ public:
 private:
     const ScriptRenderContext& context_;
 };
+#endif
 
 } // namespace
 
+#if !defined(TREMOR_HEADLESS)
 void renderScriptEntities(
     const RenderInteropRegistry& registry,
     const ScriptRenderContext& context
@@ -175,6 +420,7 @@ bool renderScriptFrame(
 
     return true;
 }
+#endif
 
 void registerScriptRenderFrameCommands(
     tremor::script::FlecsInterpreterHost& interpreterHost,
@@ -199,53 +445,40 @@ void registerScriptRenderFrameCommands(
         return true;
     });
 
-    interpreterHost.registerCommand("render_camera_offset", [&camera](
+    using tremor::script::CommandArgType;
+    const tremor::script::CommandSignature vec3Signature{
+        {CommandArgType::Number, CommandArgType::Number, CommandArgType::Number},
+        3,
+        "x y z",
+    };
+
+    interpreterHost.registerTypedCommand("render_camera_offset", vec3Signature, [&camera](
         const tremor::script::CommandContext&,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitCommandWords(argument);
-        const std::optional<glm::vec3> offset = parseVec3Args(args, 0);
-        if (args.size() != 3 || !offset) {
-            return false;
-        }
-
-        camera.cameraOffset = *offset;
+        camera.cameraOffset = vec3Argument(args, 0);
         return true;
     });
 
-    interpreterHost.registerCommand("render_camera_look_at", [&camera](
+    interpreterHost.registerTypedCommand("render_camera_look_at", vec3Signature, [&camera](
         const tremor::script::CommandContext&,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitCommandWords(argument);
-        const std::optional<glm::vec3> target = parseVec3Args(args, 0);
-        if (args.size() != 3 || !target) {
-            return false;
-        }
-
-        camera.lookTarget = *target;
+        camera.lookTarget = vec3Argument(args, 0);
         return true;
     });
 
-    interpreterHost.registerCommand("render_camera_perspective", [&camera](
+    interpreterHost.registerTypedCommand("render_camera_perspective", {
+        {CommandArgType::Number, CommandArgType::Number, CommandArgType::Number},
+        3,
+        "fov_degrees near far",
+    }, [&camera](
         const tremor::script::CommandContext&,
-        std::string_view argument
+        std::span<const tremor::script::Value> args
     ) {
-        const std::vector<std::string> args = splitCommandWords(argument);
-        if (args.size() != 3) {
-            return false;
-        }
-
-        const std::optional<float> fov = parseFloat(args[0]);
-        const std::optional<float> nearPlane = parseFloat(args[1]);
-        const std::optional<float> farPlane = parseFloat(args[2]);
-        if (!fov || !nearPlane || !farPlane) {
-            return false;
-        }
-
-        camera.fovDegrees = *fov;
-        camera.nearPlane = *nearPlane;
-        camera.farPlane = *farPlane;
+        camera.fovDegrees = static_cast<float>(*args[0].asNumber());
+        camera.nearPlane = static_cast<float>(*args[1].asNumber());
+        camera.farPlane = static_cast<float>(*args[2].asNumber());
         return true;
     });
 }
@@ -1,18 +1,26 @@
 #pragma once
 
+#include "render_interop.h"
+
+// Headless builds (the simulation benchmark) keep the script camera and its
+// commands but have no Vulkan backend to draw with
+#if !defined(TREMOR_HEADLESS)
 #include "tremor_core.h"
 #include "tremor_graphics_platform.h"
-#include "render_interop.h"
+#endif
 
 #include <flecs.h>
 
 #include <glm/glm.hpp>
 
+#include <memory>
 #include <string>
 
+#if !defined(TREMOR_HEADLESS)
 namespace tremor::gfx {
 class TaffyOverlayManager;
 }
+#endif
 
 namespace tremor::render {
 
@@ -25,8 +33,11 @@ struct ScriptRenderCamera {
     float fovDegrees = 45.0f;
     float nearPlane = 100000.0f;
     float farPlane = 0.1f;
+    // Adapter state for finding the target, like RenderMeshPass::adapterCache
+    mutable std::shared_ptr<RenderAdapterCache> targetCache;
 };
 
+#if !defined(TREMOR_HEADLESS)
 struct ScriptRenderContext {
     flecs::world& world;
     tremor::gfx::TaffyOverlayManager& overlayManager;
@@ -46,6 +57,7 @@ bool renderScriptFrame(
     flecs::world& world,
     void* renderBackend
 );
+#endif
 
 void registerScriptRenderFrameCommands(
     tremor::script::FlecsInterpreterHost& interpreterHost,